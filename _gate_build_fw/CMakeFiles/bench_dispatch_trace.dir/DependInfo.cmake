@@ -0,0 +1,34 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/rp2040/test/bench_dispatch.cpp" "CMakeFiles/bench_dispatch_trace.dir/bench_dispatch.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/bench_dispatch.cpp.o.d"
+  "/root/repo/rp2040/src/anim.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/anim.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/anim.cpp.o.d"
+  "/root/repo/rp2040/src/capture.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/capture.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/capture.cpp.o.d"
+  "/root/repo/rp2040/src/config_store.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/config_store.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/config_store.cpp.o.d"
+  "/root/repo/rp2040/src/crc16.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/crc16.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/crc16.cpp.o.d"
+  "/root/repo/rp2040/src/gfx.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/gfx.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/gfx.cpp.o.d"
+  "/root/repo/rp2040/src/graph.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/graph.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/graph.cpp.o.d"
+  "/root/repo/rp2040/src/grid.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/grid.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/grid.cpp.o.d"
+  "/root/repo/rp2040/src/macro.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/macro.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/macro.cpp.o.d"
+  "/root/repo/rp2040/src/menu.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/menu.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/menu.cpp.o.d"
+  "/root/repo/rp2040/src/power.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/power.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/power.cpp.o.d"
+  "/root/repo/rp2040/src/rotary_encoder.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/rotary_encoder.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/rotary_encoder.cpp.o.d"
+  "/root/repo/rp2040/src/ssd1306.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/ssd1306.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/ssd1306.cpp.o.d"
+  "/root/repo/rp2040/src/trace.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/trace.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/trace.cpp.o.d"
+  "/root/repo/rp2040/src/transport_i2c.cpp" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/transport_i2c.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/transport_i2c.cpp.o.d"
+  "/root/repo/rp2040/test/sim.cpp" "CMakeFiles/bench_dispatch_trace.dir/sim.cpp.o" "gcc" "CMakeFiles/bench_dispatch_trace.dir/sim.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,41 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_dispatch_trace.dir/bench_dispatch.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/bench_dispatch.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/anim.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/anim.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/capture.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/capture.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/config_store.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/config_store.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/crc16.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/crc16.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/gfx.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/gfx.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/graph.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/graph.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/grid.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/grid.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/macro.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/macro.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/menu.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/menu.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/power.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/power.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/rotary_encoder.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/rotary_encoder.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/ssd1306.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/ssd1306.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/trace.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/trace.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/transport_i2c.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/root/repo/rp2040/src/transport_i2c.cpp.o.d"
+  "CMakeFiles/bench_dispatch_trace.dir/sim.cpp.o"
+  "CMakeFiles/bench_dispatch_trace.dir/sim.cpp.o.d"
+  "bench_dispatch_trace"
+  "bench_dispatch_trace.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_dispatch_trace.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,55 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/rp2040/src/anim.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/anim.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/anim.cpp.o.d"
+  "/root/repo/rp2040/src/capture.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/capture.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/capture.cpp.o.d"
+  "/root/repo/rp2040/src/config_store.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/config_store.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/config_store.cpp.o.d"
+  "/root/repo/rp2040/src/crc16.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/crc16.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/crc16.cpp.o.d"
+  "/root/repo/rp2040/src/gfx.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/gfx.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/gfx.cpp.o.d"
+  "/root/repo/rp2040/src/graph.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/graph.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/graph.cpp.o.d"
+  "/root/repo/rp2040/src/grid.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/grid.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/grid.cpp.o.d"
+  "/root/repo/rp2040/src/macro.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/macro.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/macro.cpp.o.d"
+  "/root/repo/rp2040/src/main.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/main.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/main.cpp.o.d"
+  "/root/repo/rp2040/src/menu.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/menu.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/menu.cpp.o.d"
+  "/root/repo/rp2040/src/power.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/power.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/power.cpp.o.d"
+  "/root/repo/rp2040/src/rotary_encoder.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/rotary_encoder.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/rotary_encoder.cpp.o.d"
+  "/root/repo/rp2040/src/ssd1306.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/ssd1306.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/ssd1306.cpp.o.d"
+  "/root/repo/rp2040/src/trace.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/trace.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/trace.cpp.o.d"
+  "/root/repo/rp2040/src/transport_i2c.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/transport_i2c.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/root/repo/rp2040/src/transport_i2c.cpp.o.d"
+  "/root/repo/rp2040/test/sim.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/sim.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/sim.cpp.o.d"
+  "/root/repo/rp2040/test/test_anim.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_anim.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_anim.cpp.o.d"
+  "/root/repo/rp2040/test/test_boot.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_boot.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_boot.cpp.o.d"
+  "/root/repo/rp2040/test/test_bytestream.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_bytestream.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_bytestream.cpp.o.d"
+  "/root/repo/rp2040/test/test_capture.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_capture.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_capture.cpp.o.d"
+  "/root/repo/rp2040/test/test_config.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_config.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_config.cpp.o.d"
+  "/root/repo/rp2040/test/test_controllers.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_controllers.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_controllers.cpp.o.d"
+  "/root/repo/rp2040/test/test_dual.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_dual.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_dual.cpp.o.d"
+  "/root/repo/rp2040/test/test_framing.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_framing.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_framing.cpp.o.d"
+  "/root/repo/rp2040/test/test_gfx.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_gfx.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_gfx.cpp.o.d"
+  "/root/repo/rp2040/test/test_graph.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_graph.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_graph.cpp.o.d"
+  "/root/repo/rp2040/test/test_grid.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_grid.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_grid.cpp.o.d"
+  "/root/repo/rp2040/test/test_harness.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_harness.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_harness.cpp.o.d"
+  "/root/repo/rp2040/test/test_input.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_input.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_input.cpp.o.d"
+  "/root/repo/rp2040/test/test_macro.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_macro.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_macro.cpp.o.d"
+  "/root/repo/rp2040/test/test_main.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_main.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_main.cpp.o.d"
+  "/root/repo/rp2040/test/test_menu.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_menu.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_menu.cpp.o.d"
+  "/root/repo/rp2040/test/test_packet.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_packet.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_packet.cpp.o.d"
+  "/root/repo/rp2040/test/test_power.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_power.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_power.cpp.o.d"
+  "/root/repo/rp2040/test/test_recovery.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_recovery.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_recovery.cpp.o.d"
+  "/root/repo/rp2040/test/test_status.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_status.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_status.cpp.o.d"
+  "/root/repo/rp2040/test/test_vendor.cpp" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_vendor.cpp.o" "gcc" "CMakeFiles/fw_i2c_ssd1306_128x64.dir/test_vendor.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,83 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/anim.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/anim.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/capture.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/capture.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/config_store.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/config_store.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/crc16.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/crc16.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/gfx.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/gfx.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/graph.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/graph.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/grid.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/grid.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/macro.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/macro.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/main.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/main.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/menu.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/menu.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/power.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/power.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/rotary_encoder.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/rotary_encoder.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/ssd1306.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/ssd1306.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/trace.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/trace.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/transport_spi.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/root/repo/rp2040/src/transport_spi.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/sim.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/sim.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_anim.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_anim.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_boot.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_boot.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_bytestream.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_bytestream.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_capture.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_capture.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_config.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_config.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_controllers.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_controllers.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_dual.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_dual.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_framing.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_framing.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_gfx.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_gfx.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_graph.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_graph.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_grid.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_grid.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_harness.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_harness.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_input.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_input.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_macro.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_macro.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_main.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_main.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_menu.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_menu.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_packet.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_packet.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_power.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_power.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_recovery.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_recovery.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_status.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_status.cpp.o.d"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_vendor.cpp.o"
+  "CMakeFiles/fw_spi_ssd1306_128x64.dir/test_vendor.cpp.o.d"
+  "fw_spi_ssd1306_128x64"
+  "fw_spi_ssd1306_128x64.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fw_spi_ssd1306_128x64.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
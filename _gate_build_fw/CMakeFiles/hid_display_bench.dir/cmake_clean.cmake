@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hid_display_bench.dir/root/repo/host/hid_display.cpp.o"
+  "CMakeFiles/hid_display_bench.dir/root/repo/host/hid_display.cpp.o.d"
+  "CMakeFiles/hid_display_bench.dir/root/repo/host/hid_display_bench.cpp.o"
+  "CMakeFiles/hid_display_bench.dir/root/repo/host/hid_display_bench.cpp.o.d"
+  "hid_display_bench"
+  "hid_display_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/hid_display_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
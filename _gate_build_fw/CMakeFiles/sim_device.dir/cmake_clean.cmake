@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/anim.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/anim.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/capture.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/capture.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/config_store.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/config_store.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/crc16.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/crc16.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/gfx.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/gfx.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/graph.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/graph.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/grid.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/grid.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/macro.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/macro.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/main.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/main.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/menu.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/menu.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/power.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/power.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/rotary_encoder.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/rotary_encoder.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/ssd1306.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/ssd1306.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/trace.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/trace.cpp.o.d"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/transport_i2c.cpp.o"
+  "CMakeFiles/sim_device.dir/root/repo/rp2040/src/transport_i2c.cpp.o.d"
+  "CMakeFiles/sim_device.dir/sim.cpp.o"
+  "CMakeFiles/sim_device.dir/sim.cpp.o.d"
+  "CMakeFiles/sim_device.dir/sim_device.cpp.o"
+  "CMakeFiles/sim_device.dir/sim_device.cpp.o.d"
+  "sim_device"
+  "sim_device.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sim_device.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
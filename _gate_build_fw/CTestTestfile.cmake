@@ -0,0 +1,32 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/rp2040/test
+# Build directory: /root/repo/_gate_build_fw
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(fw_i2c_ssd1306_128x64 "/root/repo/_gate_build_fw/fw_i2c_ssd1306_128x64")
+set_tests_properties(fw_i2c_ssd1306_128x64 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;83;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_spi_ssd1306_128x64 "/root/repo/_gate_build_fw/fw_spi_ssd1306_128x64")
+set_tests_properties(fw_spi_ssd1306_128x64 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;84;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_i2c_ssd1306_128x32 "/root/repo/_gate_build_fw/fw_i2c_ssd1306_128x32")
+set_tests_properties(fw_i2c_ssd1306_128x32 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;85;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_spi_ssd1306_128x32 "/root/repo/_gate_build_fw/fw_spi_ssd1306_128x32")
+set_tests_properties(fw_spi_ssd1306_128x32 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;86;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_i2c_sh1106_128x64 "/root/repo/_gate_build_fw/fw_i2c_sh1106_128x64")
+set_tests_properties(fw_i2c_sh1106_128x64 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;87;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_spi_sh1106_128x64 "/root/repo/_gate_build_fw/fw_spi_sh1106_128x64")
+set_tests_properties(fw_spi_sh1106_128x64 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;88;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_i2c_dual "/root/repo/_gate_build_fw/fw_i2c_dual")
+set_tests_properties(fw_i2c_dual PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;89;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(fw_spi_dual "/root/repo/_gate_build_fw/fw_spi_dual")
+set_tests_properties(fw_spi_dual PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;80;add_test;/root/repo/rp2040/test/CMakeLists.txt;90;add_firmware_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(perf_gate_i2c "/root/.pyenv/shims/python3" "/root/repo/rp2040/test/../../tools/perf_gate.py" "sim:/root/repo/_gate_build_fw/sim_device_i2c" "--check" "/root/repo/rp2040/test/../../tools/perf_baseline/sim_i2c.json")
+set_tests_properties(perf_gate_i2c PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;114;add_test;/root/repo/rp2040/test/CMakeLists.txt;120;add_sim_device;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(perf_gate_spi "/root/.pyenv/shims/python3" "/root/repo/rp2040/test/../../tools/perf_gate.py" "sim:/root/repo/_gate_build_fw/sim_device_spi" "--check" "/root/repo/rp2040/test/../../tools/perf_baseline/sim_spi.json")
+set_tests_properties(perf_gate_spi PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;114;add_test;/root/repo/rp2040/test/CMakeLists.txt;121;add_sim_device;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(tools "/root/.pyenv/shims/python3" "/root/repo/rp2040/test/test_tools.py" "/root/repo/_gate_build_fw/sim_device_i2c" "/root/repo/_gate_build_fw/hid_display_bench")
+set_tests_properties(tools PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;133;add_test;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(bench_dispatch "/root/repo/_gate_build_fw/bench_dispatch" "1000")
+set_tests_properties(bench_dispatch PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;148;add_test;/root/repo/rp2040/test/CMakeLists.txt;151;add_bench_dispatch;/root/repo/rp2040/test/CMakeLists.txt;0;")
+add_test(bench_dispatch_trace "/root/repo/_gate_build_fw/bench_dispatch_trace" "1000")
+set_tests_properties(bench_dispatch_trace PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/rp2040/test/CMakeLists.txt;148;add_test;/root/repo/rp2040/test/CMakeLists.txt;152;add_bench_dispatch;/root/repo/rp2040/test/CMakeLists.txt;0;")
@@ -0,0 +1,699 @@
+#include "hid_display.h"
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace hid_display {
+
+// DRAW_TEXT costs 4 header bytes, so bridging a gap of up to 3 unchanged
+// characters is cheaper than starting a new command
+#define RUN_MERGE_GAP   3
+#define WRITE_TIMEOUT_MS 1000
+
+static bool fd_write_all(int fd, const uint8_t* data, size_t len);
+
+Frame::Frame(int cols, int rows)
+    : cols_(cols), rows_(rows), cells_(cols * rows, ' ') {}
+
+void Frame::clear() {
+    cells_.assign(cols_ * rows_, ' ');
+    bars_.clear();
+}
+
+void Frame::text(int col, int row, const std::string& s) {
+    if (row < 0 || row >= rows_) return;
+    for (size_t i = 0; i < s.size(); i++) {
+        int c = col + (int)i;
+        if (c < 0) continue;
+        if (c >= cols_) break;
+        // Control characters would end the string on the device
+        char ch = s[i];
+        cells_[row * cols_ + c] = ((uint8_t)ch < 0x20) ? ' ' : ch;
+    }
+}
+
+void Frame::progress(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t percent) {
+    ProgressBar bar = { x, y, width, height, (uint8_t)(percent > 100 ? 100 : percent) };
+    for (ProgressBar& b : bars_) {
+        if (b.same_area(bar)) {
+            b.percent = bar.percent;
+            return;
+        }
+    }
+    bars_.push_back(bar);
+}
+
+// CMD_GFX ops (rp2040/src/main.h)
+enum : uint8_t {
+    GFX_OP_PIXEL       = 0x00,
+    GFX_OP_LINE        = 0x01,
+    GFX_OP_RECT        = 0x02,
+    GFX_OP_FILL_RECT   = 0x03,
+    GFX_OP_CIRCLE      = 0x04,
+    GFX_OP_FILL_CIRCLE = 0x05,
+    GFX_OP_BITMAP      = 0x06,
+    GFX_OP_CLIP        = 0x07,
+};
+
+Graphics& Graphics::add(uint8_t op, DrawMode mode, std::initializer_list<uint8_t> args) {
+    bytes_.insert(bytes_.end(), { CMD_GFX, op, (uint8_t)mode });
+    bytes_.insert(bytes_.end(), args);
+    return *this;
+}
+
+Graphics& Graphics::pixel(uint8_t x, uint8_t y, DrawMode mode) {
+    return add(GFX_OP_PIXEL, mode, { x, y });
+}
+
+Graphics& Graphics::line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, DrawMode mode) {
+    return add(GFX_OP_LINE, mode, { x0, y0, x1, y1 });
+}
+
+Graphics& Graphics::rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, DrawMode mode) {
+    return add(GFX_OP_RECT, mode, { x, y, w, h });
+}
+
+Graphics& Graphics::fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, DrawMode mode) {
+    return add(GFX_OP_FILL_RECT, mode, { x, y, w, h });
+}
+
+Graphics& Graphics::circle(uint8_t cx, uint8_t cy, uint8_t r, DrawMode mode) {
+    return add(GFX_OP_CIRCLE, mode, { cx, cy, r });
+}
+
+Graphics& Graphics::fill_circle(uint8_t cx, uint8_t cy, uint8_t r, DrawMode mode) {
+    return add(GFX_OP_FILL_CIRCLE, mode, { cx, cy, r });
+}
+
+bool Graphics::bitmap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* rows,
+                      DrawMode mode) {
+    size_t len = (size_t)(w + 7) / 8 * h;
+    if (len > MAX_BITMAP_BYTES) return false;
+    add(GFX_OP_BITMAP, mode, { x, y, w, h });
+    bytes_.insert(bytes_.end(), rows, rows + len);
+    return true;
+}
+
+Graphics& Graphics::clip(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    return add(GFX_OP_CLIP, DrawMode::Set, { x, y, w, h });
+}
+
+Encoder::Encoder(int cols, int rows) : mirror_(cols, rows) {}
+
+// Emit DRAW_TEXT commands for the columns of row where want[col] is set,
+// merging runs separated by short gaps
+static void emit_runs(const Frame& frame, int row, const std::vector<bool>& want, std::vector<uint8_t>& out) {
+    int cols = frame.cols();
+    int col = 0;
+    while (col < cols) {
+        if (!want[col]) {
+            col++;
+            continue;
+        }
+        int start = col;
+        int end = col;  // Last wanted column in this run
+        for (int c = col + 1; c < cols && c - end <= RUN_MERGE_GAP + 1 && (size_t)(c - start) < MAX_TEXT_LEN; c++) {
+            if (want[c]) end = c;
+        }
+        out.push_back(CMD_DRAW_TEXT);
+        out.push_back((uint8_t)(start * GLYPH_SIZE));
+        out.push_back((uint8_t)(row * GLYPH_SIZE));
+        out.push_back((uint8_t)(end - start + 1));
+        for (int c = start; c <= end; c++) out.push_back((uint8_t)frame.cell(c, row));
+        col = end + 1;
+    }
+}
+
+static void emit_bar(const ProgressBar& bar, std::vector<uint8_t>& out) {
+    out.insert(out.end(), { CMD_PROGRESS_BAR, bar.x, bar.y, bar.width, bar.height, bar.percent });
+}
+
+void Encoder::encode_state(const Frame& next, std::vector<uint8_t>& out) const {
+    if (!valid_ || next.invert_ != mirror_.invert_) {
+        out.insert(out.end(), { CMD_INVERT, (uint8_t)next.invert_ });
+    }
+    if (next.brightness_ >= 0 && (!valid_ || next.brightness_ != mirror_.brightness_)) {
+        out.insert(out.end(), { CMD_BRIGHTNESS, (uint8_t)next.brightness_ });
+    }
+    if (!valid_ || next.power_ != mirror_.power_) {
+        out.insert(out.end(), { CMD_POWER, (uint8_t)next.power_ });
+    }
+}
+
+// Clear, then draw every non-blank run and every bar
+void Encoder::encode_full(const Frame& next, std::vector<uint8_t>& out) const {
+    out.push_back(CMD_CLEAR);
+    std::vector<bool> want(next.cols());
+    for (int row = 0; row < next.rows(); row++) {
+        for (int col = 0; col < next.cols(); col++) want[col] = next.cell(col, row) != ' ';
+        emit_runs(next, row, want, out);
+    }
+    for (const ProgressBar& bar : next.bars_) emit_bar(bar, out);
+}
+
+// Redraw changed character runs and changed or new bars
+void Encoder::encode_delta(const Frame& next, std::vector<uint8_t>& out) const {
+    std::vector<bool> want(next.cols());
+    for (int row = 0; row < next.rows(); row++) {
+        for (int col = 0; col < next.cols(); col++) want[col] = next.cell(col, row) != mirror_.cell(col, row);
+        emit_runs(next, row, want, out);
+    }
+    for (const ProgressBar& bar : next.bars_) {
+        bool unchanged = false;
+        for (const ProgressBar& old : mirror_.bars_) {
+            if (old.same_area(bar) && old.percent == bar.percent) unchanged = true;
+        }
+        if (!unchanged) emit_bar(bar, out);
+    }
+}
+
+void Encoder::encode(const Frame& next, std::vector<uint8_t>& out) {
+    // A removed or moved bar leaves pixels only a clear can erase
+    bool need_full = !valid_;
+    for (const ProgressBar& old : mirror_.bars_) {
+        bool kept = false;
+        for (const ProgressBar& bar : next.bars_) {
+            if (bar.same_area(old)) kept = true;
+        }
+        if (!kept) need_full = true;
+    }
+
+    std::vector<uint8_t> full;
+    encode_full(next, full);
+    if (need_full) {
+        out.insert(out.end(), full.begin(), full.end());
+    } else {
+        std::vector<uint8_t> delta;
+        encode_delta(next, delta);
+        const std::vector<uint8_t>& best = delta.size() <= full.size() ? delta : full;
+        out.insert(out.end(), best.begin(), best.end());
+    }
+    encode_state(next, out);
+
+    int brightness = mirror_.brightness_;
+    mirror_ = next;
+    if (next.brightness_ < 0) mirror_.brightness_ = brightness;
+    valid_ = true;
+}
+
+Client::Client() {
+    for (int i = 0; i < MAX_DISPLAYS; i++) pending_.emplace_back();
+}
+
+Client::~Client() {
+    close();
+}
+
+bool Client::open(const std::string& port) {
+    int fd = ::open(port.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // Raw binary stream; the baud rate is ignored by CDC ACM
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, B115200);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return attach(fd);
+}
+
+bool Client::attach(int fd) {
+    close();
+    fd_ = fd;
+    start([fd](const uint8_t* data, size_t len) { return fd_write_all(fd, data, len); });
+    return true;
+}
+
+bool Client::attach(WriteFn write) {
+    close();
+    start(std::move(write));
+    return true;
+}
+
+void Client::start(WriteFn write) {
+    sink_ = std::move(write);
+    selected_ = 0;  // Firmware boots with display 0 selected
+    packets_ = false;
+    stop_ = false;
+    write_error_ = false;
+    for (bool& p : has_pending_) p = false;
+    for (Encoder& e : encoders_) e.invalidate();
+    writer_ = std::thread(&Client::writer_loop, this);
+}
+
+void Client::close() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        queue_cv_.notify_all();
+        writer_.join();
+    }
+    sink_ = nullptr;
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+static bool fd_write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n > 0) {
+            data += n;
+            len -= n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno != EAGAIN) return false;
+
+        // Device not draining: wait for room, give up if it stays full
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        if (poll(&pfd, 1, WRITE_TIMEOUT_MS) <= 0) return false;
+    }
+    return true;
+}
+
+bool Client::write_frame(const Frame& frame, uint8_t display) {
+    if (!sink_ || display >= MAX_DISPLAYS) return false;
+
+    batch_.clear();
+    if (display != selected_) {
+        batch_.insert(batch_.end(), { CMD_SELECT_DISPLAY, display });
+        selected_ = display;
+    }
+    encoders_[display].encode(frame, batch_);
+    if (batch_.empty()) return true;  // Nothing changed
+
+    bool ok = send(batch_);
+    if (!ok) encoders_[display].invalidate();  // Unknown how much arrived
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stats_.bytes_written += batch_.size();
+    stats_.writes++;
+    return ok;
+}
+
+bool Client::draw(const Frame& frame, uint8_t display) {
+    bool ok;
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+        ok = write_frame(frame, display);
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stats_.frames_submitted++;
+    stats_.frames_sent++;
+    if (!ok) write_error_ = true;
+    return ok;
+}
+
+bool Client::draw_pages(const uint8_t* pixels, uint8_t page_start, uint8_t page_count,
+                        uint8_t display, int width) {
+    return write_raw(display, { CMD_FRAME, page_start, page_count },
+                     pixels, (size_t)page_count * width);
+}
+
+bool Client::draw_graphics(const Graphics& graphics, uint8_t display) {
+    return write_raw(display, {}, graphics.bytes().data(), graphics.bytes().size());
+}
+
+// CMD_GRAPH ops (rp2040/src/main.h)
+enum : uint8_t {
+    GRAPH_OP_SETUP  = 0x00,
+    GRAPH_OP_SAMPLE = 0x01,
+    GRAPH_OP_SCALE  = 0x02,
+};
+
+bool Client::graph_setup(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                         uint8_t min, uint8_t max, bool fill, uint8_t display) {
+    return write_raw(display, { CMD_GRAPH, GRAPH_OP_SETUP, id, x, y, w, h, min, max,
+                                (uint8_t)(fill ? 1 : 0) }, nullptr, 0, false);
+}
+
+bool Client::graph_sample(uint8_t id, uint8_t value) {
+    return write_raw(-1, { CMD_GRAPH, GRAPH_OP_SAMPLE, id, value }, nullptr, 0, false);
+}
+
+bool Client::graph_scale(uint8_t id, uint8_t min, uint8_t max) {
+    return write_raw(-1, { CMD_GRAPH, GRAPH_OP_SCALE, id, min, max }, nullptr, 0, false);
+}
+
+// CMD_MENU ops (rp2040/src/main.h)
+enum : uint8_t {
+    MENU_OP_RESET = 0x00,
+    MENU_OP_ITEM  = 0x01,
+    MENU_OP_OPEN  = 0x02,
+    MENU_OP_CLOSE = 0x03,
+};
+
+bool Client::menu_upload(const std::vector<MenuItem>& items) {
+    std::vector<uint8_t> bytes = { CMD_MENU, MENU_OP_RESET };
+    for (const MenuItem& item : items) {
+        size_t len = std::min(item.label.size(), (size_t)DEFAULT_COLS - 1);  // Device truncates too
+        bytes.insert(bytes.end(), { CMD_MENU, MENU_OP_ITEM, item.id, item.parent,
+                                    (uint8_t)item.type, (uint8_t)(item.checked ? 1 : 0),
+                                    (uint8_t)len });
+        bytes.insert(bytes.end(), item.label.begin(), item.label.begin() + len);
+    }
+    return write_raw(-1, {}, bytes.data(), bytes.size(), false);
+}
+
+// The menu draws over the whole screen: text mirroring restarts afterwards
+bool Client::menu_open(uint8_t id, uint8_t display) {
+    return write_raw(display, { CMD_MENU, MENU_OP_OPEN, id }, nullptr, 0);
+}
+
+bool Client::menu_close() {
+    return write_raw(-1, { CMD_MENU, MENU_OP_CLOSE }, nullptr, 0, false);
+}
+
+// CMD_ANIM ops (rp2040/src/main.h)
+enum : uint8_t {
+    ANIM_OP_STOP         = 0x00,
+    ANIM_OP_BLINK        = 0x01,
+    ANIM_OP_SLIDE        = 0x02,
+    ANIM_OP_CONTRAST     = 0x03,
+    ANIM_OP_INVERT_PULSE = 0x04,
+};
+
+// Blinks and pulses restore the pixels when done; a slide moves them for good
+bool Client::anim_blink(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                        uint8_t period_frames, uint8_t count, uint8_t display) {
+    return write_raw(display, { CMD_ANIM, ANIM_OP_BLINK, slot, x, y, w, h, period_frames, count },
+                     nullptr, 0, false);
+}
+
+bool Client::anim_slide(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                        int8_t dx, uint8_t frames, uint8_t display) {
+    return write_raw(display, { CMD_ANIM, ANIM_OP_SLIDE, slot, x, y, w, h, (uint8_t)dx, frames },
+                     nullptr, 0);
+}
+
+bool Client::anim_contrast(uint8_t slot, uint8_t target, uint8_t frames, uint8_t display) {
+    return write_raw(display, { CMD_ANIM, ANIM_OP_CONTRAST, slot, target, frames }, nullptr, 0, false);
+}
+
+bool Client::anim_invert_pulse(uint8_t slot, uint8_t period_frames, uint8_t count, uint8_t display) {
+    return write_raw(display, { CMD_ANIM, ANIM_OP_INVERT_PULSE, slot, period_frames, count },
+                     nullptr, 0, false);
+}
+
+bool Client::anim_stop(uint8_t slot) {
+    return write_raw(-1, { CMD_ANIM, ANIM_OP_STOP, slot }, nullptr, 0, false);
+}
+
+// CMD_MACRO ops (rp2040/src/main.h)
+enum : uint8_t {
+    MACRO_OP_BEGIN = 0x00,
+    MACRO_OP_END   = 0x01,
+    MACRO_OP_PLAY  = 0x02,
+    MACRO_OP_SAVE  = 0x04,
+};
+
+bool Client::macro_define(uint8_t id, const std::vector<uint8_t>& commands) {
+    std::vector<uint8_t> bytes = { CMD_MACRO, MACRO_OP_BEGIN, id };
+    bytes.insert(bytes.end(), commands.begin(), commands.end());
+    bytes.insert(bytes.end(), { CMD_MACRO, MACRO_OP_END });
+    return write_raw(-1, {}, bytes.data(), bytes.size(), false);
+}
+
+// Parameters travel NUL-separated in one command: the device cuts them at
+// MAX_TEXT_LEN bytes in total
+bool Client::macro_play(uint8_t id, const std::vector<std::string>& params, uint8_t display) {
+    std::string joined;
+    for (size_t i = 0; i < params.size(); i++) {
+        if (i) joined.push_back('\0');
+        joined += params[i];
+    }
+    if (joined.size() > MAX_TEXT_LEN) joined.resize(MAX_TEXT_LEN);
+    return write_raw(display, { CMD_MACRO, MACRO_OP_PLAY, id, (uint8_t)joined.size() },
+                     (const uint8_t*)joined.data(), joined.size());
+}
+
+bool Client::macro_save() {
+    return write_raw(-1, { CMD_MACRO, MACRO_OP_SAVE }, nullptr, 0, false);
+}
+
+// CMD_GRID ops (rp2040/src/main.h)
+enum : uint8_t {
+    GRID_OP_WRITE  = 0x00,
+    GRID_OP_ATTR   = 0x01,
+    GRID_OP_REDRAW = 0x02,
+};
+
+// Runs longer than one command are split, continuing at the next cell
+bool Client::grid_write(uint8_t row, uint8_t col, const std::string& text, uint8_t attr, uint8_t display) {
+    size_t cell = row * DEFAULT_COLS + col;
+    for (size_t pos = 0; pos < text.size(); pos += MAX_GRID_RUN, cell += MAX_GRID_RUN) {
+        if (cell >= (size_t)DEFAULT_COLS * DEFAULT_ROWS) break;
+        size_t len = std::min({ text.size() - pos, MAX_GRID_RUN, (size_t)DEFAULT_COLS * DEFAULT_ROWS - cell });
+        if (!write_raw(display, { CMD_GRID, GRID_OP_WRITE, (uint8_t)(cell / DEFAULT_COLS),
+                                  (uint8_t)(cell % DEFAULT_COLS), attr, (uint8_t)len },
+                       (const uint8_t*)text.data() + pos, len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Client::grid_attr(uint8_t row, uint8_t col, uint8_t count, uint8_t attr, uint8_t display) {
+    return write_raw(display, { CMD_GRID, GRID_OP_ATTR, row, col, count, attr }, nullptr, 0);
+}
+
+bool Client::grid_redraw(uint8_t display) {
+    return write_raw(display, { CMD_GRID, GRID_OP_REDRAW }, nullptr, 0);
+}
+
+// Write header + data to display outside the text mirror, which then has to
+// be redrawn in full unless the caller knows the text was not touched
+bool Client::write_raw(int display, std::initializer_list<uint8_t> header,
+                       const uint8_t* data, size_t len, bool invalidate) {
+    if (!sink_ || display >= MAX_DISPLAYS) return false;
+
+    std::lock_guard<std::mutex> io(io_mutex_);
+    batch_.clear();
+    if (display >= 0 && display != selected_) {
+        batch_.insert(batch_.end(), { CMD_SELECT_DISPLAY, (uint8_t)display });
+        selected_ = display;
+    }
+    batch_.insert(batch_.end(), header);
+    if (len) batch_.insert(batch_.end(), data, data + len);
+    if (display >= 0 && invalidate) encoders_[display].invalidate();
+
+    bool ok = send(batch_);
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stats_.bytes_written += batch_.size();
+    stats_.writes++;
+    if (!ok) write_error_ = true;
+    return ok;
+}
+
+// Bytes in the command at p, as the firmware frames it. Opcodes and ops this
+// library does not send, and CMD_FRAME (always last in a write), take the
+// rest of the data.
+static size_t command_length(const uint8_t* p, size_t avail) {
+    size_t len = avail;
+    switch (p[0]) {
+        case CMD_CLEAR:          len = 1; break;
+        case CMD_INVERT:
+        case CMD_BRIGHTNESS:
+        case CMD_POWER:
+        case CMD_SELECT_DISPLAY:
+        case CMD_PACKET:         len = 2; break;
+        case CMD_PROGRESS_BAR:   len = 6; break;
+        case CMD_DRAW_TEXT:      if (avail >= 4) len = 4 + p[3]; break;
+
+        case CMD_GFX:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case GFX_OP_PIXEL:       len = 5; break;
+                case GFX_OP_CIRCLE:
+                case GFX_OP_FILL_CIRCLE: len = 6; break;
+                case GFX_OP_LINE:
+                case GFX_OP_RECT:
+                case GFX_OP_FILL_RECT:
+                case GFX_OP_CLIP:        len = 7; break;
+                case GFX_OP_BITMAP:      if (avail >= 7) len = 7 + (size_t)(p[5] + 7) / 8 * p[6]; break;
+            }
+            break;
+
+        case CMD_GRAPH:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case GRAPH_OP_SETUP:  len = 10; break;
+                case GRAPH_OP_SAMPLE: len = 4; break;
+                case GRAPH_OP_SCALE:  len = 5; break;
+            }
+            break;
+
+        case CMD_MENU:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case MENU_OP_RESET:
+                case MENU_OP_CLOSE: len = 2; break;
+                case MENU_OP_OPEN:  len = 3; break;
+                case MENU_OP_ITEM:  if (avail >= 7) len = 7 + p[6]; break;
+            }
+            break;
+
+        case CMD_ANIM:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case ANIM_OP_STOP:         len = 3; break;
+                case ANIM_OP_BLINK:
+                case ANIM_OP_SLIDE:        len = 9; break;
+                case ANIM_OP_CONTRAST:
+                case ANIM_OP_INVERT_PULSE: len = 5; break;
+            }
+            break;
+
+        case CMD_MACRO:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case MACRO_OP_BEGIN: len = 3; break;
+                case MACRO_OP_END:
+                case MACRO_OP_SAVE:  len = 2; break;
+                case MACRO_OP_PLAY:  if (avail >= 4) len = 4 + p[3]; break;
+            }
+            break;
+
+        case CMD_GRID:
+            if (avail < 2) break;
+            switch (p[1]) {
+                case GRID_OP_REDRAW: len = 2; break;
+                case GRID_OP_ATTR:   len = 6; break;
+                case GRID_OP_WRITE:  if (avail >= 6) len = 6 + p[5]; break;
+            }
+            break;
+    }
+    return std::min(len, avail);
+}
+
+// CRC-16/CCITT-FALSE, as crc16_update() in the firmware
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+#define PACKET_SYNC 0xA5
+
+// Write bytes as they are, or in packet mode as packets of whole commands
+bool Client::send(const std::vector<uint8_t>& bytes) {
+    if (!packets_) return sink_(bytes.data(), bytes.size());
+
+    size_t pos = 0;
+    while (pos < bytes.size()) {
+        // As many whole commands as fit one packet
+        size_t end = pos;
+        while (end < bytes.size()) {
+            size_t len = command_length(&bytes[end], bytes.size() - end);
+            if (end - pos + len > MAX_PACKET_PAYLOAD) break;
+            end += len;
+        }
+        if (end == pos) return false;  // Single command too long for a packet
+
+        size_t len = end - pos;
+        packet_.assign({ PACKET_SYNC, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8),
+                         (uint8_t)((len & 0xFF) ^ (len >> 8) ^ 0xFF) });
+        packet_.insert(packet_.end(), bytes.begin() + pos, bytes.begin() + end);
+        uint16_t crc = crc16(&packet_[1], packet_.size() - 1);
+        packet_.insert(packet_.end(), { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) });
+        if (!sink_(packet_.data(), packet_.size())) return false;
+        pos = end;
+    }
+    return true;
+}
+
+// Sent in the current mode: plain to turn packets on, as a packet to turn them off
+bool Client::set_packet_mode(bool on) {
+    if (!sink_) return false;
+    std::lock_guard<std::mutex> io(io_mutex_);
+    bool ok = send({ CMD_PACKET, (uint8_t)(on ? 1 : 0) });
+    if (ok) packets_ = on;
+    return ok;
+}
+
+void Client::submit(const Frame& frame, uint8_t display) {
+    if (display >= MAX_DISPLAYS) return;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stats_.frames_submitted++;
+        if (has_pending_[display]) stats_.frames_coalesced++;
+        pending_[display] = frame;
+        has_pending_[display] = true;
+    }
+    queue_cv_.notify_one();
+}
+
+bool Client::flush() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    idle_cv_.wait(lock, [this] {
+        if (stop_) return true;  // Not attached: nothing will be written
+        if (busy_) return false;
+        for (bool p : has_pending_) if (p) return false;
+        return true;
+    });
+    return !write_error_;
+}
+
+void Client::invalidate() {
+    std::lock_guard<std::mutex> io(io_mutex_);
+    for (Encoder& e : encoders_) e.invalidate();
+}
+
+Stats Client::stats() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return stats_;
+}
+
+// Background writer: sends the newest pending frame of each display in turn
+void Client::writer_loop() {
+    int next = 0;
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this] {
+            if (stop_) return true;
+            for (bool p : has_pending_) if (p) return true;
+            return false;
+        });
+        if (stop_) break;
+
+        while (!has_pending_[next]) next = (next + 1) % MAX_DISPLAYS;
+        uint8_t display = (uint8_t)next;
+        next = (next + 1) % MAX_DISPLAYS;
+
+        Frame frame = pending_[display];
+        has_pending_[display] = false;
+        busy_ = true;
+        lock.unlock();
+
+        bool ok;
+        {
+            std::lock_guard<std::mutex> io(io_mutex_);
+            ok = write_frame(frame, display);
+        }
+
+        lock.lock();
+        busy_ = false;
+        stats_.frames_sent++;
+        if (!ok) write_error_ = true;
+        idle_cv_.notify_all();
+    }
+    busy_ = false;
+    idle_cv_.notify_all();
+}
+
+} // namespace hid_display
@@ -0,0 +1,291 @@
+#ifndef HID_DISPLAY_H
+#define HID_DISPLAY_H
+
+// Host-side client for the USB HID Display CDC protocol (Linux, POSIX termios).
+//
+// The application describes each screen as a Frame (a character grid plus
+// progress bars and panel state). An Encoder mirrors what the device already
+// shows and turns the next Frame into the shortest command stream it can:
+// only changed character runs are redrawn, or the screen is cleared and
+// redrawn when that is cheaper. Client writes each frame's commands in one
+// write() and offers an asynchronous submit()/flush() API in which frames
+// that arrive faster than the device accepts them are coalesced.
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hid_display {
+
+// Wire opcodes (rp2040/src/main.h)
+enum : uint8_t {
+    CMD_CLEAR          = 0x01,
+    CMD_DRAW_TEXT      = 0x02,
+    CMD_INVERT         = 0x04,
+    CMD_BRIGHTNESS     = 0x05,
+    CMD_PROGRESS_BAR   = 0x06,
+    CMD_POWER          = 0x07,
+    CMD_SELECT_DISPLAY = 0x0F,
+    CMD_FRAME          = 0x10,
+    CMD_GFX            = 0x11,
+    CMD_GRAPH          = 0x12,
+    CMD_MENU           = 0x13,
+    CMD_ANIM           = 0x14,
+    CMD_MACRO          = 0x16,
+    CMD_PACKET         = 0x17,
+    CMD_GRID           = 0x18,
+};
+
+// CMD_GFX draw modes
+enum class DrawMode : uint8_t { Set = 0, Clear = 1, Xor = 2 };
+
+constexpr int GLYPH_SIZE = 8;           // 8x8 font; text rows are 8-pixel pages
+constexpr int DEFAULT_COLS = 16;        // 128x64 panel
+constexpr int DEFAULT_ROWS = 8;
+constexpr int MAX_DISPLAYS = 2;         // DISPLAY_COUNT firmware limit
+constexpr size_t MAX_TEXT_LEN = 124;    // MAX_CMD_SIZE - 4
+constexpr size_t MAX_PACKET_PAYLOAD = 1027;  // PACKET_MAX_PAYLOAD: one full-screen CMD_FRAME
+constexpr size_t MAX_GRID_RUN = 122;    // MAX_CMD_SIZE - 6
+
+// CMD_GRID cell attributes
+enum GridAttr : uint8_t { GRID_INVERSE = 0x01, GRID_BLINK = 0x02 };
+
+struct ProgressBar {
+    uint8_t x, y, width, height, percent;
+
+    bool same_area(const ProgressBar& o) const {
+        return x == o.x && y == o.y && width == o.width && height == o.height;
+    }
+};
+
+// One entry of a device-side menu tree (CMD_MENU). Children of a submenu are
+// the items whose parent is its id, in upload order; parent 0 = top level.
+struct MenuItem {
+    enum Type : uint8_t { Action = 0, Submenu = 1, Toggle = 2, Back = 3 };
+
+    uint8_t id;                 // 1-255, reported back in selection events
+    uint8_t parent;
+    Type type;
+    std::string label;          // Up to 15 characters on a 128-pixel panel
+    bool checked = false;       // Initial Toggle state
+};
+
+// Batch of CMD_GFX primitives, drawn in order by Client::draw_graphics().
+// Coordinates are logical pixels; shapes past the screen edge are clipped.
+class Graphics {
+public:
+    Graphics& pixel(uint8_t x, uint8_t y, DrawMode mode = DrawMode::Set);
+    Graphics& line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, DrawMode mode = DrawMode::Set);
+    Graphics& rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, DrawMode mode = DrawMode::Set);
+    Graphics& fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, DrawMode mode = DrawMode::Set);
+    Graphics& circle(uint8_t cx, uint8_t cy, uint8_t r, DrawMode mode = DrawMode::Set);
+    Graphics& fill_circle(uint8_t cx, uint8_t cy, uint8_t r, DrawMode mode = DrawMode::Set);
+    // 1bpp rows of (w + 7) / 8 bytes, MSB leftmost; at most MAX_BITMAP_BYTES
+    // (false and nothing added if larger)
+    bool bitmap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* rows,
+                DrawMode mode = DrawMode::Set);
+    // Restrict later primitives to a rectangle; clip() resets to the whole screen
+    Graphics& clip(uint8_t x = 0, uint8_t y = 0, uint8_t w = 0, uint8_t h = 0);
+
+    void clear() { bytes_.clear(); }
+    bool empty() const { return bytes_.empty(); }
+    const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+    static constexpr size_t MAX_BITMAP_BYTES = 121;  // MAX_CMD_SIZE - 7
+
+private:
+    Graphics& add(uint8_t op, DrawMode mode, std::initializer_list<uint8_t> args);
+
+    std::vector<uint8_t> bytes_;
+};
+
+// Desired screen contents in logical (landscape) coordinates; the firmware
+// applies portrait rotation itself. Progress bars should not overlap text.
+class Frame {
+public:
+    explicit Frame(int cols = DEFAULT_COLS, int rows = DEFAULT_ROWS);
+
+    void clear();                                   // Blank text, no bars
+    void text(int col, int row, const std::string& s);
+    void progress(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t percent);
+    void set_invert(bool invert) { invert_ = invert; }
+    void set_brightness(uint8_t brightness) { brightness_ = brightness; }
+    void set_power(bool power) { power_ = power; }
+
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    char cell(int col, int row) const { return cells_[row * cols_ + col]; }
+
+private:
+    friend class Encoder;
+
+    int cols_;
+    int rows_;
+    std::string cells_;              // rows * cols characters, ' ' = blank
+    std::vector<ProgressBar> bars_;
+    bool invert_ = false;
+    int brightness_ = -1;            // -1 = leave unchanged
+    bool power_ = true;
+};
+
+// Turns frames into command bytes against a mirror of the device state
+class Encoder {
+public:
+    explicit Encoder(int cols = DEFAULT_COLS, int rows = DEFAULT_ROWS);
+
+    // Append the commands that make the device show next; updates the mirror
+    void encode(const Frame& next, std::vector<uint8_t>& out);
+
+    // Device state unknown (reconnect, other writer): next encode redraws all
+    void invalidate() { valid_ = false; }
+
+    const Frame& mirror() const { return mirror_; }
+
+private:
+    void encode_delta(const Frame& next, std::vector<uint8_t>& out) const;
+    void encode_full(const Frame& next, std::vector<uint8_t>& out) const;
+    void encode_state(const Frame& next, std::vector<uint8_t>& out) const;
+
+    Frame mirror_;
+    bool valid_ = false;
+};
+
+struct Stats {
+    uint64_t frames_submitted = 0;
+    uint64_t frames_sent = 0;
+    uint64_t frames_coalesced = 0;   // Replaced before they were sent
+    uint64_t bytes_written = 0;
+    uint64_t writes = 0;             // write() calls that carried frame data
+};
+
+class Client {
+public:
+    Client();
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    // Byte sink for other transports (e.g. UsbLink); returns false on error
+    using WriteFn = std::function<bool(const uint8_t* data, size_t len)>;
+
+    // Open a CDC tty in raw mode, take over an already open descriptor (pty,
+    // pipe, /dev/null) or write through a custom sink. Starts the writer thread.
+    bool open(const std::string& port);
+    bool attach(int fd);
+    bool attach(WriteFn write);
+    void close();
+
+    // Synchronous: write the delta for frame now (one write per frame)
+    bool draw(const Frame& frame, uint8_t display = 0);
+
+    // Asynchronous: queue frame for the writer thread and return at once. A
+    // frame still waiting for the same display is replaced (coalesced).
+    void submit(const Frame& frame, uint8_t display = 0);
+
+    // Upload raw page-format pixels (width bytes per 8-pixel page, logical
+    // orientation) with CMD_FRAME. Text mirroring restarts with a full redraw.
+    bool draw_pages(const uint8_t* pixels, uint8_t page_start, uint8_t page_count,
+                    uint8_t display = 0, int width = DEFAULT_COLS * GLYPH_SIZE);
+
+    // Draw graphics primitives on top of the current contents. Text mirroring
+    // restarts with a full redraw, which erases them again.
+    bool draw_graphics(const Graphics& graphics, uint8_t display = 0);
+
+    // Sparkline graph id on display: the device keeps the history and scrolls
+    // the plot itself, so each sample costs 4 bytes. Keep graphs clear of
+    // text rows; a full text redraw clears the plot until the next sample.
+    bool graph_setup(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                     uint8_t min, uint8_t max, bool fill = false, uint8_t display = 0);
+    bool graph_sample(uint8_t id, uint8_t value);
+    bool graph_scale(uint8_t id, uint8_t min, uint8_t max);
+
+    // Replace the device menu tree (one write), then show it on display. While
+    // open, the device navigates locally and sends [0x13][0x80][id][state] on
+    // the tty when an item is chosen, [0x13][0x81][0][0] when backed out.
+    bool menu_upload(const std::vector<MenuItem>& items);
+    bool menu_open(uint8_t id = 0, uint8_t display = 0);
+    bool menu_close();
+
+    // Device-side animations on a 25 ms frame tick (CMD_ANIM); slot 0-3 holds
+    // one animation, starting a new one in a slot replaces it. Blink and slide
+    // regions are logical pixels on display; counts of 0 repeat until stopped.
+    bool anim_blink(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                    uint8_t period_frames, uint8_t count = 0, uint8_t display = 0);
+    bool anim_slide(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                    int8_t dx, uint8_t frames, uint8_t display = 0);
+    bool anim_contrast(uint8_t slot, uint8_t target, uint8_t frames, uint8_t display = 0);
+    bool anim_invert_pulse(uint8_t slot, uint8_t period_frames, uint8_t count = 0,
+                           uint8_t display = 0);
+    bool anim_stop(uint8_t slot = 0xFF);  // 0xFF: all slots
+
+    // Command macros (CMD_MACRO): store raw protocol bytes as macro id 0-7 (one
+    // write), then replay them with one short command. Bytes 0x01-0x08 in
+    // recorded CMD_DRAW_TEXT text are replaced by params[0..7] on playback.
+    bool macro_define(uint8_t id, const std::vector<uint8_t>& commands);
+    bool macro_play(uint8_t id, const std::vector<std::string>& params = {}, uint8_t display = 0);
+    bool macro_save();  // Persist all macros to flash (~60 ms USB stall)
+
+    // Character grid (CMD_GRID): write text into the device's 8x8 cell grid
+    // from (row, col), wrapping to the next row; the device draws only cells
+    // whose character or attributes change. Blink runs on the device. Grid
+    // and text mirroring share the screen: a grid write makes the next frame
+    // a full redraw, and other drawing over the grid needs grid_redraw().
+    bool grid_write(uint8_t row, uint8_t col, const std::string& text, uint8_t attr = 0,
+                    uint8_t display = 0);
+    bool grid_attr(uint8_t row, uint8_t col, uint8_t count, uint8_t attr, uint8_t display = 0);
+    bool grid_redraw(uint8_t display = 0);
+
+    // CRC-framed packets (CMD_PACKET) until turned off or the port is closed:
+    // every write goes out as packets of whole commands, which the device
+    // drops if damaged instead of misreading the rest of the stream. Device
+    // replies are not framed.
+    bool set_packet_mode(bool on);
+
+    // Wait until every submitted frame has been written; false after a write error
+    bool flush();
+
+    // Force a full redraw on the next frame (e.g. after the device reset)
+    void invalidate();
+
+    Stats stats() const;
+
+private:
+    void start(WriteFn write);
+    void writer_loop();
+    bool write_frame(const Frame& frame, uint8_t display);  // Caller holds io_mutex_
+    bool send(const std::vector<uint8_t>& bytes);          // Caller holds io_mutex_
+    // display < 0: no CMD_SELECT_DISPLAY (command is not display-relative)
+    bool write_raw(int display, std::initializer_list<uint8_t> header,
+                   const uint8_t* data, size_t len, bool invalidate = true);
+
+    int fd_ = -1;                             // Owned descriptor (open/attach(fd))
+    WriteFn sink_;
+    int selected_ = -1;                       // Display last selected on the wire
+    bool packets_ = false;                    // CMD_PACKET mode on
+    std::vector<uint8_t> packet_;
+    Encoder encoders_[MAX_DISPLAYS];
+    std::vector<uint8_t> batch_;
+    std::mutex io_mutex_;                     // Serializes encoding and writes
+
+    // Async queue: at most one pending frame per display
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable idle_cv_;
+    std::vector<Frame> pending_;
+    bool has_pending_[MAX_DISPLAYS] = {};
+    bool busy_ = false;
+    bool stop_ = true;                        // Writer not running
+    bool write_error_ = false;
+    Stats stats_;
+    std::thread writer_;
+};
+
+} // namespace hid_display
+
+#endif // HID_DISPLAY_H
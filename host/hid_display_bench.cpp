@@ -0,0 +1,135 @@
+// Frame-rate and bandwidth benchmark for the hid_display client library.
+//
+// Usage:
+//   hid_display_bench /dev/ttyACM0 [frames]   # against the device
+//   hid_display_bench usb [frames]            # vendor bulk interface (libusb builds)
+//   hid_display_bench - [frames]              # encoder only (writes to /dev/null)
+//
+// Each canned scene submits frames as fast as possible through the async
+// API, then reports frames/s as seen by the application, frames actually
+// sent (the rest were coalesced) and wire bytes per sent frame. A final
+// "bitmap" run streams full raw frames with CMD_FRAME and reports sustained
+// throughput in KB/s.
+
+#include "hid_display.h"
+#ifdef HID_DISPLAY_WITH_LIBUSB
+#include "hid_display_usb.h"
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+using namespace hid_display;
+
+struct Scene {
+    const char* name;
+    std::function<void(Frame&, int)> build;  // Fill frame number i
+};
+
+static const Scene scenes[] = {
+    // Static menu: nothing changes after the first frame
+    { "static", [](Frame& f, int) {
+        f.clear();
+        f.text(0, 0, "Main menu");
+        f.text(1, 2, "Network");
+        f.text(1, 3, "Storage");
+        f.text(1, 4, "System");
+    } },
+    // Clock: one short field changes every frame
+    { "clock", [](Frame& f, int i) {
+        char buf[17];
+        f.clear();
+        f.text(0, 0, "Uptime");
+        snprintf(buf, sizeof(buf), "%02d:%02d:%02d", (i / 3600) % 24, (i / 60) % 60, i % 60);
+        f.text(4, 3, buf);
+    } },
+    // Progress: bar plus percentage text
+    { "progress", [](Frame& f, int i) {
+        char buf[17];
+        f.clear();
+        f.text(0, 0, "Updating...");
+        snprintf(buf, sizeof(buf), "%3d%%", i % 101);
+        f.text(6, 2, buf);
+        f.progress(10, 40, 108, 12, (uint8_t)(i % 101));
+    } },
+    // Scrolling list: every row changes every frame
+    { "scroll", [](Frame& f, int i) {
+        char buf[17];
+        f.clear();
+        for (int row = 0; row < f.rows(); row++) {
+            snprintf(buf, sizeof(buf), "%c Item %03d", row == 0 ? '>' : ' ', (i + row) % 1000);
+            f.text(0, row, buf);
+        }
+    } },
+};
+
+// Connect client to the port named on the command line
+static bool connect(Client& client, const std::string& port) {
+    if (port == "-") return client.attach(::open("/dev/null", O_WRONLY));
+#ifdef HID_DISPLAY_WITH_LIBUSB
+    if (port == "usb") {
+        static UsbLink link;                  // Opened once, shared by all scenes
+        static bool opened = link.open();
+        return opened && client.attach(link.writer());
+    }
+#endif
+    return client.open(port);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <port|usb|-> [frames]\n", argv[0]);
+        return 2;
+    }
+    std::string port = argv[1];
+    int frames = argc > 2 ? atoi(argv[2]) : 500;
+
+    printf("%-10s %10s %10s %10s %12s\n", "scene", "submit/s", "sent/s", "sent", "bytes/frame");
+    for (const Scene& scene : scenes) {
+        Client client;
+        if (!connect(client, port)) {
+            fprintf(stderr, "error: cannot open %s\n", port.c_str());
+            return 1;
+        }
+
+        Frame frame;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            scene.build(frame, i);
+            client.submit(frame);
+        }
+        bool ok = client.flush();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Stats st = client.stats();
+        printf("%-10s %10.0f %10.0f %10llu %12.1f%s\n", scene.name,
+               st.frames_submitted / secs, st.frames_sent / secs,
+               (unsigned long long)st.frames_sent,
+               st.frames_sent ? (double)st.bytes_written / st.frames_sent : 0.0,
+               ok ? "" : "  (write error)");
+    }
+
+    // Bulk streaming: full 128x64 frames, moving pattern so nothing is cached
+    Client client;
+    if (!connect(client, port)) return 1;
+
+    const int pages = DEFAULT_ROWS;
+    const int width = DEFAULT_COLS * GLYPH_SIZE;
+    std::vector<uint8_t> pixels(pages * width);
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 0; i < frames && ok; i++) {
+        for (size_t j = 0; j < pixels.size(); j++) pixels[j] = (uint8_t)(j + i);
+        ok = client.draw_pages(pixels.data(), 0, pages);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Stats st = client.stats();
+    printf("%-10s %10.0f %10s %10d %12.1f  %.0f KB/s%s\n", "bitmap", frames / secs, "-", frames,
+           (double)st.bytes_written / frames, st.bytes_written / 1024.0 / secs,
+           ok ? "" : "  (write error)");
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "hid_display_usb.h"
+
+#include <libusb-1.0/libusb.h>
+
+namespace hid_display {
+
+#define USB_TIMEOUT_MS 1000
+
+UsbLink::~UsbLink() {
+    close();
+}
+
+// Find the vendor-class interface and its bulk endpoints on an open device
+static bool find_vendor_interface(libusb_device* dev, int* iface, uint8_t* ep_out, uint8_t* ep_in) {
+    libusb_config_descriptor* config;
+    if (libusb_get_active_config_descriptor(dev, &config) != 0) return false;
+
+    bool found = false;
+    for (int i = 0; i < config->bNumInterfaces && !found; i++) {
+        const libusb_interface_descriptor* alt = &config->interface[i].altsetting[0];
+        if (alt->bInterfaceClass != LIBUSB_CLASS_VENDOR_SPEC) continue;
+
+        *ep_out = *ep_in = 0;
+        for (int e = 0; e < alt->bNumEndpoints; e++) {
+            const libusb_endpoint_descriptor* ep = &alt->endpoint[e];
+            if ((ep->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) != LIBUSB_TRANSFER_TYPE_BULK) continue;
+            if (ep->bEndpointAddress & LIBUSB_ENDPOINT_IN) *ep_in = ep->bEndpointAddress;
+            else *ep_out = ep->bEndpointAddress;
+        }
+        if (*ep_out && *ep_in) {
+            *iface = alt->bInterfaceNumber;
+            found = true;
+        }
+    }
+    libusb_free_config_descriptor(config);
+    return found;
+}
+
+bool UsbLink::open(uint16_t vid, uint16_t pid, const std::string& serial) {
+    close();
+    if (libusb_init(&ctx_) != 0) {
+        ctx_ = nullptr;
+        return false;
+    }
+
+    libusb_device** list;
+    ssize_t count = libusb_get_device_list(ctx_, &list);
+    for (ssize_t i = 0; i < count && !handle_; i++) {
+        libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) != 0) continue;
+        if (desc.idVendor != vid || desc.idProduct != pid) continue;
+        if (!find_vendor_interface(list[i], &interface_, &ep_out_, &ep_in_)) continue;
+
+        libusb_device_handle* handle;
+        if (libusb_open(list[i], &handle) != 0) continue;
+
+        if (!serial.empty()) {
+            unsigned char buf[64];
+            int n = libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, buf, sizeof(buf));
+            if (n < 0 || serial != std::string((const char*)buf, n)) {
+                libusb_close(handle);
+                continue;
+            }
+        }
+        if (libusb_claim_interface(handle, interface_) != 0) {
+            libusb_close(handle);
+            continue;
+        }
+        handle_ = handle;
+    }
+    if (count >= 0) libusb_free_device_list(list, 1);
+
+    if (!handle_) close();
+    return handle_ != nullptr;
+}
+
+void UsbLink::close() {
+    if (handle_) {
+        libusb_release_interface(handle_, interface_);
+        libusb_close(handle_);
+        handle_ = nullptr;
+    }
+    if (ctx_) {
+        libusb_exit(ctx_);
+        ctx_ = nullptr;
+    }
+}
+
+bool UsbLink::write(const uint8_t* data, size_t len) {
+    while (handle_ && len > 0) {
+        int sent = 0;
+        int ret = libusb_bulk_transfer(handle_, ep_out_, const_cast<uint8_t*>(data), (int)len, &sent, USB_TIMEOUT_MS);
+        if (ret != 0 && ret != LIBUSB_ERROR_TIMEOUT) return false;
+        if (ret == LIBUSB_ERROR_TIMEOUT && sent == 0) return false;  // Device stopped draining
+        data += sent;
+        len -= sent;
+    }
+    return len == 0;
+}
+
+int UsbLink::read(uint8_t* buf, size_t len, int timeout_ms) {
+    if (!handle_) return -1;
+    int got = 0;
+    int ret = libusb_bulk_transfer(handle_, ep_in_, buf, (int)len, &got, timeout_ms);
+    if (ret != 0 && ret != LIBUSB_ERROR_TIMEOUT) return -1;
+    return got;
+}
+
+} // namespace hid_display
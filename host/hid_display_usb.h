@@ -0,0 +1,48 @@
+#ifndef HID_DISPLAY_USB_H
+#define HID_DISPLAY_USB_H
+
+// libusb transport for firmware built with ENABLE_VENDOR_INTERFACE: the same
+// command stream as the CDC port, sent over the vendor bulk interface without
+// the tty layer. Pass writer() to Client::attach().
+
+#include "hid_display.h"
+
+struct libusb_context;
+struct libusb_device_handle;
+
+namespace hid_display {
+
+constexpr uint16_t USB_VID = 0x1209;
+constexpr uint16_t USB_PID = 0x0001;
+
+class UsbLink {
+public:
+    UsbLink() = default;
+    ~UsbLink();
+
+    UsbLink(const UsbLink&) = delete;
+    UsbLink& operator=(const UsbLink&) = delete;
+
+    // Claim the vendor interface of the first matching device (or the one
+    // with the given USB serial number)
+    bool open(uint16_t vid = USB_VID, uint16_t pid = USB_PID, const std::string& serial = "");
+    void close();
+
+    bool write(const uint8_t* data, size_t len);             // Bulk OUT
+    int read(uint8_t* buf, size_t len, int timeout_ms);      // Bulk IN: bytes, or -1
+
+    Client::WriteFn writer() {
+        return [this](const uint8_t* data, size_t len) { return write(data, len); };
+    }
+
+private:
+    libusb_context* ctx_ = nullptr;
+    libusb_device_handle* handle_ = nullptr;
+    int interface_ = -1;
+    uint8_t ep_out_ = 0;
+    uint8_t ep_in_ = 0;
+};
+
+} // namespace hid_display
+
+#endif // HID_DISPLAY_USB_H
@@ -0,0 +1,236 @@
+#include "hid_display.h"
+#include "test.h"
+
+#include <algorithm>
+#include <mutex>
+
+// Client's byte stream as the device would receive it, in plain and in
+// CMD_PACKET mode
+
+using namespace hid_display;
+
+typedef std::vector<uint8_t> bytes_t;
+
+// Records every write() the client makes
+struct Recorder {
+    std::mutex mutex;
+    std::vector<bytes_t> writes;
+
+    Client::WriteFn sink() {
+        return [this](const uint8_t* data, size_t len) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writes.emplace_back(data, data + len);
+            return true;
+        };
+    }
+
+    bytes_t all() {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_t out;
+        for (const bytes_t& w : writes) out.insert(out.end(), w.begin(), w.end());
+        return out;
+    }
+};
+
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Payload of a packet, after checking its framing
+static bytes_t unpack(const bytes_t& p) {
+    CHECK(p.size() >= 6);
+    CHECK_EQ(p[0], 0xA5);
+    size_t len = p[1] | (p[2] << 8);
+    CHECK_EQ(p[3], (uint8_t)(p[1] ^ p[2] ^ 0xFF));
+    CHECK_EQ(p.size(), 4 + len + 2);
+    CHECK(len <= MAX_PACKET_PAYLOAD);
+    CHECK_EQ(crc16(&p[1], 3 + len), (uint16_t)(p[4 + len] | (p[5 + len] << 8)));
+    return bytes_t(p.begin() + 4, p.end() - 2);
+}
+
+static Graphics many_rects(int count) {
+    Graphics g;
+    for (int i = 0; i < count; i++) g.rect(i % 100, i % 50, 10, 10);
+    return g;
+}
+
+TEST(client_packet_mode_switch) {
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+
+    // On: sent plain, the device is not in packet mode yet
+    CHECK(client.set_packet_mode(true));
+    CHECK_EQ(r.writes.size(), 1u);
+    CHECK_EQ(r.writes[0], (bytes_t{CMD_PACKET, 1}));
+
+    // Off: sent as a packet, and later writes are plain again
+    CHECK(client.set_packet_mode(false));
+    CHECK_EQ(r.writes.size(), 2u);
+    CHECK_EQ(unpack(r.writes[1]), (bytes_t{CMD_PACKET, 0}));
+    CHECK(client.graph_sample(1, 50));
+    CHECK_EQ(r.writes[2], (bytes_t{CMD_GRAPH, 0x01, 1, 50}));
+}
+
+TEST(client_packet_payload_matches_plain_stream) {
+    Frame frame;
+    frame.text(0, 0, "Hello");
+    frame.text(2, 3, "packet mode");
+    frame.progress(4, 48, 120, 8, 30);
+
+    Recorder plain;
+    Client a;
+    a.attach(plain.sink());
+    CHECK(a.draw(frame));
+    CHECK(a.draw_graphics(many_rects(3)));
+
+    Recorder framed;
+    Client b;
+    b.attach(framed.sink());
+    CHECK(b.set_packet_mode(true));
+    CHECK(b.draw(frame));
+    CHECK(b.draw_graphics(many_rects(3)));
+
+    // One packet per write, carrying exactly the plain bytes
+    CHECK_EQ(framed.writes.size(), 1 + plain.writes.size());
+    for (size_t i = 0; i < plain.writes.size(); i++) {
+        CHECK_EQ(unpack(framed.writes[i + 1]), plain.writes[i]);
+    }
+}
+
+TEST(client_packet_splits_at_command_boundaries) {
+    // 200 rectangles of 7 bytes: more than one packet holds
+    Graphics g = many_rects(200);
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+    CHECK(client.set_packet_mode(true));
+    CHECK(client.draw_graphics(g));
+
+    CHECK_EQ(r.writes.size(), 3u);
+    bytes_t first = unpack(r.writes[1]);
+    bytes_t second = unpack(r.writes[2]);
+    // As many whole 7-byte commands as fit
+    CHECK_EQ(first.size(), MAX_PACKET_PAYLOAD / 7 * 7);
+    CHECK_EQ(second.size(), g.bytes().size() - first.size());
+    bytes_t joined = first;
+    joined.insert(joined.end(), second.begin(), second.end());
+    CHECK_EQ(joined, g.bytes());
+}
+
+TEST(client_packet_full_frame_on_other_display) {
+    // Display switch plus a full-screen CMD_FRAME is 2 bytes over the limit:
+    // the switch goes in a packet of its own
+    std::vector<uint8_t> pixels(1024);
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = i * 37;
+
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+    CHECK(client.set_packet_mode(true));
+    CHECK(client.draw_pages(pixels.data(), 0, 8, 1));
+
+    CHECK_EQ(r.writes.size(), 3u);
+    CHECK_EQ(unpack(r.writes[1]), (bytes_t{CMD_SELECT_DISPLAY, 1}));
+    bytes_t frame = unpack(r.writes[2]);
+    CHECK_EQ(frame.size(), MAX_PACKET_PAYLOAD);
+    CHECK_EQ(bytes_t(frame.begin(), frame.begin() + 3), (bytes_t{CMD_FRAME, 0, 8}));
+    CHECK_EQ(bytes_t(frame.begin() + 3, frame.end()), pixels);
+}
+
+TEST(client_packet_menu_items_not_split) {
+    // Items of varying length: every packet must end on an item boundary
+    std::vector<MenuItem> items;
+    for (int i = 1; i <= 200; i++) {
+        items.push_back({ (uint8_t)i, 0, MenuItem::Action, std::string(1 + i % 15, 'a' + i % 26) });
+    }
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+    CHECK(client.set_packet_mode(true));
+    CHECK(client.menu_upload(items));
+    CHECK(r.writes.size() > 2);
+
+    for (size_t w = 1; w < r.writes.size(); w++) {
+        bytes_t payload = unpack(r.writes[w]);
+        // Walk the payload as the firmware frames it: it must end exactly
+        size_t pos = 0;
+        while (pos < payload.size()) {
+            CHECK_EQ(payload[pos], CMD_MENU);
+            uint8_t op = payload[pos + 1];
+            pos += op == 0x01 ? 7 + payload[pos + 6] : op == 0x02 ? 3 : 2;
+        }
+        CHECK_EQ(pos, payload.size());
+    }
+}
+
+TEST(client_frame_in_one_write) {
+    Frame frame;
+    for (int row = 0; row < DEFAULT_ROWS; row++) frame.text(0, row, "row " + std::to_string(row));
+
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+    CHECK(client.draw(frame));
+    CHECK_EQ(r.writes.size(), 1u);
+    Encoder e;
+    bytes_t expected;
+    e.encode(frame, expected);
+    CHECK_EQ(r.writes[0], expected);
+
+    // Nothing changed: no write at all
+    CHECK(client.draw(frame));
+    CHECK_EQ(r.writes.size(), 1u);
+    CHECK_EQ(client.stats().writes, 1u);
+    CHECK_EQ(client.stats().bytes_written, expected.size());
+}
+
+TEST(client_display_switch_in_same_write) {
+    Frame frame;
+    frame.text(0, 0, "two");
+
+    Recorder r;
+    Client client;
+    client.attach(r.sink());
+    CHECK(client.draw(frame, 1));
+    CHECK(client.draw(frame, 0));
+    CHECK_EQ(r.writes.size(), 2u);
+    CHECK_EQ(bytes_t(r.writes[0].begin(), r.writes[0].begin() + 3), (bytes_t{CMD_SELECT_DISPLAY, 1, CMD_CLEAR}));
+    CHECK_EQ(bytes_t(r.writes[1].begin(), r.writes[1].begin() + 3), (bytes_t{CMD_SELECT_DISPLAY, 0, CMD_CLEAR}));
+}
+
+TEST(client_submit_coalesces) {
+    // Writes block until released, so later frames pile up behind the first
+    std::mutex gate;
+    gate.lock();
+    Recorder r;
+    Client client;
+    Client::WriteFn record = r.sink();
+    client.attach([&](const uint8_t* data, size_t len) {
+        std::lock_guard<std::mutex> wait(gate);
+        return record(data, len);
+    });
+
+    Frame frame;
+    for (int i = 0; i < 10; i++) {
+        frame.text(0, 0, "frame " + std::to_string(i));
+        client.submit(frame);
+    }
+    gate.unlock();
+    CHECK(client.flush());
+
+    // The newest frame always arrives, most of the others were replaced
+    Stats stats = client.stats();
+    CHECK_EQ(stats.frames_submitted, 10u);
+    CHECK_EQ(stats.frames_sent + stats.frames_coalesced, 10u);
+    CHECK(stats.frames_coalesced >= 8);
+    const bytes_t& last = r.writes.back();
+    CHECK(std::find(last.begin(), last.end(), '9') != last.end());
+}
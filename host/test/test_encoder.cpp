@@ -0,0 +1,155 @@
+#include "hid_display.h"
+#include "test.h"
+
+// Encoder: full redraw vs delta, run merging, progress bars and panel state
+
+using namespace hid_display;
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t encode(Encoder& e, const Frame& f) {
+    bytes_t out;
+    e.encode(f, out);
+    return out;
+}
+
+static bytes_t text(uint8_t col, uint8_t row, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, (uint8_t)(col * GLYPH_SIZE), (uint8_t)(row * GLYPH_SIZE), (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static bytes_t cat(std::initializer_list<bytes_t> parts) {
+    bytes_t out;
+    for (const bytes_t& p : parts) out.insert(out.end(), p.begin(), p.end());
+    return out;
+}
+
+TEST(encoder_first_frame_is_full) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, "CPU");
+    f.text(4, 2, "42%");
+    CHECK_EQ(encode(e, f), cat({{CMD_CLEAR}, text(0, 0, "CPU"), text(4, 2, "42%"),
+                                {CMD_INVERT, 0}, {CMD_POWER, 1}}));
+}
+
+TEST(encoder_unchanged_frame_is_empty) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, "Hello");
+    f.progress(0, 56, 128, 8, 10);
+    encode(e, f);
+    CHECK(encode(e, f).empty());
+}
+
+TEST(encoder_delta_redraws_changed_run) {
+    Encoder e;
+    Frame f;
+    f.text(0, 3, "CPU 42%");
+    encode(e, f);
+    f.text(0, 3, "CPU 43%");
+    CHECK_EQ(encode(e, f), text(5, 3, "3"));
+}
+
+TEST(encoder_delta_merges_short_gaps) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, "abcdefghijklmnop");
+    encode(e, f);
+
+    // Changes 3 unchanged cells apart: one run is cheaper than two headers
+    Frame g = f;
+    g.text(2, 0, "X");
+    g.text(6, 0, "Y");
+    CHECK_EQ(encode(e, g), text(2, 0, "XdefY"));
+
+    // 4 apart: two runs
+    Frame h = g;
+    h.text(2, 0, "1");
+    h.text(7, 0, "2");
+    CHECK_EQ(encode(e, h), cat({text(2, 0, "1"), text(7, 0, "2")}));
+}
+
+TEST(encoder_clear_cheaper_than_delta) {
+    Encoder e;
+    Frame f;
+    for (int row = 0; row < DEFAULT_ROWS; row++) f.text(0, row, "0123456789abcdef");
+    encode(e, f);
+
+    // Blanking almost everything: a clear plus one short run beats 8
+    // rows of spaces
+    Frame g;
+    g.text(0, 0, "hi");
+    CHECK_EQ(encode(e, g), cat({{CMD_CLEAR}, text(0, 0, "hi")}));
+}
+
+TEST(encoder_bar_update_sends_only_bar) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, "Copy");
+    f.progress(4, 28, 120, 8, 10);
+    encode(e, f);
+    f.progress(4, 28, 120, 8, 60);
+    CHECK_EQ(encode(e, f), (bytes_t{CMD_PROGRESS_BAR, 4, 28, 120, 8, 60}));
+}
+
+TEST(encoder_bar_removed_or_moved_forces_full) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, "Copy");
+    f.progress(4, 28, 120, 8, 10);
+    encode(e, f);
+
+    // Removed: only a clear erases its pixels
+    Frame g;
+    g.text(0, 0, "Copy");
+    CHECK_EQ(encode(e, g), cat({{CMD_CLEAR}, text(0, 0, "Copy")}));
+
+    // Moved: same
+    encode(e, f);
+    Frame h;
+    h.text(0, 0, "Copy");
+    h.progress(4, 40, 120, 8, 10);
+    CHECK_EQ(encode(e, h), cat({{CMD_CLEAR}, text(0, 0, "Copy"), {CMD_PROGRESS_BAR, 4, 40, 120, 8, 10}}));
+}
+
+TEST(encoder_invalidate_forces_full) {
+    Encoder e;
+    Frame f;
+    f.text(1, 1, "x");
+    encode(e, f);
+    e.invalidate();
+    CHECK_EQ(encode(e, f), cat({{CMD_CLEAR}, text(1, 1, "x"), {CMD_INVERT, 0}, {CMD_POWER, 1}}));
+    CHECK(encode(e, f).empty());
+}
+
+TEST(encoder_panel_state_only_when_changed) {
+    Encoder e;
+    Frame f;
+    f.set_brightness(0x80);
+    encode(e, f);
+
+    f.set_invert(true);
+    CHECK_EQ(encode(e, f), (bytes_t{CMD_INVERT, 1}));
+
+    // Brightness left unset keeps the device's value, and is not resent
+    Frame g;
+    g.set_invert(true);
+    CHECK(encode(e, g).empty());
+    g.set_brightness(0x80);
+    CHECK(encode(e, g).empty());
+    g.set_brightness(0x20);
+    CHECK_EQ(encode(e, g), (bytes_t{CMD_BRIGHTNESS, 0x20}));
+
+    g.set_power(false);
+    CHECK_EQ(encode(e, g), (bytes_t{CMD_POWER, 0}));
+}
+
+TEST(encoder_control_characters_blanked) {
+    Encoder e;
+    Frame f;
+    f.text(0, 0, std::string("a\nb", 3));
+    CHECK_EQ(f.cell(1, 0), ' ');
+    CHECK_EQ(encode(e, f), cat({{CMD_CLEAR}, text(0, 0, "a b"), {CMD_INVERT, 0}, {CMD_POWER, 1}}));
+}
@@ -0,0 +1,193 @@
+#include "main.h"
+
+// Display-side animations run on a fixed frame tick, so transitions look the
+// same however busy the host is. Each slot holds one animation bound to the
+// display selected when it was started.
+//
+// Animations are driven by elapsed frames, not by frames executed: when the
+// bus is slow (the previous frame is still being flushed) or the main loop
+// was held up, frames are dropped and the next executed frame jumps straight
+// to the state it should show. A slow panel shows fewer steps, never a
+// growing backlog, and every animation still ends on time. A panel that
+// never catches up (host drawing faster than the bus drains) holds an
+// animation back for at most ANIM_MAX_WAIT_FRAMES ticks in a row.
+
+#define ANIM_MAX_WAIT_FRAMES 8
+
+typedef struct {
+    uint8_t type;           // ANIM_OP_* (ANIM_OP_STOP = free slot)
+    uint8_t display;
+    uint8_t x, y, w, h;     // Region (blink, slide)
+    int8_t dx;              // Slide step per frame
+    uint8_t period;         // Frames per half period (blink, invert pulse)
+    uint8_t from, to;       // Contrast ramp
+    uint32_t start;         // anim_frame when started
+    uint32_t frames;        // Length in frames (0 = until stopped)
+    uint32_t done;          // Frames applied so far
+    uint8_t waited;         // Ticks skipped in a row for a busy panel
+} anim_t;
+
+static anim_t anims[ANIM_SLOTS];
+
+static uint32_t anim_frame = 0;             // Frame counter, advances only while animating
+static absolute_time_t next_frame_time = {0};
+static bool running = false;
+
+// Invert and contrast act on the selected display: point them at a's
+static uint8_t select_display(const anim_t* a) {
+    uint8_t selected = ssd1306_selected();
+    ssd1306_select(a->display);
+    return selected;
+}
+
+// Number of half-period toggles reached after `frames` frames
+static inline uint32_t toggles(const anim_t* a, uint32_t frames) {
+    return frames / a->period;
+}
+
+// Apply an odd number of outstanding toggles as one (blink, invert pulse)
+static void toggle(anim_t* a) {
+    if (a->type == ANIM_OP_BLINK) {
+        gfx_invert_area(a->display, a->x, a->y, a->w, a->h);
+    } else {
+        uint8_t selected = select_display(a);
+        ssd1306_invert(!ssd1306_is_inverted());
+        ssd1306_select(selected);
+    }
+}
+
+// Bring a to the state of frame `target` in one step
+static void advance(anim_t* a, uint32_t target) {
+    switch (a->type) {
+        case ANIM_OP_BLINK:
+        case ANIM_OP_INVERT_PULSE:
+            if ((toggles(a, target) - toggles(a, a->done)) & 1) toggle(a);
+            break;
+
+        case ANIM_OP_SLIDE:
+            gfx_shift_area(a->display, a->x, a->y, a->w, a->h, a->dx * (int)(target - a->done));
+            break;
+
+        case ANIM_OP_CONTRAST:
+        {
+            uint8_t selected = select_display(a);
+            ssd1306_set_brightness((uint8_t)(a->from + ((int)a->to - a->from) * (int)target / (int)a->frames));
+            ssd1306_select(selected);
+            break;
+        }
+
+        default:
+            break;
+    }
+    a->done = target;
+}
+
+static anim_t* start(uint8_t slot, uint8_t type, uint32_t frames) {
+    if (slot >= ANIM_SLOTS) return NULL;
+    anim_stop(slot);
+    if (!running) {
+        running = true;
+        next_frame_time = make_timeout_time_us(ANIM_FRAME_US);
+    }
+
+    anim_t* a = &anims[slot];
+    memset(a, 0, sizeof(*a));
+    a->type = type;
+    a->display = ssd1306_selected();
+    a->start = anim_frame;
+    a->frames = frames;
+    return a;
+}
+
+// Stop slot (ANIM_SLOT_ALL: every slot). Blinks and invert pulses end in
+// their normal state; slides and contrast ramps stay where they are.
+void anim_stop(uint8_t slot) {
+    if (slot == ANIM_SLOT_ALL) {
+        for (uint8_t i = 0; i < ANIM_SLOTS; i++) anim_stop(i);
+        return;
+    }
+    if (slot >= ANIM_SLOTS) return;
+
+    anim_t* a = &anims[slot];
+    if ((a->type == ANIM_OP_BLINK || a->type == ANIM_OP_INVERT_PULSE) && (toggles(a, a->done) & 1)) {
+        toggle(a);
+    }
+    a->type = ANIM_OP_STOP;
+}
+
+// Invert a region every `period` frames; count blinks (0 = until stopped)
+void anim_blink(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t period, uint8_t count) {
+    if (period == 0) return;
+    anim_t* a = start(slot, ANIM_OP_BLINK, (uint32_t)count * 2 * period);
+    if (!a) return;
+    a->x = x;
+    a->y = y;
+    a->w = w;
+    a->h = h;
+    a->period = period;
+}
+
+// Move a region dx pixels per frame for `frames` frames
+void anim_slide(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h, int8_t dx, uint8_t frames) {
+    if (frames == 0 || dx == 0) return;
+    anim_t* a = start(slot, ANIM_OP_SLIDE, frames);
+    if (!a) return;
+    a->x = x;
+    a->y = y;
+    a->w = w;
+    a->h = h;
+    a->dx = dx;
+}
+
+// Ramp the contrast linearly to target over `frames` frames (fade)
+void anim_contrast(uint8_t slot, uint8_t target, uint8_t frames) {
+    if (frames == 0) {
+        ssd1306_set_brightness(target);
+        return;
+    }
+    uint8_t from = ssd1306_get_brightness();
+    anim_t* a = start(slot, ANIM_OP_CONTRAST, frames);
+    if (!a) return;
+    a->from = from;
+    a->to = target;
+}
+
+// Toggle the whole panel's invert mode every `period` frames; count pulses
+// (0 = until stopped)
+void anim_invert_pulse(uint8_t slot, uint8_t period, uint8_t count) {
+    if (period == 0) return;
+    anim_t* a = start(slot, ANIM_OP_INVERT_PULSE, (uint32_t)count * 2 * period);
+    if (a) a->period = period;
+}
+
+// Main-loop hook: run at most one frame per ANIM_FRAME_US
+void anim_task() {
+    if (!running || !time_reached(next_frame_time)) return;
+
+    // Frames the loop missed are dropped, not replayed
+    int64_t late_us = absolute_time_diff_us(next_frame_time, get_absolute_time());
+    uint32_t elapsed = 1 + (uint32_t)(late_us / ANIM_FRAME_US);
+    anim_frame += elapsed;
+    next_frame_time = delayed_by_us(next_frame_time, (uint64_t)elapsed * ANIM_FRAME_US);
+
+    bool active = false;
+    for (uint8_t i = 0; i < ANIM_SLOTS; i++) {
+        anim_t* a = &anims[i];
+        if (a->type == ANIM_OP_STOP) continue;
+        active = true;
+
+        // Previous frame not on the panel yet: skip, catch up next frame
+        if (ssd1306_flush_pending(a->display) && a->waited < ANIM_MAX_WAIT_FRAMES) {
+            a->waited++;
+            continue;
+        }
+        a->waited = 0;
+
+        uint32_t target = anim_frame - a->start;
+        bool finished = a->frames != 0 && target >= a->frames;
+        if (finished) target = a->frames;
+        if (target != a->done) advance(a, target);
+        if (finished) a->type = ANIM_OP_STOP;
+    }
+    running = active;
+}
@@ -0,0 +1,93 @@
+#include "main.h"
+
+// Framebuffer capture (CMD_CAPTURE): the selected display's framebuffer is
+// snapshotted and encoded into one complete reply when the command arrives,
+// then main.cpp hands it to the TX FIFO as space frees up. A remote
+// screenshot never holds up input handling, and the picture cannot tear
+// while it is being sent.
+//
+// The pixels are the framebuffer as the firmware sends it to the panel:
+// page format, rotated by 180 degrees in portrait (see CAPTURE_FLAG_PORTRAIT).
+
+#define CAPTURE_FB_SIZE (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+
+// Reply header + worst-case PackBits (one control byte per 128 literals)
+#define CAPTURE_REPLY_MAX (3 + CAPTURE_HEADER_LEN + CAPTURE_FB_SIZE + (CAPTURE_FB_SIZE + 127) / 128)
+
+static uint8_t reply[CAPTURE_REPLY_MAX];
+static uint32_t reply_len = 0;
+static uint32_t reply_sent = 0;
+
+// PackBits: control n < 0x80 is followed by n + 1 literal bytes, n > 0x80 by
+// one byte repeated 257 - n times. Runs shorter than 3 stay literal, so the
+// output is never longer than len + len / 128 (rounded up).
+static uint32_t packbits(const uint8_t* in, uint32_t len, uint8_t* out) {
+    uint32_t o = 0;
+    uint32_t i = 0;
+    while (i < len) {
+        uint32_t run = 1;
+        while (i + run < len && run < 128 && in[i + run] == in[i]) run++;
+        if (run >= 3) {
+            out[o++] = (uint8_t)(257 - run);
+            out[o++] = in[i];
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next run of 3 or 128 bytes
+        uint32_t start = i;
+        uint32_t n = 0;
+        while (i < len && n < 128) {
+            if (i + 2 < len && in[i] == in[i + 1] && in[i] == in[i + 2]) break;
+            i++;
+            n++;
+        }
+        out[o++] = (uint8_t)(n - 1);
+        memcpy(&out[o], &in[start], n);
+        o += n;
+    }
+    return o;
+}
+
+// Snapshot the selected display and build the reply
+// (replaces a capture not sent yet; main.cpp drains that first)
+void capture_start(uint8_t flags) {
+    const uint8_t* fb = ssd1306_get_buffer();
+    uint8_t* data = &reply[3 + CAPTURE_HEADER_LEN];
+    uint8_t encoding = CAPTURE_ENC_RAW;
+    uint32_t size = CAPTURE_FB_SIZE;
+
+    if (flags & CAPTURE_FLAG_RLE) {
+        uint32_t packed = packbits(fb, CAPTURE_FB_SIZE, data);
+        // Busy screens don't compress: fall back to raw
+        if (packed < CAPTURE_FB_SIZE) {
+            encoding = CAPTURE_ENC_PACKBITS;
+            size = packed;
+        }
+    }
+    if (encoding == CAPTURE_ENC_RAW) memcpy(data, fb, CAPTURE_FB_SIZE);
+
+    uint32_t payload = CAPTURE_HEADER_LEN + size;
+    reply[0] = CMD_CAPTURE;
+    reply[1] = payload & 0xFF;
+    reply[2] = payload >> 8;
+    reply[3] = encoding;
+    reply[4] = ssd1306_selected();
+    reply[5] = SSD1306_WIDTH;
+    reply[6] = SSD1306_HEIGHT;
+    reply[7] = g_portrait ? CAPTURE_FLAG_PORTRAIT : 0;
+    reply_len = 3 + payload;
+    reply_sent = 0;
+}
+
+// Bytes of the reply still to be sent (0 = none pending)
+uint32_t capture_pending(const uint8_t** data) {
+    *data = &reply[reply_sent];
+    return reply_len - reply_sent;
+}
+
+// n more bytes were accepted by the TX FIFO
+void capture_advance(uint32_t n) {
+    reply_sent += n;
+    if (reply_sent > reply_len) reply_sent = reply_len;
+}
@@ -0,0 +1,327 @@
+#include "main.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+// Persistent key/value configuration, boot splash and macros in the last flash
+// sectors.
+//
+// The store is a log of full snapshots: every commit programs the next free
+// 256-byte flash page with the whole key/value image, a sequence number and a
+// CRC. At boot the valid page with the highest sequence number wins, so a
+// page torn by power loss is simply ignored and the previous snapshot is used.
+// Pages are used round-robin across CONFIG_SECTORS sectors; a sector is only
+// erased when the log wraps into it, which spreads erase cycles evenly and
+// never touches the sector holding the newest snapshot.
+
+#define CONFIG_SECTORS          2
+#define CONFIG_REGION_SIZE      (CONFIG_SECTORS * FLASH_SECTOR_SIZE)
+#define CONFIG_REGION_OFFSET    (PICO_FLASH_SIZE_BYTES - CONFIG_REGION_SIZE)
+#define CONFIG_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define CONFIG_TOTAL_PAGES      (CONFIG_SECTORS * CONFIG_PAGES_PER_SECTOR)
+
+#define CONFIG_MAGIC            0x47464348u // "HCFG"
+#define CONFIG_HEADER_SIZE      12
+#define CONFIG_DATA_SIZE        (FLASH_PAGE_SIZE - CONFIG_HEADER_SIZE)
+
+// Splash image lives in the sector just below the config log
+#define SPLASH_OFFSET           (CONFIG_REGION_OFFSET - FLASH_SECTOR_SIZE)
+#define SPLASH_MAGIC            0x4853504Cu // "LPSH"
+
+// Macros (CMD_MACRO save) live in the sector below the splash, same format
+#define MACRO_OFFSET            (SPLASH_OFFSET - FLASH_SECTOR_SIZE)
+#define MACRO_MAGIC             0x524D4348u // "HCMR"
+
+// Splash and macros are stored as one blob per sector: header + image,
+// programmed in whole pages
+#define BLOB_HEADER_SIZE        8
+#define BLOB_PROGRAM_SIZE(len)  ((BLOB_HEADER_SIZE + (len) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE)
+
+// Batch writes: commit only after settings have been quiet for this long
+#define CONFIG_COMMIT_DELAY_US  1000000 // 1s
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                      // Monotonic commit counter, highest valid wins
+    uint16_t length;                   // Bytes used in data[]
+    uint16_t crc;                      // CRC-16 over seq, length and data[0..length)
+    uint8_t data[CONFIG_DATA_SIZE];    // [key][len][value...] entries
+} config_page_t;
+
+static_assert(sizeof(config_page_t) == FLASH_PAGE_SIZE, "config page must fill one flash page");
+
+// RAM image of the current configuration (entries only)
+static uint8_t config_data[CONFIG_DATA_SIZE];
+static uint16_t config_len = 0;
+
+// Log position and deferred-commit state
+static int32_t config_slot = -1;     // Page holding the newest snapshot (-1 = none)
+static uint32_t config_seq = 0;
+static bool config_dirty = false;
+static absolute_time_t config_dirty_time = {0};
+
+// Flash access shim: everything below reads flash through flash_ptr() and
+// changes it only through flash_erase_sector() / flash_program(), which run
+// with interrupts off (XIP is unavailable meanwhile)
+static const uint8_t* flash_ptr(uint32_t offset) {
+    return (const uint8_t*)(XIP_BASE + offset);
+}
+
+static void flash_erase_sector(uint32_t offset) {
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    restore_interrupts(ints);
+}
+
+static void flash_program(uint32_t offset, const uint8_t* data, size_t len) {
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_program(offset, data, len);
+    restore_interrupts(ints);
+}
+
+static uint16_t config_page_crc(const config_page_t* page) {
+    uint16_t crc = crc16_update(0xFFFF, (const uint8_t*)&page->seq, sizeof(page->seq));
+    crc = crc16_update(crc, (const uint8_t*)&page->length, sizeof(page->length));
+    return crc16_update(crc, page->data, page->length);
+}
+
+static const config_page_t* config_page_ptr(uint32_t slot) {
+    return (const config_page_t*)flash_ptr(CONFIG_REGION_OFFSET + slot * FLASH_PAGE_SIZE);
+}
+
+static bool config_page_valid(const config_page_t* page) {
+    return page->magic == CONFIG_MAGIC &&
+           page->length <= CONFIG_DATA_SIZE &&
+           page->crc == config_page_crc(page);
+}
+
+static bool config_page_blank(const config_page_t* page) {
+    const uint32_t* words = (const uint32_t*)page;
+    for (size_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (words[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+// Find the entry for key; returns offset of its key byte or -1
+static int config_find(uint8_t key) {
+    uint16_t pos = 0;
+    while (pos + 2 <= config_len) {
+        uint8_t entry_len = config_data[pos + 1];
+        if (pos + 2 + entry_len > config_len) break; // Truncated entry, ignore the rest
+        if (config_data[pos] == key) return pos;
+        pos += 2 + entry_len;
+    }
+    return -1;
+}
+
+// Load the newest valid snapshot from flash (call once at boot)
+void config_init() {
+    config_slot = -1;
+    config_seq = 0;
+    config_len = 0;
+    config_dirty = false;
+
+    for (uint32_t slot = 0; slot < CONFIG_TOTAL_PAGES; slot++) {
+        const config_page_t* page = config_page_ptr(slot);
+        if (!config_page_valid(page)) continue;
+        // Signed difference keeps ordering correct across seq wraparound
+        if (config_slot < 0 || (int32_t)(page->seq - config_seq) > 0) {
+            config_slot = slot;
+            config_seq = page->seq;
+        }
+    }
+
+    if (config_slot >= 0) {
+        const config_page_t* page = config_page_ptr(config_slot);
+        config_len = page->length;
+        memcpy(config_data, page->data, config_len);
+    }
+}
+
+// Copy the value for key into buf; returns value length or -1 if absent
+int config_get(uint8_t key, uint8_t* buf, uint8_t max_len) {
+    int pos = config_find(key);
+    if (pos < 0) return -1;
+    uint8_t len = config_data[pos + 1];
+    if (len > max_len) len = max_len;
+    memcpy(buf, &config_data[pos + 2], len);
+    return len;
+}
+
+uint8_t config_get_u8(uint8_t key, uint8_t fallback) {
+    uint8_t value;
+    return config_get(key, &value, 1) == 1 ? value : fallback;
+}
+
+// Set key in RAM and schedule a deferred commit; returns false if full
+bool config_set(uint8_t key, const uint8_t* value, uint8_t len) {
+    int pos = config_find(key);
+    if (pos >= 0) {
+        uint8_t old_len = config_data[pos + 1];
+        if (old_len == len && memcmp(&config_data[pos + 2], value, len) == 0) {
+            return true; // Unchanged, avoid a flash write
+        }
+        // Remove old entry, then append the new one
+        uint16_t entry_end = pos + 2 + old_len;
+        memmove(&config_data[pos], &config_data[entry_end], config_len - entry_end);
+        config_len -= 2 + old_len;
+    }
+    if ((uint32_t)config_len + 2 + len > CONFIG_DATA_SIZE) return false;
+
+    config_data[config_len++] = key;
+    config_data[config_len++] = len;
+    memcpy(&config_data[config_len], value, len);
+    config_len += len;
+
+    config_dirty = true;
+    config_dirty_time = get_absolute_time();
+    return true;
+}
+
+// Drop all keys (defaults apply from next boot)
+void config_reset() {
+    config_len = 0;
+    config_dirty = true;
+    config_dirty_time = get_absolute_time();
+}
+
+// Program the RAM image into the next free page of the log
+static void config_commit() {
+    static config_page_t page; // Static: keep 256 bytes off the stack
+
+    memset(&page, 0xFF, sizeof(page));
+    page.magic = CONFIG_MAGIC;
+    page.seq = config_seq + 1;
+    page.length = config_len;
+    memcpy(page.data, config_data, config_len);
+    page.crc = config_page_crc(&page);
+
+    // Skip pages left partially programmed by an interrupted write; a fresh
+    // sector is erased first (never the one holding the current snapshot)
+    uint32_t slot = (uint32_t)(config_slot + 1) % CONFIG_TOTAL_PAGES;
+    while (slot % CONFIG_PAGES_PER_SECTOR != 0 && !config_page_blank(config_page_ptr(slot))) {
+        slot = (slot + 1) % CONFIG_TOTAL_PAGES;
+    }
+
+    uint32_t offset = CONFIG_REGION_OFFSET + slot * FLASH_PAGE_SIZE;
+    if (slot % CONFIG_PAGES_PER_SECTOR == 0) {
+        flash_erase_sector(offset);
+    }
+    flash_program(offset, (const uint8_t*)&page, FLASH_PAGE_SIZE);
+
+    config_slot = slot;
+    config_seq = page.seq;
+}
+
+// Blob header: magic, image length, CRC-16 over the image
+typedef struct {
+    uint32_t magic;
+    uint16_t length;
+    uint16_t crc;
+} blob_header_t;
+
+static_assert(sizeof(blob_header_t) == BLOB_HEADER_SIZE, "blob header layout");
+
+// A blob sector and its save or erase waiting for config_task(). The image is
+// staged when the host asks, so later drawing or recording does not leak into
+// it, and the sector is written once requests have been quiet for the commit
+// delay: the erase runs with interrupts off for tens of ms and would otherwise
+// stall USB in the middle of the host's traffic.
+typedef struct {
+    uint32_t offset;
+    uint32_t magic;
+    uint8_t* buf;            // Staging: header + image, padded with 0xFF to whole pages
+    size_t size;
+    size_t program_len;      // Bytes of buf to program (0 = erase only)
+    bool pending;
+    absolute_time_t time;    // When the latest request came in
+} blob_t;
+
+static uint8_t splash_buf[BLOB_PROGRAM_SIZE(SSD1306_BUFFER_SIZE)];
+static uint8_t macro_buf[BLOB_PROGRAM_SIZE(MACRO_STORE_SIZE)];
+
+static_assert(sizeof(splash_buf) <= FLASH_SECTOR_SIZE, "splash blob must fit its sector");
+static_assert(sizeof(macro_buf) <= FLASH_SECTOR_SIZE, "macro blob must fit its sector");
+
+static blob_t splash = { SPLASH_OFFSET, SPLASH_MAGIC, splash_buf, sizeof(splash_buf), 0, false, {0} };
+static blob_t macros = { MACRO_OFFSET, MACRO_MAGIC, macro_buf, sizeof(macro_buf), 0, false, {0} };
+
+// Copy the blob into image (the staged one while a write is pending); false
+// if none or wrong size
+static bool blob_load(const blob_t* b, uint8_t* image, size_t len) {
+    if (b->pending && b->program_len == 0) return false;
+    const uint8_t* base = b->pending ? b->buf : flash_ptr(b->offset);
+    const blob_header_t* header = (const blob_header_t*)base;
+    const uint8_t* data = base + BLOB_HEADER_SIZE;
+
+    if (header->magic != b->magic || header->length != len) return false;
+    if (header->crc != crc16_update(0xFFFF, data, len)) return false;
+    memcpy(image, data, len);
+    return true;
+}
+
+// Stage a new image for the blob; false if it does not fit
+static bool blob_save(blob_t* b, const uint8_t* image, size_t len) {
+    if (BLOB_PROGRAM_SIZE(len) > b->size) return false;
+
+    blob_header_t header = { b->magic, (uint16_t)len, crc16_update(0xFFFF, image, len) };
+    b->program_len = BLOB_PROGRAM_SIZE(len);
+    memset(b->buf, 0xFF, b->program_len);
+    memcpy(b->buf, &header, BLOB_HEADER_SIZE);
+    memcpy(b->buf + BLOB_HEADER_SIZE, image, len);
+
+    b->pending = true;
+    b->time = get_absolute_time();
+    return true;
+}
+
+static void blob_erase(blob_t* b) {
+    b->program_len = 0;
+    b->pending = true;
+    b->time = get_absolute_time();
+}
+
+// Write a staged blob once its requests have been quiet for the commit delay
+static void blob_task(blob_t* b) {
+    if (!b->pending) return;
+    if (absolute_time_diff_us(b->time, get_absolute_time()) < CONFIG_COMMIT_DELAY_US) return;
+
+    flash_erase_sector(b->offset);
+    if (b->program_len) flash_program(b->offset, b->buf, b->program_len);
+    b->pending = false;
+}
+
+// Main-loop hook: commit batched changes once settings are quiet
+void config_task() {
+    blob_task(&splash);
+    blob_task(&macros);
+
+    if (!config_dirty) return;
+    if (absolute_time_diff_us(config_dirty_time, get_absolute_time()) < CONFIG_COMMIT_DELAY_US) return;
+
+    config_commit();
+    config_dirty = false;
+}
+
+// Copy the stored splash image into image; false if none or wrong size
+bool config_load_splash(uint8_t* image, size_t len) {
+    return blob_load(&splash, image, len);
+}
+
+// Store a splash image (staged; written to flash by config_task())
+bool config_save_splash(const uint8_t* image, size_t len) {
+    return blob_save(&splash, image, len);
+}
+
+void config_erase_splash() {
+    blob_erase(&splash);
+}
+
+// Macro store image (macro.cpp); same format as the splash
+bool config_load_macros(uint8_t* image, size_t len) {
+    return blob_load(&macros, image, len);
+}
+
+bool config_save_macros(const uint8_t* image, size_t len) {
+    return blob_save(&macros, image, len);
+}
@@ -0,0 +1,30 @@
+#include "main.h"
+
+// CRC-16/CCITT-FALSE, one table lookup per byte. Used for the flash config
+// pages and blobs and for CMD_PACKET frames, where it runs on every byte the
+// host sends.
+
+typedef struct {
+    uint16_t entry[256];
+} crc16_table_t;
+
+static constexpr crc16_table_t make_crc16_table() {
+    crc16_table_t table = {};
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+        table.entry[i] = crc;
+    }
+    return table;
+}
+
+static constexpr crc16_table_t crc16_table = make_crc16_table();
+
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc = (uint16_t)(crc << 8) ^ crc16_table.entry[(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
@@ -0,0 +1,39 @@
+#ifndef DISPLAY_CONFIG_H
+#define DISPLAY_CONFIG_H
+
+#include <stdint.h>
+
+// Compile-time display descriptor. CMake's DISPLAY_TYPE selects one
+// controller/geometry; framebuffer size, init table and flush strategy in
+// ssd1306.cpp are specialized from it, so there is no runtime dispatch.
+
+#define DISPLAY_SSD1306_128X64  1
+#define DISPLAY_SSD1306_128X32  2
+#define DISPLAY_SH1106_128X64   3
+
+#ifndef DISPLAY_CONTROLLER
+#define DISPLAY_CONTROLLER DISPLAY_SSD1306_128X64
+#endif
+
+typedef struct {
+    uint8_t width;          // Visible columns
+    uint8_t height;         // Visible rows (multiple of 8)
+    uint8_t col_offset;     // Controller RAM column of visible column 0
+    uint8_t com_pins;       // SET_COM_PINS value for the panel's COM wiring
+    bool page_addressing;   // No horizontal addressing mode: write page by page
+} display_desc_t;
+
+#if DISPLAY_CONTROLLER == DISPLAY_SSD1306_128X64
+constexpr display_desc_t DISPLAY_DESC = { 128, 64, 0, 0x12, false };
+#elif DISPLAY_CONTROLLER == DISPLAY_SSD1306_128X32
+constexpr display_desc_t DISPLAY_DESC = { 128, 32, 0, 0x02, false };
+#elif DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+// 132-column RAM with the 128 visible columns centred
+constexpr display_desc_t DISPLAY_DESC = { 128, 64, 2, 0x12, true };
+#else
+#error "Unknown DISPLAY_CONTROLLER"
+#endif
+
+static_assert(DISPLAY_DESC.height % 8 == 0, "display height must be whole pages");
+
+#endif // DISPLAY_CONFIG_H
@@ -0,0 +1,272 @@
+#include "main.h"
+
+// 1bpp graphics primitives drawing straight into the selected display's
+// framebuffer (page format: one byte = 8 vertical pixels, LSB on top).
+//
+// Coordinates are logical; in portrait mode each pixel is rotated 180° like
+// text. Every primitive is clipped to the clip rectangle, applies a draw mode
+// (set / clear / XOR) and marks only its bounding box dirty. Outlines never
+// touch a pixel twice, so XOR drawing is exactly reversible.
+
+// Clip rectangle, inclusive logical coordinates
+static int clip_x0 = 0;
+static int clip_y0 = 0;
+static int clip_x1 = SSD1306_WIDTH - 1;
+static int clip_y1 = SSD1306_HEIGHT - 1;
+
+// Display and framebuffer of the primitive being drawn
+static uint8_t fb_id;
+static uint8_t* fb;
+
+static inline void apply(uint8_t* p, uint8_t mask, uint8_t mode) {
+    switch (mode) {
+        case GFX_MODE_CLEAR: *p &= ~mask; break;
+        case GFX_MODE_XOR:   *p ^= mask;  break;
+        default:             *p |= mask;  break;
+    }
+}
+
+static inline void plot(int x, int y, uint8_t mode) {
+    if (x < clip_x0 || x > clip_x1 || y < clip_y0 || y > clip_y1) return;
+    if (g_portrait) {
+        x = SSD1306_WIDTH - 1 - x;
+        y = SSD1306_HEIGHT - 1 - y;
+    }
+    apply(&fb[(y >> 3) * SSD1306_WIDTH + x], (uint8_t)(1 << (y & 7)), mode);
+}
+
+// Clip a logical box to (cx0, cy0)-(cx1, cy1), map it to physical
+// coordinates and mark it dirty; false if nothing is left
+static bool clip_box_to(int* x0, int* y0, int* x1, int* y1, int cx0, int cy0, int cx1, int cy1) {
+    if (*x0 < cx0) *x0 = cx0;
+    if (*y0 < cy0) *y0 = cy0;
+    if (*x1 > cx1) *x1 = cx1;
+    if (*y1 > cy1) *y1 = cy1;
+    if (*x0 > *x1 || *y0 > *y1) return false;
+
+    if (g_portrait) {
+        int px0 = SSD1306_WIDTH - 1 - *x1;
+        int px1 = SSD1306_WIDTH - 1 - *x0;
+        int py0 = SSD1306_HEIGHT - 1 - *y1;
+        int py1 = SSD1306_HEIGHT - 1 - *y0;
+        *x0 = px0; *x1 = px1; *y0 = py0; *y1 = py1;
+    }
+    ssd1306_mark_dirty(fb_id, *y0 >> 3, *y1 >> 3, *x0, *x1);
+    return true;
+}
+
+static bool clip_box(int* x0, int* y0, int* x1, int* y1) {
+    return clip_box_to(x0, y0, x1, y1, clip_x0, clip_y0, clip_x1, clip_y1);
+}
+
+// Bits of a page covered by physical rows y0..y1 (which must overlap it)
+static inline uint8_t page_mask(int page, int y0, int y1) {
+    int top = page * 8 > y0 ? 0 : y0 & 7;
+    int bottom = page * 8 + 7 < y1 ? 7 : y1 & 7;
+    return (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+}
+
+// Start a primitive covering the logical box; false if it is fully clipped
+static bool begin(int x0, int y0, int x1, int y1) {
+    fb_id = ssd1306_selected();
+    fb = ssd1306_draw_buffer(fb_id);
+    return clip_box(&x0, &y0, &x1, &y1);
+}
+
+// Set the clip rectangle (w or h of 0 = whole screen)
+void gfx_set_clip(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) {
+        x = 0;
+        y = 0;
+        w = SSD1306_WIDTH;
+        h = SSD1306_HEIGHT;
+    }
+    clip_x0 = x < 0 ? 0 : x;
+    clip_y0 = y < 0 ? 0 : y;
+    clip_x1 = x + w - 1 < SSD1306_WIDTH ? x + w - 1 : SSD1306_WIDTH - 1;
+    clip_y1 = y + h - 1 < SSD1306_HEIGHT ? y + h - 1 : SSD1306_HEIGHT - 1;
+}
+
+void gfx_pixel(int x, int y, uint8_t mode) {
+    if (!begin(x, y, x, y)) return;
+    plot(x, y, mode);
+}
+
+// Filled rectangle: per page, one mask applied to a run of whole bytes
+void gfx_fill_rect(int x, int y, int w, int h, uint8_t mode) {
+    if (w <= 0 || h <= 0) return;
+    int x0 = x, y0 = y, x1 = x + w - 1, y1 = y + h - 1;
+    fb_id = ssd1306_selected();
+    fb = ssd1306_draw_buffer(fb_id);
+    if (!clip_box(&x0, &y0, &x1, &y1)) return;
+
+    // Physical box: the rotation keeps rectangles rectangles
+    for (int page = y0 >> 3; page <= y1 >> 3; page++) {
+        uint8_t mask = page_mask(page, y0, y1);
+        uint8_t* p = &fb[page * SSD1306_WIDTH + x0];
+        for (int col = x0; col <= x1; col++) apply(p++, mask, mode);
+    }
+}
+
+// Rectangle outline: top and bottom rows, then the sides between them
+void gfx_rect(int x, int y, int w, int h, uint8_t mode) {
+    if (w <= 0 || h <= 0) return;
+    gfx_fill_rect(x, y, w, 1, mode);
+    if (h > 1) gfx_fill_rect(x, y + h - 1, w, 1, mode);
+    if (h > 2) {
+        gfx_fill_rect(x, y + 1, 1, h - 2, mode);
+        if (w > 1) gfx_fill_rect(x + w - 1, y + 1, 1, h - 2, mode);
+    }
+}
+
+// Bresenham line; axis-aligned lines take the fill_rect fast path
+void gfx_line(int x0, int y0, int x1, int y1, uint8_t mode) {
+    if (x0 > x1 && (y0 == y1)) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1 && (x0 == x1)) { int t = y0; y0 = y1; y1 = t; }
+    if (y0 == y1) {
+        gfx_fill_rect(x0, y0, x1 - x0 + 1, 1, mode);
+        return;
+    }
+    if (x0 == x1) {
+        gfx_fill_rect(x0, y0, 1, y1 - y0 + 1, mode);
+        return;
+    }
+
+    if (!begin(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0)) return;
+
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0;  // Negative
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        plot(x0, y0, mode);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+// Midpoint circle outline; points shared between octants are plotted once
+void gfx_circle(int cx, int cy, int r, uint8_t mode) {
+    if (r < 0) return;
+    if (!begin(cx - r, cy - r, cx + r, cy + r)) return;
+    if (r == 0) {
+        plot(cx, cy, mode);
+        return;
+    }
+
+    int x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        // 8 symmetric points, collapsing duplicates on the axes and diagonals
+        plot(cx + x, cy + y, mode);
+        plot(cx - x, cy - y, mode);
+        if (y != 0) {
+            plot(cx + x, cy - y, mode);
+            plot(cx - x, cy + y, mode);
+        }
+        if (x != y) {
+            plot(cx + y, cy + x, mode);
+            plot(cx - y, cy - x, mode);
+            if (y != 0) {
+                plot(cx - y, cy + x, mode);
+                plot(cx + y, cy - x, mode);
+            }
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+// Filled circle: one horizontal span per row, as wide as the outline
+// gfx_circle() draws on that row, so a fill and an outline of the same radius
+// cover the same pixels
+void gfx_fill_circle(int cx, int cy, int r, uint8_t mode) {
+    static uint8_t half[256]; // Span half-width per row offset
+    if (r < 0 || r > 255) return;
+    memset(half, 0, r + 1);
+
+    int x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        if (x > half[y]) half[y] = x;
+        if (y > half[x]) half[x] = y;
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+
+    for (int dy = 0; dy <= r; dy++) {
+        gfx_fill_rect(cx - half[dy], cy + dy, 2 * half[dy] + 1, 1, mode);
+        if (dy != 0) gfx_fill_rect(cx - half[dy], cy - dy, 2 * half[dy] + 1, 1, mode);
+    }
+}
+
+// 1bpp bitmap, rows of (w + 7) / 8 bytes, MSB = leftmost pixel. Set bits are
+// drawn with mode; clear bits leave the framebuffer untouched.
+void gfx_bitmap(int x, int y, int w, int h, const uint8_t* rows, uint8_t mode) {
+    if (w <= 0 || h <= 0) return;
+    if (!begin(x, y, x + w - 1, y + h - 1)) return;
+
+    int stride = (w + 7) / 8;
+    for (int row = 0; row < h; row++) {
+        const uint8_t* src = rows + row * stride;
+        for (int col = 0; col < w; col++) {
+            if (src[col >> 3] & (0x80 >> (col & 7))) plot(x + col, y + row, mode);
+        }
+    }
+}
+
+// Region effects for animations (anim.cpp). They act on display id and
+// ignore the clip rectangle, which the host may change mid-animation.
+
+// Invert a logical region
+void gfx_invert_area(uint8_t id, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    int x0 = x, y0 = y, x1 = x + w - 1, y1 = y + h - 1;
+    fb_id = id;
+    fb = ssd1306_draw_buffer(id);
+    if (!clip_box_to(&x0, &y0, &x1, &y1, 0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1)) return;
+
+    for (int page = y0 >> 3; page <= y1 >> 3; page++) {
+        uint8_t mask = page_mask(page, y0, y1);
+        uint8_t* p = &fb[page * SSD1306_WIDTH + x0];
+        for (int col = x0; col <= x1; col++) *p++ ^= mask;
+    }
+}
+
+// Move the contents of a logical region dx pixels right (left if negative);
+// pixels shifted out are lost and the vacated columns are cleared
+void gfx_shift_area(uint8_t id, int x, int y, int w, int h, int dx) {
+    if (w <= 0 || h <= 0 || dx == 0) return;
+    int x0 = x, y0 = y, x1 = x + w - 1, y1 = y + h - 1;
+    fb_id = id;
+    fb = ssd1306_draw_buffer(id);
+    if (!clip_box_to(&x0, &y0, &x1, &y1, 0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1)) return;
+    if (g_portrait) dx = -dx;
+
+    for (int page = y0 >> 3; page <= y1 >> 3; page++) {
+        uint8_t mask = page_mask(page, y0, y1);
+        uint8_t* row = &fb[page * SSD1306_WIDTH];
+        if (dx > 0) {
+            for (int col = x1; col >= x0; col--) {
+                uint8_t src = col - dx >= x0 ? row[col - dx] : 0;
+                row[col] = (row[col] & ~mask) | (src & mask);
+            }
+        } else {
+            for (int col = x0; col <= x1; col++) {
+                uint8_t src = col - dx <= x1 ? row[col - dx] : 0;
+                row[col] = (row[col] & ~mask) | (src & mask);
+            }
+        }
+    }
+}
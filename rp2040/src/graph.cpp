@@ -0,0 +1,195 @@
+#include "main.h"
+
+// Sparkline graphs: the host sets up a region and scale once, then pushes one
+// sample at a time. Each sample scrolls the plot by one column in the
+// framebuffer (masked to the region's rows, so neighbouring content is kept)
+// and draws only the new column. Recent samples are kept in a ring buffer so
+// a rescale can redraw the whole plot.
+//
+// A graph stays on the display that was selected when it was set up.
+
+// A full-width line graph needs one sample more than it shows: the oldest
+// visible column connects to its predecessor
+#define GRAPH_HISTORY (SSD1306_WIDTH + 1)
+
+typedef struct {
+    bool active;
+    uint8_t display;
+    uint8_t x, y, w, h;                 // Logical region, clamped to the screen
+    uint8_t min, max;                   // Sample values mapped to bottom/top row
+    uint8_t flags;                      // GRAPH_FLAG_*
+    uint8_t samples[GRAPH_HISTORY];     // Ring buffer, newest at head - 1
+    uint8_t head;
+    uint8_t count;
+} graph_t;
+
+static graph_t graphs[GRAPH_COUNT];
+
+// Physical (rotated) region in framebuffer coordinates
+typedef struct {
+    int col0, col1;
+    int row0, row1;
+} graph_area_t;
+
+static graph_area_t graph_area(const graph_t* g) {
+    graph_area_t a = { g->x, g->x + g->w - 1, g->y, g->y + g->h - 1 };
+    if (g_portrait) {
+        a = { SSD1306_WIDTH - 1 - a.col1, SSD1306_WIDTH - 1 - a.col0,
+              SSD1306_HEIGHT - 1 - a.row1, SSD1306_HEIGHT - 1 - a.row0 };
+    }
+    return a;
+}
+
+// Bits of page covered by rows row0..row1 (0 if none)
+static uint8_t page_mask(int page, int row0, int row1) {
+    if (row1 < page * 8 || row0 > page * 8 + 7) return 0;
+    int top = row0 > page * 8 ? row0 & 7 : 0;
+    int bottom = row1 < page * 8 + 7 ? row1 & 7 : 7;
+    return (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+}
+
+// Logical row of value inside the region (bottom row = min)
+static int value_row(const graph_t* g, uint8_t value) {
+    if (value < g->min) value = g->min;
+    if (value > g->max) value = g->max;
+    return g->y + g->h - 1 - (value - g->min) * (g->h - 1) / (g->max - g->min);
+}
+
+// Redraw logical column x of g: clear it, then draw the sample's span. Line
+// graphs connect to the previous sample, filled graphs start at the bottom.
+static void draw_column(const graph_t* g, uint8_t* fb, int x, uint8_t value, int prev_row) {
+    int row = value_row(g, value);
+    int span0 = row, span1 = row;
+    if (g->flags & GRAPH_FLAG_FILL) {
+        span1 = g->y + g->h - 1;
+    } else if (prev_row >= 0) {
+        if (prev_row < span0) span0 = prev_row;
+        if (prev_row > span1) span1 = prev_row;
+    }
+
+    graph_area_t a = graph_area(g);
+    int col = x;
+    if (g_portrait) {
+        col = SSD1306_WIDTH - 1 - x;
+        int t = SSD1306_HEIGHT - 1 - span1;
+        span1 = SSD1306_HEIGHT - 1 - span0;
+        span0 = t;
+    }
+
+    for (int page = a.row0 >> 3; page <= a.row1 >> 3; page++) {
+        uint8_t* p = &fb[page * SSD1306_WIDTH + col];
+        *p = (*p & ~page_mask(page, a.row0, a.row1)) | page_mask(page, span0, span1);
+    }
+}
+
+// Move every column of the region one step towards the oldest sample
+static void scroll(const graph_t* g, uint8_t* fb) {
+    graph_area_t a = graph_area(g);
+    for (int page = a.row0 >> 3; page <= a.row1 >> 3; page++) {
+        uint8_t mask = page_mask(page, a.row0, a.row1);
+        uint8_t* row = &fb[page * SSD1306_WIDTH];
+        if (g_portrait) {
+            // Newest sample is on the left: shift right
+            for (int col = a.col1; col > a.col0; col--) {
+                row[col] = (row[col] & ~mask) | (row[col - 1] & mask);
+            }
+        } else {
+            for (int col = a.col0; col < a.col1; col++) {
+                row[col] = (row[col] & ~mask) | (row[col + 1] & mask);
+            }
+        }
+    }
+}
+
+static void mark_area_dirty(const graph_t* g) {
+    graph_area_t a = graph_area(g);
+    ssd1306_mark_dirty(g->display, a.row0 >> 3, a.row1 >> 3, a.col0, a.col1);
+}
+
+// Clear the region and draw the newest w samples right-aligned
+static void redraw(const graph_t* g) {
+    uint8_t* fb = ssd1306_draw_buffer(g->display);
+    int shown = g->count < g->w ? g->count : g->w;
+    int prev_row = -1;
+    if (g->count > shown) {
+        // The oldest visible column still connects to the sample before it
+        prev_row = value_row(g, g->samples[(g->head + GRAPH_HISTORY - 1 - shown) % GRAPH_HISTORY]);
+    }
+
+    for (int i = 0; i < g->w; i++) {
+        int age = g->w - 1 - i;   // 0 = newest
+        if (age >= shown) {
+            graph_area_t a = graph_area(g);
+            int col = g_portrait ? SSD1306_WIDTH - 1 - (g->x + i) : g->x + i;
+            for (int page = a.row0 >> 3; page <= a.row1 >> 3; page++) {
+                fb[page * SSD1306_WIDTH + col] &= ~page_mask(page, a.row0, a.row1);
+            }
+            continue;
+        }
+        uint8_t value = g->samples[(g->head + GRAPH_HISTORY - 1 - age) % GRAPH_HISTORY];
+        draw_column(g, fb, g->x + i, value, prev_row);
+        prev_row = value_row(g, value);
+    }
+    mark_area_dirty(g);
+}
+
+// Define graph id on the selected display and clear its region and history
+void graph_setup(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                 uint8_t min, uint8_t max, uint8_t flags) {
+    if (id >= GRAPH_COUNT) return;
+    graph_t* g = &graphs[id];
+
+    g->active = false;
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || w == 0 || h == 0) return;
+    if (w > SSD1306_WIDTH - x) w = SSD1306_WIDTH - x;
+    if (h > SSD1306_HEIGHT - y) h = SSD1306_HEIGHT - y;
+
+    g->display = ssd1306_selected();
+    g->x = x;
+    g->y = y;
+    g->w = w;
+    g->h = h;
+    g->flags = flags;
+    g->head = 0;
+    g->count = 0;
+    g->active = true;
+    graph_set_scale(id, min, max);
+}
+
+// Change the value range and redraw the plot from history
+void graph_set_scale(uint8_t id, uint8_t min, uint8_t max) {
+    if (id >= GRAPH_COUNT || !graphs[id].active) return;
+    graph_t* g = &graphs[id];
+
+    if (max <= min) {
+        if (min == 0xFF) min--;
+        max = min + 1;
+    }
+    g->min = min;
+    g->max = max;
+    redraw(g);
+}
+
+// Append a sample: scroll by one column and draw only the new one
+void graph_push(uint8_t id, uint8_t value) {
+    if (id >= GRAPH_COUNT || !graphs[id].active) return;
+    graph_t* g = &graphs[id];
+    uint8_t* fb = ssd1306_draw_buffer(g->display);
+
+    int prev_row = -1;
+    if (g->count > 0) {
+        prev_row = value_row(g, g->samples[(g->head + GRAPH_HISTORY - 1) % GRAPH_HISTORY]);
+    }
+    g->samples[g->head] = value;
+    g->head = (g->head + 1) % GRAPH_HISTORY;
+    if (g->count < GRAPH_HISTORY) g->count++;
+
+    if (g->w > 1) scroll(g, fb);
+    draw_column(g, fb, g->x + g->w - 1, value, prev_row);
+    mark_area_dirty(g);
+}
+
+// Stop updating graph id; its pixels stay until overdrawn
+void graph_delete(uint8_t id) {
+    if (id < GRAPH_COUNT) graphs[id].active = false;
+}
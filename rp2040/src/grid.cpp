@@ -0,0 +1,108 @@
+#include "main.h"
+
+// Character grid: each display is also a GRID_COLS x GRID_ROWS array of 8x8
+// cells with attributes, addressed by row and column. The host writes runs of
+// characters into it (CMD_GRID write) and only cells whose character or
+// attributes actually change are drawn, so updating a value on a text screen
+// costs the bus a few cells, not a redrawn line. Cells are drawn as soon as
+// they change; their dirty columns are merged per page by the flush.
+//
+// The grid only knows what it drew itself: CMD_CLEAR empties it along with
+// the screen, other drawing over grid cells needs GRID_OP_REDRAW afterwards.
+// It starts out blank, so the boot splash is gone only after a CMD_CLEAR.
+
+typedef struct {
+    uint8_t chars[GRID_ROWS][GRID_COLS];
+    uint8_t attrs[GRID_ROWS][GRID_COLS];
+} grid_t;
+
+static grid_t grids[DISPLAY_COUNT];
+
+static bool blink_off = false;          // Blinking cells currently blanked
+static bool blinking = false;           // Some cell has GRID_ATTR_BLINK
+static absolute_time_t next_blink_time = {0};
+
+static void draw(uint8_t id, uint8_t row, uint8_t col) {
+    uint8_t attr = grids[id].attrs[row][col];
+    char c = (attr & GRID_ATTR_BLINK) && blink_off ? ' ' : grids[id].chars[row][col];
+    ssd1306_draw_cell(id, col, row, c, attr & GRID_ATTR_INVERSE);
+}
+
+// Set one cell, drawing it only if it changed
+static void set_cell(uint8_t id, uint8_t row, uint8_t col, uint8_t c, uint8_t attr) {
+    grid_t* g = &grids[id];
+    if (g->chars[row][col] == c && g->attrs[row][col] == attr) return;
+    g->chars[row][col] = c;
+    g->attrs[row][col] = attr;
+    draw(id, row, col);
+
+    if ((attr & GRID_ATTR_BLINK) && !blinking) {
+        blinking = true;
+        blink_off = false;
+        next_blink_time = make_timeout_time_us(GRID_BLINK_US);
+    }
+}
+
+// The screen of display id was cleared: all cells are blank
+void grid_reset(uint8_t id) {
+    if (id >= DISPLAY_COUNT) return;
+    memset(grids[id].chars, ' ', sizeof(grids[id].chars));
+    memset(grids[id].attrs, 0, sizeof(grids[id].attrs));
+}
+
+// Start with blank grids (call once at boot)
+void grid_init() {
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) grid_reset(id);
+}
+
+// Write len characters from (row, col) on display id, continuing on the next
+// row at the end of one; anything past the last cell is dropped
+void grid_write(uint8_t id, uint8_t row, uint8_t col, uint8_t attr, const uint8_t* text, uint8_t len) {
+    if (id >= DISPLAY_COUNT || row >= GRID_ROWS || col >= GRID_COLS) return;
+    uint16_t cell = row * GRID_COLS + col;
+    for (uint8_t i = 0; i < len && cell < GRID_ROWS * GRID_COLS; i++, cell++) {
+        set_cell(id, cell / GRID_COLS, cell % GRID_COLS, text[i], attr);
+    }
+}
+
+// Set the attributes of count cells from (row, col), keeping their characters
+void grid_set_attr(uint8_t id, uint8_t row, uint8_t col, uint8_t count, uint8_t attr) {
+    if (id >= DISPLAY_COUNT || row >= GRID_ROWS || col >= GRID_COLS) return;
+    uint16_t cell = row * GRID_COLS + col;
+    for (uint8_t i = 0; i < count && cell < GRID_ROWS * GRID_COLS; i++, cell++) {
+        uint8_t r = cell / GRID_COLS, c = cell % GRID_COLS;
+        set_cell(id, r, c, grids[id].chars[r][c], attr);
+    }
+}
+
+// Draw every cell of display id again, e.g. after other commands drew over it
+void grid_redraw(uint8_t id) {
+    if (id >= DISPLAY_COUNT) return;
+    for (uint8_t row = 0; row < GRID_ROWS; row++) {
+        for (uint8_t col = 0; col < GRID_COLS; col++) draw(id, row, col);
+    }
+}
+
+// Main-loop hook: blink GRID_ATTR_BLINK cells every GRID_BLINK_US
+void grid_task() {
+    if (!blinking || !time_reached(next_blink_time)) return;
+    next_blink_time = make_timeout_time_us(GRID_BLINK_US);
+    blink_off = !blink_off;
+
+    bool any = false;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        for (uint8_t row = 0; row < GRID_ROWS; row++) {
+            for (uint8_t col = 0; col < GRID_COLS; col++) {
+                if (!(grids[id].attrs[row][col] & GRID_ATTR_BLINK)) continue;
+                any = true;
+                draw(id, row, col);
+            }
+        }
+    }
+
+    // Last blinking cell gone: stop, showing everything
+    if (!any) {
+        blinking = false;
+        blink_off = false;
+    }
+}
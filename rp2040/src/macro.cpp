@@ -0,0 +1,123 @@
+#include "main.h"
+
+// Command macros: the host records a sequence of ordinary commands once
+// (CMD_MACRO begin ... end) and later replays it with a single CMD_MACRO
+// play, e.g. the fixed header, footer and icons of a screen. main.cpp does
+// the recording and runs the stored commands through handle_command().
+//
+// A macro is stored as [len][command bytes] records, exactly as the commands
+// were framed. CMD_DRAW_TEXT text may contain the placeholder bytes
+// MACRO_PARAM_FIRST..MACRO_PARAM_LAST, replaced by the play command's
+// parameters, so one macro can draw a screen with changing values.
+
+typedef struct {
+    uint16_t length[MACRO_COUNT];               // Bytes used (0 = empty)
+    uint8_t data[MACRO_COUNT][MACRO_MAX_LEN];
+} macro_store_t;
+
+static_assert(sizeof(macro_store_t) == MACRO_STORE_SIZE, "macro store image size");
+
+static macro_store_t store;
+
+static uint8_t recording = MACRO_NONE;   // Macro being recorded
+static bool overflow = false;            // Recording ran out of room
+
+// Load macros saved with macro_save() (call once at boot)
+void macro_init() {
+    if (!config_load_macros((uint8_t*)&store, sizeof(store))) {
+        memset(&store, 0, sizeof(store));
+    }
+}
+
+// Start recording macro id (replaces it)
+bool macro_begin(uint8_t id) {
+    if (id >= MACRO_COUNT) return false;
+    recording = id;
+    overflow = false;
+    store.length[id] = 0;
+    return true;
+}
+
+// Append one complete command to the macro being recorded
+void macro_append(const uint8_t* cmd, uint8_t len) {
+    if (recording == MACRO_NONE || overflow) return;
+    uint16_t* used = &store.length[recording];
+    if (*used + 1 + len > MACRO_MAX_LEN) {
+        overflow = true;
+        return;
+    }
+    uint8_t* p = &store.data[recording][*used];
+    p[0] = len;
+    memcpy(&p[1], cmd, len);
+    *used += 1 + len;
+}
+
+// Finish recording; a macro that did not fit is dropped as a whole
+void macro_end() {
+    if (recording == MACRO_NONE) return;
+    if (overflow) store.length[recording] = 0;
+    recording = MACRO_NONE;
+}
+
+// Delete macro id (MACRO_ALL: every macro); RAM only until macro_save()
+void macro_delete(uint8_t id) {
+    if (id == MACRO_ALL) {
+        memset(&store, 0, sizeof(store));
+    } else if (id < MACRO_COUNT) {
+        store.length[id] = 0;
+    }
+}
+
+// Persist all macros to flash (staged now, written by config_task())
+void macro_save() {
+    config_save_macros((const uint8_t*)&store, sizeof(store));
+}
+
+// Step through macro id: returns false at the end. *offset starts at 0.
+bool macro_next(uint8_t id, uint16_t* offset, const uint8_t** cmd, uint8_t* len) {
+    if (id >= MACRO_COUNT || *offset >= store.length[id]) return false;
+    const uint8_t* p = &store.data[id][*offset];
+    *cmd = &p[1];
+    *len = p[0];
+    *offset += 1 + p[0];
+    return true;
+}
+
+// Find parameter n in params (NUL-separated); sets *len, NULL if absent
+static const uint8_t* find_param(uint8_t n, const uint8_t* params, uint8_t params_len, uint8_t* len) {
+    uint8_t start = 0;
+    for (uint8_t i = 0; i <= params_len; i++) {
+        if (i == params_len || params[i] == 0) {
+            if (n == 0) {
+                *len = i - start;
+                return &params[start];
+            }
+            n--;
+            start = i + 1;
+        }
+    }
+    return NULL;
+}
+
+// Copy a CMD_DRAW_TEXT command into out with its placeholders replaced by
+// params; the text is cut at MAX_CMD_SIZE - 4 bytes. Returns the new length.
+uint8_t macro_substitute(const uint8_t* cmd, uint8_t len, const uint8_t* params, uint8_t params_len,
+                         uint8_t* out) {
+    memcpy(out, cmd, 4);
+    uint8_t o = 4;
+    for (uint8_t i = 4; i < len && o < MAX_CMD_SIZE; i++) {
+        uint8_t c = cmd[i];
+        if (c < MACRO_PARAM_FIRST || c > MACRO_PARAM_LAST) {
+            out[o++] = c;
+            continue;
+        }
+        uint8_t plen = 0;
+        const uint8_t* p = find_param(c - MACRO_PARAM_FIRST, params, params_len, &plen);
+        if (!p) continue;  // Missing parameter: empty
+        if (plen > MAX_CMD_SIZE - o) plen = MAX_CMD_SIZE - o;
+        memcpy(&out[o], p, plen);
+        o += plen;
+    }
+    out[3] = o - 4;
+    return o;
+}
@@ -1,20 +1,135 @@
 #include "main.h"
+#include "trace.h"
 
 // Runtime orientation flag (read from GPIO jumper at boot)
 bool g_portrait = false;
 
+// Status/performance counters (CMD_STATUS)
+device_stats_t g_stats = {};
+
 // Debug flag - set to false for production use
 #define DEBUG_MODE      false
 
-// Buffer for receiving commands from serial
-static uint8_t serial_buf[MAX_CMD_SIZE];
-static uint8_t serial_buf_pos = 0;
+// Parser state for one command stream. The CDC port and (with
+// ENABLE_VENDOR_INTERFACE) the vendor bulk interface each have their own, so
+// interleaved traffic on both never corrupts a half-received command.
+typedef struct {
+    uint32_t (*available)(void);
+    uint32_t (*read)(void* buf, uint32_t len);
+    void (*reply)(const uint8_t* data, uint32_t len);
+    uint32_t (*write)(const void* data, uint32_t len);  // Non-blocking: what fits the TX FIFO
+    uint32_t (*flush)(void);
+    uint8_t* packet;                     // PACKET_BUFFER_SIZE bytes (NULL = no CMD_PACKET)
+
+    uint8_t buf[MAX_CMD_SIZE + 1] = {};  // +1 for the CMD_DRAW_TEXT terminator
+    uint8_t pos = 0;
+    uint8_t need = 1;                    // Bytes to receive before framing is checked again
+    uint32_t skip = 0;                   // Bytes left of a truncated command
+
+    // CMD_FRAME payload still to be streamed into the framebuffer
+    uint32_t frame_remaining = 0;
+    uint16_t frame_offset = 0;
+
+    // Timestamp for non-blocking text accumulation (CMD_DRAW_TEXT)
+    absolute_time_t text_start = {0};
+    bool text_pending = false;
+
+    // CMD_PACKET mode: packet received so far, starting with its sync byte
+    bool packet_mode = false;
+    bool packet_running = false;         // Executing a payload from packet
+    uint16_t packet_len = 0;
+    uint16_t packet_need = PACKET_HEADER_LEN;
+} cmd_stream_t;
 
-// Timestamp for non-blocking text accumulation (CMD_DRAW_TEXT)
-static absolute_time_t text_cmd_start = {0};
-static bool text_cmd_pending = false;
 #define TEXT_CMD_TIMEOUT_US 5000 // 5ms accumulation window
 
+#define PACKET_BUFFER_SIZE (PACKET_HEADER_LEN + PACKET_MAX_PAYLOAD + PACKET_CRC_LEN)
+
+// Boot milestones in microseconds since power-on (0 = not reached yet)
+static uint32_t boot_display_ready_us = 0;
+static uint32_t boot_usb_mounted_us = 0;
+
+// Write a complete reply to a TX FIFO, servicing USB while it drains.
+// Gives up if the host stops reading for REPLY_TIMEOUT_US.
+#define REPLY_TIMEOUT_US 100000 // 100ms without progress
+static void fifo_reply(uint32_t (*write)(const void*, uint32_t), uint32_t (*flush)(void),
+                       const uint8_t* data, uint32_t len) {
+    absolute_time_t deadline = make_timeout_time_us(REPLY_TIMEOUT_US);
+    while (len > 0) {
+        uint32_t written = write(data, len);
+        data += written;
+        len -= written;
+        flush();
+        if (len == 0) break;
+
+        if (written > 0) {
+            deadline = make_timeout_time_us(REPLY_TIMEOUT_US);
+        } else if (time_reached(deadline)) {
+            break; // Host not reading: drop the rest
+        }
+        tud_task();
+    }
+}
+
+static void cdc_reply(const uint8_t* data, uint32_t len) {
+    fifo_reply(tud_cdc_write, tud_cdc_write_flush, data, len);
+}
+
+static uint8_t cdc_packet[PACKET_BUFFER_SIZE];
+static cmd_stream_t cdc_stream = { tud_cdc_available, tud_cdc_read, cdc_reply, tud_cdc_write, tud_cdc_write_flush, cdc_packet };
+
+#if CFG_TUD_VENDOR
+static void vendor_reply(const uint8_t* data, uint32_t len) {
+    fifo_reply(tud_vendor_write, tud_vendor_write_flush, data, len);
+}
+
+static uint8_t vendor_packet[PACKET_BUFFER_SIZE];
+static cmd_stream_t vendor_stream = { tud_vendor_available, tud_vendor_read, vendor_reply, tud_vendor_write, tud_vendor_write_flush, vendor_packet };
+#endif
+
+// Stream the command being handled came from (replies go back there)
+static cmd_stream_t* reply_stream = &cdc_stream;
+
+// Stream a CMD_CAPTURE reply is being sent on (NULL = none)
+static cmd_stream_t* capture_stream = NULL;
+
+// Pass as much of the capture reply to the TX FIFO as fits without waiting.
+// drain: block until all of it is out (before another reply on that stream).
+static void capture_send(bool drain) {
+    if (!capture_stream) return;
+
+    const uint8_t* data;
+    uint32_t len = capture_pending(&data);
+    if (drain) {
+        capture_stream->reply(data, len);
+        capture_advance(len);
+    } else if (len > 0) {
+        uint32_t written = capture_stream->write(data, len);
+        capture_stream->flush();
+        capture_advance(written);
+    }
+    if (capture_pending(&data) == 0) capture_stream = NULL;
+}
+
+void cmd_reply(const uint8_t* data, uint32_t len) {
+    if (capture_stream == reply_stream) capture_send(true);
+    reply_stream->reply(data, len);
+}
+
+void cmd_notify(const uint8_t* data, uint32_t len) {
+    // Nobody listening on the tty: don't stall input handling on a full FIFO
+    if (reply_stream == &cdc_stream && !tud_cdc_connected()) return;
+    if (capture_stream == reply_stream) capture_send(true);
+    reply_stream->reply(data, len);
+}
+
+static void put_u32_le(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
 #ifdef ENABLE_TEST_COMMANDS
 // Pending test event for delayed HID reports (button release, second nav event)
 static struct {
@@ -28,7 +143,7 @@ static struct {
 #define TEST_BTN_RELEASE_DELAY_US 50000  // 50ms between press and release
 #define TEST_NAV_SECOND_EVENT_US  16000  // 16ms between nav events (matches real buttons)
 
-static void handle_test_command(uint8_t subcmd) {
+static void handle_test_command(uint8_t subcmd, const uint8_t* args) {
     // Warn if a pending event will be overwritten (debug aid for test timing issues)
     if (test_pending_event.pending && DEBUG_MODE) {
         ssd1306_draw_text(0, 48, "WARN:test evt overwrite");
@@ -38,8 +153,7 @@ static void handle_test_command(uint8_t subcmd) {
         case TEST_SUBCMD_PING:
         {
             uint8_t reply[2] = {CMD_TEST, TEST_SUBCMD_PING};
-            tud_cdc_write(reply, 2);
-            tud_cdc_write_flush();
+            cmd_reply(reply, sizeof(reply));
             break;
         }
         case TEST_SUBCMD_ROTATE_CW:
@@ -96,134 +210,731 @@ static void handle_test_command(uint8_t subcmd) {
             test_pending_event.y = 0;
             break;
 
+        case TEST_SUBCMD_FB_CHECKSUM:
+        {
+            // CRC of the selected display's framebuffer; pending = not all of
+            // it has reached the panel yet
+            uint8_t id = ssd1306_selected();
+            uint16_t crc = crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+            uint8_t reply[6] = {CMD_TEST, TEST_SUBCMD_FB_CHECKSUM, id,
+                                (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8), ssd1306_flush_pending(id)};
+            cmd_reply(reply, sizeof(reply));
+            break;
+        }
+
+        case TEST_SUBCMD_BUS_STATS:
+        {
+            // Display bus counters (as in CMD_STATUS), pending = a flush of
+            // any display is still in progress
+            bool pending = false;
+            for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+                if (ssd1306_flush_pending(id)) pending = true;
+            }
+            uint8_t reply[15] = {CMD_TEST, TEST_SUBCMD_BUS_STATS};
+            put_u32_le(&reply[2], g_stats.i2c_transactions);
+            put_u32_le(&reply[6], g_stats.i2c_bytes);
+            put_u32_le(&reply[10], g_stats.i2c_failures);
+            reply[14] = pending;
+            cmd_reply(reply, sizeof(reply));
+            break;
+        }
+
+        case TEST_SUBCMD_GPIO:
+            // Unknown pins are ignored
+            input_test_set_pin(args[0], args[1]);
+            break;
+
         default:
             break;
     }
 }
 #endif // ENABLE_TEST_COMMANDS
 
-// Handles a serial command once received
-void handle_command() {
-    // Check for minimum command length (1 byte for command type at least)
-    if (serial_buf_pos < 1) return;
+// Decode the 7-byte CMD_INPUT_CONFIG payload (also the CFG_KEY_INPUT_TIMING value)
+static void decode_input_timing(const uint8_t* p, input_timing_t* timing) {
+    timing->repeat_delay_ms = p[0] | (p[1] << 8);
+    timing->repeat_rate_ms = p[2];
+    timing->repeat_min_ms = p[3];
+    timing->repeat_accel_ms = p[4];
+    timing->long_press_ms = p[5] | (p[6] << 8);
+}
+
+// Decode the 6-byte CFG_KEY_POWER_SAVE value
+static void decode_power_config(const uint8_t* p, power_config_t* config) {
+    config->dim_seconds = p[0] | (p[1] << 8);
+    config->off_seconds = p[2] | (p[3] << 8);
+    config->dim_contrast = p[4];
+    config->shift_minutes = p[5];
+}
+
+// Apply a setting immediately (orientation only takes effect at next boot)
+static void apply_config(uint8_t key, const uint8_t* value, uint8_t len) {
+    switch (key) {
+        case CFG_KEY_BRIGHTNESS:
+            if (len >= 1) ssd1306_set_brightness(value[0]);
+            break;
+        case CFG_KEY_INVERT:
+            if (len >= 1) ssd1306_invert(value[0] > 0);
+            break;
+        case CFG_KEY_INPUT_TIMING:
+            if (len >= 7) {
+                input_timing_t timing;
+                decode_input_timing(value, &timing);
+                input_set_timing(&timing);
+            }
+            break;
+        case CFG_KEY_POWER_SAVE:
+            if (len >= 6) {
+                power_config_t config;
+                decode_power_config(value, &config);
+                power_set_config(&config);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Argument bytes after [op][mode] for a CMD_GFX op (bitmap: header only);
+// -1 for unknown ops
+static int gfx_arg_length(uint8_t op) {
+    switch (op) {
+        case GFX_OP_PIXEL:       return 2;
+        case GFX_OP_LINE:        return 4;
+        case GFX_OP_RECT:        return 4;
+        case GFX_OP_FILL_RECT:   return 4;
+        case GFX_OP_CIRCLE:      return 3;
+        case GFX_OP_FILL_CIRCLE: return 3;
+        case GFX_OP_BITMAP:      return 4;
+        case GFX_OP_CLIP:        return 4;
+        default:                 return -1;
+    }
+}
+
+// Argument bytes after [op][id] for a CMD_GRAPH op; -1 for unknown ops
+static int graph_arg_length(uint8_t op) {
+    switch (op) {
+        case GRAPH_OP_SETUP:  return 7;
+        case GRAPH_OP_SAMPLE: return 1;
+        case GRAPH_OP_SCALE:  return 2;
+        case GRAPH_OP_DELETE: return 0;
+        default:              return -1;
+    }
+}
+
+// Argument bytes after [op] for a CMD_MENU op (item: header only); -1 for
+// unknown ops
+static int menu_arg_length(uint8_t op) {
+    switch (op) {
+        case MENU_OP_RESET: return 0;
+        case MENU_OP_ITEM:  return 5;
+        case MENU_OP_OPEN:  return 1;
+        case MENU_OP_CLOSE: return 0;
+        default:            return -1;
+    }
+}
+
+// Argument bytes after [op][slot] for a CMD_ANIM op; -1 for unknown ops
+static int anim_arg_length(uint8_t op) {
+    switch (op) {
+        case ANIM_OP_STOP:         return 0;
+        case ANIM_OP_BLINK:        return 6;
+        case ANIM_OP_SLIDE:        return 6;
+        case ANIM_OP_CONTRAST:     return 2;
+        case ANIM_OP_INVERT_PULSE: return 2;
+        default:                   return -1;
+    }
+}
+
+// Argument bytes after [op] for a CMD_MACRO op (play: header only);
+// -1 for unknown ops
+static int macro_arg_length(uint8_t op) {
+    switch (op) {
+        case MACRO_OP_BEGIN:  return 1;
+        case MACRO_OP_END:    return 0;
+        case MACRO_OP_PLAY:   return 2;
+        case MACRO_OP_DELETE: return 1;
+        case MACRO_OP_SAVE:   return 0;
+        default:              return -1;
+    }
+}
+
+// Argument bytes after [op] for a CMD_GRID op (write: header only); -1 for
+// unknown ops
+static int grid_arg_length(uint8_t op) {
+    switch (op) {
+        case GRID_OP_WRITE:  return 4;
+        case GRID_OP_ATTR:   return 4;
+        case GRID_OP_REDRAW: return 0;
+        default:             return -1;
+    }
+}
+
+// Total length of a variable-length command from the bytes received so far
+// (buf[0..pos-1], pos >= the descriptor's size). May ask for more header
+// bytes first by returning a length up to the end of the header; 0 = invalid.
+typedef uint32_t (*cmd_length_fn)(const uint8_t* buf, uint8_t pos);
+
+// [0x02][x][y][len][text...]
+static uint32_t text_length(const uint8_t* buf, uint8_t pos) {
+    (void) pos;
+    return 4 + buf[3];
+}
+
+// [0x09][key][len][value...]
+static uint32_t config_set_length(const uint8_t* buf, uint8_t pos) {
+    (void) pos;
+    return 3 + buf[2];
+}
+
+// [0x11][op][mode][args...]; bitmaps carry (w + 7) / 8 * h data bytes
+// after [x][y][w][h]
+static uint32_t gfx_length(const uint8_t* buf, uint8_t pos) {
+    int args = gfx_arg_length(buf[1]);
+    if (args < 0) return 0;
+    if (buf[1] != GFX_OP_BITMAP || pos < 7) return 3 + args;
+    return 7 + (uint32_t)(buf[5] + 7) / 8 * buf[6];
+}
+
+// [0x12][op][id][args...], length fixed per op
+static uint32_t graph_length(const uint8_t* buf, uint8_t pos) {
+    (void) pos;
+    int args = graph_arg_length(buf[1]);
+    return args < 0 ? 0 : 3 + args;
+}
+
+// [0x13][op][args...]; items carry [len] label bytes after
+// [id][parent][type][flags][len]
+static uint32_t menu_length(const uint8_t* buf, uint8_t pos) {
+    int args = menu_arg_length(buf[1]);
+    if (args < 0) return 0;
+    if (buf[1] != MENU_OP_ITEM || pos < 7) return 2 + args;
+    return 7 + buf[6];
+}
+
+// [0x14][op][slot][args...], length fixed per op
+static uint32_t anim_length(const uint8_t* buf, uint8_t pos) {
+    (void) pos;
+    int args = anim_arg_length(buf[1]);
+    return args < 0 ? 0 : 3 + args;
+}
+
+// [0x16][op][args...]; play carries [len] parameter bytes after [id][len]
+static uint32_t macro_length(const uint8_t* buf, uint8_t pos) {
+    int args = macro_arg_length(buf[1]);
+    if (args < 0) return 0;
+    if (buf[1] != MACRO_OP_PLAY || pos < 4) return 2 + args;
+    return 4 + buf[3];
+}
+
+// [0x18][op][args...]; write carries [len] characters after
+// [row][col][attr][len]
+static uint32_t grid_length(const uint8_t* buf, uint8_t pos) {
+    int args = grid_arg_length(buf[1]);
+    if (args < 0) return 0;
+    if (buf[1] != GRID_OP_WRITE || pos < 6) return 2 + args;
+    return 6 + buf[5];
+}
+
+#ifdef ENABLE_TEST_COMMANDS
+// [0xF0][subcmd][args...]; only TEST_SUBCMD_GPIO has arguments
+static uint32_t test_length(const uint8_t* buf, uint8_t pos) {
+    (void) pos;
+    return buf[1] == TEST_SUBCMD_GPIO ? 4 : 2;
+}
+#endif
+
+// Stream whose commands are being recorded into a macro (NULL = none)
+static cmd_stream_t* macro_recorder = NULL;
+
+static void handle_command(cmd_stream_t* s);
+
+// Run macro id through handle_command() as if its commands had arrived on s
+static void play_macro(cmd_stream_t* s, uint8_t id, const uint8_t* params, uint8_t params_len) {
+    static cmd_stream_t player;
+    player.available = s->available;
+    player.read = s->read;
+    player.reply = s->reply;
+    player.write = s->write;
+    player.flush = s->flush;
+
+    uint16_t offset = 0;
+    const uint8_t* cmd;
+    uint8_t len;
+    while (macro_next(id, &offset, &cmd, &len)) {
+        if (cmd[0] == CMD_DRAW_TEXT && len >= 4) {
+            player.pos = macro_substitute(cmd, len, params, params_len, player.buf);
+        } else {
+            memcpy(player.buf, cmd, len);
+            player.pos = len;
+        }
+        handle_command(&player);
+    }
+    reply_stream = s;
+}
+
+// Command handlers. Each runs once its command is framed: s->buf holds at
+// least the descriptor's size in bytes, s->pos the number received (less than
+// the declared length only if it was cut at MAX_CMD_SIZE or timed out).
+
+static void cmd_clear(cmd_stream_t* s) {
+    (void) s;
+    ssd1306_clear();
+    grid_reset(ssd1306_selected());
+}
+
+static void cmd_draw_text(cmd_stream_t* s) {
+    // Format: CMD_DRAW_TEXT, x, y, len, text...
+    uint8_t x = s->buf[1];
+    uint8_t y = s->buf[2];
+    uint8_t text_len = s->buf[3];
+
+    // Clamp text length to what was received (truncated or timed out)
+    if (text_len > s->pos - 4) text_len = s->pos - 4;
+    if (text_len == 0) return;
+
+    // Null-terminate the text
+    s->buf[4 + text_len] = 0;
+
+    // Draw text starting from position 4 in buffer
+    ssd1306_draw_text(x, y, (char*)&s->buf[4]);
+}
+
+static void cmd_set_cursor(cmd_stream_t* s) {
+    // Format: CMD_SET_CURSOR, x, y
+    uint8_t x = s->buf[1];
+    uint8_t y = s->buf[2];
+    ssd1306_set_cursor(x, y);
 
-    // Debug info should only be displayed if debug mode is enabled
     if (DEBUG_MODE) {
         char debug_buf[32];
-        snprintf(debug_buf, sizeof(debug_buf), "CMD: %02X LEN: %d", serial_buf[0], serial_buf_pos);
-        // Save current display content to draw debug info at bottom
-        ssd1306_draw_text(0, 56, debug_buf);
+        snprintf(debug_buf, sizeof(debug_buf), "Cursor: %d,%d", x, y);
+        ssd1306_draw_text(0, 48, debug_buf);
     }
+}
 
-    // Process command based on first byte
-    switch (serial_buf[0]) {
-        case CMD_CLEAR:
-            // Simply clear the display without adding any debug text
-            ssd1306_clear();
-            break;
+static void cmd_invert(cmd_stream_t* s) {
+    // Format: CMD_INVERT, value (0 or 1)
+    bool invert = s->buf[1] > 0;
+    ssd1306_invert(invert);
 
-        case CMD_DRAW_TEXT:
-            // Format: CMD_DRAW_TEXT, x, y, len, text...
-            if (serial_buf_pos >= 5) {
-                uint8_t x = serial_buf[1];
-                uint8_t y = serial_buf[2];
-                uint8_t text_len = serial_buf[3];
+    if (DEBUG_MODE) {
+        ssd1306_draw_text(0, 48, invert ? "Invert: ON" : "Invert: OFF");
+    }
+}
 
-                // Clamp text length to available buffer
-                if (text_len > MAX_CMD_SIZE - 4) text_len = MAX_CMD_SIZE - 4;
-                if (text_len > serial_buf_pos - 4) text_len = serial_buf_pos - 4;
+static void cmd_brightness(cmd_stream_t* s) {
+    // Format: CMD_BRIGHTNESS, brightness_level (0-255)
+    uint8_t brightness = s->buf[1];
+    ssd1306_set_brightness(brightness);
 
-                // Null-terminate the text
-                serial_buf[4 + text_len] = 0;
+    if (DEBUG_MODE) {
+        char debug_buf[32];
+        snprintf(debug_buf, sizeof(debug_buf), "Brightness: %d", brightness);
+        ssd1306_draw_text(0, 48, debug_buf);
+    }
+}
 
-                // Draw text starting from position 4 in buffer
-                ssd1306_draw_text(x, y, (char*)&serial_buf[4]);
-            }
-            break;
+static void cmd_progress_bar(cmd_stream_t* s) {
+    // Format: CMD_PROGRESS_BAR, x, y, width, height, progress (0-100)
+    uint8_t x = s->buf[1];
+    uint8_t y = s->buf[2];
+    uint8_t width = s->buf[3];
+    uint8_t height = s->buf[4];
+    uint8_t progress = s->buf[5];
 
-        case CMD_SET_CURSOR:
-            // Format: CMD_SET_CURSOR, x, y
-            if (serial_buf_pos >= 3) {
-                uint8_t x = serial_buf[1];
-                uint8_t y = serial_buf[2];
-                ssd1306_set_cursor(x, y);
-                
-                if (DEBUG_MODE) {
-                    char debug_buf[32];
-                    snprintf(debug_buf, sizeof(debug_buf), "Cursor: %d,%d", x, y);
-                    ssd1306_draw_text(0, 48, debug_buf);
-                }
-            }
-            break;
+    ssd1306_draw_progress_bar(x, y, width, height, progress);
 
-        case CMD_INVERT:
-            // Format: CMD_INVERT, value (0 or 1)
-            if (serial_buf_pos >= 2) {
-                bool invert = serial_buf[1] > 0;
-                ssd1306_invert(invert);
-                
-                if (DEBUG_MODE) {
-                    ssd1306_draw_text(0, 48, invert ? "Invert: ON" : "Invert: OFF");
-                }
-            }
+    if (DEBUG_MODE) {
+        char debug_buf[32];
+        snprintf(debug_buf, sizeof(debug_buf), "Progress: %d%%", progress);
+        ssd1306_draw_text(0, 48, debug_buf);
+    }
+}
+
+static void cmd_power(cmd_stream_t* s) {
+    // Format: CMD_POWER, value (0 or 1)
+    bool power = s->buf[1] > 0;
+    ssd1306_power(power);
+
+    if (DEBUG_MODE) {
+        ssd1306_draw_text(0, 48, power ? "Power: ON" : "Power: OFF");
+    }
+}
+
+static void cmd_input_config(cmd_stream_t* s) {
+    // Format: CMD_INPUT_CONFIG, delay_lo, delay_hi, rate, min, accel, long_lo, long_hi
+    input_timing_t timing;
+    decode_input_timing(&s->buf[1], &timing);
+    input_set_timing(&timing);
+
+    if (DEBUG_MODE) {
+        char debug_buf[32];
+        snprintf(debug_buf, sizeof(debug_buf), "Repeat: %dms", timing.repeat_delay_ms);
+        ssd1306_draw_text(0, 48, debug_buf);
+    }
+}
+
+static void cmd_config_set(cmd_stream_t* s) {
+    // Format: CMD_CONFIG_SET, key, len, value...
+    uint8_t key = s->buf[1];
+    uint8_t len = s->buf[2];
+    if (len > CFG_MAX_VALUE_LEN) len = CFG_MAX_VALUE_LEN;
+    if (len > s->pos - 3) len = s->pos - 3;
+
+    // Persisted on the next quiet period by config_task()
+    bool stored = config_set(key, &s->buf[3], len);
+    apply_config(key, &s->buf[3], len);
+
+    if (DEBUG_MODE) {
+        char debug_buf[32];
+        snprintf(debug_buf, sizeof(debug_buf), "Config %02X: %s", key, stored ? "OK" : "FULL");
+        ssd1306_draw_text(0, 48, debug_buf);
+    }
+}
+
+static void cmd_config_reset(cmd_stream_t* s) {
+    // Format: CMD_CONFIG_RESET (defaults apply from next boot)
+    (void) s;
+    config_reset();
+}
+
+static void cmd_splash(cmd_stream_t* s) {
+    // Format: CMD_SPLASH, op (SPLASH_OP_ERASE / SPLASH_OP_SAVE)
+    if (s->buf[1] == SPLASH_OP_SAVE) {
+        config_save_splash(ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+    } else if (s->buf[1] == SPLASH_OP_ERASE) {
+        config_erase_splash();
+    }
+}
+
+static void cmd_boot_time(cmd_stream_t* s) {
+    // Reply: [0x0C][usb_mounted_us:4][display_ready_us:4][ready_us:4]
+    (void) s;
+    uint32_t ready_us = 0;
+    if (boot_usb_mounted_us && boot_display_ready_us) {
+        ready_us = boot_usb_mounted_us > boot_display_ready_us ? boot_usb_mounted_us : boot_display_ready_us;
+    }
+    uint8_t reply[13];
+    reply[0] = CMD_BOOT_TIME;
+    put_u32_le(&reply[1], boot_usb_mounted_us);
+    put_u32_le(&reply[5], boot_display_ready_us);
+    put_u32_le(&reply[9], ready_us);
+    cmd_reply(reply, sizeof(reply));
+}
+
+static void cmd_status(cmd_stream_t* s) {
+    // Format: CMD_STATUS, flags (STATUS_FLAG_RESET)
+    g_stats.version = STATS_VERSION;
+    g_stats.uptime_ms = to_ms_since_boot(get_absolute_time());
+    g_stats.flags = (ssd1306_is_ok() ? STATS_FLAG_DISPLAY_OK : 0) |
+                    (g_portrait ? STATS_FLAG_PORTRAIT : 0);
+    g_stats.i2c_baud = ssd1306_bus_speed();
+
+    uint8_t header[3] = {CMD_STATUS, sizeof(device_stats_t) & 0xFF, sizeof(device_stats_t) >> 8};
+    cmd_reply(header, sizeof(header));
+    cmd_reply((const uint8_t*)&g_stats, sizeof(g_stats));
+
+    if (s->buf[1] & STATUS_FLAG_RESET) {
+        memset(&g_stats, 0, sizeof(g_stats));
+    }
+}
+
+static void cmd_trace(cmd_stream_t* s) {
+    // Format: CMD_TRACE, op (TRACE_OP_DUMP / TRACE_OP_CLEAR)
+    if (s->buf[1] == TRACE_OP_CLEAR) {
+        trace_clear();
+    } else {
+        trace_dump();
+    }
+}
+
+static void cmd_select_display(cmd_stream_t* s) {
+    // Format: CMD_SELECT_DISPLAY, id (unknown IDs are ignored)
+    ssd1306_select(s->buf[1]);
+}
+
+static void cmd_frame(cmd_stream_t* s) {
+    // Format: CMD_FRAME, page_start, page_count, then page_count *
+    // SSD1306_WIDTH bytes of page-format pixels streamed by stream_feed().
+    // Pages past the bottom stream through too: ssd1306_write_pages() drops
+    // them, so they are not counted as parser overflows
+    s->frame_offset = s->buf[1] * SSD1306_WIDTH;
+    s->frame_remaining = s->buf[2] * SSD1306_WIDTH;
+}
+
+static void cmd_gfx(cmd_stream_t* s) {
+    // Format: CMD_GFX, op, mode, args (see GFX_OP_*)
+    uint8_t mode = s->buf[2];
+    const uint8_t* a = &s->buf[3];
+
+    switch (s->buf[1]) {
+        case GFX_OP_PIXEL:       gfx_pixel(a[0], a[1], mode); break;
+        case GFX_OP_LINE:        gfx_line(a[0], a[1], a[2], a[3], mode); break;
+        case GFX_OP_RECT:        gfx_rect(a[0], a[1], a[2], a[3], mode); break;
+        case GFX_OP_FILL_RECT:   gfx_fill_rect(a[0], a[1], a[2], a[3], mode); break;
+        case GFX_OP_CIRCLE:      gfx_circle(a[0], a[1], a[2], mode); break;
+        case GFX_OP_FILL_CIRCLE: gfx_fill_circle(a[0], a[1], a[2], mode); break;
+        case GFX_OP_CLIP:        gfx_set_clip(a[0], a[1], a[2], a[3]); break;
+
+        case GFX_OP_BITMAP:
+        {
+            // Oversize bitmaps were truncated by the framing: draw whole rows only
+            int stride = (a[2] + 7) / 8;
+            int rows = stride ? (s->pos - 7) / stride : 0;
+            gfx_bitmap(a[0], a[1], a[2], rows < a[3] ? rows : a[3], &s->buf[7], mode);
             break;
-        case CMD_BRIGHTNESS:
-            // Format: CMD_BRIGHTNESS, brightness_level (0-255)
-            if (serial_buf_pos >= 2) {
-                uint8_t brightness = serial_buf[1];
-                ssd1306_set_brightness(brightness);
-
-                if (DEBUG_MODE) {
-                    char debug_buf[32];
-                    snprintf(debug_buf, sizeof(debug_buf), "Brightness: %d", brightness);
-                    ssd1306_draw_text(0, 48, debug_buf);
-                }
-            }
+        }
+
+        default:
             break;
+    }
+}
 
-        case CMD_PROGRESS_BAR:
-            // Format: CMD_PROGRESS_BAR, x, y, width, height, progress (0-100)
-            if (serial_buf_pos >= 6) {
-                uint8_t x = serial_buf[1];
-                uint8_t y = serial_buf[2];
-                uint8_t width = serial_buf[3];
-                uint8_t height = serial_buf[4];
-                uint8_t progress = serial_buf[5];
-
-                ssd1306_draw_progress_bar(x, y, width, height, progress);
-
-                if (DEBUG_MODE) {
-                    char debug_buf[32];
-                    snprintf(debug_buf, sizeof(debug_buf), "Progress: %d%%", progress);
-                    ssd1306_draw_text(0, 48, debug_buf);
-                }
-            }
+static void cmd_graph(cmd_stream_t* s) {
+    // Format: CMD_GRAPH, op, id, args (see GRAPH_OP_*)
+    const uint8_t* a = &s->buf[3];
+    switch (s->buf[1]) {
+        case GRAPH_OP_SETUP:  graph_setup(s->buf[2], a[0], a[1], a[2], a[3], a[4], a[5], a[6]); break;
+        case GRAPH_OP_SAMPLE: graph_push(s->buf[2], a[0]); break;
+        case GRAPH_OP_SCALE:  graph_set_scale(s->buf[2], a[0], a[1]); break;
+        case GRAPH_OP_DELETE: graph_delete(s->buf[2]); break;
+        default: break;
+    }
+}
+
+static void cmd_menu(cmd_stream_t* s) {
+    // Format: CMD_MENU, op, args (see MENU_OP_*)
+    switch (s->buf[1]) {
+        case MENU_OP_RESET: menu_reset(); break;
+        case MENU_OP_ITEM:
+            menu_add_item(s->buf[2], s->buf[3], s->buf[4], s->buf[5], &s->buf[7], s->pos - 7);
             break;
+        case MENU_OP_OPEN:  menu_open_level(s->buf[2]); break;
+        case MENU_OP_CLOSE: menu_close(); break;
+        default: break;
+    }
+}
 
-        case CMD_POWER:
-            // Format: CMD_POWER, value (0 or 1)
-            if (serial_buf_pos >= 2) {
-                bool power = serial_buf[1] > 0;
-                ssd1306_power(power);
+static void cmd_anim(cmd_stream_t* s) {
+    // Format: CMD_ANIM, op, slot, args (see ANIM_OP_*)
+    uint8_t slot = s->buf[2];
+    const uint8_t* a = &s->buf[3];
+    switch (s->buf[1]) {
+        case ANIM_OP_STOP:         anim_stop(slot); break;
+        case ANIM_OP_BLINK:        anim_blink(slot, a[0], a[1], a[2], a[3], a[4], a[5]); break;
+        case ANIM_OP_SLIDE:        anim_slide(slot, a[0], a[1], a[2], a[3], (int8_t)a[4], a[5]); break;
+        case ANIM_OP_CONTRAST:     anim_contrast(slot, a[0], a[1]); break;
+        case ANIM_OP_INVERT_PULSE: anim_invert_pulse(slot, a[0], a[1]); break;
+        default: break;
+    }
+}
 
-                if (DEBUG_MODE) {
-                    ssd1306_draw_text(0, 48, power ? "Power: ON" : "Power: OFF");
-                }
-            }
+static void cmd_capture(cmd_stream_t* s) {
+    // Format: CMD_CAPTURE, flags (CAPTURE_FLAG_RLE). The reply is
+    // streamed by the main loop; a previous one is finished first.
+    capture_send(true);
+    capture_start(s->buf[1]);
+    capture_stream = s;
+}
+
+static void cmd_macro(cmd_stream_t* s) {
+    // Format: CMD_MACRO, op, args (see MACRO_OP_*)
+    uint8_t id = s->buf[2];
+    switch (s->buf[1]) {
+        case MACRO_OP_BEGIN:
+            macro_end();
+            macro_recorder = macro_begin(id) ? s : NULL;
             break;
+        case MACRO_OP_END:
+            macro_end();
+            macro_recorder = NULL;
+            break;
+        case MACRO_OP_PLAY:
+        {
+            uint8_t len = s->buf[3];
+            if (len > s->pos - 4) len = s->pos - 4;
+            play_macro(s, id, &s->buf[4], len);
+            break;
+        }
+        case MACRO_OP_DELETE: macro_delete(id); break;
+        case MACRO_OP_SAVE:   macro_save(); break;
+        default: break;
+    }
+}
 
-        default:
-            // Unknown command
-            if (DEBUG_MODE) {
-                char debug_buf[32];
-                snprintf(debug_buf, sizeof(debug_buf), "Unknown CMD: %02X", serial_buf[0]);
-                ssd1306_draw_text(0, 48, debug_buf);
-            }
+static void cmd_packet(cmd_stream_t* s) {
+    // Format: CMD_PACKET, on (1: later commands arrive in CRC-framed packets)
+    bool on = s->buf[1] > 0;
+    if (!s->packet || on == s->packet_mode) return;
+    s->packet_mode = on;
+    s->packet_len = 0;
+    s->packet_need = PACKET_HEADER_LEN;
+}
+
+static void cmd_grid(cmd_stream_t* s) {
+    // Format: CMD_GRID, op, args (see GRID_OP_*)
+    uint8_t id = ssd1306_selected();
+    const uint8_t* a = &s->buf[2];
+    switch (s->buf[1]) {
+        case GRID_OP_WRITE:
+        {
+            // Runs longer than MAX_CMD_SIZE were truncated by the framing
+            uint8_t len = a[3] < s->pos - 6 ? a[3] : s->pos - 6;
+            grid_write(id, a[0], a[1], a[2], &s->buf[6], len);
             break;
+        }
+        case GRID_OP_ATTR:   grid_set_attr(id, a[0], a[1], a[2], a[3]); break;
+        case GRID_OP_REDRAW: grid_redraw(id); break;
+        default: break;
+    }
+}
+
+#ifdef ENABLE_TEST_COMMANDS
+static void cmd_test(cmd_stream_t* s) {
+    // Format: CMD_TEST, subcommand (see TEST_SUBCMD_*), arguments
+    handle_test_command(s->buf[1], &s->buf[2]);
+}
+#endif
+
+// Descriptor flags
+#define CMD_FLAG_QUERY     0x01  // Only reads state: not idle activity
+#define CMD_FLAG_IMMEDIATE 0x02  // Replies, streams a payload, writes flash or
+                                 // controls macros: runs even while recording
+#define CMD_FLAG_TEXT      0x04  // Completed by stream_text_timeout() if it stalls
+
+typedef struct {
+    uint8_t size;                   // Fixed length, or header length when length
+                                    // is set (0 = unknown opcode)
+    cmd_length_fn length;           // Variable-length commands (NULL = fixed)
+    void (*handler)(cmd_stream_t* s);
+    uint8_t flags;                  // CMD_FLAG_*
+} cmd_desc_t;
+
+typedef struct {
+    uint8_t opcode;
+    cmd_desc_t desc;
+} cmd_entry_t;
+
+// The command set: framing and dispatch both come from here, so a new
+// command is one row (plus its handler)
+static constexpr cmd_entry_t cmd_entries[] = {
+    { CMD_CLEAR,          { 1, NULL,              cmd_clear,          0 } },
+    { CMD_DRAW_TEXT,      { 4, text_length,       cmd_draw_text,      CMD_FLAG_TEXT } },
+    { CMD_SET_CURSOR,     { 3, NULL,              cmd_set_cursor,     0 } },
+    { CMD_INVERT,         { 2, NULL,              cmd_invert,         0 } },
+    { CMD_BRIGHTNESS,     { 2, NULL,              cmd_brightness,     0 } },
+    { CMD_PROGRESS_BAR,   { 6, NULL,              cmd_progress_bar,   0 } },
+    { CMD_POWER,          { 2, NULL,              cmd_power,          0 } },
+    { CMD_INPUT_CONFIG,   { 8, NULL,              cmd_input_config,   0 } },
+    { CMD_CONFIG_SET,     { 3, config_set_length, cmd_config_set,     CMD_FLAG_IMMEDIATE } },
+    { CMD_CONFIG_RESET,   { 1, NULL,              cmd_config_reset,   CMD_FLAG_IMMEDIATE } },
+    { CMD_SPLASH,         { 2, NULL,              cmd_splash,         CMD_FLAG_IMMEDIATE } },
+    { CMD_BOOT_TIME,      { 1, NULL,              cmd_boot_time,      CMD_FLAG_QUERY | CMD_FLAG_IMMEDIATE } },
+    { CMD_STATUS,         { 2, NULL,              cmd_status,         CMD_FLAG_QUERY | CMD_FLAG_IMMEDIATE } },
+    { CMD_TRACE,          { 2, NULL,              cmd_trace,          CMD_FLAG_QUERY | CMD_FLAG_IMMEDIATE } },
+    { CMD_SELECT_DISPLAY, { 2, NULL,              cmd_select_display, 0 } },
+    { CMD_FRAME,          { 3, NULL,              cmd_frame,          CMD_FLAG_IMMEDIATE } },  // + streamed payload
+    { CMD_GFX,            { 2, gfx_length,        cmd_gfx,            0 } },
+    { CMD_GRAPH,          { 2, graph_length,      cmd_graph,          0 } },
+    { CMD_MENU,           { 2, menu_length,       cmd_menu,           0 } },
+    { CMD_ANIM,           { 2, anim_length,       cmd_anim,           0 } },
+    { CMD_CAPTURE,        { 2, NULL,              cmd_capture,        CMD_FLAG_QUERY | CMD_FLAG_IMMEDIATE } },
+    { CMD_MACRO,          { 2, macro_length,      cmd_macro,          CMD_FLAG_IMMEDIATE } },
+    { CMD_PACKET,         { 2, NULL,              cmd_packet,         CMD_FLAG_IMMEDIATE } },
+    { CMD_GRID,           { 2, grid_length,       cmd_grid,           0 } },
+#ifdef ENABLE_TEST_COMMANDS
+    { CMD_TEST,           { 2, test_length,       cmd_test,           CMD_FLAG_QUERY | CMD_FLAG_IMMEDIATE } },
+#endif
+};
+
+// Flat table indexed by opcode, built at compile time from cmd_entries
+typedef struct {
+    cmd_desc_t desc[256];
+} cmd_table_t;
+
+static constexpr cmd_table_t make_cmd_table() {
+    cmd_table_t table = {};
+    for (const cmd_entry_t& e : cmd_entries) table.desc[e.opcode] = e.desc;
+    return table;
+}
+
+static constexpr bool cmd_entries_valid() {
+    uint32_t count = sizeof(cmd_entries) / sizeof(cmd_entries[0]);
+    for (uint32_t i = 0; i < count; i++) {
+        const cmd_desc_t& d = cmd_entries[i].desc;
+        if (d.size == 0 || d.size > MAX_CMD_SIZE || d.handler == NULL) return false;
+        for (uint32_t j = i + 1; j < count; j++) {
+            if (cmd_entries[j].opcode == cmd_entries[i].opcode) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(cmd_entries_valid(), "cmd_entries: duplicate opcode or bad descriptor");
+
+static constexpr cmd_table_t cmd_table = make_cmd_table();
+
+// Handles a command once fully received on stream s
+static void handle_command(cmd_stream_t* s) {
+    // Check for minimum command length (1 byte for command type at least)
+    if (s->pos < 1) return;
+
+    const cmd_desc_t* d = &cmd_table.desc[s->buf[0]];
+    reply_stream = s;
+
+    // Recording a macro: store the command instead of running it
+    if (s == macro_recorder && !(d->flags & CMD_FLAG_IMMEDIATE)) {
+        macro_append(s->buf, s->pos);
+    } else {
+        stats_count_command(s->buf[0]);
+        TRACE_BEGIN(TRACE_EV_COMMAND, s->buf[0]);
+
+        // Anything but a query counts as activity (wakes idle panels first, so
+        // e.g. a brightness change is not undone by the wake)
+        if (!(d->flags & CMD_FLAG_QUERY)) {
+            power_activity();
+        }
+
+        // Debug info should only be displayed if debug mode is enabled
+        if (DEBUG_MODE) {
+            char debug_buf[32];
+            snprintf(debug_buf, sizeof(debug_buf), "CMD: %02X LEN: %d", s->buf[0], s->pos);
+            // Save current display content to draw debug info at bottom
+            ssd1306_draw_text(0, 56, debug_buf);
+        }
+
+        if (d->handler) {
+            d->handler(s);
+        } else if (DEBUG_MODE) {
+            char debug_buf[32];
+            snprintf(debug_buf, sizeof(debug_buf), "Unknown CMD: %02X", s->buf[0]);
+            ssd1306_draw_text(0, 48, debug_buf);
+        }
+
+        TRACE_END(TRACE_EV_COMMAND, s->buf[0]);
     }
 
     // Reset buffer position for next command
-    serial_buf_pos = 0;
+    s->pos = 0;
+    s->need = 1;
+    s->text_pending = false;
+}
+
+// Drop any partially received command on stream s
+static void stream_reset(cmd_stream_t* s) {
+    if (s == macro_recorder) {
+        macro_end();
+        macro_recorder = NULL;
+    }
+    s->pos = 0;
+    s->need = 1;
+    s->skip = 0;
+    s->frame_remaining = 0;
+    s->text_pending = false;
+    s->packet_mode = false;
+    s->packet_len = 0;
+    s->packet_need = PACKET_HEADER_LEN;
 }
 
 // CDC callback when line state changes
@@ -233,130 +944,213 @@ void tud_cdc_line_state_cb(uint8_t itf, bool dtr, bool rts) {
 
     // When DTR is deasserted, reset the command buffer
     if (!dtr) {
-        serial_buf_pos = 0;
-        text_cmd_pending = false;
+        stream_reset(&cdc_stream);
     }
 }
 
-// CDC callback when data is received
-void tud_cdc_rx_cb(uint8_t itf) {
-    (void) itf;
-
-    // Process structured commands
-    // Read data until FIFO is empty or buffer is full
-    uint8_t cmd_type = 0;
-    bool has_cmd_type = false;
+// Run one byte through the command framing, executing the command it
+// completes (the CMD_FRAME payload is taken care of by the callers)
+static void parse_byte(cmd_stream_t* s, uint8_t c) {
+    // Drop the tail of a command longer than MAX_CMD_SIZE so it is not
+    // misinterpreted as the next command header
+    if (s->skip > 0) {
+        s->skip--;
+        g_stats.parser_overflows++;
+        return;
+    }
 
-    // If we already have data in the buffer, get the command type
-    if (serial_buf_pos > 0) {
-        cmd_type = serial_buf[0];
-        has_cmd_type = true;
+    // Framing is only looked at once s->need bytes are in: the opcode, then
+    // the header, then the whole command
+    s->buf[s->pos++] = c;
+    if (s->pos < s->need) return;
+
+    const cmd_desc_t* d = &cmd_table.desc[s->buf[0]];
+    uint32_t len = d->size;
+    if (d->length && s->pos >= d->size) len = d->length(s->buf, s->pos);
+
+    if (len == 0) {
+        // Unknown command or op, just reset the buffer
+        g_stats.parser_resyncs++;
+        s->pos = 0;
+        s->need = 1;
+        return;
     }
 
-    // Read available data
-    while (tud_cdc_available() && serial_buf_pos < MAX_CMD_SIZE) {
-        uint8_t c;
-        tud_cdc_read(&c, 1);
+    // Longer commands are cut at MAX_CMD_SIZE and the rest skipped
+    uint32_t framed = len < MAX_CMD_SIZE ? len : MAX_CMD_SIZE;
+    if (s->pos < framed) {
+        s->need = framed;
+        if ((d->flags & CMD_FLAG_TEXT) && s->pos >= d->size && !s->text_pending) {
+            // Still waiting for text bytes — start safety timeout
+            s->text_start = get_absolute_time();
+            s->text_pending = true;
+        }
+        return;
+    }
 
-        // Add byte to buffer
-        serial_buf[serial_buf_pos++] = c;
+    s->skip = len - framed;
+    handle_command(s);
+}
 
-        // If this is the first byte, it's our command type
-        if (serial_buf_pos == 1) {
-            cmd_type = c;
-            has_cmd_type = true;
+// Run the commands of a packet whose CRC matched
+static void packet_run(cmd_stream_t* s, const uint8_t* data, uint32_t len) {
+    s->packet_running = true;
+    while (len > 0) {
+        if (s->frame_remaining > 0) {
+            uint32_t n = s->frame_remaining < len ? s->frame_remaining : len;
+            ssd1306_write_pages(s->frame_offset, data, n);
+            s->frame_offset += n;
+            s->frame_remaining -= n;
+            data += n;
+            len -= n;
+            continue;
         }
+        parse_byte(s, *data++);
+        len--;
     }
 
-    // If buffer is full but CDC still has data, drain excess to prevent
-    // leftover bytes being misinterpreted as the next command header
-    if (serial_buf_pos >= MAX_CMD_SIZE) {
-        uint8_t discard;
-        while (tud_cdc_available()) {
-            tud_cdc_read(&discard, 1);
-        }
+    // A command cut off by the end of the packet is dropped, so a lost packet
+    // cannot shift the framing of the next one
+    if (s->pos > 0 || s->skip > 0 || s->frame_remaining > 0) {
+        g_stats.parser_resyncs++;
+        s->pos = 0;
+        s->need = 1;
+        s->skip = 0;
+        s->frame_remaining = 0;
+        s->text_pending = false;
     }
+    s->packet_running = false;
+}
 
-    // If we don't have at least a command type yet, wait for more data
-    if (!has_cmd_type) return;
+// Take one byte of a packet; false if it completed a bad one
+static bool packet_step(cmd_stream_t* s, uint8_t c) {
+    // Between packets: hunt for the sync byte
+    if (s->packet_len == 0 && c != PACKET_SYNC) {
+        g_stats.packet_dropped_bytes++;
+        return true;
+    }
 
-    // Process commands based on type
-    switch (cmd_type) {
-        case CMD_CLEAR:
-            // Clear command only needs one byte
-            if (serial_buf_pos >= 1) {
-                handle_command();
-            }
-            break;
+    uint8_t* p = s->packet;
+    p[s->packet_len++] = c;
+    if (s->packet_len < s->packet_need) return true;
 
-        case CMD_DRAW_TEXT:
-            // Format: [0x02][x][y][len][text...] — length-based framing
-            if (serial_buf_pos >= 4) {
-                uint8_t text_len = serial_buf[3];
-                if (text_len > MAX_CMD_SIZE - 4) text_len = MAX_CMD_SIZE - 4;
-                if (serial_buf_pos >= (uint8_t)(4 + text_len)) {
-                    // All text bytes received — process immediately
-                    handle_command();
-                    text_cmd_pending = false;
-                } else if (!text_cmd_pending) {
-                    // Still waiting for text bytes — start safety timeout
-                    text_cmd_start = get_absolute_time();
-                    text_cmd_pending = true;
-                }
-            }
-            break;
+    if (s->packet_len == PACKET_HEADER_LEN) {
+        uint16_t len = p[1] | (p[2] << 8);
+        if ((p[1] ^ p[2] ^ 0xFF) != p[3] || len > PACKET_MAX_PAYLOAD) {
+            g_stats.packet_header_errors++;
+            return false;
+        }
+        s->packet_need = PACKET_HEADER_LEN + len + PACKET_CRC_LEN;
+        return true;
+    }
 
-        case CMD_SET_CURSOR:
-            // Set cursor requires 3 bytes
-            if (serial_buf_pos >= 3) {
-                handle_command();
-            }
-            break;
+    uint16_t len = s->packet_len - PACKET_HEADER_LEN - PACKET_CRC_LEN;
+    uint16_t crc = p[s->packet_len - 2] | (p[s->packet_len - 1] << 8);
+    if (crc16_update(0xFFFF, &p[1], PACKET_HEADER_LEN - 1 + len) != crc) {
+        g_stats.packet_crc_errors++;
+        return false;
+    }
 
-        case CMD_INVERT:
-            // Invert requires 2 bytes
-            if (serial_buf_pos >= 2) {
-                handle_command();
-            }
-            break;
+    g_stats.packets_ok++;
+    s->packet_len = 0;
+    s->packet_need = PACKET_HEADER_LEN;
+    packet_run(s, &p[PACKET_HEADER_LEN], len);
+    return true;
+}
 
-        case CMD_BRIGHTNESS:
-            // Brightness requires 2 bytes
-            if (serial_buf_pos >= 2) {
-                handle_command();
-            }
-            break;
+// Feed one byte in packet mode. A bad packet is dropped, but the next one may
+// already have started inside it (after a lost byte, say), so the bytes after
+// its sync byte are scanned again instead of waiting for more input.
+static void packet_feed(cmd_stream_t* s, uint8_t c) {
+    if (packet_step(s, c)) return;
+
+    uint8_t* p = s->packet;
+    uint16_t end = s->packet_len;
+    while (true) {
+        uint16_t sync = 1;
+        while (sync < end && p[sync] != PACKET_SYNC) sync++;
+        g_stats.packet_dropped_bytes += sync;
+        end -= sync;
+        memmove(p, &p[sync], end);
+        s->packet_len = 0;
+        s->packet_need = PACKET_HEADER_LEN;
+
+        // packet_step() writes at packet_len, never ahead of the byte read
+        uint16_t i = 0;
+        while (i < end && packet_step(s, p[i])) i++;
+        if (i == end) return;
+
+        // Bad again at byte i: that packet is p[0..packet_len), the bytes not
+        // rescanned yet follow it
+        memmove(&p[s->packet_len], &p[i + 1], end - i - 1);
+        end = s->packet_len + end - i - 1;
+    }
+}
 
-        case CMD_PROGRESS_BAR:
-            // Progress bar requires 6 bytes
-            if (serial_buf_pos >= 6) {
-                handle_command();
-            }
-            break;
+// Parse everything available on stream s, executing complete commands
+static void stream_feed(cmd_stream_t* s) {
+    // Replies sent while a packet runs service USB: leave new bytes in the
+    // FIFO until it is done, they would land in the buffer being executed
+    if (s->packet_running) return;
+
+    // Consume the FIFO one byte at a time, so commands written back to back
+    // in one USB packet are all executed
+    while (s->available()) {
+        // CMD_FRAME payload goes from the FIFO to the framebuffer in chunks,
+        // bypassing s->buf (and MAX_CMD_SIZE)
+        if (s->frame_remaining > 0) {
+            uint8_t chunk[64];
+            uint32_t n = s->read(chunk, s->frame_remaining < sizeof(chunk) ? s->frame_remaining : sizeof(chunk));
+            ssd1306_write_pages(s->frame_offset, chunk, n);
+            s->frame_offset += n;
+            s->frame_remaining -= n;
+            continue;
+        }
 
-        case CMD_POWER:
-            // Power requires 2 bytes
-            if (serial_buf_pos >= 2) {
-                handle_command();
-            }
-            break;
+        uint8_t c;
+        s->read(&c, 1);
+        if (s->packet_mode) {
+            packet_feed(s, c);
+        } else {
+            parse_byte(s, c);
+        }
+    }
+}
 
-#ifdef ENABLE_TEST_COMMANDS
-        case CMD_TEST:
-            // Test command requires 2 bytes: [0xF0][subcommand]
-            if (serial_buf_pos >= 2) {
-                handle_test_command(serial_buf[1]);
-                serial_buf_pos = 0;
-            }
-            break;
-#endif
+// Safety fallback: run a CMD_DRAW_TEXT whose text stalled (length-based
+// framing should complete before this, but protects against incomplete sends)
+static void stream_text_timeout(cmd_stream_t* s) {
+    if (!s->text_pending || absolute_time_diff_us(s->text_start, get_absolute_time()) < TEXT_CMD_TIMEOUT_US) return;
 
-        default:
-            // Unknown command, just reset the buffer
-            serial_buf_pos = 0;
-            break;
+    // Read any last data that arrived
+    while (s->available() && s->pos < MAX_CMD_SIZE) {
+        s->read(&s->buf[s->pos++], 1);
     }
+    g_stats.parser_timeouts++;
+    handle_command(s);
+}
+
+// CDC callback when data is received
+void tud_cdc_rx_cb(uint8_t itf) {
+    (void) itf;
+    // main() polls USB while the panels power up; commands that arrive then
+    // wait in the FIFO until the displays are initialized
+    if (!boot_display_ready_us) return;
+    stream_feed(&cdc_stream);
+}
 
+// USB device mounted (enumeration complete)
+void tud_mount_cb(void) {
+    if (!boot_usb_mounted_us) boot_usb_mounted_us = time_us_32();
+}
+
+// Bus idle for 3 ms: the host is asleep (handled by power_task())
+void tud_suspend_cb(bool remote_wakeup_en) {
+    power_usb_suspend(remote_wakeup_en);
+}
+
+void tud_resume_cb(void) {
+    power_usb_resume();
 }
 
 // HID callbacks
@@ -384,6 +1178,11 @@ int main() {
     // Initialize board
     stdio_init_all();
 
+    // Load persisted settings before anything that depends on them
+    config_init();
+    macro_init();
+    grid_init();
+
     // Read orientation jumper before USB init (so product string is correct)
     gpio_init(ORIENTATION_PIN);
     gpio_set_dir(ORIENTATION_PIN, GPIO_IN);
@@ -391,43 +1190,95 @@ int main() {
     sleep_us(10); // Let pull-up settle
     g_portrait = !gpio_get(ORIENTATION_PIN); // LOW = portrait, HIGH = landscape
 
+    // A stored orientation overrides the jumper
+    uint8_t orientation = config_get_u8(CFG_KEY_ORIENTATION, CFG_ORIENTATION_JUMPER);
+    if (orientation == CFG_ORIENTATION_LANDSCAPE) g_portrait = false;
+    if (orientation == CFG_ORIENTATION_PORTRAIT) g_portrait = true;
+
     // Initialize TinyUSB
     tusb_init();
 
-    // Initialize the SSD1306 OLED display
-    ssd1306_init();
+    // Let USB enumerate while the panel supply settles
+    while (!time_reached(from_us_since_boot(SSD1306_POWERUP_US))) {
+        tud_task();
+    }
+
+    // Initialize the OLED display(s) (shows stored splash, if any)
+    bool splash = ssd1306_init();
+    if (!splash) {
+        ssd1306_draw_text(0, 0, "Booting.......");
+        ssd1306_flush_task();
+    }
+    boot_display_ready_us = time_us_32();
 
     // Initialize the rotary encoder
     setup_rotary_encoder();
 
-    // Display startup message - only show briefly
-    ssd1306_clear();
-    //ssd1306_draw_text(0, 0, "USB HID Display");
-    ssd1306_draw_text(0, 0, "Booting.......");
-    //ssd1306_draw_text(0, 16, "Ready...");
-    
-    // Wait a moment to show startup message then clear
-    sleep_ms(2000);
-    //ssd1306_clear();
+    // Apply stored input timing and power saving (brightness/invert are
+    // applied by ssd1306_init)
+    uint8_t timing_bytes[7];
+    if (config_get(CFG_KEY_INPUT_TIMING, timing_bytes, sizeof(timing_bytes)) == sizeof(timing_bytes)) {
+        apply_config(CFG_KEY_INPUT_TIMING, timing_bytes, sizeof(timing_bytes));
+    }
+    uint8_t power_bytes[6];
+    if (config_get(CFG_KEY_POWER_SAVE, power_bytes, sizeof(power_bytes)) == sizeof(power_bytes)) {
+        apply_config(CFG_KEY_POWER_SAVE, power_bytes, sizeof(power_bytes));
+    }
+
+    // No startup delay: the boot screen stays up until the host draws, and
+    // commands are accepted as soon as USB is mounted
 
     // Main loop
+    uint32_t loop_start_us = time_us_32();
     while (1) {
+        // Host suspended the bus: sleep until it resumes (not counted as loop time)
+        if (power_suspended()) {
+            config_task();  // Batched settings still reach flash
+            power_suspend_sleep();
+            loop_start_us = time_us_32();
+            continue;
+        }
+
+        // Track the longest iteration (input latency upper bound)
+        uint32_t loop_now_us = time_us_32();
+        if (loop_now_us - loop_start_us > g_stats.loop_max_us) {
+            g_stats.loop_max_us = loop_now_us - loop_start_us;
+        }
+        loop_start_us = loop_now_us;
+        TRACE_INSTANT(TRACE_EV_LOOP, 0);
+
         // TinyUSB device task
         tud_task();
 
+        // Pass the next part of a framebuffer capture to the TX FIFO
+        capture_send(false);
+
         // Process rotary encoder
         process_rotary_encoder();
 
-        // Safety fallback: flush CMD_DRAW_TEXT if transfer stalls (length-based
-        // framing should complete before this, but protects against incomplete sends)
-        if (text_cmd_pending && absolute_time_diff_us(text_cmd_start, get_absolute_time()) >= TEXT_CMD_TIMEOUT_US) {
-            // Read any last data that arrived
-            while (tud_cdc_available() && serial_buf_pos < MAX_CMD_SIZE) {
-                tud_cdc_read(&serial_buf[serial_buf_pos++], 1);
-            }
-            handle_command();
-            text_cmd_pending = false;
-        }
+        // Complete CMD_DRAW_TEXT commands whose text stalled
+        stream_text_timeout(&cdc_stream);
+#if CFG_TUD_VENDOR
+        stream_text_timeout(&vendor_stream);
+#endif
+
+        // Advance animations on their frame tick (drops frames when behind)
+        anim_task();
+
+        // Blink character grid cells
+        grid_task();
+
+        // Send framebuffer changes (bounded per iteration, panels interleaved)
+        ssd1306_flush_task();
+
+        // Bring a failed display back (bus clear, re-init, framebuffer re-upload)
+        ssd1306_recover_task();
+
+        // Write batched setting changes to flash once the host goes quiet
+        config_task();
+
+        // Dim / switch off idle panels, pixel shift, enter USB suspend
+        power_task();
 
 #ifdef ENABLE_TEST_COMMANDS
         // Fire pending test event (delayed button release or second nav event)
@@ -447,6 +1298,12 @@ int main() {
                 // Handle incoming data with appropriate callback
                 tud_cdc_rx_cb(0);
             }
+#if CFG_TUD_VENDOR
+            // Same command stream over the vendor bulk interface
+            if (tud_vendor_available()) {
+                stream_feed(&vendor_stream);
+            }
+#endif
             
             // Give USB stack time to process data
             tud_task();
@@ -8,18 +8,70 @@
 #include "hardware/gpio.h"
 #include "pico/unique_id.h"
 #include "tusb.h"
+#include "display_config.h"
 
 // Orientation jumper: GPIO 27 to GND = portrait, floating (pull-up) = landscape
 #define ORIENTATION_PIN 27
 extern bool g_portrait;
 
-// I2C defines
+// Rotary encoder GPIO pins
+#define ROTARY_CLK_PIN  10
+#define ROTARY_DT_PIN   11
+#define ROTARY_SW_PIN   12
+
+//gpio config for up/down/left/right directional buttons
+#define LEFT_BTN_PIN    7  // REL_X value -5
+#define RIGHT_BTN_PIN   6  // REL_X value 5
+#define TOP_BTN_PIN     15 // REL_Y value 5(mapped to down button)
+#define BOT_BTN_PIN     8  // REL_Y value -5(mapped to up button)
+#define ENTER_BTN_PIN   14 // MOUSE_BTN_LEFT (active-low, directly connected)
+
+// True if a pin is one of the inputs above: display wiring must not use them
+#define PIN_IS_INPUT(pin) ((pin) == ROTARY_CLK_PIN || (pin) == ROTARY_DT_PIN || (pin) == ROTARY_SW_PIN || \
+                           (pin) == LEFT_BTN_PIN || (pin) == RIGHT_BTN_PIN || (pin) == TOP_BTN_PIN || \
+                           (pin) == BOT_BTN_PIN || (pin) == ENTER_BTN_PIN || (pin) == ORIENTATION_PIN)
+
+// I2C defines (DISPLAY_TRANSPORT=I2C)
 #define I2C_PORT        i2c0
 #define I2C_SDA_PIN     4
 #define I2C_SCL_PIN     5
+#ifndef I2C_BAUD_MAX
+#define I2C_BAUD_MAX    1000000  // Fast-mode Plus, tried first (set by CMake)
+#endif
+#define I2C_BAUD_SAFE   400000   // Fast-mode fallback after bus errors
+
+// 4-wire SPI defines (DISPLAY_TRANSPORT=SPI)
+#define SPI_PORT        spi0
+#define SPI_SCK_PIN     2
+#define SPI_MOSI_PIN    3
+#define SPI_CS_PIN      1
+#define SPI_DC_PIN      0
+#define SPI_RST_PIN     9
+#define SPI_BAUD_MAX    10000000 // SSD1306 max serial clock (100ns cycle)
+#define SPI_BAUD_SAFE   4000000
+
+// Number of panels driven (DISPLAY_COUNT=2 adds a second one, set by CMake)
+#ifndef DISPLAY_COUNT
+#define DISPLAY_COUNT   1
+#endif
+
+// Second panel: same I2C bus at 0x3D by default; set DISPLAY2_I2C_PORT to
+// i2c1 with its own pins for a separate bus. On SPI it has its own CS/RST.
+#ifndef DISPLAY2_I2C_PORT
+#define DISPLAY2_I2C_PORT   i2c0
+#define DISPLAY2_SDA_PIN    I2C_SDA_PIN
+#define DISPLAY2_SCL_PIN    I2C_SCL_PIN
+#endif
+#define DISPLAY2_ADDR       0x3D
+#define DISPLAY2_CS_PIN     13
+#define DISPLAY2_RST_PIN    16
 
 // SSD1306 defines
 #define SSD1306_ADDR    0x3C
+#define SSD1306_WIDTH   (DISPLAY_DESC.width)   // Geometry from display_config.h
+#define SSD1306_HEIGHT  (DISPLAY_DESC.height)
+#define SSD1306_BUFFER_SIZE (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+#define SSD1306_POWERUP_US  100000  // Panel supply settle time, measured from boot
 
 // Serial protocol commands
 #define CMD_CLEAR        0x01
@@ -29,34 +81,421 @@ extern bool g_portrait;
 #define CMD_BRIGHTNESS   0x05
 #define CMD_PROGRESS_BAR 0x06
 #define CMD_POWER        0x07
-#define CMD_TEST         0xF0  // Test/debug command (enabled by ENABLE_TEST_COMMANDS)
+#define CMD_INPUT_CONFIG 0x08  // Auto-repeat / long-press timing
+#define CMD_CONFIG_SET   0x09  // Persist a setting to flash
+#define CMD_CONFIG_RESET 0x0A  // Erase all persisted settings
+#define CMD_SPLASH       0x0B  // Save/erase boot splash image
+#define CMD_BOOT_TIME    0x0C  // Query boot timing (replies over CDC)
+#define CMD_STATUS       0x0D  // Query status/performance counters (replies over CDC)
+#define CMD_TRACE        0x0E  // Dump/clear trace ring buffer (ENABLE_TRACE builds)
+#define CMD_SELECT_DISPLAY 0x0F  // Target later drawing commands at a display ID
+#define CMD_FRAME        0x10  // Bulk framebuffer upload, streamed from the CDC FIFO
+#define CMD_GFX          0x11  // Graphics primitive: [0x11][op][mode][args...]
+
+// CMD_GFX operations and their argument bytes (after [op][mode])
+#define GFX_OP_PIXEL       0x00  // x, y
+#define GFX_OP_LINE        0x01  // x0, y0, x1, y1
+#define GFX_OP_RECT        0x02  // x, y, w, h
+#define GFX_OP_FILL_RECT   0x03  // x, y, w, h
+#define GFX_OP_CIRCLE      0x04  // cx, cy, r
+#define GFX_OP_FILL_CIRCLE 0x05  // cx, cy, r
+#define GFX_OP_BITMAP      0x06  // x, y, w, h, rows... ((w + 7) / 8 bytes per row)
+#define GFX_OP_CLIP        0x07  // x, y, w, h (w or h = 0: whole screen)
+
+// CMD_GFX draw modes
+#define GFX_MODE_SET       0x00
+#define GFX_MODE_CLEAR     0x01
+#define GFX_MODE_XOR       0x02
+
+#define CMD_GRAPH        0x12  // Sparkline graph: [0x12][op][id][args...]
+
+// CMD_GRAPH operations and their argument bytes (after [op][id])
+#define GRAPH_OP_SETUP     0x00  // x, y, w, h, min, max, flags
+#define GRAPH_OP_SAMPLE    0x01  // value
+#define GRAPH_OP_SCALE     0x02  // min, max
+#define GRAPH_OP_DELETE    0x03  // (none)
+
+#define GRAPH_FLAG_FILL    0x01  // Filled area instead of a line
+
+#ifndef GRAPH_COUNT
+#define GRAPH_COUNT        4     // Graphs defined at once (~140 bytes RAM each)
+#endif
+
+#define CMD_MENU         0x13  // Local menu: [0x13][op][args...]
+
+// CMD_MENU operations and their argument bytes (after [op])
+#define MENU_OP_RESET      0x00  // (none): drop the tree, close the menu
+#define MENU_OP_ITEM       0x01  // id, parent, type, flags, len, label...
+#define MENU_OP_OPEN       0x02  // id of the submenu to show (0 = top level)
+#define MENU_OP_CLOSE      0x03  // (none)
+
+// Unsolicited device -> host events: [0x13][event][id][value]
+#define MENU_EVENT_SELECTED 0x80 // Item activated; value = toggle state
+#define MENU_EVENT_CLOSED   0x81 // Backed out of the top level
+
+// Item types
+#define MENU_ITEM_ACTION   0x00  // Reports MENU_EVENT_SELECTED
+#define MENU_ITEM_SUBMENU  0x01  // Opens its children
+#define MENU_ITEM_TOGGLE   0x02  // Flips its check mark locally, then reports
+#define MENU_ITEM_BACK     0x03  // Goes to the parent level
+
+#define MENU_FLAG_CHECKED  0x01  // Initial MENU_ITEM_TOGGLE state
+
+#define MENU_MAX_ITEMS     32
+#define MENU_LABEL_LEN     (SSD1306_WIDTH / 8 - 1)  // Last column holds '>' / '*'
+
+// Navigation keys fed to menu_input() by the input scanner
+#define MENU_KEY_NEXT      0
+#define MENU_KEY_PREV      1
+#define MENU_KEY_SELECT    2
+#define MENU_KEY_BACK      3
+
+#define CMD_ANIM         0x14  // Animation: [0x14][op][slot][args...]
+
+// CMD_ANIM operations and their argument bytes (after [op][slot])
+#define ANIM_OP_STOP         0x00  // (none); slot ANIM_SLOT_ALL stops every slot
+#define ANIM_OP_BLINK        0x01  // x, y, w, h, period, count
+#define ANIM_OP_SLIDE        0x02  // x, y, w, h, dx (signed), frames
+#define ANIM_OP_CONTRAST     0x03  // target, frames
+#define ANIM_OP_INVERT_PULSE 0x04  // period, count
+
+#define ANIM_SLOT_ALL      0xFF
+#define ANIM_SLOTS         4
+#define ANIM_FRAME_US      25000  // 40 frames/s: a full frame fits at 400 kHz I2C
+
+#define CMD_CAPTURE      0x15  // Read back the selected framebuffer: [0x15][flags]
+
+// CMD_CAPTURE reply: [0x15][len_lo][len_hi][encoding][display][width][height]
+// [flags][pixels...]; pixels are page-format framebuffer bytes, raw or PackBits
+#define CAPTURE_FLAG_RLE      0x01  // Request: PackBits-compress (sent raw if it doesn't shrink)
+#define CAPTURE_FLAG_PORTRAIT 0x01  // Reply: framebuffer is rotated 180 degrees
+#define CAPTURE_ENC_RAW       0x00
+#define CAPTURE_ENC_PACKBITS  0x01
+#define CAPTURE_HEADER_LEN    5     // encoding, display, width, height, flags
+
+#define CMD_MACRO        0x16  // Command macro: [0x16][op][args...]
+
+// CMD_MACRO operations and their argument bytes (after [op])
+#define MACRO_OP_BEGIN     0x00  // id: record the following commands into macro id
+#define MACRO_OP_END       0x01  // (none): stop recording
+#define MACRO_OP_PLAY      0x02  // id, len, params... (NUL-separated text parameters)
+#define MACRO_OP_DELETE    0x03  // id (MACRO_ALL: every macro)
+#define MACRO_OP_SAVE      0x04  // (none): persist all macros to flash
+
+#define MACRO_COUNT        8
+#define MACRO_MAX_LEN      256   // Bytes per macro, one length byte per command included
+#define MACRO_ALL          0xFF
+#define MACRO_NONE         0xFF
+#define MACRO_PARAM_FIRST  0x01  // Placeholder for parameter 1 in recorded CMD_DRAW_TEXT text
+#define MACRO_PARAM_LAST   0x08  // ... parameter 8
+#define MACRO_STORE_SIZE   (MACRO_COUNT * (2 + MACRO_MAX_LEN))  // Saved image: lengths + data
+
+#define CMD_PACKET       0x17  // CRC-framed packets on this port: [0x17][on]
+
+// Packet mode (CMD_PACKET 1, until CMD_PACKET 0 or the port is closed): all
+// commands travel in [0xA5][len_lo][len_hi][check][payload][crc_lo][crc_hi]
+// with check = len_lo ^ len_hi ^ 0xFF and crc = CRC-16/CCITT-FALSE over the
+// bytes between sync and crc. A payload holds whole commands; a bad packet is
+// dropped and the parser hunts for the next sync byte. Replies are unframed.
+#define PACKET_SYNC        0xA5
+#define PACKET_HEADER_LEN  4
+#define PACKET_CRC_LEN     2
+#define PACKET_MAX_PAYLOAD (3 + SSD1306_BUFFER_SIZE)  // One full-screen CMD_FRAME
+
+#define CMD_GRID         0x18  // Character grid: [0x18][op][args...]
+
+// CMD_GRID operations and their argument bytes (after [op]); they act on the
+// selected display, CMD_CLEAR blanks its grid
+#define GRID_OP_WRITE      0x00  // row, col, attr, len, chars...: wraps to the next row
+#define GRID_OP_ATTR       0x01  // row, col, count, attr: keeps the characters
+#define GRID_OP_REDRAW     0x02  // (none): draw every cell again
+
+#define GRID_ATTR_INVERSE  0x01  // Light on dark
+#define GRID_ATTR_BLINK    0x02  // Character blanked every other GRID_BLINK_US
+
+#define GRID_COLS          (SSD1306_WIDTH / 8)
+#define GRID_ROWS          (SSD1306_HEIGHT / 8)
+#define GRID_BLINK_US      500000
+
+// CMD_TRACE operations
+#define TRACE_OP_DUMP    0x00
+#define TRACE_OP_CLEAR   0x01
+
+// CMD_SPLASH operations
+#define SPLASH_OP_ERASE  0x00  // Remove stored splash (boot shows "Booting...")
+#define SPLASH_OP_SAVE   0x01  // Store the current framebuffer as splash
+
+#ifdef ENABLE_TEST_COMMANDS
+// Test/debug command, only in builds with ENABLE_TEST_COMMANDS
+#define CMD_TEST         0xF0
 
 // Test command subcommands
-#define TEST_SUBCMD_PING       0x00
-#define TEST_SUBCMD_ROTATE_CW  0x01
-#define TEST_SUBCMD_ROTATE_CCW 0x02
-#define TEST_SUBCMD_BTN_PRESS  0x03
-#define TEST_SUBCMD_NAV_UP     0x04
-#define TEST_SUBCMD_NAV_DOWN   0x05
-#define TEST_SUBCMD_NAV_LEFT   0x06
-#define TEST_SUBCMD_NAV_RIGHT  0x07
+#define TEST_SUBCMD_PING        0x00
+#define TEST_SUBCMD_ROTATE_CW   0x01
+#define TEST_SUBCMD_ROTATE_CCW  0x02
+#define TEST_SUBCMD_BTN_PRESS   0x03
+#define TEST_SUBCMD_NAV_UP      0x04
+#define TEST_SUBCMD_NAV_DOWN    0x05
+#define TEST_SUBCMD_NAV_LEFT    0x06
+#define TEST_SUBCMD_NAV_RIGHT   0x07
+#define TEST_SUBCMD_FB_CHECKSUM 0x08  // Reply [0xF0][0x08][display][crc_lo][crc_hi][pending]
+#define TEST_SUBCMD_BUS_STATS   0x09  // Reply [0xF0][0x09][transactions:4][bytes:4][failures:4][pending]
+#define TEST_SUBCMD_GPIO        0x0A  // [pin][level]: force an input pin's level as the scanner sees it
+
+#define TEST_GPIO_RELEASE       0xFF  // TEST_SUBCMD_GPIO level: back to the real pin
+#endif // ENABLE_TEST_COMMANDS
 
 // Buffer sizes
 #define MAX_CMD_SIZE     128
 
+// Status/performance counters returned by CMD_STATUS
+// Reply: [0x0D][len_lo][len_hi][device_stats_t] (little-endian, all fields 32-bit)
+#define STATUS_FLAG_RESET      0x01  // CMD_STATUS flag: zero counters after reading
+#define STATS_VERSION          3
+#define STATS_CMD_SLOTS        64    // Per-opcode counters; last slot counts opcodes >= 63
+#define STATS_LATENCY_BUCKETS  8     // Flush latency: <250us, <500us, <1ms, ... <16ms, >=16ms
+#define STATS_LATENCY_BASE_US  250
+
+#define STATS_FLAG_DISPLAY_OK  0x01  // All panels responding
+#define STATS_FLAG_PORTRAIT    0x02
+
+typedef struct {
+    uint32_t version;           // STATS_VERSION
+    uint32_t uptime_ms;
+    uint32_t flags;             // STATS_FLAG_*
+    uint32_t i2c_transactions;
+    uint32_t i2c_bytes;         // Including control bytes
+    uint32_t i2c_failures;
+    uint32_t i2c_retries;
+    uint32_t parser_resyncs;    // Unknown opcode: buffer discarded
+    uint32_t parser_overflows;  // Bytes drained after a command overflowed MAX_CMD_SIZE
+    uint32_t parser_timeouts;   // CMD_DRAW_TEXT completed by TEXT_CMD_TIMEOUT_US
+    uint32_t hid_sent;
+    uint32_t hid_dropped;       // HID endpoint busy or not mounted
+    uint32_t loop_max_us;       // Longest main loop iteration
+    uint32_t display_recoveries; // Bus clear + re-init attempts
+    uint32_t i2c_baud;          // Current display bus speed (Hz; SPI clock on SPI builds)
+    uint32_t packets_ok;        // CMD_PACKET mode: packets executed
+    uint32_t packet_header_errors; // Length check failed or too long: packet dropped
+    uint32_t packet_crc_errors; // CRC mismatch: packet dropped
+    uint32_t packet_dropped_bytes; // Bytes skipped while hunting for PACKET_SYNC
+    uint32_t flush_latency[STATS_LATENCY_BUCKETS];  // Display data writes by duration
+    uint32_t cmd_count[STATS_CMD_SLOTS];             // Commands executed, by opcode
+} device_stats_t;
+
+extern device_stats_t g_stats;
+
+static inline void stats_count_command(uint8_t opcode) {
+    g_stats.cmd_count[opcode < STATS_CMD_SLOTS - 1 ? opcode : STATS_CMD_SLOTS - 1]++;
+}
+
+static inline void stats_record_flush(uint32_t elapsed_us) {
+    int bucket = 0;
+    uint32_t limit = STATS_LATENCY_BASE_US;
+    while (bucket < STATS_LATENCY_BUCKETS - 1 && elapsed_us >= limit) {
+        bucket++;
+        limit <<= 1;
+    }
+    g_stats.flush_latency[bucket]++;
+}
+
 // Function declarations only (no implementations)
-void ssd1306_init();
+// Drawing calls act on the selected display (ssd1306_select, default 0)
+// and only mark the framebuffer dirty; ssd1306_flush_task() sends it.
+bool ssd1306_init();
+bool ssd1306_select(uint8_t id);
+const uint8_t* ssd1306_get_buffer();
+bool ssd1306_is_ok();
+uint32_t ssd1306_bus_speed();
+void ssd1306_flush_task();
+void ssd1306_recover_task();
 void ssd1306_clear();
+void ssd1306_write_pages(uint16_t offset, const uint8_t* data, size_t len);
+uint8_t ssd1306_selected();
+uint8_t* ssd1306_draw_buffer(uint8_t id);
+void ssd1306_mark_dirty(uint8_t id, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end);
+void ssd1306_draw_cell(uint8_t id, uint8_t col, uint8_t row, char c, bool inverse);
 void ssd1306_draw_text(uint8_t x, uint8_t y, const char* text);
 void ssd1306_invert(bool invert);
 void ssd1306_power(bool power);
 void ssd1306_set_cursor(uint8_t x, uint8_t y);
 void ssd1306_set_brightness(uint8_t brightness);
 void ssd1306_draw_progress_bar(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t progress);
+uint8_t ssd1306_get_brightness();
+bool ssd1306_is_inverted();
+bool ssd1306_flush_pending(uint8_t id);
+void ssd1306_set_offset(uint8_t rows);
+bool ssd1306_is_powered();
+
+// 1bpp graphics on the selected display (gfx.cpp)
+void gfx_set_clip(int x, int y, int w, int h);
+void gfx_pixel(int x, int y, uint8_t mode);
+void gfx_line(int x0, int y0, int x1, int y1, uint8_t mode);
+void gfx_rect(int x, int y, int w, int h, uint8_t mode);
+void gfx_fill_rect(int x, int y, int w, int h, uint8_t mode);
+void gfx_circle(int cx, int cy, int r, uint8_t mode);
+void gfx_fill_circle(int cx, int cy, int r, uint8_t mode);
+void gfx_bitmap(int x, int y, int w, int h, const uint8_t* rows, uint8_t mode);
+void gfx_invert_area(uint8_t id, int x, int y, int w, int h);
+void gfx_shift_area(uint8_t id, int x, int y, int w, int h, int dx);
+
+// Sparkline graphs (graph.cpp)
+void graph_setup(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+                 uint8_t min, uint8_t max, uint8_t flags);
+void graph_set_scale(uint8_t id, uint8_t min, uint8_t max);
+void graph_push(uint8_t id, uint8_t value);
+void graph_delete(uint8_t id);
+
+// Local menu (menu.cpp)
+void menu_reset();
+void menu_add_item(uint8_t id, uint8_t parent, uint8_t type, uint8_t flags,
+                   const uint8_t* label, uint8_t len);
+void menu_open_level(uint8_t id);
+void menu_close();
+bool menu_active();
+void menu_input(uint8_t key);
+
+// Animations (anim.cpp)
+void anim_task();
+void anim_stop(uint8_t slot);
+void anim_blink(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t period, uint8_t count);
+void anim_slide(uint8_t slot, uint8_t x, uint8_t y, uint8_t w, uint8_t h, int8_t dx, uint8_t frames);
+void anim_contrast(uint8_t slot, uint8_t target, uint8_t frames);
+void anim_invert_pulse(uint8_t slot, uint8_t period, uint8_t count);
+
+// Character grid (grid.cpp)
+void grid_init();
+void grid_reset(uint8_t id);
+void grid_write(uint8_t id, uint8_t row, uint8_t col, uint8_t attr, const uint8_t* text, uint8_t len);
+void grid_set_attr(uint8_t id, uint8_t row, uint8_t col, uint8_t count, uint8_t attr);
+void grid_redraw(uint8_t id);
+void grid_task();
+
+// Framebuffer capture (capture.cpp); streamed out by main.cpp
+void capture_start(uint8_t flags);
+uint32_t capture_pending(const uint8_t** data);
+void capture_advance(uint32_t n);
+
+// Command macros (macro.cpp); recorded and played back by main.cpp
+void macro_init();
+bool macro_begin(uint8_t id);
+void macro_append(const uint8_t* cmd, uint8_t len);
+void macro_end();
+void macro_delete(uint8_t id);
+void macro_save();
+bool macro_next(uint8_t id, uint16_t* offset, const uint8_t** cmd, uint8_t* len);
+uint8_t macro_substitute(const uint8_t* cmd, uint8_t len, const uint8_t* params, uint8_t params_len,
+                         uint8_t* out);
+
+// Idle power management (power.cpp)
+// Wire format (CFG_KEY_POWER_SAVE, little-endian):
+//   [dim_lo][dim_hi][off_lo][off_hi][dim_contrast][shift_minutes]
+typedef struct {
+    uint16_t dim_seconds;      // Idle time before dimming (0 = never)
+    uint16_t off_seconds;      // Idle time before switching off (0 = never)
+    uint8_t dim_contrast;      // Contrast while dimmed
+    uint8_t shift_minutes;     // Pixel shift interval (0 = off)
+} power_config_t;
+
+#define POWER_DIM_CONTRAST_DEFAULT 0x10
+
+void power_set_config(const power_config_t* config);
+void power_activity();
+bool power_input();
+void power_task();
+
+// USB suspend (power.cpp): panels off and a slow system clock while the host
+// sleeps; input signals remote wakeup if the host allowed it
+#define POWER_SUSPEND_POLL_US   10000   // Input poll interval while suspended
+#define POWER_WAKEUP_HOLDOFF_US 5000    // Bus idle required before remote wakeup
+
+void power_usb_suspend(bool remote_wakeup);
+void power_usb_resume();
+bool power_suspended();
+void power_suspend_sleep();
+
+// Persistent configuration keys (CMD_CONFIG_SET)
+#define CFG_KEY_BRIGHTNESS   0x01  // 1 byte: contrast applied at boot
+#define CFG_KEY_INVERT       0x02  // 1 byte: 0 = normal, 1 = inverted
+#define CFG_KEY_ORIENTATION  0x03  // 1 byte: CFG_ORIENTATION_* (applies from next boot)
+#define CFG_KEY_INPUT_TIMING 0x04  // 7 bytes: CMD_INPUT_CONFIG payload
+#define CFG_KEY_POWER_SAVE   0x05  // 6 bytes: power_config_t wire format
+
+#define CFG_ORIENTATION_JUMPER    0  // Use GPIO jumper (default)
+#define CFG_ORIENTATION_LANDSCAPE 1
+#define CFG_ORIENTATION_PORTRAIT  2
+
+#define CFG_MAX_VALUE_LEN    32
+
+// Flash-backed configuration store
+void config_init();
+int config_get(uint8_t key, uint8_t* buf, uint8_t max_len);
+uint8_t config_get_u8(uint8_t key, uint8_t fallback);
+bool config_set(uint8_t key, const uint8_t* value, uint8_t len);
+void config_reset();
+void config_task();
+
+// Boot splash image (one flash sector below the config store). Saves and the
+// erase are staged in RAM and written by config_task() like settings
+bool config_load_splash(uint8_t* image, size_t len);
+bool config_save_splash(const uint8_t* image, size_t len);
+void config_erase_splash();
+
+// Macro store image (one flash sector below the splash)
+bool config_load_macros(uint8_t* image, size_t len);
+bool config_save_macros(const uint8_t* image, size_t len);
+
+// CRC-16/CCITT-FALSE (poly 0x1021, start with 0xFFFF), table-driven
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, size_t len);
+
+// Display transport (transport_i2c.cpp or transport_spi.cpp, chosen by CMake).
+// Each call is one bus transfer of a command or data stream to display id
+// (0..DISPLAY_COUNT-1); the driver above it never sees control bytes, DC or CS.
+void transport_init(uint8_t id);
+bool transport_commands(uint8_t id, const uint8_t* cmds, size_t len);
+bool transport_data(uint8_t id, const uint8_t* data, size_t len);
+void transport_recover(uint8_t id);     // Bus clear / controller reset, then re-init
+void transport_slow_down(uint8_t id);   // Fall back to the safe bus speed
+uint32_t transport_speed(uint8_t id);   // Current bus clock in Hz
 
 // Rotary encoder functions
 void setup_rotary_encoder();
 void process_rotary_encoder();
+bool input_pending();
+#ifdef ENABLE_TEST_COMMANDS
+bool input_test_set_pin(uint8_t pin, uint8_t level);  // TEST_SUBCMD_GPIO
+#endif
+
+// Direction button auto-repeat and ENTER long-press timing
+// Wire format (CMD_INPUT_CONFIG, little-endian):
+//   [0x08][delay_lo][delay_hi][rate][min][accel][long_lo][long_hi]
+typedef struct {
+    uint16_t repeat_delay_ms;  // Hold time before auto-repeat starts (0 = no repeat)
+    uint8_t repeat_rate_ms;    // First auto-repeat interval
+    uint8_t repeat_min_ms;     // Fastest interval reached by acceleration
+    uint8_t repeat_accel_ms;   // Interval reduction per repeat
+    uint16_t long_press_ms;    // ENTER hold time for long-press (0 = disabled)
+} input_timing_t;
+
+#define INPUT_REPEAT_DELAY_MS_DEFAULT 500
+#define INPUT_REPEAT_RATE_MS_DEFAULT  120
+#define INPUT_REPEAT_MIN_MS_DEFAULT   40
+#define INPUT_REPEAT_ACCEL_MS_DEFAULT 10
+#define INPUT_LONG_PRESS_MS_DEFAULT   0   // Off by default: hosts must opt in to BTN_RIGHT
+
+void input_set_timing(const input_timing_t *timing);
+void input_get_timing(input_timing_t *timing);
+
+// HID mouse button bits
+#define MOUSE_BTN_LEFT   0x01  // ENTER / encoder push
+#define MOUSE_BTN_RIGHT  0x02  // ENTER long-press (held together with left)
+
+// Reply to the current command on the interface it arrived on (CDC or
+// vendor bulk); blocks until sent or the host stops reading
+void cmd_reply(const uint8_t* data, uint32_t len);
+
+// Unsolicited message (e.g. menu events) on the interface the host last used
+void cmd_notify(const uint8_t* data, uint32_t len);
 
 // HID report function (used by rotary encoder and test commands)
 void send_mouse_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel);
@@ -0,0 +1,197 @@
+#include "main.h"
+
+// Retained-mode menu: the host uploads a tree of items once, then the
+// firmware handles navigation locally. While a menu is open, encoder and
+// button input moves the highlight instead of going to the host as HID
+// reports, and only the rows that changed are redrawn. The host hears about
+// selections (and the menu closing) through unsolicited CMD_MENU events.
+//
+// Items are kept in upload order; the children of a submenu are the items
+// whose parent is its ID, in that order (parent 0 = top level).
+
+#define MENU_COLS (SSD1306_WIDTH / 8)
+#define MENU_ROWS (SSD1306_HEIGHT / 8)
+
+typedef struct {
+    uint8_t id;
+    uint8_t parent;
+    uint8_t type;                       // MENU_ITEM_*
+    bool checked;                       // MENU_ITEM_TOGGLE state
+    char label[MENU_LABEL_LEN + 1];
+} menu_item_t;
+
+static menu_item_t items[MENU_MAX_ITEMS];
+static uint8_t item_count = 0;
+
+// Open menu state
+static bool menu_open = false;
+static uint8_t menu_display = 0;
+static uint8_t level = 0;               // Submenu shown (0 = top level)
+static uint8_t entries[MENU_MAX_ITEMS]; // Indices into items[] of its children
+static uint8_t entry_count = 0;
+static uint8_t cursor = 0;              // Highlighted entry
+static uint8_t top = 0;                 // First visible entry
+
+static menu_item_t* find_item(uint8_t id) {
+    for (uint8_t i = 0; i < item_count; i++) {
+        if (items[i].id == id) return &items[i];
+    }
+    return NULL;
+}
+
+static void notify(uint8_t event, uint8_t id, uint8_t value) {
+    uint8_t msg[4] = { CMD_MENU, event, id, value };
+    cmd_notify(msg, sizeof(msg));
+}
+
+// Draw one screen row: label, marker in the last column, highlight if current
+static void draw_row(uint8_t row) {
+    uint8_t entry = top + row;
+    const menu_item_t* item = entry < entry_count ? &items[entries[entry]] : NULL;
+    bool highlight = item && entry == cursor;
+
+    for (uint8_t col = 0; col < MENU_COLS; col++) {
+        char c = ' ';
+        if (item) {
+            if (col == MENU_COLS - 1) {
+                if (item->type == MENU_ITEM_SUBMENU) c = '>';
+                else if (item->type == MENU_ITEM_TOGGLE && item->checked) c = '*';
+            } else if (col < MENU_LABEL_LEN && item->label[col]) {
+                c = item->label[col];   // NUL-padded: spaces after the end
+            }
+        }
+        ssd1306_draw_cell(menu_display, col, row, c, highlight);
+    }
+}
+
+static void draw_all() {
+    for (uint8_t row = 0; row < MENU_ROWS; row++) draw_row(row);
+}
+
+// Show submenu id with entry `select` highlighted
+static void show_level(uint8_t id, uint8_t select) {
+    level = id;
+    entry_count = 0;
+    for (uint8_t i = 0; i < item_count; i++) {
+        if (items[i].parent == id) entries[entry_count++] = i;
+    }
+    cursor = select < entry_count ? select : 0;
+    top = cursor >= MENU_ROWS ? cursor - MENU_ROWS + 1 : 0;
+    draw_all();
+}
+
+// Move the highlight; redraws two rows, or the screen if it has to scroll
+static void move_cursor(int step) {
+    int next = cursor + step;
+    if (next < 0 || next >= entry_count) return;
+
+    uint8_t old = cursor;
+    cursor = (uint8_t)next;
+    if (cursor < top) {
+        top = cursor;
+        draw_all();
+    } else if (cursor >= top + MENU_ROWS) {
+        top = cursor - MENU_ROWS + 1;
+        draw_all();
+    } else {
+        draw_row(old - top);
+        draw_row(cursor - top);
+    }
+}
+
+static void go_back() {
+    if (level == 0) {
+        menu_open = false;
+        notify(MENU_EVENT_CLOSED, 0, 0);
+        return;
+    }
+
+    // Return to the parent with the submenu we came from highlighted
+    const menu_item_t* sub = find_item(level);
+    uint8_t parent = sub ? sub->parent : 0;
+    uint8_t select = 0;
+    for (uint8_t i = 0, n = 0; i < item_count; i++) {
+        if (items[i].parent != parent) continue;
+        if (items[i].id == level) select = n;
+        n++;
+    }
+    show_level(parent, select);
+}
+
+static void activate() {
+    if (cursor >= entry_count) return;
+    menu_item_t* item = &items[entries[cursor]];
+
+    switch (item->type) {
+        case MENU_ITEM_SUBMENU:
+            show_level(item->id, 0);
+            break;
+        case MENU_ITEM_TOGGLE:
+            item->checked = !item->checked;
+            draw_row(cursor - top);
+            notify(MENU_EVENT_SELECTED, item->id, item->checked);
+            break;
+        case MENU_ITEM_BACK:
+            go_back();
+            break;
+        default:
+            notify(MENU_EVENT_SELECTED, item->id, 0);
+            break;
+    }
+}
+
+// Drop the tree and close the menu
+void menu_reset() {
+    item_count = 0;
+    menu_open = false;
+}
+
+// Add item id under parent, or update it in place if it exists
+void menu_add_item(uint8_t id, uint8_t parent, uint8_t type, uint8_t flags,
+                   const uint8_t* label, uint8_t len) {
+    if (id == 0) return;
+    menu_item_t* item = find_item(id);
+    if (!item) {
+        if (item_count >= MENU_MAX_ITEMS) return;
+        item = &items[item_count++];
+    }
+
+    item->id = id;
+    item->parent = parent;
+    item->type = type;
+    item->checked = (flags & MENU_FLAG_CHECKED) != 0;
+    if (len > MENU_LABEL_LEN) len = MENU_LABEL_LEN;
+    memset(item->label, 0, sizeof(item->label));
+    memcpy(item->label, label, len);
+
+    // Live update while open (e.g. a label showing a value)
+    if (menu_open) show_level(level, cursor);
+}
+
+// Show submenu id (0 = top level) on the selected display and take over input
+void menu_open_level(uint8_t id) {
+    menu_display = ssd1306_selected();
+    menu_open = true;
+    show_level(id, 0);
+}
+
+// Release input back to HID; the screen keeps the menu until the host draws
+void menu_close() {
+    menu_open = false;
+}
+
+// True while a menu owns the encoder and buttons
+bool menu_active() {
+    return menu_open;
+}
+
+// Input hook (rotary_encoder.cpp), called only while menu_active()
+void menu_input(uint8_t key) {
+    switch (key) {
+        case MENU_KEY_NEXT:   move_cursor(1); break;
+        case MENU_KEY_PREV:   move_cursor(-1); break;
+        case MENU_KEY_SELECT: activate(); break;
+        case MENU_KEY_BACK:   go_back(); break;
+        default: break;
+    }
+}
@@ -0,0 +1,196 @@
+#include "main.h"
+#include "hardware/clocks.h"
+
+// Idle power management against OLED burn-in: after a period without input
+// or host commands the panels are dimmed, later switched off. Any input or
+// command wakes them at once; the input that woke them is not reported to the
+// host, so a sleeping panel never triggers an action the user couldn't see.
+// Independently, the picture can be shifted by a pixel every few minutes.
+//
+// When the host suspends the bus the panels are switched off as well, the
+// system clock drops to 48 MHz (PLL_SYS off) and the main loop sleeps in WFE,
+// polling the inputs every POWER_SUSPEND_POLL_US. Dormant mode is not used:
+// only GPIOs can wake it, and the host's resume signalling is not a GPIO.
+//
+// Idle panels get no contrast/power traffic, and a switched-off panel only
+// sees the framebuffer writes the host still sends.
+
+typedef enum {
+    POWER_ACTIVE = 0,
+    POWER_DIMMED,
+    POWER_OFF,
+    POWER_SUSPENDED,    // USB suspended: panels off, slow clock
+} power_state_t;
+
+// Vertical offsets cycled through by the pixel shift
+static const uint8_t shift_offsets[] = {0, 1, 2, 1};
+
+static power_config_t power_config = {0, 0, POWER_DIM_CONTRAST_DEFAULT, 0};
+static power_state_t state = POWER_ACTIVE;
+static absolute_time_t last_activity = {0};
+
+// Per display: contrast before dimming, and whether we switched it off (a
+// panel the host powered down stays down on wake)
+static uint8_t saved_contrast[DISPLAY_COUNT];
+static bool switched_off[DISPLAY_COUNT];
+
+static absolute_time_t next_shift = {0};
+static uint8_t shift_step = 0;
+
+// USB suspend, set from the TinyUSB callbacks (run by tud_task())
+static bool usb_suspended = false;
+static bool remote_wakeup_allowed = false;
+static absolute_time_t suspend_time = {0};
+static bool wakeup_armed = false;       // Input released since the last wakeup request
+static uint32_t saved_sys_khz = 0;
+
+static void wake() {
+    uint8_t selected = ssd1306_selected();
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        ssd1306_select(id);
+        ssd1306_set_brightness(saved_contrast[id]);
+        if (switched_off[id]) ssd1306_power(true);
+        switched_off[id] = false;
+    }
+    ssd1306_select(selected);
+    state = POWER_ACTIVE;
+}
+
+static void dim() {
+    uint8_t selected = ssd1306_selected();
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        ssd1306_select(id);
+        saved_contrast[id] = ssd1306_get_brightness();
+        // Never brighten a panel the host already set darker
+        if (power_config.dim_contrast < saved_contrast[id]) {
+            ssd1306_set_brightness(power_config.dim_contrast);
+        }
+    }
+    ssd1306_select(selected);
+    state = POWER_DIMMED;
+}
+
+static void switch_off() {
+    uint8_t selected = ssd1306_selected();
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        ssd1306_select(id);
+        if (state == POWER_ACTIVE) saved_contrast[id] = ssd1306_get_brightness();
+        switched_off[id] = ssd1306_is_powered();
+        if (switched_off[id]) ssd1306_power(false);
+    }
+    ssd1306_select(selected);
+    state = POWER_OFF;
+}
+
+static void enter_suspend() {
+    // Panels already switched off for idleness keep their record
+    if (state != POWER_OFF) switch_off();
+    saved_sys_khz = clock_get_hz(clk_sys) / 1000;
+    set_sys_clock_48mhz();
+    suspend_time = get_absolute_time();
+    wakeup_armed = !input_pending();
+    state = POWER_SUSPENDED;
+}
+
+static void leave_suspend() {
+    // Bus clocks are derived from clk_sys: restore it before any display traffic
+    set_sys_clock_khz(saved_sys_khz, true);
+    wake();
+    last_activity = get_absolute_time();
+}
+
+static void shift_all(uint8_t offset) {
+    uint8_t selected = ssd1306_selected();
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        ssd1306_select(id);
+        ssd1306_set_offset(offset);
+    }
+    ssd1306_select(selected);
+}
+
+// Apply new timing; restarts the idle timer
+void power_set_config(const power_config_t* config) {
+    power_config = *config;
+    if (power_config.shift_minutes == 0 && shift_step != 0) {
+        shift_step = 0;
+        shift_all(0);
+    }
+    next_shift = make_timeout_time_us((uint64_t)power_config.shift_minutes * 60000000u);
+    power_activity();
+}
+
+// Host command or input: restart the idle timer, waking the panels if needed
+void power_activity() {
+    last_activity = get_absolute_time();
+    if (state == POWER_DIMMED || state == POWER_OFF) wake();
+}
+
+// Input hook (rotary_encoder.cpp): true if the input only woke the panels
+// and must not be reported
+bool power_input() {
+    bool asleep = state != POWER_ACTIVE;
+    power_activity();
+    return asleep;
+}
+
+// tud_suspend_cb / tud_resume_cb: acted on by power_task() and
+// power_suspend_sleep() in main-loop context
+void power_usb_suspend(bool remote_wakeup) {
+    usb_suspended = true;
+    remote_wakeup_allowed = remote_wakeup;
+}
+
+void power_usb_resume() {
+    usb_suspended = false;
+}
+
+// True while the main loop should only call power_suspend_sleep()
+bool power_suspended() {
+    return state == POWER_SUSPENDED;
+}
+
+// One suspended main-loop iteration: service USB, request remote wakeup on
+// new input, then sleep until an interrupt or the next input poll
+void power_suspend_sleep() {
+    tud_task();
+    if (!usb_suspended) {
+        leave_suspend();
+        return;
+    }
+
+    bool input = input_pending();
+    if (input && wakeup_armed && remote_wakeup_allowed &&
+        absolute_time_diff_us(suspend_time, get_absolute_time()) >= POWER_WAKEUP_HOLDOFF_US) {
+        // The input itself is reported normally once the host has resumed
+        tud_remote_wakeup();
+        wakeup_armed = false;
+    } else if (!input) {
+        wakeup_armed = true;
+    }
+
+    best_effort_wfe_or_timeout(make_timeout_time_us(POWER_SUSPEND_POLL_US));
+}
+
+// Main-loop hook: idle transitions, pixel shift and entering USB suspend
+void power_task() {
+    if (usb_suspended) {
+        enter_suspend();
+        return;
+    }
+
+    if (power_config.shift_minutes > 0 && time_reached(next_shift)) {
+        shift_step = (shift_step + 1) % sizeof(shift_offsets);
+        shift_all(shift_offsets[shift_step]);
+        next_shift = make_timeout_time_us((uint64_t)power_config.shift_minutes * 60000000u);
+    }
+
+    if (state == POWER_OFF) return;
+    int64_t idle_us = absolute_time_diff_us(last_activity, get_absolute_time());
+
+    if (power_config.off_seconds > 0 && idle_us >= (int64_t)power_config.off_seconds * 1000000) {
+        switch_off();
+    } else if (state == POWER_ACTIVE && power_config.dim_seconds > 0 &&
+               idle_us >= (int64_t)power_config.dim_seconds * 1000000) {
+        dim();
+    }
+}
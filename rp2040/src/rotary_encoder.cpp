@@ -1,16 +1,5 @@
 #include "main.h"
-
-// Rotary encoder GPIO pins
-#define ROTARY_CLK_PIN  10
-#define ROTARY_DT_PIN   11
-#define ROTARY_SW_PIN   12
-
-//gpio config for up/down/left/right directional buttons
-#define LEFT_BTN_PIN    7  // REL_X value -5
-#define RIGHT_BTN_PIN   6  // REL_X value 5
-#define TOP_BTN_PIN     15 // REL_Y value 5(mapped to down button)
-#define BOT_BTN_PIN     8  // REL_Y value -5(mapped to up button)
-#define ENTER_BTN_PIN   14 // MOUSE_BTN_LEFT (active-low, directly connected)
+#include "trace.h"
 
 // Global state variables
 static int last_clk_state = 0;
@@ -22,6 +11,22 @@ static absolute_time_t last_rotation_time = {0}; // For rotation debouncing
 static const uint32_t DEBOUNCE_TIME_US = 5000; // 5ms debounce (increased)
 static bool last_report_state = false; // Track last reported button state
 
+// Hold-to-repeat phases for a direction button
+typedef enum {
+    REPEAT_IDLE = 0,   // No further events scheduled
+    REPEAT_SECOND,     // Waiting to send the second event of a press
+    REPEAT_HOLD,       // Button held: auto-repeat events until release
+} repeat_phase_t;
+
+// Hold-to-repeat state (advanced only by repeat_update(), driven by time_us_32())
+typedef struct {
+    repeat_phase_t phase;
+    bool held;
+    uint32_t press_time_us;
+    uint32_t next_event_us;
+    uint32_t interval_us;
+} repeat_state_t;
+
 // Direction button configuration and state
 typedef struct {
     uint gpio_pin;
@@ -29,20 +34,55 @@ typedef struct {
     int8_t rel_y;
     bool last_state;
     absolute_time_t last_debounce_time;
-    bool second_pending;
-    absolute_time_t first_event_time;
+    repeat_state_t repeat;
+    bool swallowed;         // Current press woke the panels: send none of its events
 } dir_button_t;
 
 #define NUM_DIR_BUTTONS 4
 // Landscape (default) — portrait mapping applied at runtime in setup_rotary_encoder()
 static dir_button_t dir_buttons[NUM_DIR_BUTTONS] = {
-    { LEFT_BTN_PIN,   -5,  0, false, {0}, false, {0} },  // Left
-    { RIGHT_BTN_PIN,   5,  0, false, {0}, false, {0} },  // Right
-    { TOP_BTN_PIN,     0, -5, false, {0}, false, {0} },  // Top
-    { BOT_BTN_PIN,     0,  5, false, {0}, false, {0} },  // Bottom
+    { LEFT_BTN_PIN,   -5,  0, false, {0}, {}, false },  // Left
+    { RIGHT_BTN_PIN,   5,  0, false, {0}, {}, false },  // Right
+    { TOP_BTN_PIN,     0, -5, false, {0}, {}, false },  // Top
+    { BOT_BTN_PIN,     0,  5, false, {0}, {}, false },  // Bottom
 };
 static const uint32_t SECOND_EVENT_DELAY_US = 16000; // 16ms between events to match rotary
 
+// Auto-repeat and long-press timing (runtime-configurable via CMD_INPUT_CONFIG)
+static input_timing_t input_timing = {
+    INPUT_REPEAT_DELAY_MS_DEFAULT,
+    INPUT_REPEAT_RATE_MS_DEFAULT,
+    INPUT_REPEAT_MIN_MS_DEFAULT,
+    INPUT_REPEAT_ACCEL_MS_DEFAULT,
+    INPUT_LONG_PRESS_MS_DEFAULT,
+};
+
+// ENTER long-press tracking (main loop only)
+static uint32_t button_press_time_us = 0;
+static bool long_press_active = false;
+
+// Input taken by an open menu or used to wake idle panels instead of being
+// reported over HID
+static bool button_swallowed = false;  // ENTER press consumed: swallow its release too
+static int menu_steps = 0;             // Encoder transitions towards the next menu step
+static int encoder_swallow = 0;        // Transitions left of a detent that woke the panels
+#define TRANSITIONS_PER_DETENT 2       // One detent = two events, as the host sees it
+
+#ifdef ENABLE_TEST_COMMANDS
+// Input pins forced by TEST_SUBCMD_GPIO: the scanner sees these levels
+// instead of the real ones, so tests can drive every input path
+static uint32_t forced_pins = 0;
+static uint32_t forced_levels = 0;
+#endif
+
+// Level of an input pin as the scanner sees it
+static inline bool read_pin(uint pin) {
+#ifdef ENABLE_TEST_COMMANDS
+    if (forced_pins & (1u << pin)) return (forced_levels >> pin) & 1;
+#endif
+    return gpio_get(pin);
+}
+
 // Mouse report structure
 typedef struct {
     uint8_t buttons;
@@ -51,9 +91,90 @@ typedef struct {
     int8_t wheel;
 } mouse_report_t;
 
+// Wrap-safe "has time_us_32() reached deadline" check
+static inline bool time_us_reached(uint32_t now_us, uint32_t deadline_us) {
+    return (int32_t)(now_us - deadline_us) >= 0;
+}
+
+// Advance the hold-to-repeat state machine for one button.
+// Returns true if a movement event should be sent now. Depends only on its
+// arguments and input_timing, so it can be stepped with a simulated clock.
+static bool repeat_update(repeat_state_t *st, bool pressed, uint32_t now_us) {
+    // Press edge: immediate event, second event after SECOND_EVENT_DELAY_US
+    if (pressed && !st->held) {
+        st->held = true;
+        st->press_time_us = now_us;
+        st->next_event_us = now_us + SECOND_EVENT_DELAY_US;
+        st->phase = REPEAT_SECOND;
+        return true;
+    }
+
+    // Release edge: stop repeating, but still deliver a pending second event
+    if (!pressed && st->held) {
+        st->held = false;
+        if (st->phase == REPEAT_HOLD) st->phase = REPEAT_IDLE;
+    }
+
+    if (st->phase == REPEAT_IDLE || !time_us_reached(now_us, st->next_event_us)) {
+        return false;
+    }
+
+    if (st->phase == REPEAT_SECOND) {
+        // Second event sent; arm auto-repeat if the button is still held
+        if (st->held && input_timing.repeat_delay_ms > 0) {
+            st->phase = REPEAT_HOLD;
+            st->next_event_us = st->press_time_us + input_timing.repeat_delay_ms * 1000u;
+            st->interval_us = input_timing.repeat_rate_ms * 1000u;
+        } else {
+            st->phase = REPEAT_IDLE;
+        }
+        return true;
+    }
+
+    // REPEAT_HOLD: schedule next repeat, then shrink the interval down to the floor
+    if (st->interval_us == 0) st->interval_us = 1000; // Never repeat faster than 1kHz
+    st->next_event_us += st->interval_us;
+
+    // Don't burst missed repeats if the main loop was held up
+    if (time_us_reached(now_us, st->next_event_us)) {
+        st->next_event_us = now_us + st->interval_us;
+    }
+
+    uint32_t min_us = input_timing.repeat_min_ms * 1000u;
+    uint32_t accel_us = input_timing.repeat_accel_ms * 1000u;
+    st->interval_us = (st->interval_us > min_us + accel_us) ? st->interval_us - accel_us : min_us;
+    return true;
+}
+
+// Current HID button bits: left = ENTER/encoder held, right = ENTER long-press
+static uint8_t current_buttons() {
+    uint8_t bits = button_state ? MOUSE_BTN_LEFT : 0;
+    if (long_press_active) bits |= MOUSE_BTN_RIGHT;
+    return bits;
+}
+
+// Update auto-repeat / long-press timing
+void input_set_timing(const input_timing_t *timing) {
+    input_timing = *timing;
+}
+
+void input_get_timing(input_timing_t *timing) {
+    *timing = input_timing;
+}
+
 // Read combined button state: pressed if either ROTARY_SW or ENTER is pressed
 static bool read_button_pressed() {
-    return !gpio_get(ROTARY_SW_PIN) || !gpio_get(ENTER_BTN_PIN);
+    return !read_pin(ROTARY_SW_PIN) || !read_pin(ENTER_BTN_PIN);
+}
+
+// Any button down, or the encoder moved since it was last processed (used
+// while USB is suspended and process_rotary_encoder() does not run)
+bool input_pending() {
+    if (read_button_pressed()) return true;
+    for (int i = 0; i < NUM_DIR_BUTTONS; i++) {
+        if (!read_pin(dir_buttons[i].gpio_pin)) return true;
+    }
+    return read_pin(ROTARY_CLK_PIN) != last_clk_state || read_pin(ROTARY_DT_PIN) != last_dt_state;
 }
 
 // Callback for button pin interrupt (handles both ROTARY_SW and ENTER)
@@ -78,6 +199,32 @@ static void button_callback(uint gpio, uint32_t events) {
     }
 }
 
+#ifdef ENABLE_TEST_COMMANDS
+// Force an input pin to level 0/1, or give it back (TEST_GPIO_RELEASE). A
+// change on a button pin is passed to the edge interrupt handler, as a real
+// edge would be; encoder and direction pins are polled anyway.
+bool input_test_set_pin(uint8_t pin, uint8_t level) {
+    bool input = pin == ROTARY_CLK_PIN || pin == ROTARY_DT_PIN || pin == ROTARY_SW_PIN ||
+                 pin == ENTER_BTN_PIN;
+    for (int i = 0; i < NUM_DIR_BUTTONS; i++) {
+        if (pin == dir_buttons[i].gpio_pin) input = true;
+    }
+    if (!input) return false;
+
+    bool before = read_pin(pin);
+    if (level == TEST_GPIO_RELEASE) {
+        forced_pins &= ~(1u << pin);
+    } else {
+        forced_pins |= 1u << pin;
+        forced_levels = level ? forced_levels | (1u << pin) : forced_levels & ~(1u << pin);
+    }
+    if ((pin == ROTARY_SW_PIN || pin == ENTER_BTN_PIN) && read_pin(pin) != before) {
+        button_callback(pin, before ? GPIO_IRQ_EDGE_FALL : GPIO_IRQ_EDGE_RISE);
+    }
+    return true;
+}
+#endif
+
 // Initialize rotary encoder and button GPIO
 void setup_rotary_encoder() {
     // Initialize CLK and DT pins with pull-ups
@@ -124,19 +271,23 @@ void setup_rotary_encoder() {
         gpio_init(dir_buttons[i].gpio_pin);
         gpio_set_dir(dir_buttons[i].gpio_pin, GPIO_IN);
         gpio_pull_up(dir_buttons[i].gpio_pin);
-        dir_buttons[i].last_state = !gpio_get(dir_buttons[i].gpio_pin);
+        dir_buttons[i].last_state = !read_pin(dir_buttons[i].gpio_pin);
+        dir_buttons[i].repeat.held = dir_buttons[i].last_state; // No event for a button held at boot
     }
 
     // Initialize rotary encoder states
-    last_clk_state = gpio_get(ROTARY_CLK_PIN);
-    last_dt_state = gpio_get(ROTARY_DT_PIN);
+    last_clk_state = read_pin(ROTARY_CLK_PIN);
+    last_dt_state = read_pin(ROTARY_DT_PIN);
     button_state = read_button_pressed(); // Either ROTARY_SW or ENTER
     last_report_state = button_state; // Initialize to match
 }
 
 // Send a mouse report (non-static: also called by test commands)
 void send_mouse_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel) {
-    if (!tud_hid_ready()) return;
+    if (!tud_hid_ready()) {
+        g_stats.hid_dropped++;
+        return;
+    }
 
     mouse_report_t report = {
         .buttons = buttons,
@@ -146,13 +297,19 @@ void send_mouse_report(uint8_t buttons, int8_t x, int8_t y, int8_t wheel) {
     };
 
     // Send report
-    tud_hid_report(0, &report, sizeof(report));
+    TRACE_BEGIN(TRACE_EV_HID, buttons);
+    if (tud_hid_report(0, &report, sizeof(report))) {
+        g_stats.hid_sent++;
+    } else {
+        g_stats.hid_dropped++;
+    }
 
     // Ensure the packet is sent
     tud_task();
 
     // Small delay to ensure report is processed
     sleep_us(500);
+    TRACE_END(TRACE_EV_HID, buttons);
 }
 
 // Process the rotary encoder state and send HID reports if needed
@@ -173,17 +330,38 @@ void process_rotary_encoder() {
 
     // Handle button state changes
     if (button_changed || (button_state != last_report_state)) {
-        // Send mouse report that matches the current button state
-        send_mouse_report(button_state ? 1 : 0, 0, 0, 0);
+        // Long-press tracking restarts on every edge
+        button_press_time_us = now_us;
+        long_press_active = false;
+
+        if (button_state) {
+            // A press that wakes the panels or goes to the menu is swallowed
+            // together with its release
+            bool woke = power_input();
+            button_swallowed = woke || menu_active();
+            if (!woke && menu_active()) menu_input(MENU_KEY_SELECT);
+        }
+        if (!button_swallowed) {
+            // Send mouse report that matches the current button state
+            send_mouse_report(current_buttons(), 0, 0, 0);
+        }
+        if (!button_state) button_swallowed = false;
 
         // Update state tracking
         button_changed = false;
         last_report_state = button_state;
     }
 
+    // ENTER held past the long-press threshold: add the right button until release
+    if (button_state && !button_swallowed && !long_press_active && input_timing.long_press_ms > 0 &&
+        (now_us - button_press_time_us) >= input_timing.long_press_ms * 1000u) {
+        long_press_active = true;
+        send_mouse_report(current_buttons(), 0, 0, 0);
+    }
+
     // Handle encoder rotation
-    int clk_state = gpio_get(ROTARY_CLK_PIN);
-    int dt_state = gpio_get(ROTARY_DT_PIN);
+    int clk_state = read_pin(ROTARY_CLK_PIN);
+    int dt_state = read_pin(ROTARY_DT_PIN);
 
     // Detect state change - check both pins for any change
     if (clk_state != last_clk_state || dt_state != last_dt_state) {
@@ -219,13 +397,24 @@ void process_rotary_encoder() {
             direction = -1; // Counter-clockwise
         }
 
-        // Send movement based on detected direction
-        if (direction == 1) {
+        // The detent that wakes the panels is dropped; an open menu steps
+        // once per detent; otherwise send movement
+        if (direction != 0 && power_input()) {
+            encoder_swallow = TRANSITIONS_PER_DETENT - 1;
+        } else if (direction != 0 && encoder_swallow > 0) {
+            encoder_swallow--;
+        } else if (direction != 0 && menu_active()) {
+            menu_steps = (menu_steps * direction < 0) ? direction : menu_steps + direction;
+            if (menu_steps == TRANSITIONS_PER_DETENT || menu_steps == -TRANSITIONS_PER_DETENT) {
+                menu_input(menu_steps > 0 ? MENU_KEY_NEXT : MENU_KEY_PREV);
+                menu_steps = 0;
+            }
+        } else if (direction == 1) {
             // Clockwise - move mouse right
-            send_mouse_report(button_state ? 1 : 0, -5, 0, 0);
+            send_mouse_report(current_buttons(), -5, 0, 0);
         } else if (direction == -1) {
             // Counter-clockwise - move mouse left
-            send_mouse_report(button_state ? 1 : 0, 5, 0, 0);
+            send_mouse_report(current_buttons(), 5, 0, 0);
         }
 
         // Update the last states
@@ -233,32 +422,42 @@ void process_rotary_encoder() {
         last_dt_state = dt_state;
     }
 
-    // Process direction buttons: pending second events and new presses
-    uint8_t btn_bits = button_state ? 1 : 0;
+    // Process direction buttons: debounce, then press / second event / auto-repeat
+    uint8_t btn_bits = current_buttons();
+    now_us = time_us_32();
 
     for (int i = 0; i < NUM_DIR_BUTTONS; i++) {
         dir_button_t *btn = &dir_buttons[i];
 
-        // Send second event if pending and delay has elapsed
-        if (btn->second_pending) {
-            if (absolute_time_diff_us(btn->first_event_time, now) >= SECOND_EVENT_DELAY_US) {
-                send_mouse_report(btn_bits, btn->rel_x, btn->rel_y, 0);
-                btn->second_pending = false;
-            }
-        }
-
         // Poll button with per-button debounce
         if (absolute_time_diff_us(btn->last_debounce_time, now) > DEBOUNCE_TIME_US) {
-            bool current = !gpio_get(btn->gpio_pin);
+            bool current = !read_pin(btn->gpio_pin);
             if (current != btn->last_state) {
-                if (current) {
-                    send_mouse_report(btn_bits, btn->rel_x, btn->rel_y, 0);
-                    btn->first_event_time = now;
-                    btn->second_pending = true;
-                }
                 btn->last_state = current;
                 btn->last_debounce_time = now;
             }
         }
+
+        bool press = btn->last_state && !btn->repeat.held;
+        bool second = !press && btn->repeat.phase == REPEAT_SECOND;
+        if (repeat_update(&btn->repeat, btn->last_state, now_us)) {
+            if (press) {
+                btn->swallowed = power_input();
+            } else {
+                power_activity();
+            }
+
+            if (btn->swallowed) {
+                // Woke the panels: drop the press, second event and repeats
+            } else if (menu_active()) {
+                // The menu ignores the second event; select/back act on press only
+                uint8_t key = btn->rel_y < 0 ? MENU_KEY_PREV : btn->rel_y > 0 ? MENU_KEY_NEXT :
+                              btn->rel_x > 0 ? MENU_KEY_SELECT : MENU_KEY_BACK;
+                bool repeatable = key == MENU_KEY_PREV || key == MENU_KEY_NEXT;
+                if (!second && (press || repeatable)) menu_input(key);
+            } else {
+                send_mouse_report(btn_bits, btn->rel_x, btn->rel_y, 0);
+            }
+        }
     }
 }
@@ -1,9 +1,7 @@
 #include "main.h"
+#include "trace.h"
 #include "font8x8_basic.h" // This will be created later
 
-// SSD1306 OLED display is 128x64 pixels
-#define SSD1306_WIDTH           128
-#define SSD1306_HEIGHT          64
 #define SSD1306_PAGE_HEIGHT     8 // 8 pixels per page
 
 // SSD1306 commands
@@ -31,136 +29,377 @@
 #define SSD1306_SEG_REMAP                0xA0
 #define SSD1306_SEG_REMAP_REVERSE        0xA1  // Column address 127 mapped to SEG0
 #define SSD1306_CHARGE_PUMP              0x8D
+#define SSD1306_SET_PAGE_START           0xB0  // Page addressing mode: | page
 
-// Display buffer
-static uint8_t display_buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8] = {0};
-
-static uint8_t cursor_x = 0;
-static uint8_t cursor_y = 0;
-
-// Track display connectivity — cleared on I2C failure, set on success
-static bool display_ok = true;
-
-// I2C timeout: base overhead + per-byte time
-// At 400kHz each byte takes ~25us (9 bits/byte). Add margin for clock stretching.
-#define I2C_TIMEOUT_BASE_US  5000  // 5ms base for start/stop/addressing overhead
-#define I2C_TIMEOUT_PER_BYTE_US 30 // ~30us per byte (25us actual + margin)
-
-static inline uint32_t i2c_timeout_for(size_t len) {
-    return I2C_TIMEOUT_BASE_US + (len * I2C_TIMEOUT_PER_BYTE_US);
-}
-
-// Function to send command to SSD1306
-// Returns true on success, false on I2C failure
-static bool ssd1306_command(uint8_t command) {
-    uint8_t buf[2] = {0x00, command}; // Control byte (0x00) followed by command
-    int ret = i2c_write_timeout_us(I2C_PORT, SSD1306_ADDR, buf, 2, false, i2c_timeout_for(2));
-    display_ok = (ret == 2);
-    return display_ok;
-}
-
-// Function to send data to SSD1306
-// Max transfer is full framebuffer (1024) + 1 control byte = 1025 bytes
-#define SSD1306_MAX_TRANSFER (SSD1306_WIDTH * SSD1306_HEIGHT / 8 + 1)
-static uint8_t i2c_data_buf[SSD1306_MAX_TRANSFER];
-
-// Returns true on success, false on I2C failure
-static bool ssd1306_data(uint8_t* data, size_t len) {
-    if (len + 1 > SSD1306_MAX_TRANSFER) len = SSD1306_MAX_TRANSFER - 1;
-    i2c_data_buf[0] = 0x40; // Control byte (0x40) for data
-    memcpy(i2c_data_buf + 1, data, len);
-    int ret = i2c_write_timeout_us(I2C_PORT, SSD1306_ADDR, i2c_data_buf, len + 1, false, i2c_timeout_for(len + 1));
-    display_ok = (ret == (int)(len + 1));
-    return display_ok;
-}
-
-// Initialize SSD1306 OLED display
-void ssd1306_init() {
-    // Initialize I2C port
-    i2c_init(I2C_PORT, 400000); // 400 kHz
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
-
-    // Give display time to power up
-    sleep_ms(100);
-
-    // Initialize display
-    ssd1306_command(SSD1306_DISPLAY_OFF);
-    ssd1306_command(SSD1306_SET_DISPLAY_CLOCK_DIV);
-    ssd1306_command(0x80); // Suggested ratio
-    ssd1306_command(SSD1306_SET_MULTIPLEX);
-    ssd1306_command(SSD1306_HEIGHT - 1);
-    ssd1306_command(SSD1306_SET_DISPLAY_OFFSET);
-    ssd1306_command(0x00);
-    ssd1306_command(SSD1306_SET_START_LINE | 0x00);
-    ssd1306_command(SSD1306_CHARGE_PUMP);
-    ssd1306_command(0x14); // Enable charge pump
-    ssd1306_command(SSD1306_MEMORY_MODE);
-    ssd1306_command(0x00); // Horizontal addressing mode
+// SH1106-specific commands
+#define SH1106_DCDC_CONTROL              0xAD
+#define SH1106_DCDC_ON                   0x8B
 
+#define SSD1306_PAGES           (SSD1306_HEIGHT / SSD1306_PAGE_HEIGHT)
+
+// Recovery backoff after a failed attempt (doubles up to the max)
+#define RECOVERY_BACKOFF_MIN_US  100000  // 100ms
+#define RECOVERY_BACKOFF_MAX_US  2000000 // 2s
+
+// Display data bytes sent per ssd1306_flush_task() call (~2.5ms at 1MHz I2C),
+// so a full-frame redraw never holds up input handling for long
+#define FLUSH_BUDGET_BYTES       (2 * SSD1306_WIDTH)
+
+// One panel: framebuffer, cursor, runtime state and recovery schedule
+typedef struct {
+    uint8_t buffer[SSD1306_BUFFER_SIZE];
+    uint8_t cursor_x;
+    uint8_t cursor_y;
+
+    // Columns changed since the last flush, per page (start > end = clean)
+    uint8_t dirty_start[SSD1306_PAGES];
+    uint8_t dirty_end[SSD1306_PAGES];
+
+    // Connectivity — cleared on transfer failure, set on success. While
+    // false, drawing only updates buffer; ssd1306_recover_task() brings the
+    // panel back and re-sends the framebuffer.
+    bool ok;
+
+    // Runtime display state, re-applied after a recovery re-init
+    uint8_t contrast;
+    bool inverted;
+    bool powered;
+    uint8_t offset;                     // Vertical display offset (pixel shift)
+
+    uint32_t recovery_backoff_us;
+    absolute_time_t recovery_next_time;
+} display_t;
+
+static display_t displays[DISPLAY_COUNT];
+static display_t* display = &displays[0];  // Target of drawing calls
+
+// Next display to get a page in ssd1306_flush_task() (round-robin)
+static uint8_t flush_next = 0;
+
+static inline uint8_t display_id(const display_t* d) {
+    return (uint8_t)(d - displays);
+}
+
+static void mark_dirty(display_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end) {
+    for (uint8_t page = page_start; page <= page_end; page++) {
+        if (col_start < d->dirty_start[page]) d->dirty_start[page] = col_start;
+        if (col_end > d->dirty_end[page]) d->dirty_end[page] = col_end;
+    }
+}
+
+static void mark_clean(display_t* d) {
+    memset(d->dirty_start, 0xFF, sizeof(d->dirty_start));
+    memset(d->dirty_end, 0, sizeof(d->dirty_end));
+}
+
+// Send a command or data stream through the transport with one retry (at
+// the transport's safe speed). Marks the display failed when both attempts
+// fail; while failed it does not touch the bus until a recovery attempt.
+static bool ssd1306_send(display_t* d, bool is_data, const uint8_t* buf, size_t len) {
+    if (!d->ok) return false;
+
+    uint8_t id = display_id(d);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (attempt > 0) {
+            g_stats.i2c_retries++;
+            transport_slow_down(id);
+        }
+        if (is_data ? transport_data(id, buf, len) : transport_commands(id, buf, len)) return true;
+    }
+
+    d->ok = false;
+    return false;
+}
+
+// Send a command sequence in a single transfer
+// Returns true on success, false on bus failure
+static bool ssd1306_commands(display_t* d, const uint8_t* cmds, size_t len) {
+    return ssd1306_send(d, false, cmds, len);
+}
+
+static bool ssd1306_command(display_t* d, uint8_t command) {
+    return ssd1306_commands(d, &command, 1);
+}
+
+// Send a window of the framebuffer (inclusive page/column bounds). The data
+// must be contiguous in the buffer: a single page or full-width pages.
+static bool ssd1306_flush_area(display_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end) {
+    size_t width = col_end - col_start + 1;
+    uint32_t start_us = time_us_32();
+    bool ok = true;
+
+    if constexpr (DISPLAY_DESC.page_addressing) {
+        // No horizontal addressing (SH1106): address and write each page
+        uint8_t col = col_start + DISPLAY_DESC.col_offset;
+        for (uint8_t page = page_start; page <= page_end && ok; page++) {
+            const uint8_t addr[] = {
+                (uint8_t)(SSD1306_SET_PAGE_START | page),
+                (uint8_t)(SSD1306_SET_LOW_COLUMN | (col & 0x0F)),
+                (uint8_t)(SSD1306_SET_HIGH_COLUMN | (col >> 4)),
+            };
+            ok = ssd1306_commands(d, addr, sizeof(addr)) &&
+                 ssd1306_send(d, true, &d->buffer[page * SSD1306_WIDTH + col_start], width);
+        }
+    } else {
+        // Horizontal addressing: one command transfer for the window, then
+        // one data transfer (the controller wraps pages inside the window)
+        const uint8_t window[] = {
+            SSD1306_PAGE_ADDR, page_start, page_end,
+            SSD1306_COLUMN_ADDR, col_start, col_end,
+        };
+        ok = ssd1306_commands(d, window, sizeof(window)) &&
+             ssd1306_send(d, true, &d->buffer[page_start * SSD1306_WIDTH + col_start],
+                          width * (page_end - page_start + 1));
+    }
+
+    stats_record_flush(time_us_32() - start_us);
+    return ok;
+}
+
+// Send the whole framebuffer to the display
+static bool ssd1306_flush_all(display_t* d) {
+    mark_clean(d);
+    return ssd1306_flush_area(d, 0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1);
+}
+
+// Flush the first dirty page of d; returns bytes sent (0 if clean or failed)
+static size_t ssd1306_flush_page(display_t* d) {
+    if (!d->ok) return 0; // Recovery re-sends the whole framebuffer
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        uint8_t start = d->dirty_start[page];
+        uint8_t end = d->dirty_end[page];
+        if (start > end) continue;
+
+        d->dirty_start[page] = 0xFF;
+        d->dirty_end[page] = 0;
+        return ssd1306_flush_area(d, page, page, start, end) ? end - start + 1 : 0;
+    }
+    return 0;
+}
+
+// Main-loop hook: send dirty framebuffer regions, one page per display in
+// turn so a full redraw on one panel does not starve the other
+void ssd1306_flush_task() {
+    size_t budget = FLUSH_BUDGET_BYTES;
+    uint8_t idle = 0;
+    while (budget > 0 && idle < DISPLAY_COUNT) {
+        display_t* d = &displays[flush_next];
+        flush_next = (flush_next + 1) % DISPLAY_COUNT;
+
+        size_t sent = ssd1306_flush_page(d);
+        if (sent == 0) {
+            idle++;
+            continue;
+        }
+        idle = 0;
+        budget = sent < budget ? budget - sent : 0;
+    }
+}
+
+// Panel init sequence (stateful settings are sent by ssd1306_send_init())
+static const uint8_t ssd1306_init_sequence[] = {
+    SSD1306_DISPLAY_OFF,
+    SSD1306_SET_DISPLAY_CLOCK_DIV, 0x80,    // Suggested ratio
+    SSD1306_SET_MULTIPLEX, (uint8_t)(SSD1306_HEIGHT - 1),
+    SSD1306_SET_DISPLAY_OFFSET, 0x00,
+    SSD1306_SET_START_LINE | 0x00,
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    SH1106_DCDC_CONTROL, SH1106_DCDC_ON,    // Internal DC-DC (no charge pump / memory mode)
+#else
+    SSD1306_CHARGE_PUMP, 0x14,              // Enable charge pump
+    SSD1306_MEMORY_MODE, 0x00,              // Horizontal addressing mode
+#endif
     // Same HW registers for both orientations — portrait 180° is done in software
-    ssd1306_command(SSD1306_SEG_REMAP_REVERSE); // 0xA1
-    ssd1306_command(SSD1306_COM_SCAN_DEC);      // 0xC8
+    SSD1306_SEG_REMAP_REVERSE,              // 0xA1
+    SSD1306_COM_SCAN_DEC,                   // 0xC8
+    SSD1306_SET_COM_PINS, DISPLAY_DESC.com_pins,
+    SSD1306_SET_PRECHARGE, 0xF1,
+    SSD1306_SET_VCOM_DETECT, 0x40,
+    SSD1306_DISPLAY_RAM,
+};
+
+// Run the init sequence, then restore contrast/invert/power from the runtime
+// state (two transfers; bail on failure)
+static bool ssd1306_send_init(display_t* d) {
+    if (!ssd1306_commands(d, ssd1306_init_sequence, sizeof(ssd1306_init_sequence))) return false;
+
+    const uint8_t state[] = {
+        SSD1306_SET_CONTRAST, d->contrast,
+        (uint8_t)(d->inverted ? SSD1306_DISPLAY_INVERTED : SSD1306_DISPLAY_NORMAL),
+        (uint8_t)(d->powered ? SSD1306_DISPLAY_ON : SSD1306_DISPLAY_OFF),
+        SSD1306_SET_DISPLAY_OFFSET, d->offset,
+    };
+    return ssd1306_commands(d, state, sizeof(state));
+}
+
+// Bring the panel back: bus recovery, init sequence, framebuffer
+static bool ssd1306_reinit(display_t* d) {
+    d->ok = true; // Allow bus access; the first failed write clears it again
+    transport_recover(display_id(d));
+    return ssd1306_send_init(d) && ssd1306_flush_all(d);
+}
 
-    ssd1306_command(SSD1306_SET_COM_PINS);
-    ssd1306_command(0x12);
-    ssd1306_command(SSD1306_SET_CONTRAST);
-    ssd1306_command(0xCF);
-    ssd1306_command(SSD1306_SET_PRECHARGE);
-    ssd1306_command(0xF1);
-    ssd1306_command(SSD1306_SET_VCOM_DETECT);
-    ssd1306_command(0x40);
-    ssd1306_command(SSD1306_DISPLAY_RAM);
-    ssd1306_command(SSD1306_DISPLAY_NORMAL);
-    ssd1306_command(SSD1306_DISPLAY_ON);
+// Main-loop hook: retry failed displays with exponential backoff
+void ssd1306_recover_task() {
+    for (display_t* d = displays; d < displays + DISPLAY_COUNT; d++) {
+        if (d->ok || !time_reached(d->recovery_next_time)) continue;
 
-    // Clear the display
-    ssd1306_clear();
+        g_stats.display_recoveries++;
+        if (ssd1306_reinit(d)) {
+            d->recovery_backoff_us = RECOVERY_BACKOFF_MIN_US;
+            continue;
+        }
+
+        // Next attempt runs at the transport's safe speed
+        transport_slow_down(display_id(d));
+        d->recovery_next_time = make_timeout_time_us(d->recovery_backoff_us);
+        d->recovery_backoff_us *= 2;
+        if (d->recovery_backoff_us > RECOVERY_BACKOFF_MAX_US) d->recovery_backoff_us = RECOVERY_BACKOFF_MAX_US;
+    }
+}
+
+// Initialize the OLED displays
+// Shows the splash image stored in flash, if any; returns true if it did
+bool ssd1306_init() {
+    // Initialize the display bus(es)
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        transport_init(id);
+    }
+
+    // Give display time to power up (counted from boot, so time spent on
+    // USB setup or by the caller polling tud_task() is not added on top)
+    sleep_until(from_us_since_boot(SSD1306_POWERUP_US));
+
+    bool splash = false;
+    for (display_t* d = displays; d < displays + DISPLAY_COUNT; d++) {
+        // Boot state from persisted settings
+        d->contrast = config_get_u8(CFG_KEY_BRIGHTNESS, 0xCF);
+        d->inverted = config_get_u8(CFG_KEY_INVERT, 0) != 0;
+        d->powered = true;
+        d->recovery_backoff_us = RECOVERY_BACKOFF_MIN_US;
+
+        // Framebuffer first (splash image if stored, else blank), so a failed
+        // init still leaves the right content for the recovery re-upload
+        d->cursor_x = 0;
+        mark_clean(d);
+        d->cursor_y = g_portrait ? (SSD1306_HEIGHT - SSD1306_PAGE_HEIGHT) : 0;
+        splash = config_load_splash(d->buffer, sizeof(d->buffer));
+        if (!splash) memset(d->buffer, 0, sizeof(d->buffer));
+
+        // Initialize display with a single full-frame write; a panel that fails
+        // at full speed gets one immediate retry at the safe speed
+        d->ok = true;
+        if (!(ssd1306_send_init(d) && ssd1306_flush_all(d))) {
+            transport_slow_down(display_id(d));
+            ssd1306_reinit(d);
+        }
+    }
+
+    display = &displays[0];
+    return splash;
+}
+
+// Direct subsequent drawing calls at display id; false if there is no such panel
+bool ssd1306_select(uint8_t id) {
+    if (id >= DISPLAY_COUNT) return false;
+    display = &displays[id];
+    return true;
+}
+
+// False after the last transfer to any display failed
+bool ssd1306_is_ok() {
+    for (const display_t* d = displays; d < displays + DISPLAY_COUNT; d++) {
+        if (!d->ok) return false;
+    }
+    return true;
+}
+
+// Current bus speed of display 0 in Hz (drops to the safe speed after errors)
+uint32_t ssd1306_bus_speed() {
+    return transport_speed(0);
+}
+
+// Selected display's framebuffer (page format, SSD1306_BUFFER_SIZE bytes)
+const uint8_t* ssd1306_get_buffer() {
+    return display->buffer;
 }
 
 // Clear the display
 void ssd1306_clear() {
-    memset(display_buffer, 0, sizeof(display_buffer));
+    memset(display->buffer, 0, sizeof(display->buffer));
 
     // Reset cursor position regardless of display state
-    cursor_x = 0;
-    cursor_y = g_portrait ? (SSD1306_HEIGHT - SSD1306_PAGE_HEIGHT) : 0;
+    display->cursor_x = 0;
+    display->cursor_y = g_portrait ? (SSD1306_HEIGHT - SSD1306_PAGE_HEIGHT) : 0;
+
+    mark_dirty(display, 0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1);
+}
+
+// ID of the display drawing commands currently act on
+uint8_t ssd1306_selected() {
+    return display_id(display);
+}
+
+// Framebuffer of display id for in-place drawing (gfx.cpp, graph.cpp);
+// callers report what they changed with ssd1306_mark_dirty()
+uint8_t* ssd1306_draw_buffer(uint8_t id) {
+    return displays[id].buffer;
+}
+
+// Queue a physical window of display id for the next flush
+void ssd1306_mark_dirty(uint8_t id, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end) {
+    mark_dirty(&displays[id], page_start, page_end, col_start, col_end);
+}
+
+static inline uint8_t reverse_bits(uint8_t b) {
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    return (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+}
+
+// Copy raw page-format bytes (CMD_FRAME) into the framebuffer at offset
+// (page * SSD1306_WIDTH + column, logical orientation) and mark them dirty.
+// Portrait applies the same 180° rotation as text: the byte moves to the
+// mirrored position (buffer end minus offset) with its bits reversed.
+void ssd1306_write_pages(uint16_t offset, const uint8_t* data, size_t len) {
+    if (offset >= SSD1306_BUFFER_SIZE || len == 0) return;
+    if (len > (size_t)(SSD1306_BUFFER_SIZE - offset)) len = SSD1306_BUFFER_SIZE - offset;
 
-    // Set address range for whole display (bail on first I2C failure)
-    if (!ssd1306_command(SSD1306_PAGE_ADDR)) return;
-    if (!ssd1306_command(0)) return;
-    if (!ssd1306_command(SSD1306_HEIGHT / 8 - 1)) return;
-    if (!ssd1306_command(SSD1306_COLUMN_ADDR)) return;
-    if (!ssd1306_command(0)) return;
-    if (!ssd1306_command(SSD1306_WIDTH - 1)) return;
+    size_t first = offset;
+    if (g_portrait) {
+        first = SSD1306_BUFFER_SIZE - offset - len;
+        for (size_t i = 0; i < len; i++) {
+            display->buffer[SSD1306_BUFFER_SIZE - 1 - (offset + i)] = reverse_bits(data[i]);
+        }
+    } else {
+        memcpy(&display->buffer[offset], data, len);
+    }
 
-    // Send cleared buffer to display
-    ssd1306_data(display_buffer, sizeof(display_buffer));
+    size_t last = first + len - 1;
+    uint8_t page_start = first / SSD1306_WIDTH;
+    uint8_t page_end = last / SSD1306_WIDTH;
+    if (page_start == page_end) {
+        mark_dirty(display, page_start, page_end, first % SSD1306_WIDTH, last % SSD1306_WIDTH);
+    } else {
+        mark_dirty(display, page_start, page_end, 0, SSD1306_WIDTH - 1);
+    }
 }
 
 // Set cursor position
 void ssd1306_set_cursor(uint8_t x, uint8_t y) {
-    cursor_x = x;
-    cursor_y = y;
+    display->cursor_x = x;
+    display->cursor_y = y;
 }
 
-// Draw a character at current cursor position
-static void ssd1306_draw_char(char c) {
+// Column bytes of glyph c for the current orientation (portrait: rotated 180°)
+static void glyph_columns(char c, uint8_t* transposed) {
     if ((uint8_t)c > 127) c = '?'; // Handle non-ASCII chars
 
-    // Calculate buffer position
-    int page = cursor_y / 8;  // Page = y / 8 
-    int col = cursor_x;       // Column = x
-
-    // Check bounds
-    if (page >= SSD1306_HEIGHT / 8 || col > SSD1306_WIDTH - 8) return;
-
     // The SSD1306 display writes bytes vertically (each byte is 8 vertical pixels)
     // We need to transpose the character data (convert rows to columns)
-    uint8_t transposed[8] = {0};
-    
+    memset(transposed, 0, 8);
+
     // Transpose the character (swap rows and columns)
     for (int srcRow = 0; srcRow < 8; srcRow++) {
         uint8_t src_byte = font8x8_basic[(uint8_t)c][srcRow];
@@ -177,40 +416,62 @@ static void ssd1306_draw_char(char c) {
             }
         }
     }
-    
+}
+
+// Draw a character at current cursor position
+static void ssd1306_draw_char(char c) {
+    // Calculate buffer position
+    int page = display->cursor_y / 8;  // Page = y / 8
+    int col = display->cursor_x;       // Column = x
+
+    // Check bounds
+    if (page >= SSD1306_HEIGHT / 8 || col > SSD1306_WIDTH - 8) return;
+
+    uint8_t transposed[8];
+    glyph_columns(c, transposed);
+
     // Copy transposed character to buffer
     for (int i = 0; i < 8; i++) {
         if (col + i < SSD1306_WIDTH) {
             // Calculate position in buffer (page * width + column + i)
             int pos = page * SSD1306_WIDTH + (col + i);
-            display_buffer[pos] = transposed[i];
+            display->buffer[pos] = transposed[i];
         }
     }
 
-    // Update the display for this character (bail on I2C failure)
-    if (!ssd1306_command(SSD1306_PAGE_ADDR)) return;
-    if (!ssd1306_command(page)) return;
-    if (!ssd1306_command(page)) return;
-    if (!ssd1306_command(SSD1306_COLUMN_ADDR)) return;
-    if (!ssd1306_command(col)) return;
-    if (!ssd1306_command(col + 7)) return;
-
-    // Send the character data to display
-    ssd1306_data(&display_buffer[page * SSD1306_WIDTH + col], 8);
-    
+    // Queue this character's columns for the next flush
+    mark_dirty(display, page, page, col, col + 7);
+
     // Advance cursor - move 8 pixels to the right
-    cursor_x += 8;
-    
+    display->cursor_x += 8;
+
     // Wrap to next line if needed
-    if (cursor_x > SSD1306_WIDTH - 8) {
-        cursor_x = 0;
-        cursor_y += 8; // Move down one character row (8 pixels)
-        if (cursor_y >= SSD1306_HEIGHT) {
-            cursor_y = 0; // Wrap to top if we reach the bottom
+    if (display->cursor_x > SSD1306_WIDTH - 8) {
+        display->cursor_x = 0;
+        display->cursor_y += 8; // Move down one character row (8 pixels)
+        if (display->cursor_y >= SSD1306_HEIGHT) {
+            display->cursor_y = 0; // Wrap to top if we reach the bottom
         }
     }
 }
 
+// Draw c into character cell (col, row) of display id, in logical 8x8 cells;
+// inverse draws it light-on-dark. Leaves the text cursor alone.
+void ssd1306_draw_cell(uint8_t id, uint8_t col, uint8_t row, char c, bool inverse) {
+    if (col >= SSD1306_WIDTH / 8 || row >= SSD1306_PAGES) return;
+
+    int page = g_portrait ? SSD1306_PAGES - 1 - row : row;
+    int x = g_portrait ? SSD1306_WIDTH - 8 - col * 8 : col * 8;
+    uint8_t transposed[8];
+    glyph_columns(c, transposed);
+
+    uint8_t* dst = &displays[id].buffer[page * SSD1306_WIDTH + x];
+    for (int i = 0; i < 8; i++) {
+        dst[i] = inverse ? ~transposed[i] : transposed[i];
+    }
+    mark_dirty(&displays[id], page, page, x, x + 7);
+}
+
 // Draw text at specified or current cursor position
 void ssd1306_draw_text(uint8_t x, uint8_t y, const char* text) {
     if (g_portrait) {
@@ -241,25 +502,60 @@ void ssd1306_draw_text(uint8_t x, uint8_t y, const char* text) {
 
 // Invert display
 void ssd1306_invert(bool invert) {
+    display->inverted = invert;
     if (invert) {
-        ssd1306_command(SSD1306_DISPLAY_INVERTED);
+        ssd1306_command(display, SSD1306_DISPLAY_INVERTED);
     } else {
-        ssd1306_command(SSD1306_DISPLAY_NORMAL);
+        ssd1306_command(display, SSD1306_DISPLAY_NORMAL);
     }
 }
 
 // Power on/off display
 void ssd1306_power(bool power) {
+    display->powered = power;
     if (power) {
-        ssd1306_command(SSD1306_DISPLAY_ON);
+        ssd1306_command(display, SSD1306_DISPLAY_ON);
     } else {
-        ssd1306_command(SSD1306_DISPLAY_OFF);
+        ssd1306_command(display, SSD1306_DISPLAY_OFF);
     }
 }
 // Set display brightness/contrast (0-255)
 void ssd1306_set_brightness(uint8_t brightness) {
-    ssd1306_command(SSD1306_SET_CONTRAST);
-    ssd1306_command(brightness);
+    display->contrast = brightness;
+    const uint8_t cmds[] = {SSD1306_SET_CONTRAST, brightness};
+    ssd1306_commands(display, cmds, sizeof(cmds));
+}
+
+// Shift the picture up by `rows` rows against burn-in. The controller wraps
+// the top rows around to the bottom of the screen; for the 1-2 rows the
+// power saver uses that is accepted rather than losing them.
+void ssd1306_set_offset(uint8_t rows) {
+    display->offset = rows % SSD1306_HEIGHT;
+    const uint8_t cmds[] = {SSD1306_SET_DISPLAY_OFFSET, display->offset};
+    ssd1306_commands(display, cmds, sizeof(cmds));
+}
+
+bool ssd1306_is_powered() {
+    return display->powered;
+}
+
+uint8_t ssd1306_get_brightness() {
+    return display->contrast;
+}
+
+bool ssd1306_is_inverted() {
+    return display->inverted;
+}
+
+// True while display id still has dirty pages waiting for the bus (a failed
+// display never flushes, so it never counts as busy)
+bool ssd1306_flush_pending(uint8_t id) {
+    const display_t* d = &displays[id];
+    if (!d->ok) return false;
+    for (int page = 0; page < SSD1306_PAGES; page++) {
+        if (d->dirty_start[page] <= d->dirty_end[page]) return true;
+    }
+    return false;
 }
 
 // Draw a progress bar
@@ -331,20 +627,10 @@ void ssd1306_draw_progress_bar(uint8_t x, uint8_t y, uint8_t width, uint8_t heig
             // Read-modify-write: clear only the bar's Y-range bits, then set new bar pixels.
             // This preserves text or other content on the same page outside the bar's rows.
             int pos = page * SSD1306_WIDTH + col;
-            display_buffer[pos] = (display_buffer[pos] & ~bar_mask) | (mask & bar_mask);
+            display->buffer[pos] = (display->buffer[pos] & ~bar_mask) | (mask & bar_mask);
         }
     }
 
-    // Update the display for the affected area (bail on I2C failure)
-    for (uint8_t page = start_page; page <= end_page; page++) {
-        if (!ssd1306_command(SSD1306_PAGE_ADDR)) return;
-        if (!ssd1306_command(page)) return;
-        if (!ssd1306_command(page)) return;
-        if (!ssd1306_command(SSD1306_COLUMN_ADDR)) return;
-        if (!ssd1306_command(x)) return;
-        if (!ssd1306_command(x + width - 1)) return;
-
-        // Send the progress bar data to display
-        if (!ssd1306_data(&display_buffer[page * SSD1306_WIDTH + x], width)) return;
-    }
+    // Queue the affected area for the next flush
+    mark_dirty(display, start_page, end_page, x, x + width - 1);
 }
@@ -0,0 +1,39 @@
+#include "main.h"
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+trace_event_t g_trace_buf[TRACE_BUFFER_EVENTS];
+uint32_t g_trace_head = 0;
+bool g_trace_paused = false;
+#endif
+
+// Send the recorded events, oldest first. Recording is paused meanwhile so the
+// dump itself (USB servicing) does not overwrite what is being sent.
+void trace_dump() {
+#ifdef ENABLE_TRACE
+    g_trace_paused = true;
+    uint32_t count = g_trace_head < TRACE_BUFFER_EVENTS ? g_trace_head : TRACE_BUFFER_EVENTS;
+    uint32_t first = g_trace_head - count;
+
+    uint8_t header[3] = {CMD_TRACE, (uint8_t)(count & 0xFF), (uint8_t)(count >> 8)};
+    cmd_reply(header, sizeof(header));
+
+    // The ring may wrap: send up to two contiguous spans
+    uint32_t start = first & (TRACE_BUFFER_EVENTS - 1);
+    uint32_t span = TRACE_BUFFER_EVENTS - start;
+    if (span > count) span = count;
+    cmd_reply((const uint8_t*)&g_trace_buf[start], span * sizeof(trace_event_t));
+    cmd_reply((const uint8_t*)&g_trace_buf[0], (count - span) * sizeof(trace_event_t));
+    g_trace_paused = false;
+#else
+    // Tracing compiled out: report an empty trace
+    uint8_t header[3] = {CMD_TRACE, 0, 0};
+    cmd_reply(header, sizeof(header));
+#endif
+}
+
+void trace_clear() {
+#ifdef ENABLE_TRACE
+    g_trace_head = 0;
+#endif
+}
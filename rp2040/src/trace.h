@@ -0,0 +1,66 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Hot-path tracing into a RAM ring buffer, dumped with CMD_TRACE.
+//
+// Built only with -DENABLE_TRACE=ON; otherwise every TRACE_* macro expands to
+// nothing, so production firmware carries no code or RAM for it.
+
+// Event ids (Chrome trace "name"; see tools/trace_dump.py)
+#define TRACE_EV_COMMAND  0x01  // arg = opcode
+#define TRACE_EV_I2C      0x02  // Display bus transfer (I2C or SPI), arg = bytes
+#define TRACE_EV_HID      0x03  // arg = button bits
+#define TRACE_EV_LOOP     0x04  // arg = 0
+
+#define TRACE_PHASE_BEGIN   'B'
+#define TRACE_PHASE_END     'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+// Ring capacity in events (power of two), 8 bytes each
+#define TRACE_BUFFER_EVENTS 1024
+
+typedef struct {
+    uint32_t ts_us;   // time_us_32()
+    uint8_t phase;    // TRACE_PHASE_*
+    uint8_t id;       // TRACE_EV_*
+    uint16_t arg;
+} trace_event_t;
+
+// Reply: [0x0E][count_lo][count_hi][trace_event_t * count], oldest first
+void trace_dump();
+void trace_clear();
+
+#ifdef ENABLE_TRACE
+
+#include "hardware/timer.h"
+
+static_assert((TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) == 0, "trace buffer must be a power of two");
+
+extern trace_event_t g_trace_buf[TRACE_BUFFER_EVENTS];
+extern uint32_t g_trace_head;   // Total events recorded (wraps the ring)
+extern bool g_trace_paused;     // Set while dumping
+
+static inline void trace_record(uint8_t phase, uint8_t id, uint16_t arg) {
+    if (g_trace_paused) return;
+    trace_event_t* ev = &g_trace_buf[g_trace_head++ & (TRACE_BUFFER_EVENTS - 1)];
+    ev->ts_us = time_us_32();
+    ev->phase = phase;
+    ev->id = id;
+    ev->arg = arg;
+}
+
+#define TRACE_BEGIN(id, arg)   trace_record(TRACE_PHASE_BEGIN, (id), (uint16_t)(arg))
+#define TRACE_END(id, arg)     trace_record(TRACE_PHASE_END, (id), (uint16_t)(arg))
+#define TRACE_INSTANT(id, arg) trace_record(TRACE_PHASE_INSTANT, (id), (uint16_t)(arg))
+
+#else
+
+#define TRACE_BEGIN(id, arg)   ((void)0)
+#define TRACE_END(id, arg)     ((void)0)
+#define TRACE_INSTANT(id, arg) ((void)0)
+
+#endif // ENABLE_TRACE
+
+#endif // TRACE_H
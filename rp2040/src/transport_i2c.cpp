@@ -0,0 +1,132 @@
+#include "main.h"
+#include "trace.h"
+
+// I2C display transport (DISPLAY_TRANSPORT=I2C)
+// Every transfer is one I2C write: a control byte (0x00 = command stream,
+// 0x40 = data stream) followed by the payload. With DISPLAY_COUNT=2 the second
+// panel sits on its own bus or shares the first one at another address.
+
+typedef struct {
+    i2c_inst_t* port;
+    uint sda_pin;
+    uint scl_pin;
+    uint8_t addr;
+} i2c_target_t;
+
+static const i2c_target_t i2c_targets[DISPLAY_COUNT] = {
+    { I2C_PORT, I2C_SDA_PIN, I2C_SCL_PIN, SSD1306_ADDR },
+#if DISPLAY_COUNT > 1
+    { DISPLAY2_I2C_PORT, DISPLAY2_SDA_PIN, DISPLAY2_SCL_PIN, DISPLAY2_ADDR },
+#endif
+};
+
+static_assert(!PIN_IS_INPUT(I2C_SDA_PIN) && !PIN_IS_INPUT(I2C_SCL_PIN), "I2C display pin used by an input");
+#if DISPLAY_COUNT > 1
+static_assert(!PIN_IS_INPUT(DISPLAY2_SDA_PIN) && !PIN_IS_INPUT(DISPLAY2_SCL_PIN), "second display pin used by an input");
+#endif
+
+// Adaptive bus speed per I2C block: start at I2C_BAUD_MAX, drop to
+// I2C_BAUD_SAFE on errors (panels sharing a bus share its speed)
+static uint i2c_baud[2] = { I2C_BAUD_MAX, I2C_BAUD_MAX };
+
+// I2C timeout: base overhead + per-byte time
+// At 400kHz each byte takes ~25us (9 bits/byte). Add margin for clock stretching.
+#define I2C_TIMEOUT_BASE_US  5000  // 5ms base for start/stop/addressing overhead
+#define I2C_TIMEOUT_PER_BYTE_US 30 // ~30us per byte (25us actual + margin)
+
+static inline uint32_t i2c_timeout_for(size_t len) {
+    return I2C_TIMEOUT_BASE_US + (len * I2C_TIMEOUT_PER_BYTE_US);
+}
+
+// Staging for control byte + up to a full framebuffer
+#define I2C_MAX_TRANSFER (SSD1306_BUFFER_SIZE + 1)
+static uint8_t i2c_tx_buf[I2C_MAX_TRANSFER];
+
+static bool i2c_transfer(uint8_t id, uint8_t control, const uint8_t* payload, size_t len) {
+    const i2c_target_t* t = &i2c_targets[id];
+    if (len + 1 > I2C_MAX_TRANSFER) len = I2C_MAX_TRANSFER - 1;
+    i2c_tx_buf[0] = control;
+    memcpy(i2c_tx_buf + 1, payload, len);
+
+    TRACE_BEGIN(TRACE_EV_I2C, len + 1);
+    int ret = i2c_write_timeout_us(t->port, t->addr, i2c_tx_buf, len + 1, false, i2c_timeout_for(len + 1));
+    TRACE_END(TRACE_EV_I2C, len + 1);
+
+    g_stats.i2c_transactions++;
+    if (ret != (int)(len + 1)) {
+        g_stats.i2c_failures++;
+        return false;
+    }
+    g_stats.i2c_bytes += len + 1;
+    return true;
+}
+
+// Set up the I2C peripheral and pins at the current bus speed
+void transport_init(uint8_t id) {
+    const i2c_target_t* t = &i2c_targets[id];
+    i2c_init(t->port, i2c_baud[i2c_hw_index(t->port)]);
+    gpio_set_function(t->sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(t->scl_pin, GPIO_FUNC_I2C);
+    gpio_pull_up(t->sda_pin);
+    gpio_pull_up(t->scl_pin);
+}
+
+bool transport_commands(uint8_t id, const uint8_t* cmds, size_t len) {
+    return i2c_transfer(id, 0x00, cmds, len);
+}
+
+bool transport_data(uint8_t id, const uint8_t* data, size_t len) {
+    return i2c_transfer(id, 0x40, data, len);
+}
+
+// Free a slave stuck mid-byte holding SDA low: clock SCL up to 9 times until
+// SDA is released, then generate a STOP and re-initialize the peripheral.
+// Pins are driven open-drain style (output low or input with pull-up) so the
+// bus is never driven high.
+void transport_recover(uint8_t id) {
+    const i2c_target_t* t = &i2c_targets[id];
+    uint sda = t->sda_pin;
+    uint scl = t->scl_pin;
+
+    i2c_deinit(t->port);
+    gpio_set_function(sda, GPIO_FUNC_SIO);
+    gpio_set_function(scl, GPIO_FUNC_SIO);
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+    gpio_set_dir(sda, GPIO_IN);
+    gpio_set_dir(scl, GPIO_IN);
+    sleep_us(5);
+
+    for (int i = 0; i < 9 && !gpio_get(sda); i++) {
+        gpio_set_dir(scl, GPIO_OUT); // SCL low
+        sleep_us(5);
+        gpio_set_dir(scl, GPIO_IN);  // SCL released
+        sleep_us(5);
+    }
+
+    // STOP: SDA low -> high while SCL is high
+    gpio_set_dir(scl, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(sda, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(scl, GPIO_IN);
+    sleep_us(5);
+    gpio_set_dir(sda, GPIO_IN);
+    sleep_us(5);
+
+    transport_init(id);
+}
+
+// Drop to the safe bus speed after an error at Fast-mode Plus
+void transport_slow_down(uint8_t id) {
+    i2c_inst_t* port = i2c_targets[id].port;
+    uint bus = i2c_hw_index(port);
+    if (i2c_baud[bus] > I2C_BAUD_SAFE) {
+        i2c_baud[bus] = I2C_BAUD_SAFE;
+        i2c_set_baudrate(port, i2c_baud[bus]);
+    }
+}
+
+uint32_t transport_speed(uint8_t id) {
+    return i2c_baud[i2c_hw_index(i2c_targets[id].port)];
+}
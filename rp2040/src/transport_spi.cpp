@@ -0,0 +1,96 @@
+#include "main.h"
+#include "trace.h"
+#include "hardware/spi.h"
+
+// 4-wire SPI display transport (DISPLAY_TRANSPORT=SPI)
+// DC selects command (low) or data (high); CS frames each transfer. SPI has
+// no acknowledge, so transfers cannot fail and a disconnected panel is not
+// detected — recovery only resets the controller. With DISPLAY_COUNT=2 the
+// panels share SCK/MOSI/DC and have their own CS and RST lines.
+
+typedef struct {
+    uint cs_pin;
+    uint rst_pin;
+} spi_target_t;
+
+static const spi_target_t spi_targets[DISPLAY_COUNT] = {
+    { SPI_CS_PIN, SPI_RST_PIN },
+#if DISPLAY_COUNT > 1
+    { DISPLAY2_CS_PIN, DISPLAY2_RST_PIN },
+#endif
+};
+
+static_assert(!PIN_IS_INPUT(SPI_SCK_PIN) && !PIN_IS_INPUT(SPI_MOSI_PIN) && !PIN_IS_INPUT(SPI_DC_PIN) &&
+              !PIN_IS_INPUT(SPI_CS_PIN) && !PIN_IS_INPUT(SPI_RST_PIN), "SPI display pin used by an input");
+#if DISPLAY_COUNT > 1
+static_assert(!PIN_IS_INPUT(DISPLAY2_CS_PIN) && !PIN_IS_INPUT(DISPLAY2_RST_PIN), "second display pin used by an input");
+#endif
+
+static uint spi_baud = SPI_BAUD_MAX;
+
+static bool spi_transfer(uint8_t id, bool is_data, const uint8_t* payload, size_t len) {
+    uint cs = spi_targets[id].cs_pin;
+
+    TRACE_BEGIN(TRACE_EV_I2C, len);
+    gpio_put(SPI_DC_PIN, is_data);
+    gpio_put(cs, 0);
+    spi_write_blocking(SPI_PORT, payload, len);
+    gpio_put(cs, 1);
+    TRACE_END(TRACE_EV_I2C, len);
+
+    g_stats.i2c_transactions++;
+    g_stats.i2c_bytes += len;
+    return true;
+}
+
+// Pulse the controller reset line (RES low >= 3us, per datasheet)
+static void spi_reset_panel(uint8_t id) {
+    uint rst = spi_targets[id].rst_pin;
+    gpio_put(rst, 0);
+    sleep_us(10);
+    gpio_put(rst, 1);
+    sleep_us(10);
+}
+
+void transport_init(uint8_t id) {
+    spi_init(SPI_PORT, spi_baud);
+    gpio_set_function(SPI_SCK_PIN, GPIO_FUNC_SPI);
+    gpio_set_function(SPI_MOSI_PIN, GPIO_FUNC_SPI);
+
+    // CS, DC and RST are plain GPIO outputs (CS idles high)
+    uint cs = spi_targets[id].cs_pin;
+    uint rst = spi_targets[id].rst_pin;
+    gpio_init(cs);
+    gpio_set_dir(cs, GPIO_OUT);
+    gpio_put(cs, 1);
+    gpio_init(SPI_DC_PIN);
+    gpio_set_dir(SPI_DC_PIN, GPIO_OUT);
+    gpio_init(rst);
+    gpio_set_dir(rst, GPIO_OUT);
+    spi_reset_panel(id);
+}
+
+bool transport_commands(uint8_t id, const uint8_t* cmds, size_t len) {
+    return spi_transfer(id, false, cmds, len);
+}
+
+bool transport_data(uint8_t id, const uint8_t* data, size_t len) {
+    return spi_transfer(id, true, data, len);
+}
+
+void transport_recover(uint8_t id) {
+    spi_reset_panel(id);
+}
+
+void transport_slow_down(uint8_t id) {
+    (void) id; // One SPI clock for all panels
+    if (spi_baud > SPI_BAUD_SAFE) {
+        spi_baud = SPI_BAUD_SAFE;
+        spi_init(SPI_PORT, spi_baud);
+    }
+}
+
+uint32_t transport_speed(uint8_t id) {
+    (void) id;
+    return spi_baud;
+}
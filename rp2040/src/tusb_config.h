@@ -61,18 +61,38 @@ extern "C" {
 #define CFG_TUD_MSC              0
 #define CFG_TUD_HID              1
 #define CFG_TUD_MIDI             0
+#ifdef ENABLE_VENDOR_INTERFACE
+#define CFG_TUD_VENDOR           1  // Bulk command stream for libusb hosts
+#else
 #define CFG_TUD_VENDOR           0
+#endif
 
 // HID buffer size Should be sufficient to hold ID (if any) + Data
 #define CFG_TUD_HID_EP_BUFSIZE   16
 
-// CDC FIFO size of TX and RX
-#define CFG_TUD_CDC_RX_BUFSIZE   64
-#define CFG_TUD_CDC_TX_BUFSIZE   64
+// CDC FIFO size of TX and RX (set by CMake: CDC_RX_BUFSIZE / CDC_TX_BUFSIZE).
+// The RX FIFO is the ring that absorbs bulk CMD_FRAME uploads: a full
+// 128x64 frame (1027 bytes with header) fits in the default 2 KB, so the
+// host can push it without waiting for the main loop to drain packets.
+#ifndef CFG_TUD_CDC_RX_BUFSIZE
+#define CFG_TUD_CDC_RX_BUFSIZE   2048
+#endif
+#ifndef CFG_TUD_CDC_TX_BUFSIZE
+#define CFG_TUD_CDC_TX_BUFSIZE   256
+#endif
 
-// CDC Endpoint transfer buffer size, more is faster
+// CDC Endpoint transfer buffer size. Kept at one full-speed packet: a larger
+// OUT transfer only completes on a short packet or when full, and Linux
+// cdc-acm sends no ZLP, so a write that is a multiple of 64 bytes would
+// sit in the endpoint buffer until more data arrived.
 #define CFG_TUD_CDC_EP_BUFSIZE   64
 
+// Vendor interface FIFOs: same budget as CDC, since it carries the same
+// command stream (including CMD_FRAME uploads)
+#define CFG_TUD_VENDOR_RX_BUFSIZE CFG_TUD_CDC_RX_BUFSIZE
+#define CFG_TUD_VENDOR_TX_BUFSIZE CFG_TUD_CDC_TX_BUFSIZE
+#define CFG_TUD_VENDOR_EPSIZE     64
+
 #ifdef __cplusplus
 }
 #endif
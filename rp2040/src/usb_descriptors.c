@@ -79,20 +79,32 @@ enum {
     ITF_NUM_HID = 0,
     ITF_NUM_CDC_0,
     ITF_NUM_CDC_0_DATA,
+#if CFG_TUD_VENDOR
+    ITF_NUM_VENDOR,
+#endif
     ITF_NUM_TOTAL
 };
 
+#if CFG_TUD_VENDOR
+#define CONFIG_TOTAL_LEN    (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN + TUD_CDC_DESC_LEN + TUD_VENDOR_DESC_LEN)
+#else
 #define CONFIG_TOTAL_LEN    (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN + TUD_CDC_DESC_LEN)
+#endif
 
 uint8_t const desc_configuration[] = {
     // Config number, interface count, string index, total length, attribute, power in mA
-    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
 
     // Interface descriptor, string index, protocol, report descriptor len, EP In address, size & polling interval
     TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_MOUSE, sizeof(desc_hid_report), 0x81, 16, 10),
 
     // Interface number, string index, EP notification address and size, EP data address and size
-    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_0, 4, 0x82, 8, 0x03, 0x84, 64)
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_0, 4, 0x82, 8, 0x03, 0x84, 64),
+
+#if CFG_TUD_VENDOR
+    // Interface number, string index, EP Out & IN address, EP size
+    TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, 5, 0x05, 0x85, CFG_TUD_VENDOR_EPSIZE),
+#endif
 };
 
 // Invoked when received GET CONFIGURATION DESCRIPTOR
@@ -123,7 +135,8 @@ char const* string_desc_arr[] = {
     "hackboxguy",                         // 1: Manufacturer
     NULL,                                // 2: Product (resolved at runtime from g_portrait)
     NULL,                                // 3: Serial (populated at runtime from chip ID)
-    "CDC Serial"                         // 4: CDC Interface
+    "CDC Serial",                        // 4: CDC Interface
+    "Display Bulk"                       // 5: Vendor Interface (ENABLE_VENDOR_INTERFACE)
 };
 
 // Invoked when received GET STRING DESCRIPTOR request
@@ -0,0 +1,56 @@
+// Dispatch micro-benchmark: host CPU time per command through parse_byte()
+// (descriptor table lookup, framing, handle_command() and the handler) for
+// a few command shapes. main.cpp is compiled into this file so its static
+// parser can be called directly; the simulated board only brings the
+// firmware up first.
+//
+//   bench_dispatch [commands]      (default 2000000 per shape)
+//
+// The numbers are host CPU time: compare them between builds on the same
+// machine, they say nothing absolute about the RP2040.
+
+#define main firmware_main
+#include "main.cpp"
+#undef main
+
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+#include "sim.h"
+
+typedef struct {
+    const char* name;
+    std::vector<uint8_t> cmd;
+} bench_shape_t;
+
+static cmd_stream_t bench_stream = { tud_cdc_available, tud_cdc_read, cdc_reply, tud_cdc_write, tud_cdc_write_flush, NULL };
+
+int main(int argc, char** argv) {
+    long count = argc > 1 ? atol(argv[1]) : 2000000;
+    if (count <= 0) return 1;
+
+    const bench_shape_t shapes[] = {
+        // Fixed length, trivial handler: table lookup and framing only
+        {"set_cursor", {CMD_SET_CURSOR, 8, 8}},
+        // Sub-op length function, handler finds no such graph
+        {"graph_sample", {CMD_GRAPH, GRAPH_OP_SAMPLE, 7, 50}},
+        // Variable length with a draw
+        {"draw_text_8", {CMD_DRAW_TEXT, 0, 16, 8, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}},
+        // Unknown opcode: resync per byte
+        {"unknown", {0x55}},
+    };
+
+    sim_boot();
+
+    printf("%-14s %10s %10s\n", "command", "ns/cmd", "ns/byte");
+    for (const bench_shape_t& shape : shapes) {
+        const std::vector<uint8_t>& cmd = shape.cmd;
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < count; i++) {
+            for (uint8_t b : cmd) parse_byte(&bench_stream, b);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("%-14s %10.1f %10.1f\n", shape.name, ns / count, ns / count / cmd.size());
+    }
+    return 0;
+}
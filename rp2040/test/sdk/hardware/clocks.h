@@ -0,0 +1,22 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+enum clock_index {
+    clk_sys = 5,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+void set_sys_clock_48mhz(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_CLOCKS_H
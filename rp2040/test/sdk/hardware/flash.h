@@ -0,0 +1,24 @@
+#ifndef SIM_HARDWARE_FLASH_H
+#define SIM_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+#define FLASH_PAGE_SIZE   (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Flash is a RAM array on the host; reads go through XIP_BASE as on the chip
+extern uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_memory)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_FLASH_H
@@ -0,0 +1,41 @@
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include "pico/stdlib.h"
+
+#define GPIO_IN  0
+#define GPIO_OUT 1
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+#define GPIO_IRQ_LEVEL_LOW  0x1u
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define GPIO_IRQ_EDGE_FALL  0x4u
+#define GPIO_IRQ_EDGE_RISE  0x8u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_disable_pulls(uint gpio);
+bool gpio_get(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_GPIO_H
@@ -0,0 +1,32 @@
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t* i2c);
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate);
+uint i2c_hw_index(i2c_inst_t* i2c);
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, uint timeout_us);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HARDWARE_I2C_H
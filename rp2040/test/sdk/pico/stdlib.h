@@ -0,0 +1,49 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+// Host build: the parts of the Pico SDK the firmware uses, implemented by the
+// simulated board in sim.cpp. Time is simulated and only moves when the
+// firmware sleeps, waits or services USB.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+absolute_time_t from_us_since_boot(uint64_t us);
+uint64_t to_us_since_boot(absolute_time_t t);
+uint32_t to_ms_since_boot(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+bool time_reached(absolute_time_t t);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us_32(uint32_t us);
+void busy_wait_us(uint64_t us);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout);
+static inline void tight_loop_contents(void) {}
+
+bool stdio_init_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "hardware/gpio.h"
+
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+#endif // SIM_PICO_STDLIB_H
@@ -0,0 +1,18 @@
+#ifndef SIM_PICO_UNIQUE_ID_H
+#define SIM_PICO_UNIQUE_ID_H
+
+#include "pico/stdlib.h"
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pico_get_unique_board_id_string(char* id_out, uint len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PICO_UNIQUE_ID_H
@@ -0,0 +1,54 @@
+#ifndef SIM_TUSB_H
+#define SIM_TUSB_H
+
+// Host build: the TinyUSB device API the firmware uses, backed by the
+// simulated host in sim.cpp (CDC and vendor FIFOs, HID report log)
+
+#include "pico/stdlib.h"
+#include "tusb_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+bool tusb_init(void);
+void tud_task(void);
+bool tud_mounted(void);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+
+uint32_t tud_cdc_available(void);
+uint32_t tud_cdc_read(void* buffer, uint32_t bufsize);
+uint32_t tud_cdc_write(const void* buffer, uint32_t bufsize);
+uint32_t tud_cdc_write_flush(void);
+uint32_t tud_cdc_write_available(void);
+bool tud_cdc_connected(void);
+
+bool tud_hid_ready(void);
+bool tud_hid_report(uint8_t report_id, const void* report, uint16_t len);
+
+uint32_t tud_vendor_available(void);
+uint32_t tud_vendor_read(void* buffer, uint32_t bufsize);
+uint32_t tud_vendor_write(const void* buffer, uint32_t bufsize);
+uint32_t tud_vendor_write_flush(void);
+uint32_t tud_vendor_write_available(void);
+
+// Application callbacks (main.cpp)
+void tud_mount_cb(void);
+void tud_suspend_cb(bool remote_wakeup_en);
+void tud_resume_cb(void);
+void tud_cdc_rx_cb(uint8_t itf);
+void tud_cdc_line_state_cb(uint8_t itf, bool dtr, bool rts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_TUSB_H
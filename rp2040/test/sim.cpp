@@ -0,0 +1,911 @@
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <algorithm>
+#include <deque>
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/spi.h"
+#include "hardware/sync.h"
+
+// The firmware's main(), renamed by the test build (see CMakeLists.txt)
+int firmware_main();
+
+#define SIM_GPIO_COUNT        30
+#define SIM_FIRMWARE_STACK    (1 << 20)
+#define SIM_QUERY_TIMEOUT_US  1000000
+
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+#define SIM_PAGE_ADDRESSING_ONLY true   // No 0x20-0x22: page addressing only
+#define SIM_RAM_COLS 132
+#else
+#define SIM_PAGE_ADDRESSING_ONLY false
+#define SIM_RAM_COLS 128
+#endif
+
+// Clock and coroutine
+
+static uint64_t now_us = 0;
+static uint64_t run_until_us = 0;
+static bool in_firmware = false;
+static bool firmware_started = false;
+static ucontext_t test_context;
+static ucontext_t firmware_context;
+static uint8_t* firmware_stack = NULL;
+
+static void firmware_entry() {
+    firmware_main();
+    fprintf(stderr, "sim: firmware main() returned\n");
+    abort();
+}
+
+// Hand control back to the test once main() has used up its time
+static void yield_point() {
+    if (in_firmware && now_us >= run_until_us) swapcontext(&firmware_context, &test_context);
+}
+
+void sim_run_us(uint64_t us) {
+    if (in_firmware) abort(); // Only the test side drives the clock
+    run_until_us = now_us + us;
+    if (!firmware_started) {
+        firmware_stack = (uint8_t*)malloc(SIM_FIRMWARE_STACK);
+        getcontext(&firmware_context);
+        firmware_context.uc_stack.ss_sp = firmware_stack;
+        firmware_context.uc_stack.ss_size = SIM_FIRMWARE_STACK;
+        firmware_context.uc_link = NULL;
+        makecontext(&firmware_context, firmware_entry, 0);
+        firmware_started = true;
+    }
+    in_firmware = true;
+    swapcontext(&test_context, &firmware_context);
+    in_firmware = false;
+}
+
+void sim_run_ms(uint32_t ms) {
+    sim_run_us((uint64_t)ms * 1000);
+}
+
+void sim_advance_us(uint64_t us) {
+    if (in_firmware) abort();
+    now_us += us;
+}
+
+void sim_boot() {
+    sim_run_us(SIM_BOOT_US);
+}
+
+uint64_t sim_now_us() {
+    return now_us;
+}
+
+absolute_time_t get_absolute_time(void) { return now_us; }
+absolute_time_t make_timeout_time_us(uint64_t us) { return now_us + us; }
+absolute_time_t make_timeout_time_ms(uint32_t ms) { return now_us + (uint64_t)ms * 1000; }
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+bool time_reached(absolute_time_t t) { return now_us >= t; }
+uint32_t time_us_32(void) { return (uint32_t)now_us; }
+uint64_t time_us_64(void) { return now_us; }
+
+void sleep_us(uint64_t us) {
+    now_us += us;
+    yield_point();
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+    if (t > now_us) now_us = t;
+    yield_point();
+}
+
+void busy_wait_us_32(uint32_t us) { sleep_us(us); }
+void busy_wait_us(uint64_t us) { sleep_us(us); }
+
+// Interrupts the test side raised (GPIO edges, USB resume); they end a WFE
+static uint32_t sim_interrupts = 0;
+
+// WFE: sleep until the timeout or the next interrupt. The test side can only
+// raise one while main() is handed back to it, so the sleep yields there.
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+    uint32_t interrupts = sim_interrupts;
+    while (now_us < timeout) {
+        now_us = timeout < run_until_us ? timeout : run_until_us;
+        yield_point();
+        if (sim_interrupts != interrupts) return false;
+    }
+    return true;
+}
+
+bool stdio_init_all(void) { return true; }
+
+void pico_get_unique_board_id_string(char* id_out, uint len) {
+    snprintf(id_out, len, "%s", "E6614103E7452D2F");
+}
+
+// System clock and interrupts
+
+static uint32_t sys_khz = 125000;
+static uint32_t interrupts_disabled = 0;
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    (void) clk_index;
+    return sys_khz * 1000;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void) required;
+    sys_khz = freq_khz;
+    return true;
+}
+
+void set_sys_clock_48mhz(void) {
+    sys_khz = 48000;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return interrupts_disabled++;
+}
+
+void restore_interrupts(uint32_t status) {
+    interrupts_disabled = status;
+}
+
+// Panels
+
+static sim_panel_t panels[DISPLAY_COUNT];
+
+static void panel_reset(sim_panel_t* p) {
+    p->on = false;
+    p->inverted = false;
+    p->contrast = 0x7F;
+    p->offset = 0;
+    p->multiplex = 63;
+    p->memory_mode = 2;
+    p->page = 0;
+    p->col = 0;
+    p->page_start = 0;
+    p->page_end = SIM_PANEL_PAGES - 1;
+    p->col_start = 0;
+    p->col_end = SIM_RAM_COLS - 1;
+    p->cmd_len = 0;
+    p->cmd_need = 0;
+}
+
+// Argument bytes following a command opcode; -1 if the controller lacks it
+static int command_args(uint8_t c) {
+    switch (c) {
+        case 0x20: case 0x21: case 0x22: case 0x8D:
+            if (SIM_PAGE_ADDRESSING_ONLY) return -1;
+            return c == 0x20 || c == 0x8D ? 1 : 2;
+        case 0xAD:
+            return SIM_PAGE_ADDRESSING_ONLY ? 1 : -1;
+        case 0x81: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        default:
+            if (c <= 0x1F || (c >= 0x40 && c <= 0x7F) || (c >= 0xB0 && c <= 0xB7)) return 0;
+            if (c == 0xA0 || c == 0xA1 || (c >= 0xA4 && c <= 0xA7) || c == 0xAE || c == 0xAF) return 0;
+            if (c == 0xC0 || c == 0xC8 || c == 0xE3) return 0;
+            return -1;
+    }
+}
+
+static void panel_execute(sim_panel_t* p) {
+    const uint8_t* a = &p->cmd[1];
+    uint8_t c = p->cmd[0];
+    if (c <= 0x0F) {
+        p->col = (p->col & 0xF0) | c;
+    } else if (c <= 0x1F) {
+        p->col = (p->col & 0x0F) | ((c & 0x0F) << 4);
+    } else if (c >= 0xB0 && c <= 0xB7) {
+        p->page = c & 0x07;
+    } else {
+        switch (c) {
+            case 0x20: p->memory_mode = a[0] & 0x03; break;
+            case 0x21: p->col_start = p->col = a[0]; p->col_end = a[1]; break;
+            case 0x22: p->page_start = p->page = a[0] & 0x07; p->page_end = a[1] & 0x07; break;
+            case 0x81: p->contrast = a[0]; break;
+            case 0xA6: p->inverted = false; break;
+            case 0xA7: p->inverted = true; break;
+            case 0xA8: p->multiplex = a[0]; break;
+            case 0xAE: p->on = false; break;
+            case 0xAF: p->on = true; break;
+            case 0xD3: p->offset = a[0] & 0x3F; break;
+            default: break;
+        }
+    }
+}
+
+static void panel_command(sim_panel_t* p, uint8_t c) {
+    if (p->cmd_need == 0) {
+        int args = command_args(c);
+        if (args < 0) {
+            p->bad_commands++;
+            return;
+        }
+        p->cmd[0] = c;
+        p->cmd_len = 1;
+        p->cmd_need = 1 + args;
+    } else {
+        p->cmd[p->cmd_len++] = c;
+    }
+    if (p->cmd_len == p->cmd_need) {
+        panel_execute(p);
+        p->cmd_need = 0;
+    }
+}
+
+static void panel_data(sim_panel_t* p, uint8_t d) {
+    if (p->memory_mode == 2) {
+        // Page addressing: the column pointer stops at the end of the RAM
+        if (p->col < SIM_RAM_COLS) p->ram[p->page][p->col++] = d;
+        return;
+    }
+    // Horizontal addressing inside the column/page window, wrapping
+    p->ram[p->page][p->col] = d;
+    if (p->col++ >= p->col_end) {
+        p->col = p->col_start;
+        if (p->page++ >= p->page_end) p->page = p->page_start;
+    }
+}
+
+static void panel_receive(sim_panel_t* p, bool data, const uint8_t* bytes, size_t len, uint32_t baud) {
+    p->log.push_back({now_us, data, std::vector<uint8_t>(bytes, bytes + len), baud});
+    for (size_t i = 0; i < len; i++) {
+        if (data) {
+            panel_data(p, bytes[i]);
+        } else {
+            panel_command(p, bytes[i]);
+        }
+    }
+}
+
+sim_panel_t* sim_panel(uint8_t id) {
+    return id < DISPLAY_COUNT ? &panels[id] : NULL;
+}
+
+std::vector<sim_window_t> sim_flush_windows(uint8_t id, size_t from) {
+    std::vector<sim_window_t> windows;
+    const std::vector<sim_transfer_t>& log = panels[id].log;
+    sim_window_t w = {0, 0, 0, 0};
+    for (size_t i = from; i < log.size(); i++) {
+        const std::vector<uint8_t>& b = log[i].bytes;
+        if (!log[i].data) {
+            if (b.size() == 6 && b[0] == 0x22 && b[3] == 0x21) {
+                w = {b[1], b[2], b[4], b[5]};
+            } else if (b.size() == 3 && (b[0] & 0xF0) == 0xB0 && (b[1] & 0xF0) == 0x00 && (b[2] & 0xF0) == 0x10) {
+                uint8_t col = ((b[2] & 0x0F) << 4 | b[1]) - DISPLAY_DESC.col_offset;
+                w = {(uint8_t)(b[0] & 0x0F), (uint8_t)(b[0] & 0x0F), col, col};
+            }
+            continue;
+        }
+        // Data: as many columns as it has bytes per page of the window
+        size_t cols = b.size() / (w.page_end - w.page_start + 1);
+        windows.push_back({w.page_start, w.page_end, w.col_start, (uint8_t)(w.col_start + cols - 1)});
+    }
+    return windows;
+}
+
+std::vector<uint8_t> sim_panel_image(uint8_t id) {
+    std::vector<uint8_t> image(SSD1306_BUFFER_SIZE);
+    const sim_panel_t* p = &panels[id];
+    for (int page = 0; page < SSD1306_HEIGHT / 8; page++) {
+        for (int col = 0; col < SSD1306_WIDTH; col++) {
+            image[page * SSD1306_WIDTH + col] = p->ram[page][col + DISPLAY_DESC.col_offset];
+        }
+    }
+    return image;
+}
+
+bool sim_panel_pixel(uint8_t id, uint8_t x, uint8_t y) {
+    const sim_panel_t* p = &panels[id];
+    if (!p->on) return false;
+    uint8_t row = (y + p->offset) % (p->multiplex + 1);
+    bool set = (p->ram[row / 8][x + DISPLAY_DESC.col_offset] >> (row % 8)) & 1;
+    return set != p->inverted;
+}
+
+// GPIO
+
+typedef struct {
+    bool out;
+    bool level;             // Output latch
+    bool pull_up;
+    bool driven;            // Level forced from outside
+    bool external;
+    int function;
+    uint32_t irq_events;
+} sim_gpio_t;
+
+static sim_gpio_t gpios[SIM_GPIO_COUNT];
+static gpio_irq_callback_t gpio_callback = NULL;
+
+// I2C pins as set up by the firmware, per block (-1 = none)
+static int i2c_sda[2] = {-1, -1};
+static int i2c_scl[2] = {-1, -1};
+
+static bool bus_stuck(int bus);
+
+static bool pin_level(uint pin) {
+    for (int bus = 0; bus < 2; bus++) {
+        if ((int)pin == i2c_sda[bus] && bus_stuck(bus)) return false;
+    }
+    const sim_gpio_t* g = &gpios[pin];
+    if (g->out) return g->level;
+    if (g->driven) return g->external;
+    return g->pull_up;
+}
+
+void gpio_init(uint gpio) {
+    gpios[gpio].out = false;
+    gpios[gpio].level = false;
+    gpios[gpio].function = GPIO_FUNC_SIO;
+}
+
+#ifdef SIM_TRANSPORT_SPI
+static const uint spi_cs_pins[DISPLAY_COUNT] = {
+    SPI_CS_PIN,
+#if DISPLAY_COUNT > 1
+    DISPLAY2_CS_PIN,
+#endif
+};
+static const uint spi_rst_pins[DISPLAY_COUNT] = {
+    SPI_RST_PIN,
+#if DISPLAY_COUNT > 1
+    DISPLAY2_RST_PIN,
+#endif
+};
+#endif
+
+static void release_scl(int bus);
+
+void gpio_set_dir(uint gpio, bool out) {
+    bool was_out = gpios[gpio].out;
+    gpios[gpio].out = out;
+    for (int bus = 0; bus < 2; bus++) {
+        if ((int)gpio == i2c_scl[bus] && was_out && !out) release_scl(bus);
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    gpios[gpio].function = fn;
+    if (fn == GPIO_FUNC_I2C) {
+        // RP2040 pin mux: I2C block (gpio / 2) % 2, SDA on even pins
+        int bus = (gpio / 2) % 2;
+        if (gpio % 2 == 0) {
+            i2c_sda[bus] = gpio;
+        } else {
+            i2c_scl[bus] = gpio;
+        }
+    }
+}
+
+void gpio_pull_up(uint gpio) {
+    gpios[gpio].pull_up = true;
+}
+
+void gpio_disable_pulls(uint gpio) {
+    gpios[gpio].pull_up = false;
+}
+
+bool gpio_get(uint gpio) {
+    return pin_level(gpio);
+}
+
+void gpio_put(uint gpio, bool value) {
+    bool was = gpios[gpio].level;
+    gpios[gpio].level = value;
+#ifdef SIM_TRANSPORT_SPI
+    // Falling edge on a panel's RST line resets its controller
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        if (gpio == spi_rst_pins[id] && was && !value) {
+            panel_reset(&panels[id]);
+            panels[id].resets++;
+        }
+    }
+#else
+    (void) was;
+#endif
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    if (enabled) {
+        gpios[gpio].irq_events |= events;
+    } else {
+        gpios[gpio].irq_events &= ~events;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_callback = callback;
+    gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+static void gpio_set_external(uint pin, bool driven, bool level) {
+    bool before = pin_level(pin);
+    gpios[pin].driven = driven;
+    gpios[pin].external = level;
+    bool after = pin_level(pin);
+    if (before == after || !gpio_callback) return;
+
+    uint32_t edge = after ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (gpios[pin].irq_events & edge) {
+        sim_interrupts++;
+        gpio_callback(pin, edge);
+    }
+}
+
+void sim_gpio_drive(uint pin, bool level) {
+    gpio_set_external(pin, true, level);
+}
+
+void sim_gpio_release(uint pin) {
+    gpio_set_external(pin, false, false);
+}
+
+bool sim_gpio_output(uint pin) {
+    return gpios[pin].level;
+}
+
+// I2C
+
+struct i2c_inst {
+    uint index;
+    uint baud;
+    bool enabled;
+};
+
+i2c_inst_t i2c0_inst = {0, 0, false};
+i2c_inst_t i2c1_inst = {1, 0, false};
+
+#ifndef SIM_TRANSPORT_SPI
+typedef struct {
+    uint bus;
+    uint8_t addr;
+} i2c_wiring_t;
+
+static i2c_wiring_t i2c_wiring[DISPLAY_COUNT] = {
+    { 0, SSD1306_ADDR },
+#if DISPLAY_COUNT > 1
+    { 0, DISPLAY2_ADDR },
+#endif
+};
+
+static void i2c_wire_panels() {
+    i2c_wiring[0].bus = I2C_PORT->index;
+#if DISPLAY_COUNT > 1
+    i2c_wiring[1].bus = DISPLAY2_I2C_PORT->index;
+#endif
+}
+
+static sim_panel_t* i2c_panel(uint bus, uint8_t addr) {
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        if (i2c_wiring[id].bus == bus && i2c_wiring[id].addr == addr) return &panels[id];
+    }
+    return NULL;
+}
+
+static bool bus_stuck(int bus) {
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        if ((int)i2c_wiring[id].bus == bus && panels[id].stuck_clocks > 0) return true;
+    }
+    return false;
+}
+
+// SCL released by the firmware's bus clear: one clock for stuck slaves
+static void release_scl(int bus) {
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        if ((int)i2c_wiring[id].bus == bus && panels[id].stuck_clocks > 0) panels[id].stuck_clocks--;
+    }
+}
+#else
+static bool bus_stuck(int bus) {
+    (void) bus;
+    return false;
+}
+
+static void release_scl(int bus) {
+    (void) bus;
+}
+#endif
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) {
+    i2c->baud = baudrate;
+    i2c->enabled = true;
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t* i2c) {
+    i2c->enabled = false;
+}
+
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate) {
+    i2c->baud = baudrate;
+    return baudrate;
+}
+
+uint i2c_hw_index(i2c_inst_t* i2c) {
+    return i2c->index;
+}
+
+// Nine clocks per byte (8 data + ACK), address byte included
+static uint64_t i2c_time_us(const i2c_inst_t* i2c, size_t bytes) {
+    return (bytes * 9 * 1000000ull + i2c->baud - 1) / i2c->baud;
+}
+
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, uint timeout_us) {
+    (void) nostop;
+    if (!i2c->enabled || len == 0) return PICO_ERROR_GENERIC;
+#ifndef SIM_TRANSPORT_SPI
+    sim_panel_t* p = i2c_panel(i2c->index, addr);
+#else
+    sim_panel_t* p = NULL;
+    (void) addr;
+#endif
+    if (p) p->attempts++;
+
+    if (p && (p->timeouts > 0 || p->stuck_clocks > 0)) {
+        if (p->timeouts > 0) p->timeouts--;
+        now_us += timeout_us;
+        return PICO_ERROR_TIMEOUT;
+    }
+    if (!p || !p->present || p->nacks > 0) {
+        if (p && p->nacks > 0) p->nacks--;
+        now_us += i2c_time_us(i2c, 1);
+        return PICO_ERROR_GENERIC;
+    }
+
+    now_us += i2c_time_us(i2c, len + 1);
+    // Control byte: 0x00 = command stream, 0x40 = data stream
+    if (src[0] != 0x00 && src[0] != 0x40) {
+        p->bad_commands++;
+        return (int)len;
+    }
+    panel_receive(p, src[0] == 0x40, src + 1, len - 1, i2c->baud);
+    return (int)len;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    return i2c_write_timeout_us(i2c, addr, src, len, nostop, 1000000);
+}
+
+// SPI
+
+struct spi_inst {
+    uint baud;
+};
+
+spi_inst_t spi0_inst = {0};
+spi_inst_t spi1_inst = {0};
+
+uint spi_init(spi_inst_t* spi, uint baudrate) {
+    spi->baud = baudrate;
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    now_us += (len * 8 * 1000000ull + spi->baud - 1) / spi->baud;
+#ifdef SIM_TRANSPORT_SPI
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        uint cs = spi_cs_pins[id];
+        if (gpios[cs].out && !gpios[cs].level) panel_receive(&panels[id], gpios[SPI_DC_PIN].level, src, len, spi->baud);
+    }
+#endif
+    return (int)len;
+}
+
+// Flash
+
+uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+static int64_t flash_budget = -1;
+static uint32_t flash_erases = 0;
+static uint32_t flash_programs = 0;
+
+void sim_flash_power_cut(int64_t bytes) {
+    flash_budget = bytes;
+}
+
+uint32_t sim_flash_erases() {
+    return flash_erases;
+}
+
+uint32_t sim_flash_programs() {
+    return flash_programs;
+}
+
+// One byte of an erase or program; the power cut strikes before it (and
+// takes the interrupt mask and the cut itself with it)
+static void flash_byte_budget() {
+    if (flash_budget == 0) {
+        flash_budget = -1;
+        interrupts_disabled = 0;
+        throw sim_power_loss();
+    }
+    if (flash_budget > 0) flash_budget--;
+}
+
+static void flash_check(uint32_t offset, size_t count, uint32_t align) {
+    // The SDK requires aligned ranges and interrupts off (XIP is unavailable)
+    if (offset % align || count % align || offset + count > PICO_FLASH_SIZE_BYTES || !interrupts_disabled) {
+        fprintf(stderr, "sim: bad flash access at 0x%x (+%zu, interrupts %s)\n",
+                offset, count, interrupts_disabled ? "off" : "on");
+        abort();
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    flash_check(flash_offs, count, FLASH_SECTOR_SIZE);
+    flash_erases++;
+    for (size_t i = 0; i < count; i++) {
+        flash_byte_budget();
+        sim_flash_memory[flash_offs + i] = 0xFF;
+    }
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    flash_check(flash_offs, count, FLASH_PAGE_SIZE);
+    flash_programs++;
+    for (size_t i = 0; i < count; i++) {
+        flash_byte_budget();
+        sim_flash_memory[flash_offs + i] &= data[i]; // NOR: programming only clears bits
+    }
+}
+
+// USB
+
+typedef struct {
+    std::deque<uint8_t> host_out;       // Written by the host, not delivered yet
+    std::deque<uint8_t> rx;             // Device RX FIFO
+    std::deque<uint8_t> tx;             // Device TX FIFO
+    std::vector<uint8_t> host_in;       // Received by the host
+    uint64_t next_packet_us;
+    size_t rx_size;
+    size_t tx_size;
+} sim_pipe_t;
+
+static sim_pipe_t cdc = {{}, {}, {}, {}, 0, CFG_TUD_CDC_RX_BUFSIZE, CFG_TUD_CDC_TX_BUFSIZE};
+#if CFG_TUD_VENDOR
+static sim_pipe_t vendor = {{}, {}, {}, {}, 0, CFG_TUD_VENDOR_RX_BUFSIZE, CFG_TUD_VENDOR_TX_BUFSIZE};
+#endif
+
+static bool usb_started = false;
+static bool usb_mounted = false;
+static uint64_t usb_mount_time = 0;
+static bool usb_suspended = false;
+static bool usb_suspend_request = false;
+static bool usb_remote_wakeup_en = true;
+static uint32_t usb_remote_wakeups = 0;
+static bool cdc_dtr = true;
+static bool cdc_dtr_reported = true;
+static bool host_reading = true;
+static bool hid_busy = false;
+static std::vector<sim_hid_report_t> hid_reports;
+
+// Move host data into the RX FIFO at the bulk packet rate (a packet only
+// goes in whole); returns true if anything arrived
+static bool pipe_receive(sim_pipe_t* p) {
+    if (p->next_packet_us + 1000 < now_us) p->next_packet_us = now_us - 1000; // Burst of at most 1 ms
+    bool moved = false;
+    while (!p->host_out.empty() && p->next_packet_us <= now_us) {
+        size_t n = p->host_out.size() < 64 ? p->host_out.size() : 64;
+        if (p->rx.size() + n > p->rx_size) break;
+        p->rx.insert(p->rx.end(), p->host_out.begin(), p->host_out.begin() + n);
+        p->host_out.erase(p->host_out.begin(), p->host_out.begin() + n);
+        p->next_packet_us += SIM_USB_PACKET_US;
+        moved = true;
+    }
+    return moved;
+}
+
+static void pipe_send(sim_pipe_t* p) {
+    if (!host_reading) return;
+    p->host_in.insert(p->host_in.end(), p->tx.begin(), p->tx.end());
+    p->tx.clear();
+}
+
+static uint32_t pipe_read(sim_pipe_t* p, void* buffer, uint32_t bufsize) {
+    uint32_t n = p->rx.size() < bufsize ? p->rx.size() : bufsize;
+    std::copy(p->rx.begin(), p->rx.begin() + n, (uint8_t*)buffer);
+    p->rx.erase(p->rx.begin(), p->rx.begin() + n);
+    return n;
+}
+
+static uint32_t pipe_write(sim_pipe_t* p, const void* buffer, uint32_t bufsize) {
+    uint32_t space = p->tx_size - p->tx.size();
+    uint32_t n = bufsize < space ? bufsize : space;
+    p->tx.insert(p->tx.end(), (const uint8_t*)buffer, (const uint8_t*)buffer + n);
+    return n;
+}
+
+bool tusb_init(void) {
+    usb_started = true;
+    usb_mount_time = now_us + SIM_MOUNT_US;
+    return true;
+}
+
+void tud_task(void) {
+    now_us += 1;
+    if (usb_started && !usb_mounted && now_us >= usb_mount_time) {
+        usb_mounted = true;
+        tud_mount_cb();
+    }
+    if (usb_mounted && usb_suspend_request != usb_suspended) {
+        usb_suspended = usb_suspend_request;
+        if (usb_suspended) {
+            tud_suspend_cb(usb_remote_wakeup_en);
+        } else {
+            tud_resume_cb();
+        }
+    }
+    if (usb_mounted && !usb_suspended) {
+        if (cdc_dtr != cdc_dtr_reported) {
+            cdc_dtr_reported = cdc_dtr;
+            tud_cdc_line_state_cb(0, cdc_dtr, false);
+        }
+        hid_busy = false;
+        pipe_send(&cdc);
+#if CFG_TUD_VENDOR
+        pipe_send(&vendor);
+        pipe_receive(&vendor);
+#endif
+        if (pipe_receive(&cdc)) tud_cdc_rx_cb(0);
+    }
+    yield_point();
+}
+
+bool tud_mounted(void) { return usb_mounted; }
+bool tud_suspended(void) { return usb_suspended; }
+
+bool tud_remote_wakeup(void) {
+    if (!usb_suspended) return false;
+    usb_remote_wakeups++;
+    usb_suspend_request = false; // The host resumes the bus
+    return true;
+}
+
+uint32_t tud_cdc_available(void) { return cdc.rx.size(); }
+uint32_t tud_cdc_read(void* buffer, uint32_t bufsize) { return pipe_read(&cdc, buffer, bufsize); }
+uint32_t tud_cdc_write(const void* buffer, uint32_t bufsize) { return pipe_write(&cdc, buffer, bufsize); }
+uint32_t tud_cdc_write_flush(void) { return cdc.tx.size(); }
+uint32_t tud_cdc_write_available(void) { return cdc.tx_size - cdc.tx.size(); }
+bool tud_cdc_connected(void) { return usb_mounted && !usb_suspended && cdc_dtr; }
+
+#if CFG_TUD_VENDOR
+uint32_t tud_vendor_available(void) { return vendor.rx.size(); }
+uint32_t tud_vendor_read(void* buffer, uint32_t bufsize) { return pipe_read(&vendor, buffer, bufsize); }
+uint32_t tud_vendor_write(const void* buffer, uint32_t bufsize) { return pipe_write(&vendor, buffer, bufsize); }
+uint32_t tud_vendor_write_flush(void) { return vendor.tx.size(); }
+uint32_t tud_vendor_write_available(void) { return vendor.tx_size - vendor.tx.size(); }
+
+void sim_vendor_write(const std::vector<uint8_t>& data) {
+    vendor.host_out.insert(vendor.host_out.end(), data.begin(), data.end());
+}
+
+std::vector<uint8_t> sim_vendor_read() {
+    std::vector<uint8_t> data;
+    data.swap(vendor.host_in);
+    return data;
+}
+
+std::vector<uint8_t> sim_vendor_query(const std::vector<uint8_t>& cmd, size_t reply_len) {
+    sim_vendor_write(cmd);
+    uint64_t deadline = now_us + SIM_QUERY_TIMEOUT_US;
+    while (vendor.host_in.size() < reply_len && now_us < deadline) sim_run_us(100);
+    return sim_vendor_read();
+}
+#endif
+
+bool tud_hid_ready(void) {
+    return usb_mounted && !usb_suspended && !hid_busy;
+}
+
+bool tud_hid_report(uint8_t report_id, const void* report, uint16_t len) {
+    (void) report_id;
+    if (!tud_hid_ready() || len < 4) return false;
+    const uint8_t* r = (const uint8_t*)report;
+    hid_reports.push_back({now_us, r[0], (int8_t)r[1], (int8_t)r[2], (int8_t)r[3]});
+    hid_busy = true; // Until the next tud_task(): one report per poll
+    return true;
+}
+
+void sim_cdc_write(const std::vector<uint8_t>& data) {
+    cdc.host_out.insert(cdc.host_out.end(), data.begin(), data.end());
+}
+
+size_t sim_cdc_pending() {
+    return cdc.host_out.size();
+}
+
+std::vector<uint8_t> sim_cdc_read() {
+    std::vector<uint8_t> data;
+    data.swap(cdc.host_in);
+    return data;
+}
+
+std::vector<uint8_t> sim_cdc_query(const std::vector<uint8_t>& cmd, size_t reply_len) {
+    sim_cdc_write(cmd);
+    uint64_t deadline = now_us + SIM_QUERY_TIMEOUT_US;
+    while (cdc.host_in.size() < reply_len && now_us < deadline) sim_run_us(100);
+    return sim_cdc_read();
+}
+
+void sim_cdc_set_dtr(bool dtr) {
+    cdc_dtr = dtr;
+}
+
+void sim_host_reading(bool reading) {
+    host_reading = reading;
+}
+
+void sim_usb_suspend(bool suspended, bool remote_wakeup) {
+    usb_suspend_request = suspended;
+    usb_remote_wakeup_en = remote_wakeup;
+    if (!suspended) sim_interrupts++; // Resume signalling
+}
+
+uint32_t sim_remote_wakeups() {
+    return usb_remote_wakeups;
+}
+
+std::vector<sim_hid_report_t>& sim_hid_reports() {
+    return hid_reports;
+}
+
+static bool pipe_drained(const sim_pipe_t* p) {
+    return p->host_out.empty() && p->rx.empty();
+}
+
+#if CFG_TUD_VENDOR
+#define VENDOR_DRAINED pipe_drained(&vendor)
+#else
+#define VENDOR_DRAINED true
+#endif
+
+void sim_settle() {
+    uint64_t deadline = now_us + SIM_QUERY_TIMEOUT_US;
+    // Let the firmware take in what the host has written first
+    while (now_us < deadline && !(pipe_drained(&cdc) && VENDOR_DRAINED)) sim_run_us(100);
+    sim_run_us(100);
+    while (now_us < deadline) {
+        bool pending = false;
+        for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+            if (ssd1306_flush_pending(id)) pending = true;
+        }
+        if (!pending) return;
+        sim_run_us(100);
+    }
+}
+
+// Framebuffer art
+
+std::string sim_art(const uint8_t* buf, int x, int y, int w, int h) {
+    std::string art;
+    for (int row = y; row < y + h; row++) {
+        for (int col = x; col < x + w; col++) {
+            bool set = (buf[(row / 8) * SSD1306_WIDTH + col] >> (row % 8)) & 1;
+            art += set ? '#' : '.';
+        }
+        art += '\n';
+    }
+    return art;
+}
+
+// Power-on state of the board (after the definitions above are initialized)
+static struct sim_power_on {
+    sim_power_on() {
+        memset(sim_flash_memory, 0xFF, sizeof(sim_flash_memory));
+        for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+            panel_reset(&panels[id]);
+            panels[id].present = true;
+        }
+#ifndef SIM_TRANSPORT_SPI
+        i2c_wire_panels();
+#endif
+    }
+} power_on;
@@ -0,0 +1,162 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Simulated board for the host tests. The firmware sources are compiled
+// unchanged for the host against the stand-ins in sdk/, which are implemented
+// here: a simulated clock, GPIO levels and edge interrupts, the display panels
+// on I2C or SPI, RAM-backed flash and the USB host side (CDC, vendor, HID).
+//
+// The firmware's main() runs as a coroutine. The clock only advances when the
+// firmware sleeps, services USB (tud_task) or moves bytes over the display
+// bus, and at those points control returns to the test once the time it was
+// given is used up. Nothing depends on the speed of the machine running the
+// tests, so bus counters, timings and reports are exactly reproducible.
+//
+// Panels are modelled at the controller level: each decodes the command and
+// data stream it receives (addressing mode, page/column windows, SH1106 page
+// addressing with its column offset, display offset, power, contrast) into its
+// own display RAM and keeps a log of every transfer. I2C panels can be told to
+// NACK, time out, or hold SDA low until the bus is clocked free.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "main.h"
+
+// Simulated time main() gets in sim_boot(): USB enumeration, panel power-up
+// (SSD1306_POWERUP_US) and init are over well before this
+#define SIM_BOOT_US          150000
+
+// USB: enumeration completes this long after tusb_init(); host OUT data is
+// delivered one 64-byte packet per SIM_USB_PACKET_US (full-speed bulk)
+#define SIM_MOUNT_US         20000
+#define SIM_USB_PACKET_US    50
+
+// Clock and firmware execution
+void sim_boot();                      // Start main() and run it for SIM_BOOT_US
+void sim_run_us(uint64_t us);         // Let main() run for us more microseconds
+void sim_run_ms(uint32_t ms);
+uint64_t sim_now_us();
+void sim_advance_us(uint64_t us);     // Move the clock without running main()
+                                      // (for firmware functions a test calls itself)
+
+// CDC, host side. Written bytes reach the device FIFO at the USB packet rate;
+// the host reads everything the device sends unless told to stop.
+void sim_cdc_write(const std::vector<uint8_t>& data);
+std::vector<uint8_t> sim_cdc_read();  // Bytes received since the last read
+size_t sim_cdc_pending();             // Written bytes the device has not taken in yet
+void sim_cdc_set_dtr(bool dtr);
+void sim_host_reading(bool reading);
+
+// Send cmd, run until reply_len bytes have come back (at most 1 s) and return
+// what was received
+std::vector<uint8_t> sim_cdc_query(const std::vector<uint8_t>& cmd, size_t reply_len);
+
+#if CFG_TUD_VENDOR
+// Vendor bulk interface, host side: same model as CDC, own FIFOs
+void sim_vendor_write(const std::vector<uint8_t>& data);
+std::vector<uint8_t> sim_vendor_read();
+std::vector<uint8_t> sim_vendor_query(const std::vector<uint8_t>& cmd, size_t reply_len);
+#endif
+
+// USB suspend/resume as signalled by the host; remote_wakeup: the host
+// enabled remote wakeup before suspending
+void sim_usb_suspend(bool suspended, bool remote_wakeup = true);
+uint32_t sim_remote_wakeups();        // tud_remote_wakeup() calls while suspended
+
+typedef struct {
+    uint64_t time_us;
+    uint8_t buttons;
+    int8_t x;
+    int8_t y;
+    int8_t wheel;
+} sim_hid_report_t;
+
+std::vector<sim_hid_report_t>& sim_hid_reports();
+
+// GPIO: external level on a pin (edge interrupts fire as on the chip); a pin
+// not driven reads its pull-up
+void sim_gpio_drive(uint pin, bool level);
+void sim_gpio_release(uint pin);
+bool sim_gpio_output(uint pin);       // Level the firmware drives on an output
+
+// One bus transfer as the panel received it (I2C: control byte stripped; a
+// control byte other than 0x00/0x40 counts as a bad command)
+typedef struct {
+    uint64_t time_us;
+    bool data;                        // false = command stream (I2C control byte / SPI DC)
+    std::vector<uint8_t> bytes;
+    uint32_t baud;                    // Bus clock it was sent at
+} sim_transfer_t;
+
+#define SIM_PANEL_PAGES 8
+#define SIM_PANEL_COLS  132           // SH1106 RAM width (SSD1306 uses 128)
+
+typedef struct {
+    // Display RAM and registers, decoded from the bus stream
+    uint8_t ram[SIM_PANEL_PAGES][SIM_PANEL_COLS];
+    bool on;
+    bool inverted;
+    uint8_t contrast;
+    uint8_t offset;                   // SET_DISPLAY_OFFSET (0xD3)
+    uint8_t multiplex;                // SET_MULTIPLEX (0xA8): rows - 1
+    uint8_t memory_mode;              // 0 = horizontal, 2 = page addressing
+    uint32_t resets;                  // RST pulses (SPI)
+    uint32_t bad_commands;            // Opcodes this controller does not have
+
+    std::vector<sim_transfer_t> log;
+    uint32_t attempts;                // I2C writes addressed to it, including failed ones
+
+    // I2C fault injection
+    bool present;                     // false: address is NACKed
+    int nacks;                        // NACK the next n writes
+    int timeouts;                     // Time out the next n writes
+    int stuck_clocks;                 // Hold SDA low until SCL pulses this often
+
+    // Decoder state
+    uint8_t page;
+    uint8_t col;
+    uint8_t page_start, page_end;
+    uint8_t col_start, col_end;
+    uint8_t cmd[3];
+    uint8_t cmd_len;
+    uint8_t cmd_need;
+} sim_panel_t;
+
+sim_panel_t* sim_panel(uint8_t id);   // Panel wired as display id in this build
+
+// Framebuffer windows a panel was sent from log entry from on: each
+// addressing command (SSD1306 page/column window, SH1106 page and column)
+// with the data transfer after it, in visible columns
+typedef struct {
+    uint8_t page_start, page_end;
+    uint8_t col_start, col_end;
+} sim_window_t;
+
+std::vector<sim_window_t> sim_flush_windows(uint8_t id, size_t from);
+
+// Visible columns of a panel's RAM in framebuffer layout (SSD1306_BUFFER_SIZE)
+std::vector<uint8_t> sim_panel_image(uint8_t id);
+
+// What the viewer sees at (x, y): RAM row shifted by the display offset,
+// wrapping as the controller does, blank while off, inverted if set
+bool sim_panel_pixel(uint8_t id, uint8_t x, uint8_t y);
+
+// Flash: sim_flash_memory (hardware/flash.h) is the whole chip, erased at start.
+// A power cut makes the erase or program that reaches it stop after the given
+// number of further bytes and throw sim_power_loss (for direct calls from a
+// test, not from inside a running main()). The cut is used up by it.
+struct sim_power_loss {};
+void sim_flash_power_cut(int64_t bytes);  // -1 = never
+uint32_t sim_flash_erases();
+uint32_t sim_flash_programs();
+
+// Run until the host's data (CDC and vendor) is taken in and no display has framebuffer
+// changes left to send (at most 1 s)
+void sim_settle();
+
+// Framebuffer rendering for golden comparisons: one line per pixel row of the
+// w x h area at (x, y), '#' = set, '.' = clear
+std::string sim_art(const uint8_t* buf, int x, int y, int w, int h);
+
+#endif // SIM_H
@@ -0,0 +1,114 @@
+// Emulated device for the host tools: the firmware on the simulated board,
+// its CDC port served over stdin/stdout or a pseudo-terminal, with the
+// simulated clock kept in step with the wall clock. tools/*.py open it as
+// port "sim:<path to this binary>"; anything that opens a tty (the host
+// library, hid_display_bench) can use the --pty mode.
+//
+//   sim_device           CDC on stdin/stdout, exits when stdin closes
+//   sim_device --pty     prints the pty path, serves it until killed
+//
+// Bus counters and framebuffer contents are those of the test builds; times
+// are simulated (see sim.h), so throughput figures describe the firmware and
+// the modelled full-speed USB, not the machine running it.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+
+// Simulated time run per step at most, so host data is taken in promptly
+#define STEP_US 1000
+
+// Host data handed to the simulated USB at most; the rest waits in the pipe
+// or pty, so a writer blocks once the device falls behind, as it would on a
+// device that NAKs (more than a STEP_US worth of bulk packets)
+#define HOST_WINDOW 4096
+
+// Pipe buffer asked for on stdin: a host write of this much (64 full frames)
+// completes at once and waits there, so how fast the simulated device takes
+// it in does not depend on when the host process gets scheduled
+#define PIPE_BUFFER_SIZE (1 << 20)
+
+static uint64_t wall_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool write_all(int fd, const uint8_t* data, size_t len) {
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Master side of a new pty in raw mode; its path is printed on stdout. The
+// slave stays open here too, so a client closing it does not end the serving
+static int open_pty() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+    const char* path = ptsname(master);
+    int slave = path ? open(path, O_RDWR | O_NOCTTY) : -1;
+    if (slave < 0) return -1;
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    printf("%s\n", path);
+    fflush(stdout);
+    return master;
+}
+
+int main(int argc, char** argv) {
+    bool pty = argc == 2 && strcmp(argv[1], "--pty") == 0;
+    if (argc > 1 && !pty) {
+        fprintf(stderr, "usage: %s [--pty]\n", argv[0]);
+        return 2;
+    }
+    int in = STDIN_FILENO, out = STDOUT_FILENO;
+    fcntl(in, F_SETPIPE_SZ, PIPE_BUFFER_SIZE); // Best effort: not a pipe, or over the limit
+    if (pty) {
+        in = out = open_pty();
+        if (in < 0) {
+            perror("pty");
+            return 1;
+        }
+    }
+
+    sim_boot();
+    uint64_t start_wall = wall_us();
+    uint64_t start_sim = sim_now_us();
+    static uint8_t buf[HOST_WINDOW];
+
+    for (;;) {
+        // A full window: poll() ignores the negative fd and only waits
+        size_t room = HOST_WINDOW - (sim_cdc_pending() < HOST_WINDOW ? sim_cdc_pending() : HOST_WINDOW);
+        struct pollfd p = {room ? in : -1, POLLIN, 0};
+        if (poll(&p, 1, 1) > 0) {
+            ssize_t n = read(in, buf, room);
+            if (n > 0) {
+                sim_cdc_write(std::vector<uint8_t>(buf, buf + n));
+            } else if (!pty) {
+                return 0; // Host closed the pipe
+            }
+        }
+
+        // Catch up with the wall clock a step at a time
+        uint64_t target = start_sim + (wall_us() - start_wall);
+        if (target > sim_now_us()) {
+            uint64_t us = target - sim_now_us();
+            sim_run_us(us < STEP_US ? us : STEP_US);
+        }
+
+        std::vector<uint8_t> reply = sim_cdc_read();
+        if (!reply.empty() && !write_all(out, reply.data(), reply.size())) return 0;
+    }
+}
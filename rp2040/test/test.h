@@ -0,0 +1,56 @@
+#ifndef TEST_H
+#define TEST_H
+
+// Minimal test runner for the host tests. TEST(name) registers a case; the
+// CHECK macros fail it with the location and, for CHECK_EQ, both values.
+// Every case runs in a process of its own (fork), so firmware statics and the
+// simulated board start from their power-on state each time.
+
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+typedef void (*test_fn_t)();
+
+int test_register(const char* name, test_fn_t fn);
+[[noreturn]] void test_fail(const char* file, int line, const std::string& message);
+
+// Power-cycle the board in the middle of a case: the case runs again from
+// the top in a fresh process, with the simulated flash kept. test_boot()
+// counts the reboots so far (0 on the first run). Simulated-board runners
+// (TEST_WITH_SIM) only.
+[[noreturn]] void test_reboot();
+int test_boot();
+
+std::string test_str(const std::string& v);
+std::string test_str(const char* v);
+std::string test_str(const std::vector<uint8_t>& v);
+std::string test_str(bool v);
+
+template <typename T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, int>::type = 0>
+std::string test_str(T v) {
+    return std::to_string((long long)v);
+}
+
+#define TEST(name) \
+    static void test_##name(); \
+    static int test_registered_##name = test_register(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) test_fail(__FILE__, __LINE__, "CHECK(" #cond ")"); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto test_a = (actual); \
+        auto test_e = (expected); \
+        if (!(test_a == test_e)) { \
+            test_fail(__FILE__, __LINE__, "CHECK_EQ(" #actual ", " #expected ")\n  actual:   " + \
+                      test_str(test_a) + "\n  expected: " + test_str(test_e)); \
+        } \
+    } while (0)
+
+#endif // TEST_H
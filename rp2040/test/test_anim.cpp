@@ -0,0 +1,201 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// Animations on the simulated clock: where blink, slide, contrast ramp and
+// invert pulse are after a given number of frames and when they end, stopping
+// one early, and frames dropped while the panel has not taken the previous
+// one yet. The frame-dropping tests call anim_task() directly with main()
+// paused, so the frame tick is exactly where the test puts it.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// anim.cpp: ticks an animation waits for a busy panel before advancing anyway
+#define MAX_WAIT_FRAMES 8
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static bool fb_pixel(int x, int y) {
+    return (ssd1306_get_buffer()[(y / 8) * SSD1306_WIDTH + x] >> (y % 8)) & 1;
+}
+
+static bytes_t framebuffer() {
+    return bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE);
+}
+
+static void anim_boot() {
+    sim_boot();
+    const char* s = "Blink";
+    bytes_t cmd = {CMD_CLEAR, CMD_DRAW_TEXT, 0, 0, 5};
+    cmd.insert(cmd.end(), s, s + 5);
+    send(cmd);
+}
+
+// Invert commands (0xA6/0xA7) the panel received since log entry at
+static int invert_commands(size_t at) {
+    int count = 0;
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+    for (size_t i = at; i < log.size(); i++) {
+        if (!log[i].data && log[i].bytes.size() == 1 && (log[i].bytes[0] & 0xFE) == 0xA6) count++;
+    }
+    return count;
+}
+
+TEST(anim_blink_ends_restored) {
+    // Period 2, three blinks: inverted from frame 2, back for good at frame 12
+    anim_boot();
+    bytes_t normal = framebuffer();
+    send({CMD_ANIM, ANIM_OP_BLINK, 0, 0, 0, 40, 8, 2, 3});
+    sim_run_ms(2 * ANIM_FRAME_US / 1000 + 10);
+    bytes_t fb = framebuffer();
+    for (int col = 0; col < 40; col++) CHECK_EQ(fb[col], (uint8_t)~normal[col]);
+    CHECK_EQ(fb[40], normal[40]);
+
+    sim_run_ms(10 * ANIM_FRAME_US / 1000);
+    CHECK_EQ(framebuffer(), normal);
+    CHECK_EQ(sim_panel_image(0), normal);
+
+    // Finished: nothing more is sent
+    size_t at = sim_panel(0)->log.size();
+    sim_run_ms(500);
+    CHECK_EQ(sim_panel(0)->log.size(), at);
+}
+
+TEST(anim_slide_end_state) {
+    // 3 px right per frame for 4 frames, then 2 px left for 3 frames
+    anim_boot();
+    send({CMD_CLEAR, CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, 10, 10});
+    send({CMD_ANIM, ANIM_OP_SLIDE, 0, 0, 8, 64, 8, 3, 4});
+    sim_run_ms(4 * ANIM_FRAME_US / 1000 + 10);
+    CHECK(fb_pixel(22, 10));
+    CHECK(!fb_pixel(10, 10));
+
+    send({CMD_ANIM, ANIM_OP_SLIDE, 0, 0, 8, 64, 8, (uint8_t)-2, 3});
+    sim_run_ms(10 * ANIM_FRAME_US / 1000);
+    CHECK(fb_pixel(16, 10));
+    CHECK(!fb_pixel(22, 10));
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+}
+
+TEST(anim_contrast_ramp) {
+    // 0xCF down to 0x0F over 8 frames: halfway after 4, exact at the end
+    anim_boot();
+    send({CMD_ANIM, ANIM_OP_CONTRAST, 0, 0x0F, 8});
+    sim_run_ms(4 * ANIM_FRAME_US / 1000 + 10);
+    CHECK_EQ(sim_panel(0)->contrast, 0xCF - (0xCF - 0x0F) / 2);
+    sim_run_ms(4 * ANIM_FRAME_US / 1000);
+    CHECK_EQ(sim_panel(0)->contrast, 0x0F);
+    CHECK_EQ(ssd1306_get_brightness(), 0x0F);
+}
+
+TEST(anim_invert_pulse_ends_normal) {
+    // Period 2, two pulses: 8 frames, inverted during frames 2-3 and 6-7
+    anim_boot();
+    send({CMD_ANIM, ANIM_OP_INVERT_PULSE, 0, 2, 2});
+    sim_run_ms(2 * ANIM_FRAME_US / 1000 + 10);
+    CHECK(sim_panel(0)->inverted);
+    sim_run_ms(2 * ANIM_FRAME_US / 1000);
+    CHECK(!sim_panel(0)->inverted);
+    sim_run_ms(2 * ANIM_FRAME_US / 1000);
+    CHECK(sim_panel(0)->inverted);
+    sim_run_ms(2 * ANIM_FRAME_US / 1000);
+    CHECK(!sim_panel(0)->inverted);
+    CHECK(!ssd1306_is_inverted());
+}
+
+TEST(anim_stop_restores_normal_state) {
+    // Stopped while inverted: blink and invert pulse go back to normal
+    anim_boot();
+    bytes_t normal = framebuffer();
+    send({CMD_ANIM, ANIM_OP_BLINK, 0, 0, 0, 40, 8, 2, 0, CMD_ANIM, ANIM_OP_INVERT_PULSE, 1, 2, 0});
+    // Frame 2 flushes the blink, so the pulse on the same panel catches up
+    // at frame 3
+    sim_run_ms(3 * ANIM_FRAME_US / 1000 + 10);
+    CHECK(framebuffer() != normal);
+    CHECK(sim_panel(0)->inverted);
+    send({CMD_ANIM, ANIM_OP_STOP, ANIM_SLOT_ALL});
+    CHECK_EQ(framebuffer(), normal);
+    CHECK_EQ(sim_panel_image(0), normal);
+    CHECK(!sim_panel(0)->inverted);
+
+    // A slide stops where it is
+    send({CMD_CLEAR, CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, 10, 10});
+    send({CMD_ANIM, ANIM_OP_SLIDE, 2, 0, 8, 64, 8, 1, 100});
+    sim_run_ms(3 * ANIM_FRAME_US / 1000 + 10);
+    send({CMD_ANIM, ANIM_OP_STOP, 2});
+    int x = 0;
+    while (x < 64 && !fb_pixel(x, 10)) x++;
+    CHECK(x >= 13 && x < 20);
+    sim_run_ms(200);
+    CHECK(fb_pixel(x, 10));
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+}
+
+TEST(anim_drops_frames_while_flush_pending) {
+    // Invert pulse toggling every frame, started with main() paused
+    anim_boot();
+    size_t at = sim_panel(0)->log.size();
+    anim_invert_pulse(0, 1, 10);
+
+    // Frames 1-3 come due while page 0 is still to be sent: skipped
+    gfx_invert_area(0, 0, 0, 8, 8);
+    sim_advance_us(3 * ANIM_FRAME_US);
+    anim_task();
+    CHECK(!ssd1306_is_inverted());
+    CHECK_EQ(invert_commands(at), 0);
+
+    // Page sent; at frame 5 the five toggles are applied as one
+    while (ssd1306_flush_pending(0)) ssd1306_flush_task();
+    sim_advance_us(2 * ANIM_FRAME_US);
+    anim_task();
+    CHECK(ssd1306_is_inverted());
+    CHECK_EQ(invert_commands(at), 1);
+
+    // Still ends on time, in the normal state
+    sim_run_ms(15 * ANIM_FRAME_US / 1000 + 10);
+    CHECK(!sim_panel(0)->inverted);
+}
+
+TEST(anim_busy_panel_does_not_stall) {
+    // A panel that always has a page left to send holds the animation back
+    // for MAX_WAIT_FRAMES ticks, then it advances anyway
+    anim_boot();
+    anim_invert_pulse(0, 1, 0);
+    for (int tick = 1; tick <= MAX_WAIT_FRAMES; tick++) {
+        gfx_invert_area(0, 0, 0, 8, 8);
+        sim_advance_us(ANIM_FRAME_US);
+        anim_task();
+        CHECK(!ssd1306_is_inverted());
+    }
+    gfx_invert_area(0, 0, 0, 8, 8);
+    sim_advance_us(ANIM_FRAME_US);
+    anim_task();
+    CHECK(ssd1306_is_inverted());
+    anim_stop(0);
+    CHECK(!ssd1306_is_inverted());
+}
+
+#ifndef SIM_TRANSPORT_SPI
+TEST(anim_runs_on_offline_panel) {
+    // A panel that dropped off the bus does not hold an invert pulse back:
+    // it ends on time, and recovery re-sends the normal state
+    anim_boot();
+    sim_panel(0)->present = false;
+    send({CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, 3, 3});
+    CHECK(!ssd1306_is_ok());
+    send({CMD_ANIM, ANIM_OP_INVERT_PULSE, 0, 2, 2});
+    sim_run_ms(2 * ANIM_FRAME_US / 1000 + 10);
+    CHECK(ssd1306_is_inverted());
+    sim_run_ms(6 * ANIM_FRAME_US / 1000);
+    CHECK(!ssd1306_is_inverted());
+
+    sim_panel(0)->present = true;
+    sim_run_ms(2500);
+    sim_settle();
+    CHECK(ssd1306_is_ok());
+    CHECK(!sim_panel(0)->inverted);
+}
+#endif // !SIM_TRANSPORT_SPI
@@ -0,0 +1,187 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// Startup: CMD_BOOT_TIME's timestamps against what the simulated USB and
+// panels saw, no waiting beyond SSD1306_POWERUP_US and the init write
+// itself before commands are answered, and a splash saved with CMD_SPLASH
+// shown on the next boot (in place of "Booting"), until erased.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// config_store.cpp: blob writes wait this long after the last request
+#define COMMIT_DELAY_US 1000000
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static uint32_t get_u32(const bytes_t& b, size_t offset) {
+    return b[offset] | (b[offset + 1] << 8) | (b[offset + 2] << 16) | ((uint32_t)b[offset + 3] << 24);
+}
+
+typedef struct {
+    uint32_t usb_mounted_us;
+    uint32_t display_ready_us;
+    uint32_t ready_us;
+} boot_time_t;
+
+static boot_time_t boot_time() {
+    bytes_t reply = sim_cdc_query({CMD_BOOT_TIME}, 13);
+    if (reply.size() != 13 || reply[0] != CMD_BOOT_TIME) test_fail(__FILE__, __LINE__, "bad BOOT_TIME reply " + test_str(reply));
+    return { get_u32(reply, 1), get_u32(reply, 5), get_u32(reply, 9) };
+}
+
+// Time the bus needed for the transfers the panels had received by t (a log
+// entry is stamped when its transfer ends)
+static uint64_t bus_time_us(uint64_t t) {
+    uint64_t us = 0;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        for (const sim_transfer_t& x : sim_panel(id)->log) {
+            if (x.time_us > t) break;
+#ifdef SIM_TRANSPORT_SPI
+            uint64_t bits = 8 * x.bytes.size();
+#else
+            uint64_t bits = 9 * (x.bytes.size() + 2); // Address and control byte, 9 clocks each
+#endif
+            us += bits * 1000000 / x.baud + 1;
+        }
+    }
+    return us;
+}
+
+static bytes_t panel_image() {
+    return sim_panel_image(0);
+}
+
+static bytes_t framebuffer() {
+    return bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE);
+}
+
+static void draw_splash() {
+    const char* s = "Splash";
+    bytes_t cmd = {CMD_CLEAR, CMD_DRAW_TEXT, 16, 8, 6};
+    cmd.insert(cmd.end(), s, s + 6);
+    bytes_t rect = {CMD_GFX, GFX_OP_RECT, GFX_MODE_SET, 0, 0, SSD1306_WIDTH, SSD1306_HEIGHT};
+    cmd.insert(cmd.end(), rect.begin(), rect.end());
+    send(cmd);
+}
+
+static bool blank(const bytes_t& image, int pages) {
+    for (int i = 0; i < pages * SSD1306_WIDTH; i++) {
+        if (image[i]) return false;
+    }
+    return true;
+}
+
+TEST(boot_time_reply) {
+    sim_boot();
+    boot_time_t t = boot_time();
+
+    // Mounted when the simulated host finished enumerating
+    CHECK(t.usb_mounted_us >= SIM_MOUNT_US);
+    CHECK(t.usb_mounted_us < SIM_MOUNT_US + 1000);
+
+    // Display ready once the panel supply settled and the init went out
+    CHECK(t.display_ready_us >= SSD1306_POWERUP_US);
+    CHECK(!sim_panel(0)->log.empty());
+    CHECK(sim_panel(0)->log[0].time_us >= SSD1306_POWERUP_US);
+    CHECK(sim_panel(0)->log[0].time_us < SSD1306_POWERUP_US + 1000);
+    CHECK(t.display_ready_us > sim_panel(0)->log[0].time_us);
+    CHECK_EQ(t.ready_us, t.usb_mounted_us > t.display_ready_us ? t.usb_mounted_us : t.display_ready_us);
+
+    // Queried again later: the same boot, the same values
+    sim_run_ms(500);
+    boot_time_t again = boot_time();
+    CHECK_EQ(again.usb_mounted_us, t.usb_mounted_us);
+    CHECK_EQ(again.display_ready_us, t.display_ready_us);
+    CHECK_EQ(again.ready_us, t.ready_us);
+}
+
+TEST(boot_no_wait_beyond_powerup) {
+    // A ping queued before USB is up is answered as soon as the displays
+    // are ready: power-up wait, then nothing but the bus transfers of the
+    // init and boot message
+    sim_cdc_write({CMD_TEST, TEST_SUBCMD_PING});
+    bytes_t reply;
+    while (reply.empty() && sim_now_us() < 1000000) {
+        sim_run_us(100);
+        reply = sim_cdc_read();
+    }
+    uint64_t answered = sim_now_us();
+    CHECK_EQ(reply, bytes_t({CMD_TEST, TEST_SUBCMD_PING}));
+
+    boot_time_t t = boot_time();
+    CHECK(t.display_ready_us <= SSD1306_POWERUP_US + bus_time_us(t.display_ready_us) + 1000);
+    CHECK(answered >= t.ready_us);
+    CHECK(answered <= t.ready_us + 2000);
+}
+
+TEST(boot_commands_wait_for_displays) {
+    // Drawing sent while the panels power up is not handled before their
+    // init (which would clear it) but right after
+    sim_run_us(SIM_MOUNT_US + 1000);
+    const char* s = "Early";
+    bytes_t cmd = {CMD_DRAW_TEXT, 0, 24, 5};
+    cmd.insert(cmd.end(), s, s + 5);
+    sim_cdc_write(cmd);
+    sim_run_us(SSD1306_POWERUP_US - sim_now_us() - 1000);
+    CHECK(sim_panel(0)->log.empty());
+    sim_boot();
+    sim_settle();
+    bytes_t shown = panel_image();
+    CHECK(!blank(bytes_t(shown.begin() + 3 * SSD1306_WIDTH, shown.end()), 1));
+    CHECK_EQ(shown, framebuffer());
+}
+
+TEST(boot_splash_across_reboots) {
+    if (test_boot() == 0) {
+        // Without a splash the boot message shows
+        sim_boot();
+        CHECK(!blank(panel_image(), 1));
+        draw_splash();
+        send({CMD_SPLASH, SPLASH_OP_SAVE});
+        sim_run_us(COMMIT_DELAY_US + 10000);
+        test_reboot();
+    }
+
+    if (test_boot() == 1) {
+        // The stored image is on the panel from its first full-frame write,
+        // with no boot message drawn over it
+        sim_boot();
+        bytes_t shown = panel_image();
+        CHECK_EQ(framebuffer(), shown);
+        draw_splash();
+        CHECK_EQ(framebuffer(), shown);
+
+        send({CMD_SPLASH, SPLASH_OP_ERASE});
+        sim_run_us(COMMIT_DELAY_US + 10000);
+        test_reboot();
+    }
+
+    // Erased: back to the boot message
+    sim_boot();
+    bytes_t shown = panel_image();
+    draw_splash();
+    CHECK(framebuffer() != shown);
+    CHECK(!blank(shown, 1));
+    CHECK(blank(bytes_t(shown.begin() + SSD1306_WIDTH, shown.end()), SSD1306_HEIGHT / 8 - 1));
+}
+
+TEST(boot_splash_lost_before_commit) {
+    // Power lost before the deferred write: the old state (no splash) stays
+    if (test_boot() == 0) {
+        sim_boot();
+        draw_splash();
+        send({CMD_SPLASH, SPLASH_OP_SAVE});
+        sim_run_us(COMMIT_DELAY_US / 2);
+        test_reboot();
+    }
+
+    sim_boot();
+    bytes_t shown = panel_image();
+    bytes_t stored(SSD1306_BUFFER_SIZE);
+    CHECK(!config_load_splash(stored.data(), stored.size()));
+    CHECK(blank(bytes_t(shown.begin() + SSD1306_WIDTH, shown.end()), SSD1306_HEIGHT / 8 - 1));
+}
@@ -0,0 +1,145 @@
+#include "sim.h"
+#include "test.h"
+
+// Golden byte streams: the exact command and data transfers each panel
+// receives for init, the full-frame upload and a partial flush, as the panel
+// logs record them (I2C control byte 0x00/0x40, SPI DC low/high). The
+// expected bytes are written out here rather than taken from the firmware's
+// tables, so a change to either shows up as a diff.
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t init_sequence() {
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    return {0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0xAD, 0x8B,
+            0xA1, 0xC8, 0xDA, 0x12, 0xD9, 0xF1, 0xDB, 0x40, 0xA4};
+#elif DISPLAY_CONTROLLER == DISPLAY_SSD1306_128X32
+    return {0xAE, 0xD5, 0x80, 0xA8, 0x1F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+            0xA1, 0xC8, 0xDA, 0x02, 0xD9, 0xF1, 0xDB, 0x40, 0xA4};
+#else
+    return {0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+            0xA1, 0xC8, 0xDA, 0x12, 0xD9, 0xF1, 0xDB, 0x40, 0xA4};
+#endif
+}
+
+// Addressing for one window of the framebuffer, as flush_area sends it
+static std::vector<bytes_t> window(uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end) {
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    // Page addressing, RAM column = visible column + 2
+    std::vector<bytes_t> out;
+    uint8_t col = col_start + 2;
+    for (uint8_t page = page_start; page <= page_end; page++) {
+        out.push_back({(uint8_t)(0xB0 | page), (uint8_t)(col & 0x0F), (uint8_t)(0x10 | (col >> 4))});
+    }
+    return out;
+#else
+    return {{0x22, page_start, page_end, 0x21, col_start, col_end}};
+#endif
+}
+
+static void check_transfer(const sim_transfer_t& t, bool data, const bytes_t& bytes, int line) {
+    if (t.data != data) test_fail(__FILE__, line, data ? "expected a data transfer" : "expected a command transfer");
+    if (t.bytes != bytes) test_fail(__FILE__, line, "transfer bytes differ from the golden stream");
+}
+
+// Transfers at..end of log are the window of fb, addressing and data
+static void check_window(const std::vector<sim_transfer_t>& log, size_t at, const uint8_t* fb, uint8_t page_start,
+                         uint8_t page_end, uint8_t col_start, uint8_t col_end, int line) {
+    std::vector<bytes_t> addr = window(page_start, page_end, col_start, col_end);
+    if (log.size() != at + 2 * addr.size()) {
+        test_fail(__FILE__, line, std::to_string(log.size() - at) + " transfers, expected " +
+                                      std::to_string(2 * addr.size()));
+    }
+    for (size_t i = 0; i < addr.size(); i++) {
+        bytes_t data;
+        for (uint8_t page = page_start; page <= page_end; page++) {
+            if (addr.size() > 1 && page != page_start + i) continue;
+            data.insert(data.end(), fb + page * SSD1306_WIDTH + col_start, fb + page * SSD1306_WIDTH + col_end + 1);
+        }
+        check_transfer(log[at + 2 * i], false, addr[i], line);
+        check_transfer(log[at + 2 * i + 1], true, data, line);
+    }
+}
+
+TEST(bytestream_boot_init_and_full_frame) {
+    sim_boot();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+    CHECK(log.size() >= 2);
+
+    check_transfer(log[0], false, init_sequence(), __LINE__);
+    // State transfer: default contrast, normal, on, no offset
+    check_transfer(log[1], false, {0x81, 0xCF, 0xA6, 0xAF, 0xD3, 0x00}, __LINE__);
+
+    // Then the whole (blank, no splash stored) framebuffer
+    uint8_t last_page = SSD1306_HEIGHT / 8 - 1;
+    size_t frame = 2 * window(0, last_page, 0, SSD1306_WIDTH - 1).size();
+    CHECK(log.size() >= 2 + frame);
+    bytes_t blank(SSD1306_BUFFER_SIZE, 0);
+    check_window(std::vector<sim_transfer_t>(log.begin(), log.begin() + 2 + frame), 2, blank.data(), 0, last_page, 0,
+                 SSD1306_WIDTH - 1, __LINE__);
+
+    CHECK_EQ(sim_panel(0)->bad_commands, 0u);
+    CHECK_EQ(sim_panel(0)->multiplex, (uint8_t)(SSD1306_HEIGHT - 1));
+}
+
+TEST(bytestream_partial_flush_window) {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+
+    // One pixel: one page, one column
+    size_t at = log.size();
+    sim_cdc_write({CMD_GFX, GFX_OP_PIXEL, 0, 10, 20});
+    sim_settle();
+    check_window(log, at, ssd1306_get_buffer(), 2, 2, 10, 10, __LINE__);
+    CHECK_EQ(log.back().bytes, (bytes_t{0x10}));
+
+    // A text line: 8 columns per character on one page
+    at = log.size();
+    sim_cdc_write({CMD_DRAW_TEXT, 16, 8, 3, 'a', 'b', 'c'});
+    sim_settle();
+    check_window(log, at, ssd1306_get_buffer(), 1, 1, 16, 16 + 3 * 8 - 1, __LINE__);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+    CHECK_EQ(sim_panel(0)->bad_commands, 0u);
+}
+
+TEST(bytestream_column_offset_edges) {
+    // Leftmost and rightmost visible columns: on the SH1106 these are RAM
+    // columns 2 and 129 (high nibble 0x18), on the SSD1306 0 and 127
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+
+    size_t at = log.size();
+    sim_cdc_write({CMD_GFX, GFX_OP_PIXEL, 0, 0, 0});
+    sim_settle();
+    check_window(log, at, ssd1306_get_buffer(), 0, 0, 0, 0, __LINE__);
+
+    at = log.size();
+    sim_cdc_write({CMD_GFX, GFX_OP_PIXEL, 0, (uint8_t)(SSD1306_WIDTH - 1), (uint8_t)(SSD1306_HEIGHT - 1)});
+    sim_settle();
+    uint8_t last_page = SSD1306_HEIGHT / 8 - 1;
+    check_window(log, at, ssd1306_get_buffer(), last_page, last_page, SSD1306_WIDTH - 1, SSD1306_WIDTH - 1, __LINE__);
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    CHECK_EQ(log[at].bytes, (bytes_t{0xB7, 0x01, 0x18}));
+#endif
+
+    // The panel shows both pixels where the framebuffer has them
+    CHECK(sim_panel_pixel(0, 0, 0));
+    CHECK(sim_panel_pixel(0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1));
+    CHECK(!sim_panel_pixel(0, 1, 0));
+}
+
+TEST(bytestream_state_after_settings) {
+    // Contrast and invert are one command transfer each, nothing else
+    sim_boot();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+    size_t at = log.size();
+    sim_cdc_write({CMD_BRIGHTNESS, 0x40, CMD_INVERT, 1});
+    sim_settle();
+    CHECK_EQ(log.size(), at + 2);
+    check_transfer(log[at], false, {0x81, 0x40}, __LINE__);
+    check_transfer(log[at + 1], false, {0xA7}, __LINE__);
+}
@@ -0,0 +1,225 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// CMD_CAPTURE over CDC: the reply decoded (raw or PackBits) and checked
+// against the framebuffer's TEST_SUBCMD_FB_CHECKSUM, no more than a TX FIFO
+// of it queued while the host does not read (input is still handled),
+// replies to later commands on the same stream coming after it whole, and
+// one capture per display.
+
+typedef std::vector<uint8_t> bytes_t;
+
+typedef struct {
+    uint8_t encoding;
+    uint8_t display;
+    uint8_t width, height;
+    uint8_t flags;
+    bytes_t pixels;     // Decoded framebuffer
+} capture_t;
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static bytes_t unpackbits(const uint8_t* p, size_t len) {
+    bytes_t out;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t n = p[i++];
+        if (n < 0x80) {
+            if (i + n + 1 > len) test_fail(__FILE__, __LINE__, "PackBits literal past the end");
+            out.insert(out.end(), p + i, p + i + n + 1);
+            i += n + 1;
+        } else if (n > 0x80) {
+            if (i >= len) test_fail(__FILE__, __LINE__, "PackBits run past the end");
+            out.insert(out.end(), 257 - n, p[i++]);
+        }
+    }
+    return out;
+}
+
+// Decode one capture reply from the front of `stream` and remove it
+static capture_t take_capture(bytes_t* stream, int line) {
+    capture_t c = {};
+    if (stream->size() < 3 + CAPTURE_HEADER_LEN || (*stream)[0] != CMD_CAPTURE) {
+        test_fail(__FILE__, line, "no capture reply: " + test_str(*stream));
+    }
+    size_t payload = (*stream)[1] | ((*stream)[2] << 8);
+    if (stream->size() < 3 + payload) test_fail(__FILE__, line, "capture reply cut short");
+    const uint8_t* p = stream->data() + 3;
+    c.encoding = p[0];
+    c.display = p[1];
+    c.width = p[2];
+    c.height = p[3];
+    c.flags = p[4];
+    const uint8_t* pixels = p + CAPTURE_HEADER_LEN;
+    size_t size = payload - CAPTURE_HEADER_LEN;
+    c.pixels = c.encoding == CAPTURE_ENC_PACKBITS ? unpackbits(pixels, size) : bytes_t(pixels, pixels + size);
+    stream->erase(stream->begin(), stream->begin() + 3 + payload);
+    return c;
+}
+
+static capture_t capture(uint8_t flags, int line) {
+    bytes_t reply = sim_cdc_query({CMD_CAPTURE, flags}, 3 + CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE);
+    capture_t c = take_capture(&reply, line);
+    if (!reply.empty()) test_fail(__FILE__, line, "bytes after the capture reply");
+    return c;
+}
+
+static uint16_t device_checksum() {
+    bytes_t reply = sim_cdc_query({CMD_TEST, TEST_SUBCMD_FB_CHECKSUM}, 6);
+    if (reply.size() != 6) test_fail(__FILE__, __LINE__, "bad FB_CHECKSUM reply " + test_str(reply));
+    return reply[3] | (reply[4] << 8);
+}
+
+static uint16_t crc(const bytes_t& pixels) {
+    return crc16_update(0xFFFF, pixels.data(), pixels.size());
+}
+
+static void draw_screen() {
+    const char* s = "Capture";
+    bytes_t cmd = {CMD_CLEAR, CMD_DRAW_TEXT, 0, 0, 7};
+    cmd.insert(cmd.end(), s, s + 7);
+    bytes_t rect = {CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET, 20, 12, 40, 10};
+    cmd.insert(cmd.end(), rect.begin(), rect.end());
+    send(cmd);
+}
+
+// Full-screen CMD_FRAME of bytes that do not repeat three times in a row
+static void draw_noise() {
+    bytes_t cmd = {CMD_FRAME, 0, SSD1306_HEIGHT / 8};
+    uint32_t x = 12345;
+    for (int i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        x = x * 1103515245 + 12345;
+        cmd.push_back((uint8_t)(x >> 16) ^ (uint8_t)i);
+    }
+    send(cmd);
+}
+
+TEST(capture_raw_matches_checksum) {
+    sim_boot();
+    draw_screen();
+    capture_t c = capture(0, __LINE__);
+    CHECK_EQ(c.encoding, CAPTURE_ENC_RAW);
+    CHECK_EQ(c.display, 0);
+    CHECK_EQ(c.width, SSD1306_WIDTH);
+    CHECK_EQ(c.height, SSD1306_HEIGHT);
+    CHECK_EQ(c.flags, 0);
+    CHECK_EQ(c.pixels.size(), (size_t)SSD1306_BUFFER_SIZE);
+    CHECK_EQ(crc(c.pixels), device_checksum());
+    CHECK_EQ(c.pixels, sim_panel_image(0));
+}
+
+TEST(capture_packbits_matches_checksum) {
+    // A mostly blank screen compresses; noise falls back to raw
+    sim_boot();
+    draw_screen();
+    bytes_t reply = sim_cdc_query({CMD_CAPTURE, CAPTURE_FLAG_RLE}, 3 + CAPTURE_HEADER_LEN);
+    sim_run_ms(20);
+    bytes_t rest = sim_cdc_read();
+    reply.insert(reply.end(), rest.begin(), rest.end());
+    size_t payload = reply[1] | (reply[2] << 8);
+    CHECK(payload < CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE / 4);
+    capture_t c = take_capture(&reply, __LINE__);
+    CHECK_EQ(c.encoding, CAPTURE_ENC_PACKBITS);
+    CHECK_EQ(c.pixels.size(), (size_t)SSD1306_BUFFER_SIZE);
+    CHECK_EQ(crc(c.pixels), device_checksum());
+
+    draw_noise();
+    c = capture(CAPTURE_FLAG_RLE, __LINE__);
+    CHECK_EQ(c.encoding, CAPTURE_ENC_RAW);
+    CHECK_EQ(crc(c.pixels), device_checksum());
+}
+
+TEST(capture_sent_in_pieces_while_input_runs) {
+    // Host not reading: only a TX FIFO's worth goes out, and input is still
+    // reported meanwhile
+    sim_boot();
+    draw_noise();
+    uint16_t expected = device_checksum();
+    sim_host_reading(false);
+    sim_cdc_write({CMD_CAPTURE, 0});
+    sim_run_ms(20);
+    sim_hid_reports().clear();
+    sim_gpio_drive(BOT_BTN_PIN, false);
+    sim_run_ms(50);
+    sim_gpio_release(BOT_BTN_PIN);
+    sim_run_ms(50);
+    CHECK(!sim_hid_reports().empty());
+    CHECK(sim_cdc_read().empty());
+    const uint8_t* data;
+    CHECK_EQ(capture_pending(&data), 3u + CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE - CFG_TUD_CDC_TX_BUFSIZE);
+
+    // Drawing after the command does not change the captured picture
+    send({CMD_CLEAR});
+    bytes_t reply;
+    sim_host_reading(true);
+    for (int i = 0; i < 20 && reply.size() < 3 + CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE; i++) {
+        sim_run_ms(1);
+        bytes_t part = sim_cdc_read();
+        reply.insert(reply.end(), part.begin(), part.end());
+    }
+    capture_t c = take_capture(&reply, __LINE__);
+    CHECK_EQ(crc(c.pixels), expected);
+    CHECK(reply.empty());
+}
+
+TEST(capture_interleaved_with_commands) {
+    // Capture, drawing, a query and another capture in one write: the
+    // replies come back whole and in order, each capture showing the screen
+    // as it was when its command arrived
+    sim_boot();
+    draw_screen();
+    uint16_t before = device_checksum();
+    bytes_t cmds = {CMD_CAPTURE, 0, CMD_CLEAR, CMD_BOOT_TIME, CMD_CAPTURE, CAPTURE_FLAG_RLE, CMD_TEST, TEST_SUBCMD_PING};
+    sim_cdc_write(cmds);
+    bytes_t stream;
+    for (int i = 0; i < 100; i++) {
+        sim_run_ms(1);
+        bytes_t part = sim_cdc_read();
+        stream.insert(stream.end(), part.begin(), part.end());
+    }
+
+    capture_t first = take_capture(&stream, __LINE__);
+    CHECK_EQ(crc(first.pixels), before);
+    CHECK(stream.size() >= 13);
+    CHECK_EQ(stream[0], CMD_BOOT_TIME);
+    stream.erase(stream.begin(), stream.begin() + 13);
+    capture_t second = take_capture(&stream, __LINE__);
+    CHECK_EQ(second.pixels, bytes_t(SSD1306_BUFFER_SIZE, 0));
+    CHECK(!stream.empty());
+    CHECK_EQ(stream[0], CMD_TEST);
+    CHECK_EQ(crc(second.pixels), device_checksum());
+}
+
+#if DISPLAY_COUNT > 1
+TEST(capture_per_display) {
+    // Different content on each display; a capture reads the selected one
+    sim_boot();
+    draw_screen();
+    send({CMD_SELECT_DISPLAY, 1});
+    draw_noise();
+
+    bytes_t stream;
+    sim_cdc_write({CMD_SELECT_DISPLAY, 0, CMD_CAPTURE, 0, CMD_SELECT_DISPLAY, 1, CMD_CAPTURE, CAPTURE_FLAG_RLE});
+    for (int i = 0; i < 100; i++) {
+        sim_run_ms(1);
+        bytes_t part = sim_cdc_read();
+        stream.insert(stream.end(), part.begin(), part.end());
+    }
+    capture_t c0 = take_capture(&stream, __LINE__);
+    capture_t c1 = take_capture(&stream, __LINE__);
+    CHECK(stream.empty());
+
+    CHECK_EQ(c0.display, 0);
+    CHECK_EQ(c1.display, 1);
+    CHECK_EQ(c0.pixels, bytes_t(ssd1306_draw_buffer(0), ssd1306_draw_buffer(0) + SSD1306_BUFFER_SIZE));
+    CHECK_EQ(c1.pixels, bytes_t(ssd1306_draw_buffer(1), ssd1306_draw_buffer(1) + SSD1306_BUFFER_SIZE));
+    CHECK(c0.pixels != c1.pixels);
+    CHECK_EQ(crc(c1.pixels), device_checksum());
+    send({CMD_SELECT_DISPLAY, 0});
+    CHECK_EQ(crc(c0.pixels), device_checksum());
+}
+#endif // DISPLAY_COUNT > 1
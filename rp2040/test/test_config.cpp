@@ -0,0 +1,222 @@
+#include "sim.h"
+#include "test.h"
+#include "hardware/flash.h"
+#include <string.h>
+
+// Config store against the RAM-backed flash, called directly with main() not
+// running: power cut at every byte of a commit, pages left torn by an earlier
+// cut, the erase when the log wraps into a sector, and the sequence number
+// wrapping around. A "reboot" is config_init() reading the flash again.
+
+// Store layout (config_store.cpp): two sectors at the top of flash, one
+// snapshot per page: magic, seq, length, CRC-16, data
+#define REGION_OFFSET     (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+#define PAGES_PER_SECTOR  ((int)(FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE))
+#define TOTAL_PAGES       (2 * PAGES_PER_SECTOR)
+#define PAGE_MAGIC        0x47464348u
+#define COMMIT_DELAY_US   1000000
+
+typedef std::vector<uint8_t> bytes_t;
+
+static uint8_t* slot_ptr(uint32_t slot) {
+    return &sim_flash_memory[REGION_OFFSET + slot * FLASH_PAGE_SIZE];
+}
+
+static uint32_t slot_magic(uint32_t slot) {
+    uint32_t magic;
+    memcpy(&magic, slot_ptr(slot), 4);
+    return magic;
+}
+
+static uint32_t slot_seq(uint32_t slot) {
+    uint32_t seq;
+    memcpy(&seq, slot_ptr(slot) + 4, 4);
+    return seq;
+}
+
+// A valid snapshot holding brightness = value, written as a commit would
+static void write_snapshot(uint32_t slot, uint32_t seq, uint8_t value) {
+    uint8_t* page = slot_ptr(slot);
+    uint16_t length = 3;
+    uint8_t data[3] = {CFG_KEY_BRIGHTNESS, 1, value};
+    uint32_t magic = PAGE_MAGIC;
+    memcpy(page, &magic, 4);
+    memcpy(page + 4, &seq, 4);
+    memcpy(page + 8, &length, 2);
+    uint16_t crc = crc16_update(0xFFFF, page + 4, 4);
+    crc = crc16_update(crc, page + 8, 2);
+    crc = crc16_update(crc, data, length);
+    memcpy(page + 10, &crc, 2);
+    memcpy(page + 12, data, length);
+}
+
+static void set_brightness(uint8_t value) {
+    CHECK(config_set(CFG_KEY_BRIGHTNESS, &value, 1));
+}
+
+// Let the batching delay pass and run the commit
+static void commit() {
+    sim_advance_us(COMMIT_DELAY_US + 1);
+    config_task();
+}
+
+static uint8_t boot_brightness() {
+    config_init();
+    return config_get_u8(CFG_KEY_BRIGHTNESS, 0);
+}
+
+// Commit new_value with the power cut after every possible byte count. After
+// each cut a reboot must find the previous value, or the new one once its
+// page is complete (the rest of the page is blank padding, so that happens a
+// little before the program ends), and the store must take the next commit.
+// Returns the bytes the whole commit took.
+static int64_t check_power_loss(uint8_t old_value, uint8_t new_value, int64_t durable_at) {
+    CHECK_EQ(boot_brightness(), old_value);
+    bytes_t region(slot_ptr(0), slot_ptr(TOTAL_PAGES));
+
+    for (int64_t cut = 0;; cut++) {
+        memcpy(slot_ptr(0), region.data(), region.size());
+        config_init();
+        set_brightness(new_value);
+        sim_flash_power_cut(cut);
+        try {
+            commit();
+        } catch (sim_power_loss&) {
+            if (boot_brightness() != (cut < durable_at ? old_value : new_value)) {
+                test_fail(__FILE__, __LINE__, "power cut after " + std::to_string(cut) + " bytes: found " +
+                                                  std::to_string(config_get_u8(CFG_KEY_BRIGHTNESS, 0)));
+            }
+            // The store goes on past whatever the cut left behind
+            set_brightness(0x5A);
+            commit();
+            if (boot_brightness() != 0x5A) {
+                test_fail(__FILE__, __LINE__, "commit after a cut at " + std::to_string(cut) + " bytes not found");
+            }
+            continue;
+        }
+        sim_flash_power_cut(-1);
+        CHECK_EQ(boot_brightness(), new_value);
+        return cut;
+    }
+}
+
+// Bytes of a snapshot page up to the end of a one-key image: header + 3
+#define SNAPSHOT_BYTES 15
+
+TEST(config_power_loss_mid_sector) {
+    set_brightness(0x11);
+    commit();
+    CHECK_EQ(check_power_loss(0x11, 0x22, SNAPSHOT_BYTES), (int64_t)FLASH_PAGE_SIZE);
+}
+
+TEST(config_power_loss_in_sector_erase) {
+    // Fill the first sector; the next commit erases the second one first
+    for (int i = 0; i < PAGES_PER_SECTOR; i++) {
+        set_brightness(0x10 + i);
+        commit();
+    }
+    uint8_t last = 0x10 + PAGES_PER_SECTOR - 1;
+    CHECK_EQ(check_power_loss(last, 0x77, FLASH_SECTOR_SIZE + SNAPSHOT_BYTES), (int64_t)(FLASH_SECTOR_SIZE + FLASH_PAGE_SIZE));
+}
+
+TEST(config_power_loss_wrapping_to_first_sector) {
+    // Log full: the commit erases sector 0 while sector 1 holds the newest
+    for (int i = 0; i < TOTAL_PAGES; i++) {
+        set_brightness(0x80 + i);
+        commit();
+    }
+    CHECK_EQ(check_power_loss(0x80 + TOTAL_PAGES - 1, 0x33, FLASH_SECTOR_SIZE + SNAPSHOT_BYTES), (int64_t)(FLASH_SECTOR_SIZE + FLASH_PAGE_SIZE));
+}
+
+TEST(config_torn_page_skipped) {
+    write_snapshot(0, 1, 0x41);
+    // Slot 1: partly programmed by a cut, not a valid snapshot
+    memset(slot_ptr(1), 0x00, 40);
+    CHECK_EQ(boot_brightness(), 0x41);
+
+    set_brightness(0x42);
+    commit();
+    CHECK_EQ(slot_magic(2), PAGE_MAGIC);
+    CHECK_EQ(slot_seq(2), 2u);
+    CHECK_EQ(boot_brightness(), 0x42);
+}
+
+TEST(config_sector_erased_only_on_wrap) {
+    config_init();
+    uint32_t erases = sim_flash_erases();
+    for (int i = 0; i < TOTAL_PAGES + 1; i++) {
+        set_brightness(i);
+        commit();
+        // Erases when the log enters a sector: slot 0 (first commit), slot
+        // 16 and, wrapping, slot 0 again
+        uint32_t expected = erases + 1 + (i >= PAGES_PER_SECTOR) + (i >= TOTAL_PAGES);
+        if (sim_flash_erases() != expected) {
+            test_fail(__FILE__, __LINE__, "commit " + std::to_string(i) + ": " + std::to_string(sim_flash_erases() - erases) +
+                                              " erases");
+        }
+    }
+    // The wrap left sector 1 (the previous snapshots) intact
+    CHECK_EQ(slot_seq(0), (uint32_t)TOTAL_PAGES + 1);
+    CHECK_EQ(slot_magic(1), 0xFFFFFFFFu);
+    CHECK_EQ(slot_seq(TOTAL_PAGES - 1), (uint32_t)TOTAL_PAGES);
+    CHECK_EQ(boot_brightness(), (uint8_t)TOTAL_PAGES);
+}
+
+TEST(config_seq_wraparound) {
+    // Sequence numbers about to wrap: 0 after 0xFFFFFFFF is the newer one
+    write_snapshot(0, 0xFFFFFFFEu, 0x01);
+    write_snapshot(1, 0xFFFFFFFFu, 0x02);
+    CHECK_EQ(boot_brightness(), 0x02);
+
+    set_brightness(0x03);
+    commit();
+    CHECK_EQ(slot_seq(2), 0u);
+    CHECK_EQ(boot_brightness(), 0x03);
+
+    set_brightness(0x04);
+    commit();
+    CHECK_EQ(slot_seq(3), 1u);
+    CHECK_EQ(boot_brightness(), 0x04);
+}
+
+// Splash blob: the sector below the config log, header magic first
+#define SPLASH_SECTOR     (REGION_OFFSET - FLASH_SECTOR_SIZE)
+#define SPLASH_BLOB_MAGIC 0x4853504Cu
+
+TEST(config_splash_save_deferred) {
+    // The image is taken when saved; flash is only touched once saves have
+    // been quiet for the commit delay
+    config_init();
+    uint32_t erases = sim_flash_erases();
+    bytes_t image(SSD1306_BUFFER_SIZE);
+    for (size_t i = 0; i < image.size(); i++) image[i] = (uint8_t)(i * 7);
+    bytes_t saved = image;
+    CHECK(config_save_splash(image.data(), image.size()));
+    image[0] ^= 0xFF;
+    sim_advance_us(COMMIT_DELAY_US / 2);
+    config_task();
+    CHECK_EQ(sim_flash_erases(), erases);
+
+    // Meanwhile a load gets the staged image
+    bytes_t loaded(SSD1306_BUFFER_SIZE);
+    CHECK(config_load_splash(loaded.data(), loaded.size()));
+    CHECK_EQ(loaded, saved);
+
+    commit();
+    CHECK_EQ(sim_flash_erases(), erases + 1);
+    uint32_t magic;
+    memcpy(&magic, &sim_flash_memory[SPLASH_SECTOR], 4);
+    CHECK_EQ(magic, SPLASH_BLOB_MAGIC);
+    loaded.assign(SSD1306_BUFFER_SIZE, 0);
+    CHECK(config_load_splash(loaded.data(), loaded.size()));
+    CHECK_EQ(loaded, saved);
+
+    // Removing it is deferred the same way, and takes effect for loads at once
+    config_erase_splash();
+    CHECK(!config_load_splash(loaded.data(), loaded.size()));
+    CHECK_EQ(sim_flash_erases(), erases + 1);
+    commit();
+    CHECK_EQ(sim_flash_erases(), erases + 2);
+    memcpy(&magic, &sim_flash_memory[SPLASH_SECTOR], 4);
+    CHECK_EQ(magic, 0xFFFFFFFFu);
+}
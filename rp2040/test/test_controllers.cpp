@@ -0,0 +1,117 @@
+#include "sim.h"
+#include "test.h"
+
+// Per-controller byte streams for a full redraw: the SSD1306 gets one
+// horizontal-addressing window per dirty page, the SH1106 (no horizontal
+// addressing) a page/column address and the page data, offset by its two
+// hidden RAM columns. The 128x32 SSD1306 has four pages and never addresses
+// a fifth.
+
+typedef std::vector<uint8_t> bytes_t;
+
+#define PAGES (SSD1306_HEIGHT / 8)
+
+static bytes_t page_address(uint8_t page) {
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    return {(uint8_t)(0xB0 | page), 0x02, 0x10};
+#else
+    return {0x22, page, page, 0x21, 0x00, 0x7F};
+#endif
+}
+
+static bytes_t pattern() {
+    bytes_t fb(SSD1306_BUFFER_SIZE);
+    for (size_t i = 0; i < fb.size(); i++) fb[i] = (uint8_t)(i * 7 + i / SSD1306_WIDTH);
+    return fb;
+}
+
+TEST(controller_geometry) {
+#if DISPLAY_CONTROLLER == DISPLAY_SSD1306_128X32
+    CHECK_EQ(SSD1306_BUFFER_SIZE, 512);
+#else
+    CHECK_EQ(SSD1306_BUFFER_SIZE, 1024);
+#endif
+    sim_boot();
+    sim_panel_t* p = sim_panel(0);
+    CHECK_EQ(p->multiplex, (uint8_t)(SSD1306_HEIGHT - 1));
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    CHECK_EQ(p->memory_mode, 2);
+#else
+    CHECK_EQ(p->memory_mode, 0);
+#endif
+    CHECK_EQ(p->bad_commands, 0u);
+}
+
+TEST(controller_full_frame_stream) {
+    sim_boot();
+    sim_settle();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+    size_t at = log.size();
+
+    bytes_t fb = pattern();
+    bytes_t cmd = {CMD_FRAME, 0, PAGES};
+    cmd.insert(cmd.end(), fb.begin(), fb.end());
+    sim_cdc_write(cmd);
+    sim_settle();
+
+    // Page by page, in order, each as address + one data transfer
+    CHECK_EQ(log.size(), at + 2 * PAGES);
+    for (uint8_t page = 0; page < PAGES; page++) {
+        const sim_transfer_t& addr = log[at + 2 * page];
+        const sim_transfer_t& data = log[at + 2 * page + 1];
+        CHECK(!addr.data);
+        CHECK_EQ(addr.bytes, page_address(page));
+        CHECK(data.data);
+        CHECK_EQ(data.bytes, bytes_t(fb.begin() + page * SSD1306_WIDTH, fb.begin() + (page + 1) * SSD1306_WIDTH));
+    }
+    CHECK_EQ(sim_panel_image(0), fb);
+    CHECK_EQ(sim_panel(0)->bad_commands, 0u);
+}
+
+TEST(controller_hidden_columns_untouched) {
+    // The SH1106's RAM is 132 columns wide; the 128 visible ones start at 2
+    sim_boot();
+    bytes_t cmd = {CMD_FRAME, 0, PAGES};
+    cmd.insert(cmd.end(), SSD1306_BUFFER_SIZE, 0xFF);
+    sim_cdc_write(cmd);
+    sim_settle();
+
+    sim_panel_t* p = sim_panel(0);
+    for (uint8_t page = 0; page < PAGES; page++) {
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+        CHECK_EQ(p->ram[page][0], 0);
+        CHECK_EQ(p->ram[page][1], 0);
+        CHECK_EQ(p->ram[page][2], 0xFF);
+        CHECK_EQ(p->ram[page][129], 0xFF);
+        CHECK_EQ(p->ram[page][130], 0);
+        CHECK_EQ(p->ram[page][131], 0);
+#else
+        CHECK_EQ(p->ram[page][0], 0xFF);
+        CHECK_EQ(p->ram[page][127], 0xFF);
+#endif
+    }
+    // Pages past the panel's height are never written
+    for (uint8_t page = PAGES; page < SIM_PANEL_PAGES; page++) {
+        for (int col = 0; col < SIM_PANEL_COLS; col++) CHECK_EQ(p->ram[page][col], 0);
+    }
+}
+
+TEST(controller_bottom_line_text) {
+    // Text on the last line lands on the last page and nowhere past it
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+    const std::vector<sim_transfer_t>& log = sim_panel(0)->log;
+    size_t at = log.size();
+
+    sim_cdc_write({CMD_DRAW_TEXT, 0, (uint8_t)(SSD1306_HEIGHT - 8), 2, 'O', 'K'});
+    sim_settle();
+    CHECK_EQ(log.size(), at + 2);
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106_128X64
+    CHECK_EQ(log[at].bytes, (bytes_t{(uint8_t)(0xB0 | (PAGES - 1)), 0x02, 0x10}));
+#else
+    CHECK_EQ(log[at].bytes, (bytes_t{0x22, PAGES - 1, PAGES - 1, 0x21, 0x00, 0x0F}));
+#endif
+    CHECK_EQ(log[at + 1].bytes.size(), 16u);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
@@ -0,0 +1,96 @@
+#include "sim.h"
+#include "test.h"
+
+// DISPLAY_COUNT=2: both panels on their own wiring (I2C 0x3C/0x3D on one bus,
+// or SPI with a CS and RST line each), without taking over any input pin.
+
+#if DISPLAY_COUNT > 1
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t text(uint8_t x, uint8_t y, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, x, y, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static bytes_t framebuffer(uint8_t id) {
+    const uint8_t* fb = ssd1306_draw_buffer(id);
+    return bytes_t(fb, fb + SSD1306_BUFFER_SIZE);
+}
+
+TEST(dual_draws_reach_selected_panel) {
+    sim_boot();
+    sim_cdc_write({CMD_SELECT_DISPLAY, 0, CMD_CLEAR, CMD_SELECT_DISPLAY, 1, CMD_CLEAR});
+    sim_settle();
+    CHECK_EQ(sim_panel(0)->bad_commands, 0u);
+    CHECK_EQ(sim_panel(1)->bad_commands, 0u);
+
+    size_t log0 = sim_panel(0)->log.size();
+    bytes_t cmd = {CMD_SELECT_DISPLAY, 1};
+    bytes_t draw = text(0, 8, "Second");
+    cmd.insert(cmd.end(), draw.begin(), draw.end());
+    sim_cdc_write(cmd);
+    sim_settle();
+
+    CHECK_EQ(sim_panel(0)->log.size(), log0);
+    CHECK_EQ(sim_panel_image(1), framebuffer(1));
+    CHECK_EQ(sim_panel_image(0), bytes_t(SSD1306_BUFFER_SIZE, 0));
+    CHECK(framebuffer(1) != bytes_t(SSD1306_BUFFER_SIZE, 0));
+
+    // And back to the first one
+    sim_cdc_write({CMD_SELECT_DISPLAY, 0, CMD_INVERT, 1});
+    sim_settle();
+    CHECK(sim_panel(0)->inverted);
+    CHECK(!sim_panel(1)->inverted);
+}
+
+TEST(dual_display_pins_leave_inputs_working) {
+    static const struct {
+        uint pin;
+        int8_t x;
+        int8_t y;
+    } buttons[] = {
+        { LEFT_BTN_PIN, -5, 0 },
+        { RIGHT_BTN_PIN, 5, 0 },
+        { TOP_BTN_PIN, 0, -5 },
+        { BOT_BTN_PIN, 0, 5 },
+    };
+
+    sim_boot();
+    sim_settle();
+    uint32_t resets[2] = { sim_panel(0)->resets, sim_panel(1)->resets };
+    bytes_t image[2] = { sim_panel_image(0), sim_panel_image(1) };
+
+    for (const auto& b : buttons) {
+        sim_hid_reports().clear();
+        sim_gpio_drive(b.pin, false);
+        sim_run_ms(60);
+        sim_gpio_release(b.pin);
+        sim_run_ms(60);
+
+        // Press event and the second one 16 ms later (landscape)
+        CHECK_EQ(sim_hid_reports().size(), 2u);
+        CHECK_EQ(sim_hid_reports()[0].x, b.x);
+        CHECK_EQ(sim_hid_reports()[0].y, b.y);
+    }
+
+    // The button edges did not reset or write to either panel
+    CHECK_EQ(sim_panel(0)->resets, resets[0]);
+    CHECK_EQ(sim_panel(1)->resets, resets[1]);
+    CHECK_EQ(sim_panel_image(0), image[0]);
+    CHECK_EQ(sim_panel_image(1), image[1]);
+}
+
+#ifndef SIM_TRANSPORT_SPI
+TEST(dual_i2c_missing_second_panel_keeps_first) {
+    sim_panel(1)->present = false;
+    sim_boot();
+    sim_cdc_write(text(0, 0, "First"));
+    sim_settle();
+    CHECK_EQ(sim_panel_image(0), framebuffer(0));
+    CHECK(sim_panel(1)->log.empty());
+}
+#endif
+
+#endif // DISPLAY_COUNT > 1
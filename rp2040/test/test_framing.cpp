@@ -0,0 +1,195 @@
+#include "sim.h"
+#include "test.h"
+
+// Command framing from the descriptor table: every opcode and op at the
+// length the protocol gives it, each followed by a TEST ping that must still
+// be framed as a command of its own. A length the table gets too long
+// swallows the ping, one too short leaves bytes that run as extra commands.
+
+typedef std::vector<uint8_t> bytes_t;
+
+typedef struct {
+    const char* name;
+    bytes_t cmd;
+    bool known;           // false: unknown opcode or op, dropped as a resync
+    int overflow;         // Bytes skipped past MAX_CMD_SIZE (-1 = not checked)
+} framing_case_t;
+
+static bytes_t with_tail(bytes_t head, size_t n, uint8_t fill = 'x') {
+    head.insert(head.end(), n, fill);
+    return head;
+}
+
+static std::vector<framing_case_t> framing_cases() {
+    bytes_t frame_one_page = with_tail({CMD_FRAME, 0, 1}, SSD1306_WIDTH, 0x55);
+    bytes_t frame_clamped = with_tail({CMD_FRAME, 7, 4}, 4 * SSD1306_WIDTH, 0x55);
+
+    return {
+        {"clear",             {CMD_CLEAR}, true, 0},
+        {"text",              {CMD_DRAW_TEXT, 0, 0, 3, 'a', 'b', 'c'}, true, 0},
+        {"text_empty",        {CMD_DRAW_TEXT, 0, 0, 0}, true, 0},
+        {"text_max",          with_tail({CMD_DRAW_TEXT, 0, 0, MAX_CMD_SIZE - 4}, MAX_CMD_SIZE - 4), true, 0},
+        {"text_over_max",     with_tail({CMD_DRAW_TEXT, 0, 0, 200}, 200), true, 4 + 200 - MAX_CMD_SIZE},
+        {"set_cursor",        {CMD_SET_CURSOR, 8, 8}, true, 0},
+        {"invert",            {CMD_INVERT, 0}, true, 0},
+        {"brightness",        {CMD_BRIGHTNESS, 0x80}, true, 0},
+        {"progress_bar",      {CMD_PROGRESS_BAR, 0, 56, 64, 8, 50}, true, 0},
+        {"power",             {CMD_POWER, 1}, true, 0},
+        {"input_config",      {CMD_INPUT_CONFIG, 0xF4, 0x01, 120, 40, 10, 0, 0}, true, 0},
+        {"config_set",        {CMD_CONFIG_SET, CFG_KEY_BRIGHTNESS, 1, 0x80}, true, 0},
+        {"config_reset",      {CMD_CONFIG_RESET}, true, 0},
+        {"splash_erase",      {CMD_SPLASH, SPLASH_OP_ERASE}, true, 0},
+        {"boot_time",         {CMD_BOOT_TIME}, true, 0},
+        {"status",            {CMD_STATUS, 0}, true, 0},
+        {"trace_clear",       {CMD_TRACE, TRACE_OP_CLEAR}, true, 0},
+        {"select_display",    {CMD_SELECT_DISPLAY, 0}, true, 0},
+        {"frame",             frame_one_page, true, 0},
+        {"frame_clamped",     frame_clamped, true, 0},
+        {"gfx_pixel",         {CMD_GFX, GFX_OP_PIXEL, 0, 1, 1}, true, 0},
+        {"gfx_line",          {CMD_GFX, GFX_OP_LINE, 0, 0, 0, 10, 10}, true, 0},
+        {"gfx_rect",          {CMD_GFX, GFX_OP_RECT, 0, 0, 0, 10, 10}, true, 0},
+        {"gfx_fill_rect",     {CMD_GFX, GFX_OP_FILL_RECT, 2, 0, 0, 10, 10}, true, 0},
+        {"gfx_circle",        {CMD_GFX, GFX_OP_CIRCLE, 0, 20, 20, 5}, true, 0},
+        {"gfx_fill_circle",   {CMD_GFX, GFX_OP_FILL_CIRCLE, 1, 20, 20, 5}, true, 0},
+        {"gfx_bitmap",        {CMD_GFX, GFX_OP_BITMAP, 0, 0, 0, 10, 3, 0xFF, 0xC0, 0x81, 0x40, 0xFF, 0xC0}, true, 0},
+        {"gfx_clip",          {CMD_GFX, GFX_OP_CLIP, 0, 0, 0, 0, 0}, true, 0},
+        {"gfx_unknown_op",    {CMD_GFX, 0x20}, false, 0},
+        {"graph_setup",       {CMD_GRAPH, GRAPH_OP_SETUP, 0, 0, 40, 64, 16, 0, 100, 0}, true, 0},
+        {"graph_sample",      {CMD_GRAPH, GRAPH_OP_SAMPLE, 0, 50}, true, 0},
+        {"graph_scale",       {CMD_GRAPH, GRAPH_OP_SCALE, 0, 0, 200}, true, 0},
+        {"graph_delete",      {CMD_GRAPH, GRAPH_OP_DELETE, 0}, true, 0},
+        {"graph_unknown_op",  {CMD_GRAPH, 0x20}, false, 0},
+        {"menu_reset",        {CMD_MENU, MENU_OP_RESET}, true, 0},
+        {"menu_item",         {CMD_MENU, MENU_OP_ITEM, 1, 0, 0, 0, 4, 'I', 't', 'e', 'm'}, true, 0},
+        {"menu_open",         {CMD_MENU, MENU_OP_OPEN, 0}, true, 0},
+        {"menu_close",        {CMD_MENU, MENU_OP_CLOSE}, true, 0},
+        {"menu_unknown_op",   {CMD_MENU, 0x20}, false, 0},
+        {"anim_blink",        {CMD_ANIM, ANIM_OP_BLINK, 0, 0, 0, 8, 8, 4, 2}, true, 0},
+        {"anim_slide",        {CMD_ANIM, ANIM_OP_SLIDE, 1, 0, 0, 8, 8, 1, 4}, true, 0},
+        {"anim_contrast",     {CMD_ANIM, ANIM_OP_CONTRAST, 2, 0x40, 4}, true, 0},
+        {"anim_invert_pulse", {CMD_ANIM, ANIM_OP_INVERT_PULSE, 3, 4, 2}, true, 0},
+        {"anim_stop",         {CMD_ANIM, ANIM_OP_STOP, ANIM_SLOT_ALL}, true, 0},
+        {"anim_unknown_op",   {CMD_ANIM, 0x20}, false, 0},
+        {"capture",           {CMD_CAPTURE, 0}, true, 0},
+        {"macro_begin",       {CMD_MACRO, MACRO_OP_BEGIN, 0}, true, 0},
+        {"macro_end",         {CMD_MACRO, MACRO_OP_END}, true, 0},
+        {"macro_play",        {CMD_MACRO, MACRO_OP_PLAY, 0, 3, 'a', 0, 'b'}, true, 0},
+        {"macro_delete",      {CMD_MACRO, MACRO_OP_DELETE, 0}, true, 0},
+        {"macro_unknown_op",  {CMD_MACRO, 0x20}, false, 0},
+        {"packet_off",        {CMD_PACKET, 0}, true, 0},
+        {"grid_write",        {CMD_GRID, GRID_OP_WRITE, 0, 0, 0, 3, 'a', 'b', 'c'}, true, 0},
+        {"grid_attr",         {CMD_GRID, GRID_OP_ATTR, 0, 0, 3, GRID_ATTR_INVERSE}, true, 0},
+        {"grid_redraw",       {CMD_GRID, GRID_OP_REDRAW}, true, 0},
+        {"grid_unknown_op",   {CMD_GRID, 0x20}, false, 0},
+        {"test_ping",         {CMD_TEST, TEST_SUBCMD_PING}, true, 0},
+        {"test_gpio",         {CMD_TEST, TEST_SUBCMD_GPIO, ORIENTATION_PIN, TEST_GPIO_RELEASE}, true, 0},
+        {"test_fb_checksum",  {CMD_TEST, TEST_SUBCMD_FB_CHECKSUM}, true, 0},
+        {"test_bus_stats",    {CMD_TEST, TEST_SUBCMD_BUS_STATS}, true, 0},
+        {"unknown_opcode",    {0x55}, false, 0},
+    };
+}
+
+static uint32_t commands_executed() {
+    uint32_t total = 0;
+    for (uint32_t n : g_stats.cmd_count) total += n;
+    return total;
+}
+
+static uint32_t& count_of(uint8_t opcode) {
+    return g_stats.cmd_count[opcode < STATS_CMD_SLOTS - 1 ? opcode : STATS_CMD_SLOTS - 1];
+}
+
+// Every case followed by a ping, sent whole or in two USB transfers split
+// at byte split (0 = whole), so lengths are also decided from partial commands
+static void check_case(const framing_case_t& c, size_t split) {
+    bytes_t stream = c.cmd;
+    stream.push_back(CMD_TEST);
+    stream.push_back(TEST_SUBCMD_PING);
+
+    uint32_t executed = commands_executed();
+    uint32_t own = count_of(c.cmd[0]);
+    uint32_t pings = count_of(CMD_TEST);
+    uint32_t resyncs = g_stats.parser_resyncs;
+    uint32_t overflows = g_stats.parser_overflows;
+
+    if (split > 0) {
+        sim_cdc_write(bytes_t(stream.begin(), stream.begin() + split));
+        sim_run_us(SIM_USB_PACKET_US * 4);
+        sim_cdc_write(bytes_t(stream.begin() + split, stream.end()));
+    } else {
+        sim_cdc_write(stream);
+    }
+    sim_settle();
+    sim_run_ms(20); // Capture and other streamed replies
+    sim_cdc_read();
+
+    std::string where = std::string(c.name) + (split ? " split at " + std::to_string(split) : "") + ": ";
+    bool ping_ran = count_of(CMD_TEST) == pings + 1 + (c.cmd[0] == CMD_TEST);
+    if (!ping_ran) test_fail(__FILE__, __LINE__, where + "following command not framed");
+    if (c.known) {
+        if (commands_executed() != executed + 2) {
+            test_fail(__FILE__, __LINE__, where + std::to_string(commands_executed() - executed) +
+                                              " commands ran, expected 2");
+        }
+        if (c.cmd[0] != CMD_TEST && count_of(c.cmd[0]) != own + 1) {
+            test_fail(__FILE__, __LINE__, where + "command did not run");
+        }
+        if (g_stats.parser_resyncs != resyncs) test_fail(__FILE__, __LINE__, where + "resync");
+    } else {
+        if (commands_executed() != executed + 1) test_fail(__FILE__, __LINE__, where + "unknown command ran");
+        if (g_stats.parser_resyncs != resyncs + 1) test_fail(__FILE__, __LINE__, where + "no resync");
+    }
+    if (c.overflow >= 0 && g_stats.parser_overflows - overflows != (uint32_t)c.overflow) {
+        test_fail(__FILE__, __LINE__, where + std::to_string(g_stats.parser_overflows - overflows) +
+                                          " bytes skipped, expected " + std::to_string(c.overflow));
+    }
+}
+
+TEST(framing_every_opcode) {
+    sim_boot();
+    for (const framing_case_t& c : framing_cases()) check_case(c, 0);
+}
+
+TEST(framing_every_opcode_split) {
+    sim_boot();
+    for (const framing_case_t& c : framing_cases()) {
+        // Every split point of short commands, the ends of long ones
+        for (size_t split = 1; split <= c.cmd.size() + 1; split++) {
+            if (split > 8 && split + 8 < c.cmd.size()) continue;
+            check_case(c, split);
+        }
+    }
+}
+
+TEST(framing_text_completed_by_timeout) {
+    // Text that never arrives in full is drawn by the safety timeout and
+    // the parser takes the next bytes as a new command
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR, CMD_DRAW_TEXT, 0, 0, 5, 'a', 'b'});
+    sim_run_ms(1000);
+    uint32_t pings = count_of(CMD_TEST);
+    CHECK_EQ(sim_cdc_query({CMD_TEST, TEST_SUBCMD_PING}, 2), (bytes_t{CMD_TEST, TEST_SUBCMD_PING}));
+    CHECK_EQ(count_of(CMD_TEST), pings + 1);
+    CHECK(g_stats.parser_timeouts >= 1);
+}
+
+TEST(framing_frame_past_bottom_dropped) {
+    // Two pages from the bottom one: the first is drawn, the second dropped
+    // without counting as an overflow
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+    uint8_t last = SSD1306_HEIGHT / 8 - 1;
+    uint32_t overflows = g_stats.parser_overflows;
+    bytes_t frame = {CMD_FRAME, last, 2};
+    frame.insert(frame.end(), SSD1306_WIDTH, 0x0F);
+    frame.insert(frame.end(), SSD1306_WIDTH, 0xF0);
+    sim_cdc_write(frame);
+    sim_settle();
+    CHECK_EQ(g_stats.parser_overflows, overflows);
+    bytes_t image = sim_panel_image(0);
+    CHECK_EQ(image, bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+    CHECK_EQ(image[last * SSD1306_WIDTH], 0x0F);
+    CHECK_EQ(image[SSD1306_BUFFER_SIZE - 1], 0x0F);
+    CHECK_EQ(image[0], 0x00);
+}
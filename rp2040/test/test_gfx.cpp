@@ -0,0 +1,239 @@
+#include "sim.h"
+#include "test.h"
+
+// Graphics primitives against golden framebuffers: pixel art of each shape,
+// draw modes (XOR drawn twice leaves nothing), clipping, and the dirty box
+// each primitive hands to the flush.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// Pixel art of the shapes drawn by the tests below
+static const std::string LINE_ART =
+    "..............\n"
+    ".##...........\n"
+    "...###........\n"
+    "......##......\n"
+    "........###...\n"
+    "...........##.\n"
+    "..............\n";
+
+static const std::string RECT_ART =
+    "..........\n"
+    ".########.\n"
+    ".#......#.\n"
+    ".#......#.\n"
+    ".#......#.\n"
+    ".########.\n"
+    "..........\n";
+
+static const std::string FILL_RECT_ART =
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "..####..\n"
+    "..####..\n"
+    "..####..\n"
+    "..####..\n"
+    "..####..\n"
+    "..####..\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n";
+
+static const std::string CIRCLE_ART =
+    "...........\n"
+    "....###....\n"
+    "..##...##..\n"
+    "..#.....#..\n"
+    ".#.......#.\n"
+    ".#.......#.\n"
+    ".#.......#.\n"
+    "..#.....#..\n"
+    "..##...##..\n"
+    "....###....\n"
+    "...........\n";
+
+static const std::string FILL_CIRCLE_ART =
+    "...........\n"
+    "....###....\n"
+    "..#######..\n"
+    "..#######..\n"
+    ".#########.\n"
+    ".#########.\n"
+    ".#########.\n"
+    "..#######..\n"
+    "..#######..\n"
+    "....###....\n"
+    "...........\n";
+
+static const std::string BITMAP_ART =
+    "............\n"
+    ".##########.\n"
+    ".#......#.#.\n"
+    ".#.#.#.#.#..\n"
+    "............\n";
+
+static const std::string XOR_ART =
+    ".#####..##.\n"
+    "#..###..##.\n"
+    "###..#####.\n"
+    "#####..###.\n"
+    "#######..#.\n"
+    "#########..\n"
+    "...........\n";
+
+static const std::string CLIP_ART =
+    "..........\n"
+    "..........\n"
+    "...#####..\n"
+    "...#####..\n"
+    "...#####..\n"
+    "...#####..\n"
+    "..........\n"
+    "..........\n";
+
+static void gfx_boot() {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+}
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static std::string art(int x, int y, int w, int h) {
+    return sim_art(ssd1306_get_buffer(), x, y, w, h);
+}
+
+static uint16_t fb_crc() {
+    return crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+}
+
+static size_t log_size() {
+    return sim_panel(0)->log.size();
+}
+
+static bool window_is(const sim_window_t& w, uint8_t page, uint8_t col_start, uint8_t col_end) {
+    return w.page_start == page && w.page_end == page && w.col_start == col_start && w.col_end == col_end;
+}
+
+TEST(gfx_line_golden) {
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_SET, 1, 1, 12, 5});
+    CHECK_EQ(art(0, 0, 14, 7), LINE_ART);
+}
+
+TEST(gfx_rect_golden) {
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_RECT, GFX_MODE_SET, 1, 1, 8, 5});
+    CHECK_EQ(art(0, 0, 10, 7), RECT_ART);
+}
+
+TEST(gfx_fill_rect_across_pages) {
+    // Rows 5..10 span pages 0 and 1: one window per page, the box's columns
+    gfx_boot();
+    size_t at = log_size();
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET, 2, 5, 4, 6});
+    CHECK_EQ(art(0, 0, 8, 16), FILL_RECT_ART);
+    std::vector<sim_window_t> windows = sim_flush_windows(0, at);
+    CHECK_EQ(windows.size(), 2u);
+    CHECK(window_is(windows[0], 0, 2, 5));
+    CHECK(window_is(windows[1], 1, 2, 5));
+}
+
+TEST(gfx_circle_golden) {
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_CIRCLE, GFX_MODE_SET, 5, 5, 4});
+    CHECK_EQ(art(0, 0, 11, 11), CIRCLE_ART);
+}
+
+TEST(gfx_fill_circle_golden) {
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_FILL_CIRCLE, GFX_MODE_SET, 5, 5, 4});
+    CHECK_EQ(art(0, 0, 11, 11), FILL_CIRCLE_ART);
+}
+
+TEST(gfx_fill_circle_covers_outline) {
+    // Every radius: the outline drawn over the fill adds no pixel
+    gfx_boot();
+    for (uint8_t r = 0; r <= 30; r++) {
+        send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_CLEAR, 0, 0, 128, 64});
+        send({CMD_GFX, GFX_OP_FILL_CIRCLE, GFX_MODE_SET, 40, 31, r});
+        uint16_t filled = fb_crc();
+        send({CMD_GFX, GFX_OP_CIRCLE, GFX_MODE_SET, 40, 31, r});
+        if (fb_crc() != filled) test_fail(__FILE__, __LINE__, "radius " + std::to_string(r));
+    }
+}
+
+TEST(gfx_bitmap_golden) {
+    // 10x3, two bytes per row, MSB first
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_BITMAP, GFX_MODE_SET, 1, 1, 10, 3, 0xFF, 0xC0, 0x81, 0x40, 0xAA, 0x80});
+    CHECK_EQ(art(0, 0, 12, 5), BITMAP_ART);
+}
+
+TEST(gfx_xor_is_reversible) {
+    gfx_boot();
+    uint16_t blank = fb_crc();
+
+    // Every outline primitive twice in XOR: nothing left
+    const bytes_t shapes[] = {
+        {CMD_GFX, GFX_OP_LINE, GFX_MODE_XOR, 3, 60, 120, 2},
+        {CMD_GFX, GFX_OP_RECT, GFX_MODE_XOR, 10, 10, 50, 20},
+        {CMD_GFX, GFX_OP_CIRCLE, GFX_MODE_XOR, 64, 16, 15},
+        {CMD_GFX, GFX_OP_FILL_CIRCLE, GFX_MODE_XOR, 30, 20, 9},
+    };
+    for (const bytes_t& s : shapes) send(s);
+    CHECK(fb_crc() != blank);
+    for (const bytes_t& s : shapes) send(s);
+    CHECK_EQ(fb_crc(), blank);
+    CHECK_EQ(sim_panel_image(0), bytes_t(SSD1306_BUFFER_SIZE, 0));
+
+    // XOR line across a filled box cuts through it; CLEAR removes a part
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET, 0, 0, 10, 6});
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_XOR, 0, 0, 9, 5});
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_CLEAR, 6, 0, 2, 2});
+    CHECK_EQ(art(0, 0, 11, 7), XOR_ART);
+}
+
+TEST(gfx_clip) {
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_CLIP, 0, 3, 2, 5, 4});
+
+    // Only the clip box is drawn, and only it is sent
+    size_t at = log_size();
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET, 0, 0, 16, 16});
+    CHECK_EQ(art(0, 0, 10, 8), CLIP_ART);
+    std::vector<sim_window_t> windows = sim_flush_windows(0, at);
+    CHECK_EQ(windows.size(), 1u);
+    CHECK(window_is(windows[0], 0, 3, 7));
+
+    // A primitive wholly outside draws and sends nothing
+    at = log_size();
+    send({CMD_GFX, GFX_OP_CIRCLE, GFX_MODE_SET, 60, 30, 5});
+    CHECK_EQ(log_size(), at);
+
+    // w = 0: whole screen again
+    send({CMD_GFX, GFX_OP_CLIP, 0, 0, 0, 0, 0});
+    send({CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, (uint8_t)(SSD1306_WIDTH - 1), (uint8_t)(SSD1306_HEIGHT - 1)});
+    CHECK(sim_panel_pixel(0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1));
+}
+
+TEST(gfx_scene_checksum) {
+    // One of everything: framebuffer CRC per geometry, and the panel shows it
+    gfx_boot();
+    send({CMD_GFX, GFX_OP_RECT, GFX_MODE_SET, 0, 0, 128, 32});
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_SET, 0, 0, 127, 31});
+    send({CMD_GFX, GFX_OP_FILL_CIRCLE, GFX_MODE_XOR, 64, 16, 12});
+    send({CMD_GFX, GFX_OP_CIRCLE, GFX_MODE_SET, 100, 16, 10});
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_CLEAR, 20, 10, 10, 10});
+    send({CMD_GFX, GFX_OP_BITMAP, GFX_MODE_XOR, 4, 20, 10, 3, 0xFF, 0xC0, 0x81, 0x40, 0xAA, 0x80});
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0x92E5 : 0x3000);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
@@ -0,0 +1,171 @@
+#include "sim.h"
+#include "test.h"
+
+// Sparkline graphs against golden framebuffers: line and filled plots, the
+// scroll leaving pixels outside the region alone, a rescale redrawing from
+// history, and each sample sending only the graph's region.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// 12x8 graph at (2, 2), scale 0..7, after the samples of push_samples()
+static const std::string LINE_ART =
+    "................\n"
+    "................\n"
+    "......###.......\n"
+    "......#.#...##..\n"
+    "......#.#.####..\n"
+    "......#.###..#..\n"
+    ".....##.##...#..\n"
+    "....##..##...#..\n"
+    "...##...##......\n"
+    "..##....##......\n"
+    "................\n"
+    "................\n";
+
+static const std::string FILL_ART =
+    "................\n"
+    "................\n"
+    "......##........\n"
+    "......##....#...\n"
+    "......##..###...\n"
+    "......##.####...\n"
+    ".....###.####...\n"
+    "....####.#####..\n"
+    "...#####.#####..\n"
+    "..############..\n"
+    "................\n"
+    "................\n";
+
+// The line graph rescaled to 0..14
+static const std::string RESCALED_ART =
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "......###...##..\n"
+    "......#.######..\n"
+    "....###.##...#..\n"
+    "..###...##......\n"
+    "................\n"
+    "................\n";
+
+// Line graph between a line above and below its region, a bar to its right
+static const std::string NEIGHBOURS_ART =
+    "..............##\n"
+    "################\n"
+    "......###.....##\n"
+    "......#.#...####\n"
+    "......#.#.######\n"
+    "......#.###..###\n"
+    ".....##.##...###\n"
+    "....##..##...###\n"
+    "...##...##....##\n"
+    "..##....##....##\n"
+    "################\n"
+    "..............##\n";
+
+static const uint8_t samples[] = {0, 1, 2, 3, 7, 7, 0, 4, 5, 5, 6, 2};
+
+static void graph_boot() {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+}
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static std::string art(int x, int y, int w, int h) {
+    return sim_art(ssd1306_get_buffer(), x, y, w, h);
+}
+
+static uint16_t fb_crc() {
+    return crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+}
+
+static void setup(uint8_t flags) {
+    send({CMD_GRAPH, GRAPH_OP_SETUP, 0, 2, 2, 12, 8, 0, 7, flags});
+}
+
+static void push_samples() {
+    for (uint8_t v : samples) send({CMD_GRAPH, GRAPH_OP_SAMPLE, 0, v});
+}
+
+TEST(graph_line_golden) {
+    graph_boot();
+    setup(0);
+    push_samples();
+    CHECK_EQ(art(0, 0, 16, 12), LINE_ART);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(graph_fill_golden) {
+    graph_boot();
+    setup(GRAPH_FLAG_FILL);
+    push_samples();
+    CHECK_EQ(art(0, 0, 16, 12), FILL_ART);
+}
+
+TEST(graph_sample_sends_region_only) {
+    // Rows 2..9: pages 0 and 1, columns 2..13
+    graph_boot();
+    setup(0);
+    size_t at = sim_panel(0)->log.size();
+    send({CMD_GRAPH, GRAPH_OP_SAMPLE, 0, 3});
+    std::vector<sim_window_t> windows = sim_flush_windows(0, at);
+    CHECK_EQ(windows.size(), 2u);
+    for (uint8_t page = 0; page < 2; page++) {
+        CHECK_EQ(windows[page].page_start, page);
+        CHECK_EQ(windows[page].page_end, page);
+        CHECK_EQ(windows[page].col_start, 2);
+        CHECK_EQ(windows[page].col_end, 13);
+    }
+}
+
+TEST(graph_scroll_keeps_neighbours) {
+    graph_boot();
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_SET, 0, 1, 15, 1});
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_SET, 0, 10, 15, 10});
+    send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET, 14, 0, 2, 12});
+    setup(0);
+    push_samples();
+    CHECK_EQ(art(0, 0, 16, 12), NEIGHBOURS_ART);
+}
+
+TEST(graph_rescale_redraws_history) {
+    graph_boot();
+    setup(0);
+    push_samples();
+    send({CMD_GRAPH, GRAPH_OP_SCALE, 0, 0, 14});
+    CHECK_EQ(art(0, 0, 16, 12), RESCALED_ART);
+}
+
+TEST(graph_scroll_matches_redraw) {
+    // Many more samples than columns: the scrolled plot is exactly what a
+    // redraw from history draws, for line and filled graphs
+    for (uint8_t flags : {0, GRAPH_FLAG_FILL}) {
+        graph_boot();
+        send({CMD_GRAPH, GRAPH_OP_SETUP, 1, 20, 5, 40, 20, 10, 90, flags});
+        for (int i = 0; i < 150; i++) send({CMD_GRAPH, GRAPH_OP_SAMPLE, 1, (uint8_t)((i * 37) % 100)});
+        uint16_t scrolled = fb_crc();
+        send({CMD_GRAPH, GRAPH_OP_SCALE, 1, 10, 90});
+        CHECK_EQ(fb_crc(), scrolled);
+    }
+}
+
+TEST(graph_checksum) {
+    // Two graphs side by side, one line and one filled: framebuffer CRC per geometry
+    graph_boot();
+    send({CMD_GRAPH, GRAPH_OP_SETUP, 0, 0, 0, 64, 32, 0, 100, 0});
+    send({CMD_GRAPH, GRAPH_OP_SETUP, 1, 64, 0, 64, 32, 0, 100, GRAPH_FLAG_FILL});
+    for (int i = 0; i < 80; i++) {
+        send({CMD_GRAPH, GRAPH_OP_SAMPLE, 0, (uint8_t)((i * 13) % 101)});
+        send({CMD_GRAPH, GRAPH_OP_SAMPLE, 1, (uint8_t)((i * 29) % 101)});
+    }
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0xCF3C : 0xE357);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
@@ -0,0 +1,190 @@
+#include "sim.h"
+#include "test.h"
+
+// Character grid against golden framebuffers: what a write draws (pixel art
+// of the cells and a CRC of the whole framebuffer), that a rewrite only draws
+// and sends the cells that changed, inverse and blinking cells, and the
+// flush merging the dirty cells of a page into one window.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// "HELLO" at row 1, column 2 (pixels 16..55, 8..15)
+static const std::string HELLO_ART =
+    "##..##..#######.####....####......###...\n"
+    "##..##...##...#..##......##......##.##..\n"
+    "##..##...##.#....##......##.....##...##.\n"
+    "######...####....##......##.....##...##.\n"
+    "##..##...##.#....##...#..##...#.##...##.\n"
+    "##..##...##...#..##..##..##..##..##.##..\n"
+    "##..##..#######.#######.#######...###...\n"
+    "........................................\n";
+
+// The same cells after "HELP!"
+static const std::string HELP_ART =
+    "##..##..#######.####....######.....##...\n"
+    "##..##...##...#..##......##..##...####..\n"
+    "##..##...##.#....##......##..##...####..\n"
+    "######...####....##......#####.....##...\n"
+    "##..##...##.#....##...#..##........##...\n"
+    "##..##...##...#..##..##..##.............\n"
+    "##..##..#######.#######.####.......##...\n"
+    "........................................\n";
+
+// "A" plain and inverse in cells 0 and 1
+static const std::string INVERSE_ART =
+    "..##....##..####\n"
+    ".####...#....###\n"
+    "##..##....##..##\n"
+    "##..##....##..##\n"
+    "######........##\n"
+    "##..##....##..##\n"
+    "##..##....##..##\n"
+    "........########\n";
+
+// Blinking "B" next to a plain "C", shown and blanked
+static const std::string BLINK_ON_ART =
+    "######....####..\n"
+    ".##..##..##..##.\n"
+    ".##..##.##......\n"
+    ".#####..##......\n"
+    ".##..##.##......\n"
+    ".##..##..##..##.\n"
+    "######....####..\n"
+    "................\n";
+static const std::string BLINK_OFF_ART =
+    "..........####..\n"
+    ".........##..##.\n"
+    "........##......\n"
+    "........##......\n"
+    "........##......\n"
+    ".........##..##.\n"
+    "..........####..\n"
+    "................\n";
+
+static bytes_t grid_write(uint8_t row, uint8_t col, uint8_t attr, const std::string& s) {
+    bytes_t cmd = {CMD_GRID, GRID_OP_WRITE, row, col, attr, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static uint16_t fb_crc() {
+    return crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+}
+
+static void grid_boot() {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+}
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static void check_windows(const std::vector<sim_window_t>& got, const std::vector<sim_window_t>& want, int line) {
+    bool same = got.size() == want.size();
+    for (size_t i = 0; same && i < got.size(); i++) {
+        same = got[i].page_start == want[i].page_start && got[i].page_end == want[i].page_end &&
+               got[i].col_start == want[i].col_start && got[i].col_end == want[i].col_end;
+    }
+    if (same) return;
+    std::string msg = "flushed";
+    for (const sim_window_t& w : got) {
+        msg += " [p" + std::to_string(w.page_start) + "-" + std::to_string(w.page_end) + " c" +
+               std::to_string(w.col_start) + "-" + std::to_string(w.col_end) + "]";
+    }
+    test_fail(__FILE__, line, msg);
+}
+
+static size_t log_size() {
+    return sim_panel(0)->log.size();
+}
+
+TEST(grid_write_golden) {
+    grid_boot();
+    size_t at = log_size();
+    send(grid_write(1, 2, 0, "HELLO"));
+    CHECK_EQ(sim_art(ssd1306_get_buffer(), 16, 8, 40, 8), HELLO_ART);
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0xB221 : 0x8BD2);
+    check_windows(sim_flush_windows(0, at), {{1, 1, 16, 55}}, __LINE__);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(grid_rewrite_draws_changed_cells_only) {
+    grid_boot();
+    send(grid_write(1, 2, 0, "HELLO"));
+
+    // Same text again: nothing drawn, nothing sent
+    size_t at = log_size();
+    send(grid_write(1, 2, 0, "HELLO"));
+    CHECK_EQ(log_size(), at);
+
+    // "HELP!": only the last two cells change
+    send(grid_write(1, 2, 0, "HELP!"));
+    check_windows(sim_flush_windows(0, at), {{1, 1, 40, 55}}, __LINE__);
+    CHECK_EQ(sim_art(ssd1306_get_buffer(), 16, 8, 40, 8), HELP_ART);
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0xB0BE : 0xA2A5);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(grid_page_coalescing) {
+    // Cells changed by one USB transfer: merged into one window per page,
+    // spanning the first to the last dirty column
+    grid_boot();
+    size_t at = log_size();
+    bytes_t cmds = grid_write(1, 0, 0, "X");
+    bytes_t more[] = {grid_write(1, 10, 0, "Y"), grid_write(3, 15, 0, "Z"), grid_write(1, 4, 0, "W")};
+    for (const bytes_t& m : more) cmds.insert(cmds.end(), m.begin(), m.end());
+    send(cmds);
+    check_windows(sim_flush_windows(0, at), {{1, 1, 0, 87}, {3, 3, 120, 127}}, __LINE__);
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0x2D63 : 0x1F89);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(grid_inverse_golden) {
+    grid_boot();
+    send(grid_write(0, 0, 0, "A"));
+    send(grid_write(0, 1, GRID_ATTR_INVERSE, "A"));
+    CHECK_EQ(sim_art(ssd1306_get_buffer(), 0, 0, 16, 8), INVERSE_ART);
+    const uint8_t* fb = ssd1306_get_buffer();
+    for (int i = 0; i < 8; i++) CHECK_EQ(fb[8 + i], (uint8_t)~fb[i]);
+
+    // Inverse off again: the plain glyph, sent as one cell
+    size_t at = log_size();
+    send({CMD_GRID, GRID_OP_ATTR, 0, 1, 1, 0});
+    check_windows(sim_flush_windows(0, at), {{0, 0, 8, 15}}, __LINE__);
+    for (int i = 0; i < 8; i++) CHECK_EQ(fb[8 + i], fb[i]);
+}
+
+TEST(grid_blink_golden) {
+    grid_boot();
+    send(grid_write(2, 4, GRID_ATTR_BLINK, "B"));
+    send(grid_write(2, 5, 0, "C"));
+    std::string shown = sim_art(ssd1306_get_buffer(), 32, 16, 16, 8);
+    CHECK_EQ(shown, BLINK_ON_ART);
+    uint16_t shown_crc = fb_crc();
+
+    // Blanked after GRID_BLINK_US: only the blinking cell is drawn and sent
+    size_t at = log_size();
+    sim_run_us(GRID_BLINK_US);
+    sim_settle();
+    check_windows(sim_flush_windows(0, at), {{2, 2, 32, 39}}, __LINE__);
+    CHECK_EQ(sim_art(ssd1306_get_buffer(), 32, 16, 16, 8), BLINK_OFF_ART);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+
+    // And back
+    at = log_size();
+    sim_run_us(GRID_BLINK_US);
+    sim_settle();
+    check_windows(sim_flush_windows(0, at), {{2, 2, 32, 39}}, __LINE__);
+    CHECK_EQ(fb_crc(), shown_crc);
+
+    // Blink attribute cleared: the cell stays and the blinking stops
+    send({CMD_GRID, GRID_OP_ATTR, 2, 4, 1, 0});
+    at = log_size();
+    sim_run_us(3 * GRID_BLINK_US);
+    sim_settle();
+    CHECK_EQ(log_size(), at);
+    CHECK_EQ(fb_crc(), shown_crc);
+}
@@ -0,0 +1,186 @@
+#include <stddef.h>
+#include "sim.h"
+#include "test.h"
+
+// The ENABLE_TEST_COMMANDS protocol (framebuffer checksum, bus counters,
+// forced input pins) against the emulator, with the queries decoded as
+// tools/perf_gate.py decodes them. The gate itself runs on sim_device (see
+// CMakeLists.txt).
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t text(uint8_t x, uint8_t y, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, x, y, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static uint32_t get_u32(const bytes_t& b, size_t offset) {
+    return b[offset] | (b[offset + 1] << 8) | (b[offset + 2] << 16) | ((uint32_t)b[offset + 3] << 24);
+}
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t failures;
+    bool pending;
+} bus_stats_t;
+
+static bus_stats_t bus_stats() {
+    bytes_t reply = sim_cdc_query({CMD_TEST, TEST_SUBCMD_BUS_STATS}, 15);
+    if (reply.size() != 15 || reply[0] != CMD_TEST || reply[1] != TEST_SUBCMD_BUS_STATS) {
+        test_fail(__FILE__, __LINE__, "bad BUS_STATS reply " + test_str(reply));
+    }
+    return { get_u32(reply, 2), get_u32(reply, 6), get_u32(reply, 10), reply[14] != 0 };
+}
+
+// Poll until every flush is done, as perf_gate.py does
+static bus_stats_t settle() {
+    for (int i = 0; i < 1000; i++) {
+        bus_stats_t stats = bus_stats();
+        if (!stats.pending) return stats;
+        sim_run_us(5000);
+    }
+    test_fail(__FILE__, __LINE__, "display flush did not finish");
+}
+
+static uint16_t fb_checksum(bool* pending = NULL) {
+    bytes_t reply = sim_cdc_query({CMD_TEST, TEST_SUBCMD_FB_CHECKSUM}, 6);
+    if (reply.size() != 6) test_fail(__FILE__, __LINE__, "bad FB_CHECKSUM reply " + test_str(reply));
+    if (pending) *pending = reply[5] != 0;
+    return reply[3] | (reply[4] << 8);
+}
+
+static uint32_t hid_sent() {
+    bytes_t reply = sim_cdc_query({CMD_STATUS, 0}, 3 + sizeof(device_stats_t));
+    if (reply.size() != 3 + sizeof(device_stats_t)) test_fail(__FILE__, __LINE__, "bad CMD_STATUS reply");
+    return get_u32(reply, 3 + offsetof(device_stats_t, hid_sent));
+}
+
+static void gpio(uint8_t pin, uint8_t level) {
+    sim_cdc_write({CMD_TEST, TEST_SUBCMD_GPIO, pin, level});
+    sim_run_ms(12); // Past the 5 ms debounce, as perf_gate.py's EDGE_GAP_S
+}
+
+// Bytes the display bus carried according to the panels' own logs
+static uint32_t panel_bus_bytes() {
+    uint32_t total = 0;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        for (const sim_transfer_t& t : sim_panel(id)->log) {
+#ifdef SIM_TRANSPORT_SPI
+            total += t.bytes.size();
+#else
+            total += t.bytes.size() + 1; // Control byte
+#endif
+        }
+    }
+    return total;
+}
+
+TEST(boot_ping) {
+    sim_boot();
+    CHECK_EQ(sim_cdc_query({CMD_TEST, TEST_SUBCMD_PING}, 2), (bytes_t{CMD_TEST, TEST_SUBCMD_PING}));
+}
+
+TEST(boot_panels_show_framebuffer) {
+    sim_boot();
+    sim_settle();
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        const sim_panel_t* p = sim_panel(id);
+        CHECK(p->on);
+        CHECK_EQ(p->bad_commands, 0u);
+        CHECK_EQ(p->multiplex, (uint8_t)(SSD1306_HEIGHT - 1));
+        const uint8_t* fb = ssd1306_draw_buffer(id);
+        CHECK_EQ(sim_panel_image(id), bytes_t(fb, fb + SSD1306_BUFFER_SIZE));
+    }
+    // The boot message on display 0
+    CHECK(sim_art(ssd1306_draw_buffer(0), 0, 0, 8, 8) != sim_art(ssd1306_draw_buffer(0), 120, 0, 8, 8));
+}
+
+TEST(fb_checksum_tracks_framebuffer_and_flush) {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+
+    bool pending = true;
+    uint16_t blank = fb_checksum(&pending);
+    CHECK(!pending);
+    CHECK_EQ(blank, crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE));
+
+    // Drawn but not sent yet: checksum changes, flush reported pending.
+    // Both commands go in one USB packet, so the query runs right after the draw
+    bytes_t cmds = text(0, 0, "Hello, world");
+    cmds.push_back(CMD_TEST);
+    cmds.push_back(TEST_SUBCMD_FB_CHECKSUM);
+    bytes_t reply = sim_cdc_query(cmds, 6);
+    CHECK_EQ(reply.size(), 6u);
+    uint16_t drawn = reply[3] | (reply[4] << 8);
+    CHECK(drawn != blank);
+    CHECK_EQ(reply[5], 1);
+    CHECK_EQ(drawn, crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE));
+
+    settle();
+    CHECK_EQ(fb_checksum(&pending), drawn);
+    CHECK(!pending);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(bus_stats_match_panel_traffic) {
+    sim_boot();
+    settle();
+    bus_stats_t before = bus_stats();
+    CHECK_EQ(before.bytes, panel_bus_bytes());
+    CHECK_EQ(before.failures, 0u);
+
+    sim_cdc_write(text(0, 24, "CPU 42%"));
+    bus_stats_t after = settle();
+    CHECK_EQ(after.bytes, panel_bus_bytes());
+    CHECK(after.transactions > before.transactions);
+}
+
+TEST(gpio_encoder_detent_reports_movement) {
+    sim_boot();
+    sim_hid_reports().clear();
+
+    // One detent clockwise: two Gray code transitions, one report each
+    gpio(ROTARY_CLK_PIN, 0);
+    gpio(ROTARY_DT_PIN, 0);
+    gpio(ROTARY_CLK_PIN, 1);
+    gpio(ROTARY_DT_PIN, 1);
+    gpio(ROTARY_CLK_PIN, TEST_GPIO_RELEASE);
+    gpio(ROTARY_DT_PIN, TEST_GPIO_RELEASE);
+
+    std::vector<sim_hid_report_t>& reports = sim_hid_reports();
+    CHECK_EQ(reports.size(), 4u);
+    for (const sim_hid_report_t& r : reports) {
+        CHECK_EQ(r.buttons, 0);
+        CHECK_EQ(r.y, 0);
+        CHECK(r.x == 5 || r.x == -5);
+    }
+}
+
+TEST(gpio_enter_press_and_release) {
+    sim_boot();
+    sim_hid_reports().clear();
+    uint32_t sent = hid_sent();
+
+    gpio(ENTER_BTN_PIN, 0);
+    sim_run_ms(60);
+    gpio(ENTER_BTN_PIN, TEST_GPIO_RELEASE);
+    CHECK_EQ(hid_sent() - sent, 2u);
+
+    std::vector<sim_hid_report_t>& reports = sim_hid_reports();
+    CHECK_EQ(reports.size(), 2u);
+    CHECK_EQ(reports[0].buttons, MOUSE_BTN_LEFT);
+    CHECK_EQ(reports[1].buttons, 0);
+}
+
+TEST(gpio_unknown_pin_ignored) {
+    sim_boot();
+    sim_hid_reports().clear();
+    gpio(ORIENTATION_PIN, 0);
+    gpio(I2C_SDA_PIN, 0);
+    sim_run_ms(50);
+    CHECK(sim_hid_reports().empty());
+    CHECK_EQ(sim_cdc_query({CMD_TEST, TEST_SUBCMD_PING}, 2), (bytes_t{CMD_TEST, TEST_SUBCMD_PING}));
+}
@@ -0,0 +1,122 @@
+#include "sim.h"
+#include "test.h"
+
+// Button timing on the simulated clock: the two press events, auto-repeat
+// starting after the repeat delay and accelerating down to the minimum
+// interval, repeats stopping on release, and ENTER long-press reported as
+// the right button held together with the left one.
+
+typedef std::vector<uint8_t> bytes_t;
+
+static void input_config(uint16_t delay, uint8_t rate, uint8_t min, uint8_t accel, uint16_t long_press) {
+    sim_cdc_write({CMD_INPUT_CONFIG, (uint8_t)delay, (uint8_t)(delay >> 8), rate, min, accel,
+                   (uint8_t)long_press, (uint8_t)(long_press >> 8)});
+    sim_settle();
+}
+
+// Hold pin for ms, release it and let any pending event go out. Returns the
+// reports sent, with times in ms since the press.
+static std::vector<sim_hid_report_t> hold(uint pin, uint32_t ms) {
+    sim_hid_reports().clear();
+    uint64_t start = sim_now_us();
+    sim_gpio_drive(pin, false);
+    sim_run_ms(ms);
+    sim_gpio_release(pin);
+    sim_run_ms(100);
+    std::vector<sim_hid_report_t> reports = sim_hid_reports();
+    for (sim_hid_report_t& r : reports) r.time_us = (r.time_us - start) / 1000;
+    return reports;
+}
+
+// Every report at the expected time (ms since the press, to within the 1 ms
+// the main loop may take to notice), moving as the button does
+static void check_times(const std::vector<sim_hid_report_t>& reports, const std::vector<uint64_t>& times, int8_t y,
+                        int line) {
+    std::string msg;
+    if (reports.size() != times.size()) {
+        msg = std::to_string(reports.size()) + " reports, expected " + std::to_string(times.size());
+    }
+    for (size_t i = 0; msg.empty() && i < times.size(); i++) {
+        if (reports[i].time_us > times[i] + 1 || reports[i].time_us + 1 < times[i]) {
+            msg = "report " + std::to_string(i) + " at " + std::to_string(reports[i].time_us) + " ms, expected " +
+                  std::to_string(times[i]);
+        } else if (reports[i].y != y || reports[i].x != 0 || reports[i].buttons != 0) {
+            msg = "report " + std::to_string(i) + " moved wrong";
+        }
+    }
+    if (!msg.empty()) test_fail(__FILE__, line, msg);
+}
+
+TEST(input_press_sends_two_events) {
+    // Released before the repeat delay: the press and the second event only
+    sim_boot();
+    sim_settle();
+    check_times(hold(BOT_BTN_PIN, 200), {0, 16}, 5, __LINE__);
+}
+
+TEST(input_repeat_accelerates_to_min) {
+    // Defaults: repeats from 500 ms, 120 ms apart, 10 ms faster each time
+    // down to 40 ms
+    sim_boot();
+    sim_settle();
+    std::vector<uint64_t> times = {0, 16};
+    uint64_t t = INPUT_REPEAT_DELAY_MS_DEFAULT;
+    uint32_t interval = INPUT_REPEAT_RATE_MS_DEFAULT;
+    while (t < 1500) {
+        times.push_back(t);
+        t += interval;
+        interval = interval - INPUT_REPEAT_ACCEL_MS_DEFAULT > INPUT_REPEAT_MIN_MS_DEFAULT
+                       ? interval - INPUT_REPEAT_ACCEL_MS_DEFAULT
+                       : INPUT_REPEAT_MIN_MS_DEFAULT;
+    }
+    check_times(hold(TOP_BTN_PIN, 1500), times, -5, __LINE__);
+}
+
+TEST(input_repeat_timing_configurable) {
+    // 300 ms delay, 50 ms first interval, 15 ms steps, 20 ms floor
+    sim_boot();
+    input_config(300, 50, 20, 15, 0);
+    check_times(hold(BOT_BTN_PIN, 450), {0, 16, 300, 350, 385, 405, 425, 445}, 5, __LINE__);
+
+    // Delay 0: no repeats however long the button is held
+    input_config(0, 50, 20, 15, 0);
+    check_times(hold(BOT_BTN_PIN, 1000), {0, 16}, 5, __LINE__);
+}
+
+TEST(input_repeat_restarts_per_press) {
+    // A second press starts over from the repeat delay and the first interval
+    sim_boot();
+    input_config(300, 50, 20, 15, 0);
+    hold(BOT_BTN_PIN, 450);
+    check_times(hold(BOT_BTN_PIN, 360), {0, 16, 300, 350}, 5, __LINE__);
+}
+
+TEST(input_long_press_adds_right_button) {
+    sim_boot();
+    input_config(INPUT_REPEAT_DELAY_MS_DEFAULT, INPUT_REPEAT_RATE_MS_DEFAULT, INPUT_REPEAT_MIN_MS_DEFAULT,
+                 INPUT_REPEAT_ACCEL_MS_DEFAULT, 800);
+
+    // Held past 800 ms: left on press, left + right at 800 ms, both released together
+    std::vector<sim_hid_report_t> reports = hold(ENTER_BTN_PIN, 1200);
+    CHECK_EQ(reports.size(), 3u);
+    CHECK_EQ(reports[0].buttons, MOUSE_BTN_LEFT);
+    CHECK(reports[0].time_us <= 1);
+    CHECK_EQ(reports[1].buttons, MOUSE_BTN_LEFT | MOUSE_BTN_RIGHT);
+    CHECK(reports[1].time_us >= 800 && reports[1].time_us <= 801);
+    CHECK_EQ(reports[2].buttons, 0);
+
+    // Released before: a plain click
+    reports = hold(ENTER_BTN_PIN, 700);
+    CHECK_EQ(reports.size(), 2u);
+    CHECK_EQ(reports[0].buttons, MOUSE_BTN_LEFT);
+    CHECK_EQ(reports[1].buttons, 0);
+}
+
+TEST(input_long_press_off_by_default) {
+    sim_boot();
+    sim_settle();
+    std::vector<sim_hid_report_t> reports = hold(ENTER_BTN_PIN, 3000);
+    CHECK_EQ(reports.size(), 2u);
+    CHECK_EQ(reports[0].buttons, MOUSE_BTN_LEFT);
+    CHECK_EQ(reports[1].buttons, 0);
+}
@@ -0,0 +1,191 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// Command macros over CDC: recording stores commands without running them,
+// playback draws what the commands would have drawn, text parameters are
+// substituted (and cut where the command buffer ends), a recording that does
+// not fit is dropped, and saved macros survive a reboot while unsaved ones
+// do not.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// config_store.cpp: blob writes wait this long after the last request
+#define COMMIT_DELAY_US 1000000
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static bytes_t text(uint8_t x, uint8_t y, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, x, y, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static bytes_t play(uint8_t id, const std::string& params) {
+    bytes_t cmd = {CMD_MACRO, MACRO_OP_PLAY, id, (uint8_t)params.size()};
+    cmd.insert(cmd.end(), params.begin(), params.end());
+    return cmd;
+}
+
+static bytes_t framebuffer() {
+    return bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE);
+}
+
+// Framebuffer the commands draw on a cleared screen
+static bytes_t drawn(const std::vector<bytes_t>& cmds) {
+    send({CMD_CLEAR});
+    for (const bytes_t& cmd : cmds) send(cmd);
+    bytes_t fb = framebuffer();
+    send({CMD_CLEAR});
+    return fb;
+}
+
+static void record(uint8_t id, const std::vector<bytes_t>& cmds) {
+    send({CMD_MACRO, MACRO_OP_BEGIN, id});
+    for (const bytes_t& cmd : cmds) send(cmd);
+    send({CMD_MACRO, MACRO_OP_END});
+}
+
+static void macro_boot() {
+    sim_boot();
+    send({CMD_CLEAR});
+}
+
+// Header line and a frame: what a recorded screen typically holds
+static const std::vector<bytes_t> SCREEN = {
+    text(0, 0, "Status"),
+    {CMD_GFX, GFX_OP_RECT, GFX_MODE_SET, 0, 10, 100, 20},
+    text(4, 16, "Ready"),
+};
+
+TEST(macro_record_and_play) {
+    macro_boot();
+    bytes_t expected = drawn(SCREEN);
+    bytes_t blank = framebuffer();
+
+    // Recording stores the commands without drawing anything
+    record(0, SCREEN);
+    CHECK_EQ(framebuffer(), blank);
+
+    send(play(0, ""));
+    CHECK_EQ(framebuffer(), expected);
+    CHECK_EQ(sim_panel_image(0), expected);
+
+    // Played again on top of other content, and after a delete nothing
+    send({CMD_CLEAR});
+    send(play(0, ""));
+    CHECK_EQ(framebuffer(), expected);
+    send({CMD_CLEAR, CMD_MACRO, MACRO_OP_DELETE, 0});
+    send(play(0, ""));
+    CHECK_EQ(framebuffer(), blank);
+}
+
+TEST(macro_queries_run_while_recording) {
+    // A query during a recording is answered at once and not recorded
+    macro_boot();
+    send({CMD_MACRO, MACRO_OP_BEGIN, 1});
+    send(text(0, 0, "A"));
+    bytes_t reply = sim_cdc_query({CMD_BOOT_TIME}, 13);
+    CHECK_EQ(reply.size(), 13u);
+    CHECK_EQ(reply[0], CMD_BOOT_TIME);
+    send({CMD_MACRO, MACRO_OP_END});
+    bytes_t expected = drawn({text(0, 0, "A")});
+    send(play(1, ""));
+    CHECK_EQ(framebuffer(), expected);
+    CHECK(sim_cdc_read().empty());
+}
+
+TEST(macro_text_parameters) {
+    macro_boot();
+    record(2, {text(0, 0, "CPU \x01%"), text(0, 8, "\x02/\x03 \x01")});
+
+    // Parameters by position; a missing one is left out
+    bytes_t expected = drawn({text(0, 0, "CPU 42%"), text(0, 8, "up/ 42")});
+    send(play(2, std::string("42\0up", 5)));
+    CHECK_EQ(framebuffer(), expected);
+
+    // Empty parameters are empty text
+    expected = drawn({text(0, 0, "CPU %"), text(0, 8, "/ ")});
+    send(play(2, ""));
+    CHECK_EQ(framebuffer(), expected);
+}
+
+TEST(macro_substitute_cuts_at_command_size) {
+    // Two copies of a 100-byte parameter: the text is cut at MAX_CMD_SIZE - 4
+    // and the length byte rewritten to match
+    uint8_t cmd[] = {CMD_DRAW_TEXT, 0, 0, 3, 'x', MACRO_PARAM_FIRST, MACRO_PARAM_FIRST};
+    std::string param(100, 'p');
+    uint8_t out[MAX_CMD_SIZE];
+    uint8_t len = macro_substitute(cmd, sizeof(cmd), (const uint8_t*)param.data(), param.size(), out);
+    CHECK_EQ(len, MAX_CMD_SIZE);
+    CHECK_EQ(out[3], MAX_CMD_SIZE - 4);
+    CHECK_EQ(out[4], 'x');
+    CHECK_EQ(std::string((const char*)&out[5], MAX_CMD_SIZE - 5), std::string(MAX_CMD_SIZE - 5, 'p'));
+
+    // Short enough: nothing cut
+    len = macro_substitute(cmd, sizeof(cmd), (const uint8_t*)"ab", 2, out);
+    CHECK_EQ(len, 9);
+    CHECK_EQ(out[3], 5);
+    CHECK_EQ(std::string((const char*)&out[4], 5), "xabab");
+
+    // Played: draws exactly the cut text
+    macro_boot();
+    record(3, {bytes_t(cmd, cmd + sizeof(cmd))});
+    bytes_t expected = drawn({text(0, 0, "x" + std::string(MAX_CMD_SIZE - 5, 'p'))});
+    send(play(3, param));
+    CHECK_EQ(framebuffer(), expected);
+}
+
+TEST(macro_size_limit) {
+    // 24-byte commands take 25 bytes each: ten fit in MACRO_MAX_LEN, eleven not
+    macro_boot();
+    std::vector<bytes_t> cmds;
+    for (int i = 0; i < 10; i++) cmds.push_back(text(0, (i % 8) * 8, std::string(20, 'a' + i)));
+    CHECK_EQ(cmds.size() * (1 + cmds[0].size()), 250u);
+    bytes_t expected = drawn(cmds);
+    record(4, cmds);
+    send(play(4, ""));
+    CHECK_EQ(framebuffer(), expected);
+
+    // One more: the whole recording is dropped, the old macro with it
+    cmds.push_back(text(0, 0, std::string(20, 'z')));
+    record(4, cmds);
+    send({CMD_CLEAR});
+    bytes_t blank = framebuffer();
+    send(play(4, ""));
+    CHECK_EQ(framebuffer(), blank);
+}
+
+TEST(macro_saved_across_reboot) {
+    if (test_boot() == 0) {
+        macro_boot();
+        record(0, SCREEN);
+        record(5, {text(0, 0, "Unsaved")});
+        send({CMD_MACRO, MACRO_OP_DELETE, 5});
+        send({CMD_MACRO, MACRO_OP_SAVE});
+
+        // Written once the commit delay has passed, not from the command
+        uint32_t erases = sim_flash_erases();
+        sim_run_us(COMMIT_DELAY_US / 2);
+        CHECK_EQ(sim_flash_erases(), erases);
+        sim_run_us(COMMIT_DELAY_US / 2 + 10000);
+        CHECK_EQ(sim_flash_erases(), erases + 1);
+
+        // Recorded after the save: lost with the reboot
+        record(6, {text(0, 0, "Later")});
+        test_reboot();
+    }
+
+    macro_boot();
+    bytes_t expected = drawn(SCREEN);
+    bytes_t blank = framebuffer();
+    send(play(0, ""));
+    CHECK_EQ(framebuffer(), expected);
+    send({CMD_CLEAR});
+    send(play(5, ""));
+    send(play(6, ""));
+    CHECK_EQ(framebuffer(), blank);
+}
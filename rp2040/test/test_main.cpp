@@ -0,0 +1,155 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef TEST_WITH_SIM
+#include "sim.h"
+#include "hardware/flash.h"
+#endif
+
+// Runner: `tests` runs every case, `tests name...` the cases whose name
+// contains one of the arguments, `tests --list` prints the names.
+// test_reboot() re-executes the binary as `tests --reboot boot flash name`
+// in the case's own process, so the parent still waits for it. It needs the
+// simulated board (TEST_WITH_SIM); the host library tests run without one.
+
+#define TEST_TIMEOUT_S 60
+
+typedef struct {
+    const char* name;
+    test_fn_t fn;
+} test_case_t;
+
+static std::vector<test_case_t>& test_cases() {
+    static std::vector<test_case_t> cases;
+    return cases;
+}
+
+static const char* current_name = NULL;
+static int current_boot = 0;
+
+int test_register(const char* name, test_fn_t fn) {
+    test_cases().push_back({name, fn});
+    return 0;
+}
+
+void test_fail(const char* file, int line, const std::string& message) {
+    fflush(stdout);
+    fprintf(stderr, "%s:%d: %s\n", file, line, message.c_str());
+    fflush(stderr);
+    _exit(1);
+}
+
+std::string test_str(const std::string& v) {
+    // Multi-line values (framebuffer art) start on a line of their own
+    return v.find('\n') != std::string::npos ? "\n" + v : "\"" + v + "\"";
+}
+
+std::string test_str(const char* v) {
+    return test_str(std::string(v));
+}
+
+std::string test_str(const std::vector<uint8_t>& v) {
+    std::string s = "[";
+    char hex[4];
+    for (size_t i = 0; i < v.size(); i++) {
+        snprintf(hex, sizeof(hex), i ? " %02X" : "%02X", v[i]);
+        s += hex;
+    }
+    return s + "] (" + std::to_string(v.size()) + " bytes)";
+}
+
+std::string test_str(bool v) {
+    return v ? "true" : "false";
+}
+
+int test_boot() {
+    return current_boot;
+}
+
+#ifdef TEST_WITH_SIM
+void test_reboot() {
+    char path[] = "/tmp/sim-flash-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, sim_flash_memory, PICO_FLASH_SIZE_BYTES) != (ssize_t)PICO_FLASH_SIZE_BYTES) {
+        test_fail(__FILE__, __LINE__, "reboot: cannot save the flash image");
+    }
+    close(fd);
+
+    std::string boot = std::to_string(current_boot + 1);
+    const char* args[] = {"tests", "--reboot", boot.c_str(), path, current_name, NULL};
+    fflush(stdout);
+    fflush(stderr);
+    execv("/proc/self/exe", (char* const*)args);
+    test_fail(__FILE__, __LINE__, "reboot: exec failed");
+}
+
+// The rest of a case after test_reboot(): flash image restored, then the case
+// from the top
+static int resume(const char* boot, const char* path, const char* name) {
+    FILE* f = fopen(path, "rb");
+    if (!f || fread(sim_flash_memory, 1, PICO_FLASH_SIZE_BYTES, f) != PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "%s: cannot read the flash image %s\n", name, path);
+        return 1;
+    }
+    fclose(f);
+    unlink(path);
+
+    current_boot = atoi(boot);
+    for (const test_case_t& t : test_cases()) {
+        if (strcmp(t.name, name) != 0) continue;
+        current_name = t.name;
+        t.fn();
+        return 0;
+    }
+    return 1;
+}
+#endif // TEST_WITH_SIM
+
+static bool selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strstr(name, argv[i])) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && strcmp(argv[1], "--list") == 0) {
+        for (const test_case_t& t : test_cases()) printf("%s\n", t.name);
+        return 0;
+    }
+#ifdef TEST_WITH_SIM
+    if (argc == 5 && strcmp(argv[1], "--reboot") == 0) {
+        _exit(resume(argv[2], argv[3], argv[4]));
+    }
+#endif
+
+    int passed = 0, failed = 0;
+    for (const test_case_t& t : test_cases()) {
+        if (!selected(t.name, argc, argv)) continue;
+        fflush(stdout);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            alarm(TEST_TIMEOUT_S);
+            current_name = t.name;
+            t.fn();
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            printf("ok   %s\n", t.name);
+            passed++;
+        } else {
+            if (WIFSIGNALED(status)) fprintf(stderr, "%s: killed by signal %d\n", t.name, WTERMSIG(status));
+            printf("FAIL %s\n", t.name);
+            failed++;
+        }
+    }
+    printf("%d passed, %d failed\n", passed, failed);
+    return failed ? 1 : 0;
+}
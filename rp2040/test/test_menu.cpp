@@ -0,0 +1,261 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// Retained-mode menu against golden framebuffers: the rows an opened menu
+// draws, moving the highlight redrawing only the two rows involved, a toggle
+// redrawing its own row, scrolling redrawing the screen, and going into a
+// submenu and back. Input is fed through menu_input(), as the encoder and
+// buttons do while the menu is open.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// Left end of rows 0..2: "Brightness" highlighted, "Invert", "About"
+static const std::string TOP_ART =
+    "......############..############...#####\n"
+    "#..##..##########################..#####\n"
+    "#..##..#..#...###...#####...#..##..#..##\n"
+    "#.....###...#..###..####..##..###...#..#\n"
+    "#..##..##..##..###..####..##..###..##..#\n"
+    "#..##..##..#######..#####.....###..##..#\n"
+    "......##....#####....#######..##...##..#\n"
+    "########################.....###########\n"
+    ".####...................................\n"
+    "..##....................................\n"
+    "..##....#####...##..##...####...##.###..\n"
+    "..##....##..##..##..##..##..##...###.##.\n"
+    "..##....##..##..##..##..######...##..##.\n"
+    "..##....##..##...####...##.......##.....\n"
+    ".####...##..##....##.....####...####....\n"
+    "........................................\n"
+    "..##....###........................#....\n"
+    ".####....##.......................##....\n"
+    "##..##...##......####...##..##...#####..\n"
+    "##..##...#####..##..##..##..##....##....\n"
+    "######...##..##.##..##..##..##....##....\n"
+    "##..##...##..##.##..##..##..##....##.#..\n"
+    "##..##..##.###...####....###.##....##...\n"
+    "........................................\n";
+
+// Right end of the same rows: '>' (submenu, highlighted), '*' (checked toggle)
+static const std::string MARKER_ART =
+    "#..#####\n"
+    "##..####\n"
+    "###..###\n"
+    "####..##\n"
+    "###..###\n"
+    "##..####\n"
+    "#..#####\n"
+    "########\n"
+    "........\n"
+    ".##..##.\n"
+    "..####..\n"
+    "########\n"
+    "..####..\n"
+    ".##..##.\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n"
+    "........\n";
+
+// Left end of rows 0..1 with the highlight moved to "Invert"
+static const std::string MOVED_ART =
+    "######............##............###.....\n"
+    ".##..##..........................##.....\n"
+    ".##..##.##.###...###.....###.##..##.##..\n"
+    ".#####...###.##...##....##..##...###.##.\n"
+    ".##..##..##..##...##....##..##...##..##.\n"
+    ".##..##..##.......##.....#####...##..##.\n"
+    "######..####.....####.......##..###..##.\n"
+    "........................#####...........\n"
+    "#....###################################\n"
+    "##..####################################\n"
+    "##..####.....###..##..###....###..#...##\n"
+    "##..####..##..##..##..##..##..###...#..#\n"
+    "##..####..##..##..##..##......###..##..#\n"
+    "##..####..##..###....###..#######..#####\n"
+    "#....###..##..####..#####....###....####\n"
+    "########################################\n";
+
+// Left end of row 0 scrolled down by one: "Invert"
+static const std::string SCROLLED_ART =
+    ".####...................................\n"
+    "..##....................................\n"
+    "..##....#####...##..##...####...##.###..\n"
+    "..##....##..##..##..##..##..##...###.##.\n"
+    "..##....##..##..##..##..######...##..##.\n"
+    "..##....##..##...####...##.......##.....\n"
+    ".####...##..##....##.....####...####....\n"
+    "........................................\n";
+
+// An empty highlighted cell
+static const std::string HIGHLIGHTED_BLANK_ART =
+    "########\n"
+    "########\n"
+    "########\n"
+    "########\n"
+    "########\n"
+    "########\n"
+    "########\n"
+    "########\n";
+
+enum { ITEM_BRIGHTNESS = 1, ITEM_INVERT, ITEM_ABOUT, ITEM_LOW, ITEM_HIGH, ITEM_BACK };
+
+static void add_item(uint8_t id, uint8_t parent, uint8_t type, uint8_t flags, const char* label) {
+    bytes_t cmd = {CMD_MENU, MENU_OP_ITEM, id, parent, type, flags, (uint8_t)strlen(label)};
+    cmd.insert(cmd.end(), label, label + strlen(label));
+    sim_cdc_write(cmd);
+}
+
+static void menu_boot() {
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    add_item(ITEM_BRIGHTNESS, 0, MENU_ITEM_SUBMENU, 0, "Brightness");
+    add_item(ITEM_INVERT, 0, MENU_ITEM_TOGGLE, MENU_FLAG_CHECKED, "Invert");
+    add_item(ITEM_ABOUT, 0, MENU_ITEM_ACTION, 0, "About");
+    add_item(ITEM_LOW, ITEM_BRIGHTNESS, MENU_ITEM_ACTION, 0, "Low");
+    add_item(ITEM_HIGH, ITEM_BRIGHTNESS, MENU_ITEM_ACTION, 0, "High");
+    add_item(ITEM_BACK, ITEM_BRIGHTNESS, MENU_ITEM_BACK, 0, "Back");
+    sim_cdc_write({CMD_MENU, MENU_OP_OPEN, 0});
+    sim_settle();
+}
+
+static void key(uint8_t k) {
+    menu_input(k);
+    sim_settle();
+}
+
+static std::string art(int x, int y, int w, int h) {
+    return sim_art(ssd1306_get_buffer(), x, y, w, h);
+}
+
+static uint16_t fb_crc() {
+    return crc16_update(0xFFFF, ssd1306_get_buffer(), SSD1306_BUFFER_SIZE);
+}
+
+static size_t log_size() {
+    return sim_panel(0)->log.size();
+}
+
+// The pages flushed since log entry `at`, each as a whole-width window
+static bool flushed_rows(size_t at, const std::vector<uint8_t>& rows) {
+    std::vector<sim_window_t> windows = sim_flush_windows(0, at);
+    if (windows.size() != rows.size()) return false;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const sim_window_t& w = windows[i];
+        if (w.page_start != rows[i] || w.page_end != rows[i] || w.col_start != 0 || w.col_end != SSD1306_WIDTH - 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(menu_open_golden) {
+    menu_boot();
+    CHECK(menu_active());
+    CHECK_EQ(art(0, 0, 40, 24), TOP_ART);
+    CHECK_EQ(art(SSD1306_WIDTH - 8, 0, 8, 24), MARKER_ART);
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0xFFA2 : 0x18C7);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(menu_move_redraws_two_rows) {
+    menu_boot();
+    size_t at = log_size();
+    key(MENU_KEY_NEXT);
+    CHECK(flushed_rows(at, {0, 1}));
+    CHECK_EQ(art(0, 0, 40, 16), MOVED_ART);
+
+    // Back up: the first screen again; past either end: nothing
+    key(MENU_KEY_PREV);
+    uint16_t opened = fb_crc();
+    at = log_size();
+    key(MENU_KEY_PREV);
+    CHECK_EQ(log_size(), at);
+    key(MENU_KEY_NEXT);
+    key(MENU_KEY_NEXT);
+    at = log_size();
+    key(MENU_KEY_NEXT);
+    CHECK_EQ(log_size(), at);
+    key(MENU_KEY_PREV);
+    key(MENU_KEY_PREV);
+    CHECK_EQ(fb_crc(), opened);
+}
+
+TEST(menu_toggle_redraws_its_row) {
+    menu_boot();
+    key(MENU_KEY_NEXT);
+    uint16_t checked = fb_crc();
+    sim_cdc_read();
+
+    // Unchecked: the marker goes, only row 1 is sent, and the host is told
+    size_t at = log_size();
+    key(MENU_KEY_SELECT);
+    CHECK(flushed_rows(at, {1}));
+    CHECK_EQ(art(SSD1306_WIDTH - 8, 8, 8, 8), HIGHLIGHTED_BLANK_ART);
+    CHECK_EQ(sim_cdc_read(), bytes_t({CMD_MENU, MENU_EVENT_SELECTED, ITEM_INVERT, 0}));
+
+    key(MENU_KEY_SELECT);
+    CHECK_EQ(fb_crc(), checked);
+    CHECK_EQ(sim_cdc_read(), bytes_t({CMD_MENU, MENU_EVENT_SELECTED, ITEM_INVERT, 1}));
+}
+
+TEST(menu_scroll_redraws_screen) {
+    // Two more items than rows: stepping past the last row scrolls by one
+    menu_boot();
+    int rows = SSD1306_HEIGHT / 8;
+    for (int i = 0; i < rows - 1; i++) {
+        std::string label = "Item " + std::to_string(i);
+        add_item(10 + i, 0, MENU_ITEM_ACTION, 0, label.c_str());
+    }
+    sim_cdc_write({CMD_MENU, MENU_OP_OPEN, 0});
+    sim_settle();
+    uint16_t first = fb_crc();
+    for (int i = 0; i < rows - 1; i++) key(MENU_KEY_NEXT);
+
+    size_t at = log_size();
+    key(MENU_KEY_NEXT);
+    std::vector<uint8_t> all;
+    for (int page = 0; page < rows; page++) all.push_back(page);
+    CHECK(flushed_rows(at, all));
+
+    // "Invert" now on the top row, the last item highlighted on the bottom one
+    CHECK_EQ(art(0, 0, 40, 8), SCROLLED_ART);
+    CHECK_EQ(art(SSD1306_WIDTH - 8, (rows - 1) * 8, 8, 8), HIGHLIGHTED_BLANK_ART);
+
+    // And back to the top: the first screen again
+    for (int i = 0; i < rows; i++) key(MENU_KEY_PREV);
+    CHECK_EQ(fb_crc(), first);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(menu_submenu_and_back) {
+    menu_boot();
+    uint16_t opened = fb_crc();
+
+    // Into "Brightness", to its "Back" item and out: the top level with
+    // "Brightness" highlighted, as it was
+    key(MENU_KEY_SELECT);
+    CHECK_EQ(fb_crc(), SSD1306_HEIGHT == 32 ? 0xE08D : 0xD3F0);
+    key(MENU_KEY_NEXT);
+    key(MENU_KEY_NEXT);
+    key(MENU_KEY_SELECT);
+    CHECK_EQ(fb_crc(), opened);
+
+    // The back key from the submenu does the same; from the top it closes
+    key(MENU_KEY_SELECT);
+    key(MENU_KEY_BACK);
+    CHECK_EQ(fb_crc(), opened);
+    sim_cdc_read();
+    size_t at = log_size();
+    key(MENU_KEY_BACK);
+    CHECK(!menu_active());
+    CHECK_EQ(log_size(), at);
+    CHECK_EQ(sim_cdc_read(), bytes_t({CMD_MENU, MENU_EVENT_CLOSED, 0, 0}));
+}
@@ -0,0 +1,323 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+#include "hardware/clocks.h"
+
+// Idle power saving on the simulated clock, configured as the host does with
+// CMD_CONFIG_SET: dimming and switching off after the configured idle times,
+// input waking the panels without being reported, host commands (but not
+// queries) counting as activity, and the pixel shift cycling through its
+// offsets, checked on what the panel shows (the top rows wrap to the bottom).
+// USB suspend: panels off and the slow clock until the host resumes, input
+// requesting a remote wakeup when the host allows it, and that input
+// reported once the bus is back.
+
+typedef std::vector<uint8_t> bytes_t;
+
+#define BOOT_CONTRAST 0xCF
+
+static bool fb_pixel(int x, int y) {
+    return (ssd1306_get_buffer()[(y / 8) * SSD1306_WIDTH + x] >> (y % 8)) & 1;
+}
+
+// Every screen pixel is the framebuffer's, `shift` rows further down, with
+// the top `shift` rows wrapped around to the bottom
+static void check_screen(int shift, int line) {
+    for (int y = 0; y < SSD1306_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_WIDTH; x++) {
+            if (sim_panel_pixel(0, x, y) != fb_pixel(x, (y + shift) % SSD1306_HEIGHT)) {
+                test_fail(__FILE__, line, "pixel (" + std::to_string(x) + ", " + std::to_string(y) + ") with shift " +
+                                              std::to_string(shift));
+                return;
+            }
+        }
+    }
+}
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static void draw_text(uint8_t y, const char* s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, 0, y, (uint8_t)strlen(s)};
+    cmd.insert(cmd.end(), s, s + strlen(s));
+    send(cmd);
+}
+
+static void power_config(uint16_t dim, uint16_t off, uint8_t dim_contrast, uint8_t shift_min) {
+    send({CMD_CONFIG_SET, CFG_KEY_POWER_SAVE, 6, (uint8_t)dim, (uint8_t)(dim >> 8), (uint8_t)off, (uint8_t)(off >> 8),
+          dim_contrast, shift_min});
+}
+
+static void power_boot() {
+    sim_boot();
+    send({CMD_CLEAR});
+    draw_text(0, "Power");
+}
+
+// Press and release a button; returns the reports it produced
+static std::vector<sim_hid_report_t> press(uint pin) {
+    sim_hid_reports().clear();
+    sim_gpio_drive(pin, false);
+    sim_run_ms(100);
+    sim_gpio_release(pin);
+    sim_run_ms(100);
+    return sim_hid_reports();
+}
+
+TEST(power_dim_off_wake_timing) {
+    // Dim after 2 s, off after 5 s, counted from the config command
+    power_boot();
+    power_config(2, 5, 0x10, 0);
+    sim_run_ms(1995);
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+    sim_run_ms(10);
+    CHECK_EQ(sim_panel(0)->contrast, 0x10);
+    CHECK(sim_panel(0)->on);
+
+    sim_run_ms(2990);
+    CHECK(sim_panel(0)->on);
+    sim_run_ms(10);
+    CHECK(!sim_panel(0)->on);
+    CHECK(!sim_panel_pixel(0, 1, 1));
+
+    // A press wakes the panel at its previous contrast and is swallowed
+    CHECK(press(BOT_BTN_PIN).empty());
+    CHECK(sim_panel(0)->on);
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+    check_screen(0, __LINE__);
+
+    // The next one is reported, and the idle time starts over from the wake
+    CHECK_EQ(press(BOT_BTN_PIN).size(), 2u);
+    sim_run_ms(1700);
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+    sim_run_ms(200);
+    CHECK_EQ(sim_panel(0)->contrast, 0x10);
+}
+
+TEST(power_dim_press_swallowed) {
+    // A press on a dimmed (not yet off) panel only wakes it too
+    power_boot();
+    power_config(1, 0, 0x10, 0);
+    sim_run_ms(1100);
+    CHECK_EQ(sim_panel(0)->contrast, 0x10);
+    CHECK(press(ENTER_BTN_PIN).empty());
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+    std::vector<sim_hid_report_t> reports = press(ENTER_BTN_PIN);
+    CHECK_EQ(reports.size(), 2u);
+    CHECK_EQ(reports[0].buttons, MOUSE_BTN_LEFT);
+}
+
+TEST(power_commands_wake_queries_do_not) {
+    power_boot();
+    power_config(1, 0, 0x10, 0);
+
+    // Polling the counters lets the panel dim
+    for (int i = 0; i < 6; i++) {
+        sim_cdc_query({CMD_STATUS, 0}, 3 + sizeof(device_stats_t));
+        sim_run_ms(200);
+    }
+    CHECK_EQ(sim_panel(0)->contrast, 0x10);
+
+    // Drawing wakes it
+    draw_text(8, "Awake");
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+}
+
+TEST(power_dim_never_brightens) {
+    // The host set the panel darker than the dim level: left alone
+    power_boot();
+    send({CMD_BRIGHTNESS, 0x08});
+    power_config(1, 0, 0x10, 0);
+    sim_run_ms(1500);
+    CHECK_EQ(sim_panel(0)->contrast, 0x08);
+}
+
+TEST(power_shift_cycles) {
+    // One row per minute through 0, 1, 2, 1 and around again
+    power_boot();
+    draw_text(24, "Shift");
+    power_config(0, 0, 0x10, 1);
+    uint64_t start = sim_now_us();
+    const uint8_t cycle[] = {1, 2, 1, 0, 1};
+    uint8_t previous = 0;
+    for (int i = 0; i < 5; i++) {
+        uint8_t offset = cycle[i];
+        sim_run_us(start + (i + 1) * 60000000ull - 10000 - sim_now_us());
+        CHECK_EQ(sim_panel(0)->offset, previous);
+        sim_run_ms(20);
+        CHECK_EQ(sim_panel(0)->offset, offset);
+        check_screen(offset, __LINE__);
+        previous = offset;
+    }
+
+    // Turned off: back to the unshifted picture at once
+    power_config(0, 0, 0x10, 0);
+    CHECK_EQ(sim_panel(0)->offset, 0);
+    check_screen(0, __LINE__);
+}
+
+TEST(power_shift_wraps_top_rows) {
+    // Text on the top row and a line on the bottom one: shifted by 2, the
+    // line moves up and the top two rows show under it
+    power_boot();
+    send({CMD_GFX, GFX_OP_LINE, GFX_MODE_SET, 0, SSD1306_HEIGHT - 1, 127, SSD1306_HEIGHT - 1});
+    ssd1306_set_offset(2);
+    sim_settle();
+    CHECK_EQ(sim_panel(0)->offset, 2);
+    check_screen(2, __LINE__);
+    CHECK(sim_panel_pixel(0, 0, SSD1306_HEIGHT - 3));
+
+    // Drawing keeps the shift
+    draw_text(16, "Middle");
+    CHECK_EQ(sim_panel(0)->offset, 2);
+    check_screen(2, __LINE__);
+}
+
+#ifndef SIM_TRANSPORT_SPI
+TEST(power_shift_restored_after_recovery) {
+    // The panel re-initialized after a fault gets the current shift back
+    power_boot();
+    ssd1306_set_offset(1);
+    sim_settle();
+    sim_panel(0)->present = false;
+    send({CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, 3, 5});
+    sim_panel(0)->present = true;
+    sim_run_ms(300);
+    sim_settle();
+    CHECK(ssd1306_is_ok());
+    CHECK_EQ(sim_panel(0)->offset, 1);
+    check_screen(1, __LINE__);
+}
+#endif // !SIM_TRANSPORT_SPI
+
+static uint32_t sys_mhz() {
+    return clock_get_hz(clk_sys) / 1000000;
+}
+
+TEST(suspend_and_resume) {
+    power_boot();
+    uint32_t mhz = sys_mhz();
+    bytes_t image = sim_panel_image(0);
+    sim_usb_suspend(true);
+    sim_run_ms(20);
+    CHECK(power_suspended());
+    CHECK(!sim_panel(0)->on);
+    CHECK_EQ(sys_mhz(), 48u);
+
+    // Asleep: no panel traffic beyond the input polls
+    size_t at = sim_panel(0)->log.size();
+    sim_run_ms(500);
+    CHECK_EQ(sim_panel(0)->log.size(), at);
+    CHECK_EQ(sim_remote_wakeups(), 0u);
+
+    // Resumed: clock, panel and picture as before
+    sim_usb_suspend(false);
+    sim_run_ms(20);
+    CHECK(!power_suspended());
+    CHECK_EQ(sys_mhz(), mhz);
+    CHECK(sim_panel(0)->on);
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+    CHECK_EQ(sim_panel_image(0), image);
+    check_screen(0, __LINE__);
+}
+
+TEST(suspend_remote_wakeup_reports_input) {
+    // A press while suspended: a wakeup request within one input poll, the
+    // host resumes, and the press is reported as usual
+    power_boot();
+    sim_usb_suspend(true);
+    sim_run_ms(50);
+    sim_hid_reports().clear();
+    uint64_t pressed = sim_now_us();
+    sim_gpio_drive(BOT_BTN_PIN, false);
+    while (sim_remote_wakeups() == 0 && sim_now_us() - pressed < 100000) sim_run_us(100);
+    CHECK_EQ(sim_remote_wakeups(), 1u);
+    CHECK(sim_now_us() - pressed <= POWER_SUSPEND_POLL_US + 200);
+
+    sim_run_ms(50);
+    sim_gpio_release(BOT_BTN_PIN);
+    sim_run_ms(50);
+    CHECK(!power_suspended());
+    CHECK(sim_panel(0)->on);
+    CHECK(!sim_hid_reports().empty());
+    CHECK_EQ(sim_hid_reports()[0].y, 5);
+    CHECK_EQ(sim_remote_wakeups(), 1u);
+}
+
+TEST(suspend_wakeup_holdoff) {
+    // Input right after the suspend waits for the bus to be idle for
+    // POWER_WAKEUP_HOLDOFF_US before the wakeup is requested
+    power_boot();
+    sim_usb_suspend(true);
+    sim_run_ms(1);
+    uint64_t suspended = sim_now_us();
+    sim_gpio_drive(ENTER_BTN_PIN, false);
+    sim_run_us(POWER_WAKEUP_HOLDOFF_US - 2000);
+    CHECK_EQ(sim_remote_wakeups(), 0u);
+    sim_run_us(POWER_SUSPEND_POLL_US + 2000);
+    CHECK_EQ(sim_remote_wakeups(), 1u);
+    CHECK(sim_now_us() - suspended >= POWER_WAKEUP_HOLDOFF_US);
+    sim_gpio_release(ENTER_BTN_PIN);
+}
+
+TEST(suspend_input_held_from_before) {
+    // A button already held when the host suspends does not wake it; only a
+    // new press after its release does
+    power_boot();
+    sim_gpio_drive(TOP_BTN_PIN, false);
+    sim_run_ms(20);
+    sim_usb_suspend(true);
+    sim_run_ms(200);
+    CHECK(power_suspended());
+    CHECK_EQ(sim_remote_wakeups(), 0u);
+
+    sim_gpio_release(TOP_BTN_PIN);
+    sim_run_ms(50);
+    CHECK_EQ(sim_remote_wakeups(), 0u);
+    sim_gpio_drive(TOP_BTN_PIN, false);
+    sim_run_ms(20);
+    CHECK_EQ(sim_remote_wakeups(), 1u);
+    sim_gpio_release(TOP_BTN_PIN);
+}
+
+TEST(suspend_without_remote_wakeup) {
+    // The host did not enable remote wakeup: input leaves it asleep
+    power_boot();
+    sim_usb_suspend(true, false);
+    sim_run_ms(20);
+    sim_hid_reports().clear();
+    sim_gpio_drive(BOT_BTN_PIN, false);
+    sim_run_ms(100);
+    sim_gpio_release(BOT_BTN_PIN);
+    sim_run_ms(100);
+    CHECK(power_suspended());
+    CHECK_EQ(sim_remote_wakeups(), 0u);
+    CHECK(sim_hid_reports().empty());
+    CHECK(!sim_panel(0)->on);
+
+    sim_usb_suspend(false);
+    sim_run_ms(20);
+    CHECK(sim_panel(0)->on);
+}
+
+TEST(suspend_keeps_idle_state_and_commits_settings) {
+    // Panels switched off for idleness come back on with the resume, and a
+    // setting changed just before the suspend still reaches flash
+    power_boot();
+    power_config(0, 1, 0x10, 0);
+    sim_run_ms(1100);
+    CHECK(!sim_panel(0)->on);
+    uint32_t programs = sim_flash_programs();
+    send({CMD_CONFIG_SET, CFG_KEY_INVERT, 1, 0});
+    sim_usb_suspend(true);
+    sim_run_ms(1500);
+    CHECK(power_suspended());
+    CHECK(sim_flash_programs() > programs);
+
+    sim_usb_suspend(false);
+    sim_run_ms(20);
+    CHECK(sim_panel(0)->on);
+    CHECK_EQ(sim_panel(0)->contrast, BOOT_CONTRAST);
+}
@@ -0,0 +1,137 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// I2C fault handling with the fake bus NACKing, timing out or holding SDA
+// low: a failed write is retried once at the safe speed, a display that still
+// fails is marked down, and recovery (bus clear, init, framebuffer re-upload)
+// is retried with a backoff doubling from 100 ms to 2 s.
+
+#ifndef SIM_TRANSPORT_SPI
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t framebuffer() {
+    return bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE);
+}
+
+static void draw_text(uint8_t y, const char* s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, 0, y, (uint8_t)strlen(s)};
+    cmd.insert(cmd.end(), s, s + strlen(s));
+    sim_cdc_write(cmd);
+}
+
+// Run for ms milliseconds in 1 ms steps; the start of every burst of
+// attempts to reach the panel (times in ms since the call)
+static std::vector<uint64_t> attempt_bursts(sim_panel_t* p, uint32_t ms) {
+    std::vector<uint64_t> bursts;
+    uint64_t start = sim_now_us();
+    uint32_t attempts = p->attempts;
+    bool quiet = true;
+    for (uint32_t i = 0; i < ms; i++) {
+        sim_run_us(1000);
+        if (p->attempts != attempts && quiet) bursts.push_back((sim_now_us() - start) / 1000);
+        quiet = p->attempts == attempts;
+        attempts = p->attempts;
+    }
+    return bursts;
+}
+
+TEST(recovery_nack_retried_at_safe_speed) {
+    sim_boot();
+    sim_settle();
+    sim_panel_t* p = sim_panel(0);
+    CHECK_EQ(p->log.back().baud, (uint32_t)I2C_BAUD_MAX);
+
+    // One NACK: the retry goes through at the safe speed and the display stays up
+    uint32_t retries = g_stats.i2c_retries;
+    uint32_t failures = g_stats.i2c_failures;
+    p->nacks = 1;
+    draw_text(0, "Retry");
+    sim_settle();
+    CHECK_EQ(g_stats.i2c_retries, retries + 1);
+    CHECK_EQ(g_stats.i2c_failures, failures + 1);
+    CHECK(ssd1306_is_ok());
+    CHECK_EQ(p->log.back().baud, (uint32_t)I2C_BAUD_SAFE);
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+}
+
+TEST(recovery_timeouts_mark_display_down_then_reupload) {
+    sim_boot();
+    sim_settle();
+    sim_panel_t* p = sim_panel(0);
+
+    // Write and retry both time out, so the display is marked down; the
+    // first recovery runs right away: init, state and the whole framebuffer
+    // instead of the page that failed
+    p->timeouts = 2;
+    uint32_t recoveries = g_stats.display_recoveries;
+    uint32_t attempts = p->attempts;
+    size_t at = p->log.size();
+    draw_text(0, "Lost");
+    sim_run_ms(20);
+    sim_settle();
+    CHECK(ssd1306_is_ok());
+    CHECK_EQ(p->timeouts, 0);
+    CHECK_EQ(g_stats.display_recoveries, recoveries + 1);
+    CHECK_EQ(p->attempts - attempts, 2 + (uint32_t)(p->log.size() - at));
+    CHECK(p->log.size() > at + 2);
+    CHECK_EQ(p->log[at].bytes[0], 0xAE);
+    CHECK_EQ(p->log[at + 1].bytes[0], 0x81);
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+    CHECK_EQ(p->bad_commands, 0u);
+}
+
+TEST(recovery_backoff_doubles_to_max) {
+    sim_boot();
+    sim_settle();
+    sim_panel_t* p = sim_panel(0);
+
+    // Panel gone: the failing flush (write + retry), the immediate recovery,
+    // then recoveries 100, 200, ... 1600 ms apart, capped at 2 s
+    p->present = false;
+    draw_text(0, "Gone");
+    std::vector<uint64_t> bursts = attempt_bursts(p, 9000);
+    CHECK(!ssd1306_is_ok());
+    CHECK(bursts.size() >= 8);
+    const uint64_t gaps[] = {100, 200, 400, 800, 1600, 2000, 2000};
+    for (size_t i = 0; i < sizeof(gaps) / sizeof(gaps[0]) && i + 1 < bursts.size(); i++) {
+        uint64_t gap = bursts[i + 1] - bursts[i];
+        if (gap + 1 < gaps[i] || gap > gaps[i] + 1) {
+            test_fail(__FILE__, __LINE__, "recovery " + std::to_string(i + 1) + " after " + std::to_string(gap) +
+                                              " ms, expected " + std::to_string(gaps[i]));
+        }
+    }
+
+    // Back: the next attempt restores the display and the backoff restarts
+    p->present = true;
+    draw_text(8, "Back");
+    attempt_bursts(p, 2100);
+    CHECK(ssd1306_is_ok());
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+
+    p->present = false;
+    draw_text(16, "Again");
+    bursts = attempt_bursts(p, 500);
+    CHECK(bursts.size() >= 2);
+    CHECK(bursts[1] - bursts[0] <= 101);
+}
+
+TEST(recovery_clears_stuck_sda) {
+    sim_boot();
+    sim_settle();
+    sim_panel_t* p = sim_panel(0);
+
+    // SDA held low until SCL is clocked 5 times: every write times out until
+    // the recovery's bus clear frees it
+    p->stuck_clocks = 5;
+    draw_text(0, "Stuck");
+    sim_run_ms(50);
+    sim_settle();
+    CHECK_EQ(p->stuck_clocks, 0);
+    CHECK(ssd1306_is_ok());
+    CHECK_EQ(sim_panel_image(0), framebuffer());
+    CHECK(g_stats.display_recoveries >= 1);
+}
+
+#endif // !SIM_TRANSPORT_SPI
@@ -0,0 +1,320 @@
+#include "sim.h"
+#include "test.h"
+#include <stddef.h>
+#include <string.h>
+
+// CMD_STATUS: the whole reply decoded the way tools/status.py does it (a
+// header, then device_stats_t as little-endian words in declaration order),
+// and every counter in it moved by the traffic or fault that should move it:
+// bus transfers and bytes against the simulated panels, NACK retries and
+// failures, panel recovery, parser resyncs/overflows/timeouts, HID reports
+// sent and dropped, the packet layer, per-opcode counts and the reset flag.
+
+typedef std::vector<uint8_t> bytes_t;
+
+// The word order tools/status.py decodes (SCALAR_FIELDS, then the histogram
+// and the per-opcode counts); a field added anywhere but the end breaks it
+static_assert(offsetof(device_stats_t, version) == 0 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, uptime_ms) == 1 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, flags) == 2 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, i2c_transactions) == 3 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, i2c_bytes) == 4 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, i2c_failures) == 5 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, i2c_retries) == 6 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, parser_resyncs) == 7 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, parser_overflows) == 8 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, parser_timeouts) == 9 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, hid_sent) == 10 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, hid_dropped) == 11 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, loop_max_us) == 12 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, display_recoveries) == 13 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, i2c_baud) == 14 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, packets_ok) == 15 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, packet_header_errors) == 16 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, packet_crc_errors) == 17 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, packet_dropped_bytes) == 18 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, flush_latency) == 19 * 4, "status.py layout");
+static_assert(offsetof(device_stats_t, cmd_count) == (19 + STATS_LATENCY_BUCKETS) * 4, "status.py layout");
+static_assert(sizeof(device_stats_t) == (19 + STATS_LATENCY_BUCKETS + STATS_CMD_SLOTS) * 4, "status.py layout");
+
+// main.cpp: a stalled CMD_DRAW_TEXT is run after this long
+#define TEXT_CMD_TIMEOUT_US 5000
+
+// ssd1306.cpp: first recovery attempt this long after a panel failed
+#define RECOVERY_BACKOFF_MIN_US 100000
+
+static void send(const bytes_t& cmd) {
+    sim_cdc_write(cmd);
+    sim_settle();
+}
+
+static uint32_t get_u32(const bytes_t& b, size_t offset) {
+    return b[offset] | (b[offset + 1] << 8) | (b[offset + 2] << 16) | ((uint32_t)b[offset + 3] << 24);
+}
+
+// Query CMD_STATUS and decode every word of the reply
+static device_stats_t status(uint8_t flags = 0) {
+    const size_t len = sizeof(device_stats_t);
+    bytes_t reply = sim_cdc_query({CMD_STATUS, flags}, 3 + len);
+    if (reply.size() != 3 + len || reply[0] != CMD_STATUS || (size_t)(reply[1] | (reply[2] << 8)) != len) {
+        test_fail(__FILE__, __LINE__, "bad STATUS reply " + test_str(bytes_t(reply.begin(), reply.begin() + (reply.size() < 3 ? reply.size() : 3))));
+    }
+    uint32_t words[sizeof(device_stats_t) / 4];
+    for (size_t i = 0; i < len / 4; i++) words[i] = get_u32(reply, 3 + 4 * i);
+    device_stats_t st;
+    memcpy(&st, words, sizeof(st));
+    return st;
+}
+
+static uint32_t flushes(const device_stats_t& st) {
+    uint32_t n = 0;
+    for (int i = 0; i < STATS_LATENCY_BUCKETS; i++) n += st.flush_latency[i];
+    return n;
+}
+
+// Log length of each panel
+static std::vector<size_t> logged() {
+    std::vector<size_t> n;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) n.push_back(sim_panel(id)->log.size());
+    return n;
+}
+
+// Transfers the panels received since logged() returned from, and the bytes
+// the transport counts for them (I2C adds the control byte to each)
+static uint32_t transfers_since(const std::vector<size_t>& from) {
+    uint32_t n = 0;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) n += sim_panel(id)->log.size() - from[id];
+    return n;
+}
+
+static uint32_t bytes_since(const std::vector<size_t>& from) {
+    uint32_t n = 0;
+    for (uint8_t id = 0; id < DISPLAY_COUNT; id++) {
+        const std::vector<sim_transfer_t>& log = sim_panel(id)->log;
+        for (size_t i = from[id]; i < log.size(); i++) {
+#ifdef SIM_TRANSPORT_SPI
+            n += log[i].bytes.size();
+#else
+            n += log[i].bytes.size() + 1;
+#endif
+        }
+    }
+    return n;
+}
+
+static bytes_t text(uint8_t x, uint8_t y, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, x, y, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+static bytes_t packet(const bytes_t& payload) {
+    uint16_t len = payload.size();
+    bytes_t p = {PACKET_SYNC, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8), (uint8_t)((len & 0xFF) ^ (len >> 8) ^ 0xFF)};
+    p.insert(p.end(), payload.begin(), payload.end());
+    uint16_t crc = crc16_update(0xFFFF, &p[1], p.size() - 1);
+    p.push_back(crc & 0xFF);
+    p.push_back(crc >> 8);
+    return p;
+}
+
+TEST(status_reply_header_fields) {
+    sim_boot();
+    sim_run_ms(100);
+    device_stats_t st = status();
+    CHECK_EQ(st.version, (uint32_t)STATS_VERSION);
+    CHECK(st.uptime_ms >= sim_now_us() / 1000 - 5);
+    CHECK(st.uptime_ms <= sim_now_us() / 1000);
+    CHECK_EQ(st.flags, (uint32_t)STATS_FLAG_DISPLAY_OK);
+    CHECK_EQ(st.i2c_baud, sim_panel(0)->log.back().baud);
+    CHECK(st.loop_max_us > 0);
+
+    // Nothing went wrong during boot
+    CHECK_EQ(st.i2c_failures, 0u);
+    CHECK_EQ(st.i2c_retries, 0u);
+    CHECK_EQ(st.display_recoveries, 0u);
+    CHECK_EQ(st.parser_resyncs + st.parser_overflows + st.parser_timeouts, 0u);
+    CHECK_EQ(st.hid_sent + st.hid_dropped, 0u);
+    CHECK_EQ(st.packets_ok + st.packet_header_errors + st.packet_crc_errors + st.packet_dropped_bytes, 0u);
+}
+
+TEST(status_portrait_flag) {
+    // Orientation jumper fitted at power-up
+    sim_gpio_drive(ORIENTATION_PIN, false);
+    sim_boot();
+    CHECK_EQ(status().flags, (uint32_t)(STATS_FLAG_DISPLAY_OK | STATS_FLAG_PORTRAIT));
+}
+
+TEST(status_bus_counters_match_panels) {
+    // Transfers and bytes are those the panels received; every data write
+    // lands in one histogram bucket
+    sim_boot();
+    device_stats_t before = status();
+    std::vector<size_t> from = logged();
+    send({CMD_CLEAR});
+    send(text(0, 0, "Counters"));
+    send({CMD_PROGRESS_BAR, 0, 40, SSD1306_WIDTH, 8, 70});
+    device_stats_t after = status();
+
+    CHECK(transfers_since(from) > 0);
+    CHECK_EQ(after.i2c_transactions - before.i2c_transactions, transfers_since(from));
+    CHECK_EQ(after.i2c_bytes - before.i2c_bytes, bytes_since(from));
+    CHECK(flushes(after) > flushes(before));
+    CHECK(flushes(after) - flushes(before) <= after.i2c_transactions - before.i2c_transactions);
+    CHECK_EQ(after.i2c_failures, 0u);
+}
+
+#ifndef SIM_TRANSPORT_SPI
+TEST(status_nack_retry_and_failure) {
+    // One NACK: a failed transaction and its retry, the draw still lands
+    sim_boot();
+    device_stats_t before = status();
+    sim_panel(0)->nacks = 1;
+    send(text(0, 0, "Retry"));
+    device_stats_t after = status();
+    CHECK_EQ(after.i2c_failures - before.i2c_failures, 1u);
+    CHECK_EQ(after.i2c_retries - before.i2c_retries, 1u);
+    CHECK_EQ(after.flags & STATS_FLAG_DISPLAY_OK, (uint32_t)STATS_FLAG_DISPLAY_OK);
+    CHECK_EQ(sim_panel_image(0), bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE));
+}
+
+TEST(status_panel_lost_and_recovered) {
+    // The panel stops answering: the write and its retry fail, display_ok
+    // drops; the recovery task counts its attempts (failing while the panel
+    // is away) and restores the flag once it is back
+    sim_boot();
+    device_stats_t before = status();
+    sim_panel(0)->present = false;
+    send(text(0, 0, "Lost"));
+    device_stats_t lost = status();
+    CHECK(lost.i2c_failures - before.i2c_failures >= 2u);
+    CHECK(lost.i2c_retries > before.i2c_retries);
+    CHECK_EQ(lost.flags & STATS_FLAG_DISPLAY_OK, 0u);
+
+    sim_run_us(RECOVERY_BACKOFF_MIN_US + 10000);
+    device_stats_t failed = status();
+    CHECK(failed.display_recoveries > lost.display_recoveries);
+    CHECK(failed.i2c_failures > lost.i2c_failures);
+
+    sim_panel(0)->present = true;
+    sim_run_ms(2000);
+    device_stats_t back = status();
+    CHECK(back.display_recoveries > failed.display_recoveries);
+    CHECK_EQ(back.flags & STATS_FLAG_DISPLAY_OK, (uint32_t)STATS_FLAG_DISPLAY_OK);
+}
+#endif
+
+TEST(status_parser_counters) {
+    sim_boot();
+    device_stats_t st = status();
+
+    // Unknown opcode: one resync per byte thrown away
+    send({0x7E, 0x7F});
+    device_stats_t resynced = status();
+    CHECK_EQ(resynced.parser_resyncs - st.parser_resyncs, 2u);
+
+    // Text past MAX_CMD_SIZE: the command is cut and the rest drained
+    send(text(0, 0, std::string(200, 'x')));
+    device_stats_t overflowed = status();
+    CHECK_EQ(overflowed.parser_overflows - resynced.parser_overflows, (uint32_t)(4 + 200 - MAX_CMD_SIZE));
+    CHECK_EQ(overflowed.parser_resyncs, resynced.parser_resyncs);
+
+    // Text that stops short: run by the timeout
+    bytes_t stalled = text(0, 0, "Stall");
+    stalled.resize(stalled.size() - 2);
+    sim_cdc_write(stalled);
+    sim_run_us(TEXT_CMD_TIMEOUT_US + 2000);
+    device_stats_t timed_out = status();
+    CHECK_EQ(timed_out.parser_timeouts - overflowed.parser_timeouts, 1u);
+    CHECK_EQ(timed_out.cmd_count[CMD_DRAW_TEXT] - overflowed.cmd_count[CMD_DRAW_TEXT], 1u);
+}
+
+TEST(status_hid_sent_and_dropped) {
+    sim_boot();
+    device_stats_t before = status();
+    send({CMD_TEST, TEST_SUBCMD_ROTATE_CW});
+    device_stats_t one = status();
+    CHECK_EQ(one.hid_sent - before.hid_sent, 1u);
+    CHECK_EQ(one.hid_dropped, before.hid_dropped);
+
+    // The host suspends the bus as the button goes down and the encoder
+    // turns: the press report goes out, the USB poll after it suspends, and
+    // the rotation report of the same scan finds HID not ready
+    sim_usb_suspend(true, false);
+    sim_gpio_drive(ROTARY_SW_PIN, false);
+    sim_gpio_drive(ROTARY_CLK_PIN, false);
+    sim_run_ms(5);
+    sim_usb_suspend(false);
+    sim_gpio_release(ROTARY_SW_PIN);
+    sim_gpio_release(ROTARY_CLK_PIN);
+    sim_run_ms(100);
+    device_stats_t after = status();
+    CHECK(after.hid_dropped > one.hid_dropped);
+    CHECK(after.hid_sent > one.hid_sent);
+    CHECK_EQ(sim_hid_reports().size(), (size_t)after.hid_sent);
+}
+
+TEST(status_packet_counters) {
+    sim_boot();
+    device_stats_t before = status();
+    send({CMD_PACKET, 1});
+
+    // Status queries go in packets from here on
+    auto query = [](uint8_t flags) {
+        const size_t len = sizeof(device_stats_t);
+        bytes_t reply = sim_cdc_query(packet({CMD_STATUS, flags}), 3 + len);
+        device_stats_t st;
+        memset(&st, 0, sizeof(st));
+        if (reply.size() == 3 + len) memcpy(&st, &reply[3], len);
+        return st;
+    };
+
+    send(packet(text(0, 0, "Ok")));
+    bytes_t bad_crc = packet(text(0, 0, "Crc"));
+    bad_crc[5] ^= 0x01;
+    send(bad_crc);
+    bytes_t bad_header = packet(text(0, 0, "Hdr"));
+    bad_header[3] ^= 0xFF;
+    send(bad_header);
+    send({0x00, 0x11, 0x22});
+    device_stats_t after = query(0);
+
+    CHECK_EQ(after.version, (uint32_t)STATS_VERSION);
+    CHECK_EQ(after.packets_ok - before.packets_ok, 2u); // Including the query's own packet
+    CHECK_EQ(after.packet_crc_errors - before.packet_crc_errors, 1u);
+    CHECK_EQ(after.packet_header_errors - before.packet_header_errors, 1u);
+    CHECK_EQ(after.packet_dropped_bytes - before.packet_dropped_bytes, (uint32_t)(bad_crc.size() + bad_header.size() + 3));
+}
+
+TEST(status_command_counts_and_reset) {
+    sim_boot();
+    status(STATUS_FLAG_RESET);
+    send({CMD_CLEAR, CMD_CLEAR, CMD_CLEAR, CMD_INVERT, 1, CMD_TEST, TEST_SUBCMD_PING});
+    sim_cdc_read();
+    send(text(0, 0, "A"));
+    device_stats_t st = status();
+
+    CHECK_EQ(st.cmd_count[CMD_CLEAR], 3u);
+    CHECK_EQ(st.cmd_count[CMD_INVERT], 1u);
+    CHECK_EQ(st.cmd_count[CMD_DRAW_TEXT], 1u);
+    CHECK_EQ(st.cmd_count[CMD_STATUS], 1u);
+    CHECK_EQ(st.cmd_count[STATS_CMD_SLOTS - 1], 1u); // CMD_TEST and any opcode past the table
+    uint32_t counted = 0;
+    for (int i = 0; i < STATS_CMD_SLOTS; i++) counted += st.cmd_count[i];
+    CHECK_EQ(counted, 7u);
+    CHECK(st.i2c_transactions > 0);
+
+    // The reset reply still carries the counts; the next one starts over
+    device_stats_t last = status(STATUS_FLAG_RESET);
+    CHECK_EQ(last.cmd_count[CMD_CLEAR], 3u);
+    CHECK_EQ(last.cmd_count[CMD_STATUS], 2u);
+    device_stats_t fresh = status();
+    CHECK_EQ(fresh.version, (uint32_t)STATS_VERSION);
+    CHECK_EQ(fresh.cmd_count[CMD_CLEAR], 0u);
+    CHECK_EQ(fresh.cmd_count[CMD_STATUS], 1u);
+    CHECK_EQ(fresh.i2c_transactions, 0u);
+    CHECK_EQ(fresh.i2c_bytes, 0u);
+    CHECK_EQ(flushes(fresh), 0u);
+    CHECK_EQ(fresh.flags, (uint32_t)STATS_FLAG_DISPLAY_OK);
+    CHECK(fresh.uptime_ms >= last.uptime_ms);
+}
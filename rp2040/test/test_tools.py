@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""tools/*.py against the emulated device (sim_device, see CMakeLists.txt).
+
+Usage: test_tools.py <path to sim_device> [<path to hid_display_bench>]
+       (ctest passes both; without the bench its test is skipped)
+"""
+
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+
+TOOLS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "tools")
+sys.path.insert(0, TOOLS_DIR)
+import replay  # noqa: E402
+import status  # noqa: E402
+import trace_dump  # noqa: E402
+from devport import open_port  # noqa: E402
+from record import read_session  # noqa: E402
+
+sys.path.insert(0, os.path.join(TOOLS_DIR, "corpus"))
+import make_corpus  # noqa: E402
+
+CORPUS = sorted(glob.glob(os.path.join(TOOLS_DIR, "corpus", "*.session")))
+
+SIM_DEVICE = None
+BENCH = None
+
+CMD_CLEAR = 0x01
+CMD_DRAW_TEXT = 0x02
+CMD_INVERT = 0x04
+
+
+def run_tool(*args):
+    return subprocess.run([sys.executable] + list(args), capture_output=True, timeout=60)
+
+
+class TraceDumpTest(unittest.TestCase):
+    def test_decodes_emulator_ring(self):
+        # Two commands, then the ring as trace_dump.py reads and converts it
+        with open_port("sim:" + SIM_DEVICE, timeout=2.0) as ser:
+            ser.write(bytes([CMD_CLEAR, CMD_DRAW_TEXT, 0, 0, 5]) + b"Trace")
+            time.sleep(0.2)
+            events = trace_dump.dump(ser)
+        trace = trace_dump.to_chrome(events)["traceEvents"]
+        self.assertEqual(len(trace), len(events))
+
+        # Command spans in the order sent, each ended on its own thread
+        spans = [(e["name"], e["ph"]) for e in trace if e["cat"] == "protocol"]
+        self.assertIn(("cmd_0x01", "B"), spans)
+        start = spans.index(("cmd_0x01", "B"))
+        self.assertEqual(spans[start:start + 4], [("cmd_0x01", "B"), ("cmd_0x01", "E"),
+                                                  ("cmd_0x02", "B"), ("cmd_0x02", "E")])
+
+        # Display transfers come in begin/end pairs carrying their size
+        bus = [e for e in trace if e["name"] == "i2c"]
+        self.assertTrue(bus)
+        for begin, end in zip(bus[0::2], bus[1::2]):
+            self.assertEqual((begin["ph"], end["ph"]), ("B", "E"))
+            self.assertGreater(begin["args"]["arg"], 0)
+            self.assertGreaterEqual(end["ts"], begin["ts"])
+
+        # Main-loop ticks are instants; time starts at 0 and never goes back
+        loops = [e for e in trace if e["name"] == "loop"]
+        self.assertTrue(loops)
+        self.assertTrue(all(e["ph"] == "i" and e["s"] == "t" for e in loops))
+        self.assertEqual(trace[0]["ts"], 0)
+        self.assertEqual([e["ts"] for e in trace], sorted(e["ts"] for e in trace))
+
+    def test_command_line_writes_chrome_json(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            out = os.path.join(tmp, "trace.json")
+            result = run_tool(os.path.join(TOOLS_DIR, "trace_dump.py"), "sim:" + SIM_DEVICE, "-o", out, "--clear")
+            self.assertEqual(result.returncode, 0, result.stderr)
+            with open(out) as f:
+                trace = json.load(f)
+        self.assertEqual(trace["displayTimeUnit"], "ms")
+        self.assertTrue(any(e["name"] == "loop" for e in trace["traceEvents"]))
+
+
+class StatusTest(unittest.TestCase):
+    def test_decodes_emulator_reply(self):
+        # The emulator's reply through status.py's own decode(); sizes and
+        # field order are checked against device_stats_t in test_status.cpp
+        with open_port("sim:" + SIM_DEVICE, timeout=2.0) as ser:
+            ser.write(bytes([CMD_CLEAR, CMD_CLEAR, CMD_INVERT, 0, 0x7E]))
+            time.sleep(0.1)
+            ser.write(bytes([status.CMD_STATUS, 0]))
+            header = ser.read(3)
+            payload = ser.read(header[1] | (header[2] << 8))
+        self.assertEqual(header[0], status.CMD_STATUS)
+        self.assertEqual(len(payload), 4 * (len(status.SCALAR_FIELDS) + status.STATS_LATENCY_BUCKETS +
+                                            status.STATS_CMD_SLOTS))
+        stats = status.decode(payload)
+        self.assertEqual(stats["version"], status.STATS_VERSION)
+        self.assertEqual(stats["flag_names"], ["display_ok"])
+        self.assertEqual(stats["commands"], {"CLEAR": 2, "INVERT": 1, "STATUS": 1})
+        self.assertEqual(stats["parser_resyncs"], 1)
+        self.assertGreater(stats["i2c_transactions"], 0)
+        self.assertGreater(stats["i2c_bytes"], stats["i2c_transactions"])
+        self.assertGreater(sum(stats["flush_latency"].values()), 0)
+        self.assertEqual(stats["i2c_failures"], 0)
+
+    def test_command_line_json(self):
+        result = run_tool(os.path.join(TOOLS_DIR, "status.py"), "sim:" + SIM_DEVICE, "--json")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        stats = json.loads(result.stdout)
+        self.assertEqual(stats["version"], status.STATS_VERSION)
+        self.assertEqual(stats["commands"], {"STATUS": 1})
+        self.assertEqual(set(status.SCALAR_FIELDS) - set(stats), set())
+
+
+class ReplayTest(unittest.TestCase):
+    def test_corpus_is_generated(self):
+        # The checked-in sessions are what make_corpus.py writes today
+        self.assertEqual(sorted(os.path.basename(p)[:-len(".session")] for p in CORPUS),
+                         sorted(make_corpus.SESSIONS))
+        for path in CORPUS:
+            name = os.path.basename(path)[:-len(".session")]
+            with self.subTest(session=name):
+                expected = [(round(t, 3), d) for t, d in make_corpus.SESSIONS[name]()]
+                self.assertEqual(read_session(path), expected)
+
+    def test_corpus_replays_cleanly(self):
+        # Every session back to back with a barrier after each write: all of
+        # it parsed, drawn without bus errors, each write answered
+        for path in CORPUS:
+            writes = read_session(path)
+            with self.subTest(session=os.path.basename(path)):
+                result = replay.replay("sim:" + SIM_DEVICE, writes, fast=True, sync=True)
+                self.assertEqual(result["writes"], len(writes))
+                self.assertEqual(result["parser_resyncs"], 0)
+                self.assertEqual(result["i2c_failures"], 0)
+                self.assertGreater(result["i2c_transactions"], 0)
+                self.assertGreater(result["i2c_bytes"], result["bytes_sent"])
+                self.assertGreater(sum(result["flush_latency"].values()), 0)
+                self.assertEqual(sum(rt["count"] for rt in result["round_trip_us"].values()), len(writes))
+
+    def test_command_line_timed_playback(self):
+        # Original timing, JSON out, then --compare against it
+        path = os.path.join(TOOLS_DIR, "corpus", "boot.session")
+        result = run_tool(os.path.join(TOOLS_DIR, "replay.py"), "sim:" + SIM_DEVICE, path, "--json")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        first = json.loads(result.stdout)
+        self.assertGreaterEqual(first["elapsed_s"], read_session(path)[-1][0] / 1000.0)
+        self.assertEqual(first["parser_resyncs"], 0)
+
+        with tempfile.TemporaryDirectory() as tmp:
+            baseline = os.path.join(tmp, "boot.json")
+            with open(baseline, "w") as f:
+                json.dump(first, f)
+            result = run_tool(os.path.join(TOOLS_DIR, "replay.py"), "sim:" + SIM_DEVICE, path, "--compare", baseline)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn(b"parser_resyncs     0  (=)", result.stdout)
+
+
+class BenchTest(unittest.TestCase):
+    def test_host_bench_on_pty(self):
+        # host/hid_display_bench through the kernel tty layer, as on a real
+        # port: every scene gets through, and the bitmap rate is the emulated
+        # device's (the pty holds little), not how fast a pipe can be written
+        if BENCH is None:
+            self.skipTest("no hid_display_bench given")
+        device = subprocess.Popen([SIM_DEVICE, "--pty"], stdout=subprocess.PIPE)
+        try:
+            pty = device.stdout.readline().decode().strip()
+            result = subprocess.run([BENCH, pty, "100"], capture_output=True, timeout=60)
+        finally:
+            device.kill()
+            device.wait()
+            device.stdout.close()
+        self.assertEqual(result.returncode, 0, result.stderr)
+        rows = {line.split()[0]: line for line in result.stdout.decode().splitlines()[1:]}
+        self.assertEqual(sorted(rows), ["bitmap", "clock", "progress", "scroll", "static"])
+        self.assertFalse([r for r in rows.values() if "write error" in r])
+
+        with open(os.path.join(TOOLS_DIR, "perf_baseline", "sim_i2c.json")) as f:
+            device_kbps = json.load(f)["frame_stream"]["kbps"]
+        kbps = float(rows["bitmap"].split()[-2])
+        self.assertLess(kbps, device_kbps * 1.5)
+        self.assertGreater(kbps, device_kbps * 0.25)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__, file=sys.stderr)
+        sys.exit(2)
+    SIM_DEVICE = os.path.abspath(sys.argv.pop(1))
+    if len(sys.argv) > 1 and os.path.isfile(sys.argv[1]):
+        BENCH = os.path.abspath(sys.argv.pop(1))
+    unittest.main()
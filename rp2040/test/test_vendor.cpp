@@ -0,0 +1,149 @@
+#include "sim.h"
+#include "test.h"
+#include <string.h>
+
+// The vendor bulk interface (ENABLE_VENDOR_INTERFACE builds): the command
+// stream and its replies looped back over it, a framebuffer sent with
+// CMD_FRAME and read back with CMD_CAPTURE, and vendor commands and queries
+// interleaved with CDC traffic, each stream parsed and answered on its own.
+
+#if CFG_TUD_VENDOR
+
+typedef std::vector<uint8_t> bytes_t;
+
+static void vendor_send(const bytes_t& cmd) {
+    sim_vendor_write(cmd);
+    sim_settle();
+}
+
+static bytes_t framebuffer() {
+    return bytes_t(ssd1306_get_buffer(), ssd1306_get_buffer() + SSD1306_BUFFER_SIZE);
+}
+
+static bool fb_pixel(int x, int y) {
+    return (ssd1306_get_buffer()[(y / 8) * SSD1306_WIDTH + x] >> (y % 8)) & 1;
+}
+
+static bytes_t text(uint8_t x, uint8_t y, const std::string& s) {
+    bytes_t cmd = {CMD_DRAW_TEXT, x, y, (uint8_t)s.size()};
+    cmd.insert(cmd.end(), s.begin(), s.end());
+    return cmd;
+}
+
+// Full-screen framebuffer of bytes that do not repeat
+static bytes_t noise() {
+    bytes_t fb;
+    uint32_t x = 4321;
+    for (int i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        x = x * 1103515245 + 12345;
+        fb.push_back((uint8_t)(x >> 16) ^ (uint8_t)i);
+    }
+    return fb;
+}
+
+static bytes_t frame_cmd(const bytes_t& fb) {
+    bytes_t cmd = {CMD_FRAME, 0, SSD1306_HEIGHT / 8};
+    cmd.insert(cmd.end(), fb.begin(), fb.end());
+    return cmd;
+}
+
+TEST(vendor_commands_and_replies) {
+    // Drawing over vendor matches the same commands over CDC; replies come
+    // back on vendor only
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_cdc_write(text(0, 0, "Bulk"));
+    sim_settle();
+    bytes_t expected = framebuffer();
+    vendor_send({CMD_CLEAR});
+    CHECK(framebuffer() != expected);
+    vendor_send(text(0, 0, "Bulk"));
+    CHECK_EQ(framebuffer(), expected);
+    CHECK_EQ(sim_panel_image(0), expected);
+
+    bytes_t reply = sim_vendor_query({CMD_TEST, TEST_SUBCMD_PING}, 2);
+    CHECK_EQ(reply, bytes_t({CMD_TEST, TEST_SUBCMD_PING}));
+    reply = sim_vendor_query({CMD_BOOT_TIME}, 13);
+    CHECK_EQ(reply.size(), 13u);
+    CHECK_EQ(reply[0], CMD_BOOT_TIME);
+    CHECK(sim_cdc_read().empty());
+}
+
+TEST(vendor_frame_capture_loopback) {
+    // A framebuffer sent in bulk comes back byte for byte
+    sim_boot();
+    bytes_t fb = noise();
+    vendor_send(frame_cmd(fb));
+    CHECK_EQ(framebuffer(), fb);
+
+    bytes_t reply = sim_vendor_query({CMD_CAPTURE, 0}, 3 + CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE);
+    CHECK_EQ(reply.size(), 3u + CAPTURE_HEADER_LEN + SSD1306_BUFFER_SIZE);
+    CHECK_EQ(reply[0], CMD_CAPTURE);
+    CHECK_EQ(reply[3], CAPTURE_ENC_RAW);
+    CHECK_EQ(bytes_t(reply.begin() + 3 + CAPTURE_HEADER_LEN, reply.end()), fb);
+    CHECK(sim_cdc_read().empty());
+}
+
+TEST(vendor_queries_while_cdc_streams) {
+    // A CDC frame arrives a packet at a time while vendor queries are
+    // answered between its packets; neither stream sees the other's replies
+    sim_boot();
+    bytes_t fb = noise();
+    bytes_t cdc_cmd = frame_cmd(fb);
+    cdc_cmd.push_back(CMD_TEST);
+    cdc_cmd.push_back(TEST_SUBCMD_PING);
+
+    bytes_t vendor_in;
+    int rounds = 0;
+    for (size_t at = 0; at < cdc_cmd.size(); at += 64, rounds++) {
+        size_t n = cdc_cmd.size() - at < 64 ? cdc_cmd.size() - at : 64;
+        sim_cdc_write(bytes_t(cdc_cmd.begin() + at, cdc_cmd.begin() + at + n));
+        sim_vendor_write({CMD_BOOT_TIME, CMD_TEST, TEST_SUBCMD_PING});
+        sim_run_us(500);
+        bytes_t part = sim_vendor_read();
+        vendor_in.insert(vendor_in.end(), part.begin(), part.end());
+
+        // Halfway: vendor replies are in, the frame is not
+        if (rounds == 8) {
+            CHECK_EQ(vendor_in.size(), 9u * (13 + 2));
+            CHECK(framebuffer() != fb);
+            CHECK(sim_cdc_read().empty());
+        }
+    }
+    sim_settle();
+    sim_run_ms(5);
+    bytes_t part = sim_vendor_read();
+    vendor_in.insert(vendor_in.end(), part.begin(), part.end());
+
+    CHECK_EQ(vendor_in.size(), (size_t)rounds * (13 + 2));
+    for (size_t at = 0; at + 15 <= vendor_in.size(); at += 15) {
+        CHECK_EQ(vendor_in[at], CMD_BOOT_TIME);
+        CHECK_EQ(vendor_in[at + 13], CMD_TEST);
+        CHECK_EQ(vendor_in[at + 14], TEST_SUBCMD_PING);
+    }
+    CHECK_EQ(sim_cdc_read(), bytes_t({CMD_TEST, TEST_SUBCMD_PING}));
+    CHECK_EQ(framebuffer(), fb);
+}
+
+TEST(vendor_half_command_survives_cdc_traffic) {
+    // Half a command on vendor, whole commands on CDC, then the rest: each
+    // parser finishes its own command
+    sim_boot();
+    sim_cdc_write({CMD_CLEAR});
+    sim_settle();
+    vendor_send({CMD_GFX, GFX_OP_FILL_RECT, GFX_MODE_SET});
+    bytes_t reply = sim_cdc_query({CMD_GFX, GFX_OP_PIXEL, GFX_MODE_SET, 100, 2, CMD_TEST, TEST_SUBCMD_PING}, 2);
+    CHECK_EQ(reply, bytes_t({CMD_TEST, TEST_SUBCMD_PING}));
+    CHECK(fb_pixel(100, 2));
+    CHECK(!fb_pixel(10, 10));
+
+    vendor_send({10, 10, 20, 8});
+    for (int y = 10; y < 18; y++) {
+        for (int x = 10; x < 30; x++) CHECK(fb_pixel(x, y));
+    }
+    CHECK(!fb_pixel(30, 10));
+    CHECK(fb_pixel(100, 2));
+    CHECK(sim_vendor_read().empty());
+}
+
+#endif // CFG_TUD_VENDOR
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Screenshot the framebuffer of a USB HID Display (CMD_CAPTURE, 0x15) as PNG.
+
+The picture is what the firmware holds in its framebuffer for the selected
+display, i.e. what it sends to the panel. Portrait captures are turned back
+to the logical orientation unless --physical is given.
+
+Usage:
+    capture.py /dev/ttyACM0 -o screen.png             # PackBits-compressed transfer
+    capture.py /dev/ttyACM0 -o screen.png --scale 4   # 4x4 pixels per dot
+    capture.py /dev/ttyACM0 -o screen.png --raw       # uncompressed transfer
+    capture.py /dev/ttyACM0 --compare golden.png      # exit 1 if the screen differs
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from devport import open_port, port_errors  # noqa: E402
+
+CMD_CAPTURE = 0x15
+CAPTURE_FLAG_RLE = 0x01
+CAPTURE_FLAG_PORTRAIT = 0x01
+CAPTURE_ENC_RAW = 0x00
+CAPTURE_ENC_PACKBITS = 0x01
+HEADER_LEN = 5
+
+
+def unpackbits(data):
+    """Decode PackBits as produced by rp2040/src/capture.cpp."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        n = data[i]
+        i += 1
+        if n < 0x80:
+            out += data[i:i + n + 1]
+            i += n + 1
+        elif n > 0x80:
+            out += bytes([data[i]]) * (257 - n)
+            i += 1
+    return bytes(out)
+
+
+def query(port, rle=True, timeout=2.0):
+    """Send CMD_CAPTURE and return the raw reply payload."""
+    with open_port(port, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(bytes([CMD_CAPTURE, CAPTURE_FLAG_RLE if rle else 0]))
+        header = ser.read(3)
+        if len(header) != 3 or header[0] != CMD_CAPTURE:
+            raise IOError("no capture reply (got %r)" % header)
+        length = header[1] | (header[2] << 8)
+        payload = ser.read(length)
+        if len(payload) != length:
+            raise IOError("short capture reply: %d of %d bytes" % (len(payload), length))
+        return payload
+
+
+def decode(payload, physical=False):
+    """Decode a reply payload into (display, width, height, rows of 0/1)."""
+    encoding, display, width, height, flags = payload[:HEADER_LEN]
+    data = payload[HEADER_LEN:]
+    if encoding == CAPTURE_ENC_PACKBITS:
+        data = unpackbits(data)
+    elif encoding != CAPTURE_ENC_RAW:
+        raise ValueError("unknown capture encoding %d" % encoding)
+    if len(data) != width * height // 8:
+        raise ValueError("framebuffer is %d bytes, expected %d" % (len(data), width * height // 8))
+
+    # Page format: one byte per column per 8-row page, LSB on top
+    rows = [[(data[(y // 8) * width + x] >> (y % 8)) & 1 for x in range(width)]
+            for y in range(height)]
+    if flags & CAPTURE_FLAG_PORTRAIT and not physical:
+        rows = [row[::-1] for row in rows[::-1]]
+    return display, width, height, rows
+
+
+def scale_rows(rows, scale):
+    return [[p for p in row for _ in range(scale)] for row in rows for _ in range(scale)]
+
+
+def png_bytes(rows):
+    """Encode rows of 0/1 as a 1-bit grayscale PNG (lit pixels white)."""
+    width, height = len(rows[0]), len(rows)
+    raw = bytearray()
+    for row in rows:
+        raw.append(0)  # Filter: none
+        for x in range(0, width, 8):
+            byte = 0
+            for bit, p in enumerate(row[x:x + 8]):
+                byte |= p << (7 - bit)
+            raw.append(byte)
+
+    def chunk(tag, body):
+        return (struct.pack(">I", len(body)) + tag + body +
+                struct.pack(">I", zlib.crc32(tag + body) & 0xFFFFFFFF))
+
+    return (b"\x89PNG\r\n\x1a\n" +
+            chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 1, 0, 0, 0, 0)) +
+            chunk(b"IDAT", zlib.compress(bytes(raw), 9)) +
+            chunk(b"IEND", b""))
+
+
+def png_rows(path):
+    """Read back a PNG written by png_bytes() (1-bit grayscale, no interlace)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("%s is not a PNG" % path)
+    pos, idat, header = 8, b"", None
+    while pos < len(data):
+        length, tag = struct.unpack_from(">I4s", data, pos)
+        body = data[pos + 8:pos + 8 + length]
+        if tag == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif tag == b"IDAT":
+            idat += body
+        pos += 12 + length
+    if header is None or header[2:5] != (1, 0, 0) or header[6] != 0:
+        raise ValueError("%s is not a 1-bit grayscale capture" % path)
+    width, height = header[:2]
+    raw = zlib.decompress(idat)
+    stride = 1 + (width + 7) // 8
+    rows = []
+    for y in range(height):
+        line = raw[y * stride:(y + 1) * stride]
+        if line[0] != 0:
+            raise ValueError("%s uses PNG filters; only captures are supported" % path)
+        rows.append([(line[1 + x // 8] >> (7 - x % 8)) & 1 for x in range(width)])
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0, or sim:<sim_device>")
+    parser.add_argument("-o", "--output", help="PNG file to write")
+    parser.add_argument("--scale", type=int, default=1, help="pixels per dot in the PNG (default 1)")
+    parser.add_argument("--raw", action="store_true", help="request an uncompressed transfer")
+    parser.add_argument("--physical", action="store_true", help="keep portrait captures as sent to the panel")
+    parser.add_argument("--compare", metavar="PNG", help="compare with a capture saved at scale 1; exit 1 if different")
+    args = parser.parse_args()
+
+    try:
+        display, width, height, rows = decode(query(args.port, not args.raw), args.physical)
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(png_bytes(scale_rows(rows, max(1, args.scale))))
+            print("display %d: %dx%d -> %s" % (display, width, height, args.output))
+        if args.compare:
+            golden = png_rows(args.compare)
+            if len(golden) != len(rows) or len(golden[0]) != len(rows[0]):
+                print("size differs from %s" % args.compare)
+                return 1
+            diff = sum(a != b for ra, rb in zip(rows, golden) for a, b in zip(ra, rb))
+            if diff:
+                print("%d pixels differ from %s" % (diff, args.compare))
+                return 1
+            print("matches %s" % args.compare)
+    except port_errors() as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""Regenerate the canned benchmark sessions in this directory.
+
+The sessions model typical host workloads for tools/replay.py. They are
+generated rather than recorded so they stay deterministic and readable; keep
+the .session files in git so results stay comparable across revisions.
+
+Usage:
+    make_corpus.py            # rewrite all *.session files next to this script
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from record import write_session  # noqa: E402
+
+WIDTH = 128
+
+
+def clear():
+    return bytes([0x01])
+
+
+def text(x, y, s):
+    data = s.encode("ascii")
+    return bytes([0x02, x, y, len(data)]) + data
+
+
+def brightness(v):
+    return bytes([0x05, v])
+
+
+def progress(x, y, w, h, pct):
+    return bytes([0x06, x, y, w, h, pct])
+
+
+def xor_rect(x, y, w, h):
+    return bytes([0x11, 0x03, 0x02, x, y, w, h])
+
+
+def graph_setup(gid, x, y, w, h, lo, hi):
+    return bytes([0x12, 0x00, gid, x, y, w, h, lo, hi, 0])
+
+
+def graph_sample(gid, value):
+    return bytes([0x12, 0x01, gid, value])
+
+
+def boot():
+    """Host daemon start: reset the panel and draw the first screen."""
+    writes = [(0.0, brightness(0xCF)), (2.0, clear()), (4.0, text(0, 0, "Micropanel"))]
+    writes.append((6.0, text(0, 16, "Connecting...")))
+    for i, pct in enumerate(range(0, 101, 20)):
+        writes.append((50.0 + i * 40.0, progress(0, 32, WIDTH, 8, pct)))
+    t = 300.0
+    writes.append((t, clear()))
+    for row, line in enumerate(["Host: online", "IP: 10.0.0.17", "Uptime: 0:00", "Ready"]):
+        writes.append((t + 2.0 + row, text(0, row * 16, line)))
+    return writes
+
+
+def dashboard():
+    """30 s of system monitor: four value lines per second, a graph at 4 Hz."""
+    rng = random.Random(45)
+    writes = [(0.0, clear()), (1.0, text(0, 0, "CPU")), (2.0, graph_setup(0, 0, 40, WIDTH, 24, 0, 100))]
+    cpu = 30
+    for tick in range(120):
+        t = 10.0 + tick * 250.0
+        cpu = max(0, min(100, cpu + rng.randint(-12, 12)))
+        writes.append((t, graph_sample(0, cpu)))
+        if tick % 4 == 0:
+            writes.append((t + 1.0, text(32, 0, "%3d%%" % cpu)))
+            writes.append((t + 2.0, text(0, 8, "MEM %4d MB" % rng.randint(900, 1100))))
+            writes.append((t + 3.0, text(0, 16, "TMP %4.1f C" % (45 + rng.random() * 10))))
+            writes.append((t + 4.0, text(0, 24, "NET %4d kB/s" % rng.randint(0, 2000))))
+    return writes
+
+
+def menu_navigation():
+    """Host-driven menu: redraw on every encoder step, scrolling past 8 rows."""
+    items = ["Network", "Display", "Brightness", "Timeout", "Sound", "Language",
+             "Date/Time", "Updates", "Storage", "About", "Reboot", "Shutdown"]
+    rows = 8
+    writes = []
+    t = 0.0
+
+    def draw_page(top, cursor):
+        nonlocal t
+        writes.append((t, clear()))
+        for row in range(rows):
+            t += 1.0
+            writes.append((t, text(0, row * 8, items[top + row].ljust(16))))
+        t += 1.0
+        writes.append((t, xor_rect(0, (cursor - top) * 8, WIDTH, 8)))
+
+    top, cursor = 0, 0
+    draw_page(top, cursor)
+    path = list(range(1, len(items))) + list(range(len(items) - 2, -1, -1))
+    for step in path:
+        t += 150.0
+        if step < top or step >= top + rows:
+            top = step if step < top else step - rows + 1
+            cursor = step
+            draw_page(top, cursor)
+            continue
+        # Move the highlight: un-invert the old row, invert the new one
+        writes.append((t, xor_rect(0, (cursor - top) * 8, WIDTH, 8)))
+        writes.append((t + 1.0, xor_rect(0, (step - top) * 8, WIDTH, 8)))
+        cursor = step
+    return writes
+
+
+def firmware_update():
+    """Progress screen of a 10 s update: bar and percentage every 100 ms."""
+    writes = [(0.0, clear()), (1.0, text(0, 0, "Updating...")), (2.0, text(0, 8, "Do not unplug"))]
+    for pct in range(101):
+        t = 10.0 + pct * 100.0
+        writes.append((t, progress(0, 32, WIDTH, 12, pct)))
+        writes.append((t + 1.0, text(48, 48, "%3d%%" % pct)))
+    t += 200.0
+    writes.append((t, clear()))
+    writes.append((t + 1.0, text(0, 24, "Update done")))
+    return writes
+
+
+SESSIONS = {
+    "boot": boot,
+    "dashboard": dashboard,
+    "menu_navigation": menu_navigation,
+    "firmware_update": firmware_update,
+}
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name, make in SESSIONS.items():
+        path = os.path.join(here, name + ".session")
+        write_session(path, make(), "%s: %s\nGenerated by make_corpus.py" % (name, make.__doc__))
+        print("wrote %s" % path)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,85 @@
+"""Open the display for the tools: a serial port, or the emulator.
+
+A port named "sim:PATH" starts PATH, the emulated device built by rp2040/test
+(sim_device: the firmware on the simulated board), and talks to its CDC port
+over a pipe. Tools and their gates then run without hardware, and pyserial is
+only needed for real ports.
+"""
+
+import os
+import select
+import subprocess
+import time
+
+SIM_PREFIX = "sim:"
+
+
+class SimPort:
+    """The part of serial.Serial the tools use, on a sim_device process."""
+
+    def __init__(self, path, timeout=None):
+        self.timeout = timeout
+        self._proc = subprocess.Popen([path], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self._fd = self._proc.stdout.fileno()
+
+    def write(self, data):
+        self._proc.stdin.write(data)
+        self._proc.stdin.flush()
+        return len(data)
+
+    def read(self, size=1):
+        """Up to size bytes: as pyserial, wait at most timeout for all of them."""
+        data = b""
+        deadline = None if self.timeout is None else time.monotonic() + self.timeout
+        while len(data) < size:
+            wait = None if deadline is None else max(0.0, deadline - time.monotonic())
+            if not select.select([self._fd], [], [], wait)[0]:
+                break
+            chunk = os.read(self._fd, size - len(data))
+            if not chunk:
+                raise IOError("emulator exited")
+            data += chunk
+        return data
+
+    def reset_input_buffer(self):
+        while select.select([self._fd], [], [], 0)[0]:
+            if not os.read(self._fd, 4096):
+                break
+
+    def flush(self):
+        pass
+
+    def fileno(self):
+        return self._fd
+
+    def close(self):
+        if self._proc.poll() is None:
+            self._proc.stdin.close()
+            try:
+                self._proc.wait(timeout=2)
+            except subprocess.TimeoutExpired:
+                self._proc.kill()
+                self._proc.wait()
+        self._proc.stdout.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def open_port(port, timeout=None):
+    if port.startswith(SIM_PREFIX):
+        return SimPort(port[len(SIM_PREFIX):], timeout)
+    import serial
+    return serial.Serial(port, timeout=timeout)
+
+
+def port_errors():
+    """Exception types open_port() and reads can raise, for except clauses."""
+    try:
+        import serial
+        return (IOError, ValueError, serial.SerialException)
+    except ImportError:
+        return (IOError, ValueError)
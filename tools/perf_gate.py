@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""Performance regression gate for firmware built with ENABLE_TEST_COMMANDS.
+
+Runs a fixed set of scenarios (a text draw, a progress bar, a full frame, an
+encoder detent, ...) and measures each one with the test-only subcommands of
+CMD_TEST (0xF0): the display bus counters before and after the scenario, the
+CRC of the framebuffer it leaves behind, and the HID reports it produced
+(from CMD_STATUS). Input scenarios force the encoder and button pins with
+TEST_SUBCMD_GPIO, so they go through the same scanner as a real knob.
+
+It also streams FRAME_STREAM_COUNT full-screen CMD_FRAME uploads back to back
+and reports the rate the device took them in, timed by its own uptime
+(CMD_STATUS before and after, in the same write).
+
+Save a baseline from a known-good build, then check later builds against it:
+bus bytes or transactions growing by more than --tolerance percent, a
+framebuffer that differs, a changed number of HID reports, or frame
+throughput dropping by more than --tolerance percent fail the gate (exit
+status 1). Baselines are only comparable between runs with the same
+display configuration (panel, orientation, bus speed).
+
+The port can also be the emulator ("sim:<path to sim_device>", see
+devport.py); ctest runs the gate that way against the baselines in
+tools/perf_baseline/.
+
+Usage:
+    perf_gate.py /dev/ttyACM0                          # run and print
+    perf_gate.py /dev/ttyACM0 --save baseline.json     # record a baseline
+    perf_gate.py /dev/ttyACM0 --check baseline.json    # exit 1 on regression
+    perf_gate.py /dev/ttyACM0 --check baseline.json --tolerance 10
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from devport import open_port, port_errors  # noqa: E402
+from status import CMD_STATUS, decode  # noqa: E402
+
+CMD_CLEAR = 0x01
+CMD_DRAW_TEXT = 0x02
+CMD_PROGRESS_BAR = 0x06
+CMD_FRAME = 0x10
+CMD_GRID = 0x18
+GRID_OP_WRITE = 0x00
+CMD_TEST = 0xF0
+TEST_SUBCMD_PING = 0x00
+TEST_SUBCMD_FB_CHECKSUM = 0x08
+TEST_SUBCMD_BUS_STATS = 0x09
+TEST_SUBCMD_GPIO = 0x0A
+TEST_GPIO_RELEASE = 0xFF
+
+# Input pins, as in rp2040/src/rotary_encoder.cpp
+ROTARY_CLK_PIN = 10
+ROTARY_DT_PIN = 11
+ENTER_BTN_PIN = 14
+TOP_BTN_PIN = 15
+
+EDGE_GAP_S = 0.012       # Between forced edges: past the 5 ms debounce
+SETTLE_TIMEOUT_S = 2.0   # For the display flush to finish
+
+# Counters compared against the baseline with --tolerance (lower is better)
+METRICS = ["bus_bytes", "bus_transactions"]
+
+# Throughput run: 64 KB, long enough for the millisecond uptime to time it
+FRAME_STREAM_COUNT = 64
+FRAME_STREAM = "frame_stream"
+
+
+def text(x, y, s):
+    data = s.encode("ascii")
+    return bytes([CMD_DRAW_TEXT, x, y, len(data)]) + data
+
+
+def grid(row, col, s):
+    data = s.encode("ascii")
+    return bytes([CMD_GRID, GRID_OP_WRITE, row, col, 0, len(data)]) + data
+
+
+def gpio(pin, level):
+    return ("gpio", pin, level)
+
+
+def wait(seconds):
+    return ("wait", seconds)
+
+
+# Each scenario starts on a cleared, flushed screen. Steps are command bytes
+# or ("gpio", pin, level) / ("wait", seconds). Consecutive commands go out in
+# one write, so host scheduling does not decide how the flushes split.
+SCENARIOS = {
+    "clear": [bytes([CMD_CLEAR])],
+    "text_line": [text(0, 0, "Hello, world")],
+    "text_screen": [text(0, y, "Line %d: 0123456789" % (y // 8)) for y in range(0, 64, 8)],
+    "text_update": [text(0, 24, "CPU 42%"), wait(0.1), text(0, 24, "CPU 43%")],
+    "grid_update": [grid(3, 0, "CPU 42%"), wait(0.1), grid(3, 0, "CPU 43%")],
+    "progress_bar": [bytes([CMD_PROGRESS_BAR, 4, 28, 120, 8, 60])],
+    "full_frame": [bytes([CMD_FRAME, 0, 8]) + bytes((i * 37) & 0xFF for i in range(1024))],
+    "encoder_detent": [gpio(ROTARY_CLK_PIN, 0), gpio(ROTARY_DT_PIN, 0),
+                       gpio(ROTARY_CLK_PIN, 1), gpio(ROTARY_DT_PIN, 1),
+                       gpio(ROTARY_CLK_PIN, TEST_GPIO_RELEASE), gpio(ROTARY_DT_PIN, TEST_GPIO_RELEASE)],
+    "enter_click": [gpio(ENTER_BTN_PIN, 0), wait(0.06), gpio(ENTER_BTN_PIN, TEST_GPIO_RELEASE)],
+    "nav_up": [gpio(TOP_BTN_PIN, 0), wait(0.06), gpio(TOP_BTN_PIN, TEST_GPIO_RELEASE)],
+}
+
+
+def read_exact(ser, n):
+    data = ser.read(n)
+    if len(data) != n:
+        raise IOError("device stopped answering (%d of %d bytes)" % (len(data), n))
+    return data
+
+
+def test_query(ser, subcmd, reply_len):
+    ser.write(bytes([CMD_TEST, subcmd]))
+    reply = read_exact(ser, reply_len)
+    if reply[0] != CMD_TEST or reply[1] != subcmd:
+        raise IOError("unexpected reply %r" % reply)
+    return reply
+
+
+def bus_stats(ser):
+    """Return (transactions, bytes, failures, pending)."""
+    reply = test_query(ser, TEST_SUBCMD_BUS_STATS, 15)
+    return struct.unpack("<III", reply[2:14]) + (bool(reply[14]),)
+
+
+def fb_checksum(ser):
+    reply = test_query(ser, TEST_SUBCMD_FB_CHECKSUM, 6)
+    return reply[3] | (reply[4] << 8)
+
+
+def read_status(ser):
+    """Decode a CMD_STATUS reply already asked for."""
+    header = read_exact(ser, 3)
+    if header[0] != CMD_STATUS:
+        raise IOError("unexpected reply %r" % header)
+    return decode(read_exact(ser, header[1] | (header[2] << 8)))
+
+
+def hid_sent(ser):
+    ser.write(bytes([CMD_STATUS, 0]))
+    return read_status(ser)["hid_sent"]
+
+
+def settle(ser):
+    """Wait until every display flush is done; returns the bus counters."""
+    deadline = time.monotonic() + SETTLE_TIMEOUT_S
+    while True:
+        stats = bus_stats(ser)
+        if not stats[3]:
+            return stats
+        if time.monotonic() > deadline:
+            raise IOError("display flush did not finish")
+        time.sleep(0.005)
+
+
+def run_scenario(ser, steps):
+    ser.write(bytes([CMD_CLEAR]))
+    settle(ser)
+    hid_before = hid_sent(ser)
+    transactions, nbytes, failures, _ = settle(ser)
+
+    pending = b""
+    for step in steps:
+        if isinstance(step, bytes):
+            pending += step
+            continue
+        if pending:
+            ser.write(pending)
+            pending = b""
+        if step[0] == "gpio":
+            ser.write(bytes([CMD_TEST, TEST_SUBCMD_GPIO, step[1], step[2]]))
+            time.sleep(EDGE_GAP_S)
+        else:
+            time.sleep(step[1])
+    if pending:
+        ser.write(pending)
+
+    # Reports are sent from the main loop: give the last edge time to land
+    time.sleep(0.05)
+    after = settle(ser)
+    return {
+        "bus_transactions": after[0] - transactions,
+        "bus_bytes": after[1] - nbytes,
+        "bus_failures": after[2] - failures,
+        "hid_reports": hid_sent(ser) - hid_before,
+        "fb_crc": "%04x" % fb_checksum(ser),
+    }
+
+
+def frame_stream(ser):
+    """Full frames back to back between two CMD_STATUS queries: the second
+    is only parsed once the device has taken in every frame."""
+    frames = b"".join(bytes([CMD_FRAME, 0, 8]) + bytes((i * 37 + n) & 0xFF for i in range(1024))
+                      for n in range(FRAME_STREAM_COUNT))
+    ser.write(bytes([CMD_STATUS, 0]) + frames + bytes([CMD_STATUS, 0]))
+    before = read_status(ser)["uptime_ms"]
+    after = read_status(ser)["uptime_ms"]
+    settle(ser)
+    ms = max(after - before, 1)
+    return {"frames": FRAME_STREAM_COUNT, "bytes": len(frames), "device_ms": ms,
+            "kbps": round(len(frames) / 1024.0 / (ms / 1000.0))}
+
+
+def run(port):
+    with open_port(port, timeout=1.0) as ser:
+        ser.reset_input_buffer()
+        try:
+            test_query(ser, TEST_SUBCMD_PING, 2)
+        except IOError:
+            raise IOError("no test command reply: firmware not built with ENABLE_TEST_COMMANDS?")
+        results = {name: run_scenario(ser, steps) for name, steps in SCENARIOS.items()}
+        results[FRAME_STREAM] = frame_stream(ser)
+        return results
+
+
+def check(results, baseline, tolerance):
+    """Return a list of regressions against baseline."""
+    failures = []
+    for name, result in results.items():
+        old = baseline.get(name)
+        if old is None:
+            continue
+        if name == FRAME_STREAM:
+            if result["kbps"] < old["kbps"] * (1 - tolerance / 100.0):
+                failures.append("%s: %d KB/s, baseline %d" % (name, result["kbps"], old["kbps"]))
+            continue
+        for metric in METRICS:
+            limit = old[metric] * (1 + tolerance / 100.0)
+            if result[metric] > limit:
+                failures.append("%s: %s %d, baseline %d" % (name, metric, result[metric], old[metric]))
+        if result["fb_crc"] != old["fb_crc"]:
+            failures.append("%s: framebuffer crc %s, baseline %s" % (name, result["fb_crc"], old["fb_crc"]))
+        if result["hid_reports"] != old["hid_reports"]:
+            failures.append("%s: %d HID reports, baseline %d" % (name, result["hid_reports"], old["hid_reports"]))
+        if result["bus_failures"]:
+            failures.append("%s: %d bus failures" % (name, result["bus_failures"]))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0, or sim:<sim_device>")
+    parser.add_argument("--save", metavar="JSON", help="write the results as a baseline")
+    parser.add_argument("--check", metavar="JSON", help="compare against a baseline, exit 1 on regression")
+    parser.add_argument("--tolerance", type=float, default=5.0,
+                        help="allowed growth of bus bytes/transactions and drop of frame "
+                             "throughput in percent (default 5)")
+    args = parser.parse_args()
+
+    try:
+        results = run(args.port)
+    except port_errors() as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    print("%-16s %10s %10s %6s %6s" % ("scenario", "bus bytes", "bus trans", "hid", "crc"))
+    for name, r in results.items():
+        if name != FRAME_STREAM:
+            print("%-16s %10d %10d %6d %6s" % (name, r["bus_bytes"], r["bus_transactions"], r["hid_reports"], r["fb_crc"]))
+    r = results[FRAME_STREAM]
+    print("%s: %d frames, %d bytes in %d ms: %d KB/s" % (FRAME_STREAM, r["frames"], r["bytes"], r["device_ms"], r["kbps"]))
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2)
+    if args.check:
+        with open(args.check) as f:
+            failures = check(results, json.load(f), args.tolerance)
+        for failure in failures:
+            print("FAIL %s" % failure)
+        if failures:
+            return 1
+        print("PASS")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Record the command stream a host application sends to the USB HID Display.
+
+Creates a pseudo-terminal and prints its path; point the application at it
+instead of /dev/ttyACM0 (the host library accepts any tty). Every write that
+arrives is logged with its time, so tools/replay.py can play the session back
+against any firmware revision. With --device the bytes are also forwarded to
+a real display and its replies relayed back, so applications that query the
+device keep working while being recorded.
+
+Usage:
+    record.py -o dashboard.session                        # record only
+    record.py -o dashboard.session --device /dev/ttyACM0  # record and pass through
+
+Stop with Ctrl-C. Session format (one host write per line):
+
+    # comment
+    <milliseconds since the first write> <hex bytes>
+
+Writes reach the pty in chunks that may be split or merged by the kernel, so
+line boundaries are close to, but not exactly, the application's writes.
+"""
+
+import argparse
+import os
+import select
+import sys
+import time
+import tty
+
+SESSION_HEADER = "# usb-hid-display session v1"
+
+
+def write_session(path, writes, comment=None):
+    """Save [(t_ms, bytes)] in the session format."""
+    with open(path, "w") as f:
+        f.write(SESSION_HEADER + "\n")
+        if comment:
+            for line in comment.splitlines():
+                f.write("# %s\n" % line)
+        for t_ms, data in writes:
+            f.write("%.3f %s\n" % (t_ms, data.hex(" ")))
+
+
+def read_session(path):
+    """Load a session file as [(t_ms, bytes)]."""
+    writes = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            t, _, hexdata = line.partition(" ")
+            try:
+                writes.append((float(t), bytes.fromhex(hexdata)))
+            except ValueError:
+                raise ValueError("%s:%d: malformed line" % (path, number))
+    return writes
+
+
+def record(output, device=None):
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print("recording: open %s as the display (Ctrl-C to stop)" % os.ttyname(slave), file=sys.stderr)
+
+    ser = None
+    if device:
+        from devport import open_port
+        ser = open_port(device, timeout=0)
+
+    writes = []
+    start = None
+    try:
+        while True:
+            fds = [master] + ([ser.fileno()] if ser else [])
+            ready, _, _ = select.select(fds, [], [])
+            if master in ready:
+                try:
+                    data = os.read(master, 4096)
+                except OSError:
+                    continue  # Application closed the pty; wait for it to reopen
+                now = time.monotonic()
+                if start is None:
+                    start = now
+                writes.append(((now - start) * 1000.0, data))
+                if ser:
+                    ser.write(data)
+            if ser and ser.fileno() in ready:
+                reply = ser.read(4096)
+                if reply:
+                    os.write(master, reply)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if ser:
+            ser.close()
+        os.close(master)
+        os.close(slave)
+
+    write_session(output, writes)
+    total = sum(len(d) for _, d in writes)
+    print("recorded %d writes, %d bytes -> %s" % (len(writes), total, output), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", required=True, help="session file to write")
+    parser.add_argument("--device", help="also forward to this CDC serial port, e.g. /dev/ttyACM0")
+    args = parser.parse_args()
+    record(args.output, args.device)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Replay a recorded command session against a USB HID Display and report cost.
+
+Plays a session written by tools/record.py (or one of tools/corpus/*.session)
+with its original timing, then reads the CMD_STATUS counters, which were
+zeroed before the run. The report covers display bus traffic (bytes and
+transactions), peak main-loop latency and the flush latency histogram. Run
+the same session on two firmware revisions and compare the JSON outputs.
+
+With --sync, every write is followed by a CMD_BOOT_TIME query used as a
+barrier. The reply arrives once the device has handled everything before it,
+so the round trip is the time until the command took effect in the
+framebuffer. The flush to the glass follows within the time shown by the
+flush latency histogram. The extra queries add to the command counts but not
+to the display traffic. --sync assumes the session itself gets no replies;
+all corpus sessions qualify.
+
+Usage:
+    replay.py /dev/ttyACM0 tools/corpus/dashboard.session
+    replay.py /dev/ttyACM0 session --fast --sync      # back to back, per-command timing
+    replay.py /dev/ttyACM0 session --json > new.json
+    replay.py /dev/ttyACM0 session --compare old.json # deltas against a previous run
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from devport import open_port, port_errors  # noqa: E402
+from record import read_session  # noqa: E402
+from status import COMMAND_NAMES, STATUS_FLAG_RESET, CMD_STATUS, decode  # noqa: E402
+
+CMD_BOOT_TIME = 0x0C
+BOOT_TIME_REPLY_LEN = 13
+
+# Counters compared between runs (lower is better)
+METRICS = ["i2c_bytes", "i2c_transactions", "i2c_failures", "loop_max_us", "parser_resyncs"]
+
+
+def read_exact(ser, n):
+    data = ser.read(n)
+    if len(data) != n:
+        raise IOError("device stopped answering (%d of %d bytes)" % (len(data), n))
+    return data
+
+
+def query_status(ser, reset=False):
+    ser.write(bytes([CMD_STATUS, STATUS_FLAG_RESET if reset else 0]))
+    header = read_exact(ser, 3)
+    if header[0] != CMD_STATUS:
+        raise IOError("unexpected reply %r" % header)
+    return decode(read_exact(ser, header[1] | (header[2] << 8)))
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p))]
+
+
+def replay(port, writes, speed=1.0, fast=False, sync=False):
+    with open_port(port, timeout=2.0) as ser:
+        ser.reset_input_buffer()
+        query_status(ser, reset=True)
+
+        round_trips = {}
+        start = time.monotonic()
+        for t_ms, data in writes:
+            if not fast:
+                delay = start + t_ms / 1000.0 / speed - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+            sent = time.monotonic()
+            ser.write(data)
+            if sync:
+                ser.reset_input_buffer()
+                ser.write(bytes([CMD_BOOT_TIME]))
+                read_exact(ser, BOOT_TIME_REPLY_LEN)
+                name = COMMAND_NAMES.get(data[0], "0x%02X" % data[0])
+                round_trips.setdefault(name, []).append((time.monotonic() - sent) * 1e6)
+        ser.flush()
+        elapsed = time.monotonic() - start
+
+        # Let the last flush reach the panel before reading the counters
+        time.sleep(0.1)
+        stats = query_status(ser)
+
+    result = {
+        "writes": len(writes),
+        "bytes_sent": sum(len(d) for _, d in writes),
+        "elapsed_s": round(elapsed, 3),
+        "flush_latency": stats["flush_latency"],
+    }
+    for name in METRICS:
+        result[name] = stats[name]
+    if sync:
+        result["round_trip_us"] = {
+            name: {"count": len(v), "p50": int(percentile(v, 0.5)),
+                   "p95": int(percentile(v, 0.95)), "max": int(max(v))}
+            for name, v in sorted(round_trips.items())
+        }
+    return result
+
+
+def print_report(result, baseline=None):
+    def delta(name):
+        if not baseline or name not in baseline:
+            return ""
+        old = baseline[name]
+        if old == result[name]:
+            return "  (=)"
+        if old == 0:
+            return "  (was 0)"
+        return "  (%+.1f%%)" % ((result[name] - old) * 100.0 / old)
+
+    print("%-18s %d (%d bytes in %.2f s)" % ("writes", result["writes"], result["bytes_sent"], result["elapsed_s"]))
+    for name in METRICS:
+        print("%-18s %d%s" % (name, result[name], delta(name)))
+    print("flush_latency")
+    for label, count in result["flush_latency"].items():
+        if count:
+            print("  %-16s %d" % (label, count))
+    if "round_trip_us" in result:
+        print("round trip (us)      count     p50     p95     max")
+        for name, rt in result["round_trip_us"].items():
+            print("  %-16s %7d %7d %7d %7d" % (name, rt["count"], rt["p50"], rt["p95"], rt["max"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0, or sim:<sim_device>")
+    parser.add_argument("session", help="session file (tools/record.py format)")
+    parser.add_argument("--speed", type=float, default=1.0, help="playback speed factor (default 1.0)")
+    parser.add_argument("--fast", action="store_true", help="ignore timestamps, send back to back")
+    parser.add_argument("--sync", action="store_true", help="measure the round trip of every write")
+    parser.add_argument("--json", action="store_true", help="print JSON")
+    parser.add_argument("--compare", metavar="JSON", help="show changes against a previous --json run")
+    args = parser.parse_args()
+
+    try:
+        writes = read_session(args.session)
+        result = replay(args.port, writes, args.speed, args.fast, args.sync)
+    except port_errors() as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    if args.json:
+        print(json.dumps(result, indent=2))
+        return 0
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+    print_report(result, baseline)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
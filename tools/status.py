@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Query and decode the USB HID Display status counters (CMD_STATUS, 0x0D).
+
+Usage:
+    status.py /dev/ttyACM0            # print counters
+    status.py /dev/ttyACM0 --reset    # print, then zero counters on the device
+    status.py /dev/ttyACM0 --json     # machine-readable output for fleet monitoring
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from devport import open_port, port_errors  # noqa: E402
+
+CMD_STATUS = 0x0D
+STATUS_FLAG_RESET = 0x01
+
+# Must match device_stats_t in rp2040/src/main.h
+STATS_VERSION = 3
+STATS_CMD_SLOTS = 64
+STATS_LATENCY_BUCKETS = 8
+STATS_LATENCY_BASE_US = 250
+
+SCALAR_FIELDS = [
+    "version", "uptime_ms", "flags",
+    "i2c_transactions", "i2c_bytes", "i2c_failures", "i2c_retries",
+    "parser_resyncs", "parser_overflows", "parser_timeouts",
+    "hid_sent", "hid_dropped", "loop_max_us",
+    "display_recoveries", "i2c_baud",
+    "packets_ok", "packet_header_errors", "packet_crc_errors", "packet_dropped_bytes",
+]
+
+FLAG_NAMES = {0x01: "display_ok", 0x02: "portrait"}
+
+COMMAND_NAMES = {
+    0x01: "CLEAR", 0x02: "DRAW_TEXT", 0x03: "SET_CURSOR", 0x04: "INVERT",
+    0x05: "BRIGHTNESS", 0x06: "PROGRESS_BAR", 0x07: "POWER", 0x08: "INPUT_CONFIG",
+    0x09: "CONFIG_SET", 0x0A: "CONFIG_RESET", 0x0B: "SPLASH", 0x0C: "BOOT_TIME",
+    0x0D: "STATUS", 0x0E: "TRACE", 0x0F: "SELECT_DISPLAY",
+    0x10: "FRAME", 0x11: "GFX", 0x12: "GRAPH", 0x13: "MENU", 0x14: "ANIM",
+    0x15: "CAPTURE", 0x16: "MACRO", 0x17: "PACKET", 0x18: "GRID",
+}
+
+
+def latency_bucket_label(index):
+    if index == STATS_LATENCY_BUCKETS - 1:
+        return ">=%dus" % (STATS_LATENCY_BASE_US << (index - 1))
+    return "<%dus" % (STATS_LATENCY_BASE_US << index)
+
+
+def decode(payload):
+    """Decode a device_stats_t payload into a dict."""
+    words = len(payload) // 4
+    values = struct.unpack("<%dI" % words, payload[:words * 4])
+    if values[0] != STATS_VERSION:
+        raise ValueError("unsupported stats version %d" % values[0])
+
+    stats = dict(zip(SCALAR_FIELDS, values))
+    pos = len(SCALAR_FIELDS)
+    stats["flush_latency"] = {
+        latency_bucket_label(i): values[pos + i] for i in range(STATS_LATENCY_BUCKETS)
+    }
+    pos += STATS_LATENCY_BUCKETS
+    commands = {}
+    for opcode, count in enumerate(values[pos:pos + STATS_CMD_SLOTS]):
+        if count:
+            name = COMMAND_NAMES.get(opcode, "0x%02X" % opcode)
+            if opcode == STATS_CMD_SLOTS - 1:
+                name = "other"
+            commands[name] = count
+    stats["commands"] = commands
+    stats["flag_names"] = [n for bit, n in FLAG_NAMES.items() if stats["flags"] & bit]
+    return stats
+
+
+def query(port, reset=False, timeout=1.0):
+    """Send CMD_STATUS and return the raw device_stats_t payload."""
+    with open_port(port, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(bytes([CMD_STATUS, STATUS_FLAG_RESET if reset else 0]))
+        header = ser.read(3)
+        if len(header) != 3 or header[0] != CMD_STATUS:
+            raise IOError("no status reply (got %r)" % header)
+        length = header[1] | (header[2] << 8)
+        payload = ser.read(length)
+        if len(payload) != length:
+            raise IOError("short status reply: %d of %d bytes" % (len(payload), length))
+        return payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0, or sim:<sim_device>")
+    parser.add_argument("--reset", action="store_true", help="zero counters after reading")
+    parser.add_argument("--json", action="store_true", help="print JSON")
+    args = parser.parse_args()
+
+    try:
+        stats = decode(query(args.port, args.reset))
+    except port_errors() as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    if args.json:
+        print(json.dumps(stats, indent=2))
+        return 0
+
+    for name in SCALAR_FIELDS:
+        if name == "flags":
+            print("%-18s %s" % (name, ", ".join(stats["flag_names"]) or "-"))
+        else:
+            print("%-18s %d" % (name, stats[name]))
+    print("flush_latency")
+    for label, count in stats["flush_latency"].items():
+        print("  %-16s %d" % (label, count))
+    print("commands")
+    for name, count in stats["commands"].items():
+        print("  %-16s %d" % (name, count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
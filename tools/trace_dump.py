@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Dump the firmware trace ring buffer (CMD_TRACE, 0x0E) as Chrome trace JSON.
+
+Requires firmware built with -DENABLE_TRACE=ON. Open the output in
+chrome://tracing or https://ui.perfetto.dev.
+
+Usage:
+    trace_dump.py /dev/ttyACM0 -o trace.json           # dump
+    trace_dump.py /dev/ttyACM0 -o trace.json --clear   # dump, then clear the ring
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from devport import open_port, port_errors  # noqa: E402
+
+CMD_TRACE = 0x0E
+TRACE_OP_DUMP = 0x00
+TRACE_OP_CLEAR = 0x01
+
+# Must match trace_event_t / TRACE_EV_* in rp2040/src/trace.h
+EVENT_SIZE = 8
+EVENTS = {
+    0x01: ("command", "protocol"),
+    0x02: ("i2c", "i2c"),
+    0x03: ("hid_report", "usb"),
+    0x04: ("loop", "main"),
+}
+# One Chrome "thread" per subsystem so overlapping spans stay readable
+THREADS = {"main": 1, "protocol": 2, "i2c": 3, "usb": 4}
+
+
+def dump(ser, clear=False):
+    """Dump the ring over an open port; returns (ts_us, phase, id, arg) tuples."""
+    ser.write(bytes([CMD_TRACE, TRACE_OP_DUMP]))
+    header = ser.read(3)
+    if len(header) != 3 or header[0] != CMD_TRACE:
+        raise IOError("no trace reply (got %r)" % header)
+    count = header[1] | (header[2] << 8)
+    data = ser.read(count * EVENT_SIZE)
+    if len(data) != count * EVENT_SIZE:
+        raise IOError("short trace reply: %d of %d bytes" % (len(data), count * EVENT_SIZE))
+    if clear:
+        ser.write(bytes([CMD_TRACE, TRACE_OP_CLEAR]))
+    return [struct.unpack_from("<IBBH", data, i * EVENT_SIZE) for i in range(count)]
+
+
+def read_events(port, clear=False, timeout=2.0):
+    with open_port(port, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        return dump(ser, clear)
+
+
+def to_chrome(events):
+    """Convert (ts_us, phase, id, arg) tuples to Chrome trace events.
+
+    time_us_32() wraps every ~71 minutes, so timestamps are unwrapped relative
+    to the first event.
+    """
+    out = []
+    base = None
+    last = 0
+    offset = 0
+    for ts, phase, ev_id, arg in events:
+        if base is None:
+            base = ts
+        if ts < last:
+            offset += 1 << 32
+        last = ts
+        name, category = EVENTS.get(ev_id, ("event_%02x" % ev_id, "other"))
+        if ev_id == 0x01:
+            name = "cmd_0x%02x" % arg
+        entry = {
+            "name": name,
+            "cat": category,
+            "ph": chr(phase),
+            "ts": ts + offset - base,
+            "pid": 1,
+            "tid": THREADS.get(category, 9),
+            "args": {"arg": arg},
+        }
+        if entry["ph"] == "i":
+            entry["s"] = "t"
+        out.append(entry)
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="CDC serial port, e.g. /dev/ttyACM0, or sim:<sim_device>")
+    parser.add_argument("-o", "--output", default="-", help="output file (default stdout)")
+    parser.add_argument("--clear", action="store_true", help="clear the ring after dumping")
+    args = parser.parse_args()
+
+    try:
+        events = read_events(args.port, args.clear)
+    except port_errors() as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+    if not events:
+        print("no events (is the firmware built with -DENABLE_TRACE=ON?)", file=sys.stderr)
+
+    trace = to_chrome(events)
+    if args.output == "-":
+        json.dump(trace, sys.stdout, indent=1)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+        print("%d events written to %s" % (len(events), args.output), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())